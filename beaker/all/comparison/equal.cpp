@@ -8,14 +8,16 @@
 namespace beaker {
 
 
-/// Returns true if a and b are the same name.
-bool
-equal(const name& a, const name& b)
+/// Returns true if a and b have the same kind and equal properties.
+static bool
+compare_structure(const name& a, const name& b)
 {
-  if (&a == &b)
-    return true;
   if (a.get_kind() != b.get_kind())
     return false;
+#if BEAKER_HASH_CACHE
+  if (a.hash_ && b.hash_ && a.hash_ != b.hash_)
+    return false;
+#endif
   switch (a.get_kind()) {
 #define def_name(NS, N) \
     case NS::N ## _name_kind: \
@@ -25,14 +27,20 @@ equal(const name& a, const name& b)
   assert(false && "invalid type");
 }
 
-/// Returns true if a and b are the same type.
-bool
-equal(const type& a, const type& b)
+/// Returns true if a and b have the same kind and equal properties.
+///
+/// When the library is configured with BEAKER_HASH_CACHE, types whose 
+/// stored hash codes differ are not equal, and they are not compared
+/// further.
+static bool
+compare_structure(const type& a, const type& b)
 {
-  if (&a == &b)
-    return true;
   if (a.get_kind() != b.get_kind())
     return false;
+#if BEAKER_HASH_CACHE
+  if (a.hash_ && b.hash_ && a.hash_ != b.hash_)
+    return false;
+#endif
   switch (a.get_kind()) {
 #define def_type(NS, T) \
     case NS::T ## _type_kind: \
@@ -42,6 +50,44 @@ equal(const type& a, const type& b)
   assert(false && "invalid type");
 }
 
+/// Returns true if the distinct names a and b are equal. Distinct canonical
+/// names are never equal.
+bool
+equal_distinct(const name& a, const name& b)
+{
+  assert(&a != &b);
+  if (is_canonical_name(a))
+    return false;
+  return compare_structure(a, b);
+}
+
+/// Returns true if the distinct types a and b are equal. Distinct canonical
+/// types are never equal.
+bool
+equal_distinct(const type& a, const type& b)
+{
+  assert(&a != &b);
+  if (is_canonical_type(a))
+    return false;
+  return compare_structure(a, b);
+}
+
+/// Returns true if a and b have equal structure, even if they are distinct
+/// canonical names.
+bool
+equal_structure(const name& a, const name& b)
+{
+  return &a == &b || compare_structure(a, b);
+}
+
+/// Returns true if a and b have equal structure, even if they are distinct
+/// canonical types. The operands of a and b are compared by equal(). 
+bool
+equal_structure(const type& a, const type& b)
+{
+  return &a == &b || compare_structure(a, b);
+}
+
 /// Returns true if a and b denote the same computations.
 bool
 equal(const expr& a, const expr& b)
@@ -62,4 +108,12 @@ equal(const expr& a, const expr& b)
   assert(false && "invalid expression");
 }
 
+/// Returns true if a and b have equal structure. This is the same as 
+/// equal().
+bool
+equal_structure(const expr& a, const expr& b)
+{
+  return equal(a, b);
+}
+
 } // namespace beaker
\ No newline at end of file
@@ -5,3 +5,4 @@
 #include <beaker/sys.name/comparison/equal.hpp>
 #include <beaker/sys.var/comparison/equal.hpp>
 #include <beaker/sys.fn/comparison/equal.hpp>
+#include <beaker/sys.tuple/comparison/equal.hpp>
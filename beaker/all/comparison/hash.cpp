@@ -8,8 +8,8 @@
 namespace beaker {
 
 /// Appends the kind of n's hash code and dispatch to an appropriate overload.
-void
-hash(hasher& h, const name& n)
+static void
+append_structure(hasher& h, const name& n)
 {
   hash(h, n.get_kind());
   switch (n.get_kind()) {
@@ -22,8 +22,8 @@ hash(hasher& h, const name& n)
 }
 
 /// Appends the kind of t's hash code and dispatch to an appropriate overload.
-void
-hash(hasher& h, const type& t)
+static void
+append_structure(hasher& h, const type& t)
 {
   hash(h, t.get_kind());
   switch (t.get_kind()) {
@@ -35,6 +35,68 @@ hash(hasher& h, const type& t)
   assert(false && "invalid type");
 }
 
+#if BEAKER_HASH_CACHE
+/// Returns the hash code stored in t, computing it if needed. A computed
+/// code is never 0.
+template<typename T>
+static inline std::uint32_t
+get_hash_code(const T& t)
+{
+  if (!t.hash_) {
+    hasher h;
+    append_structure(h, t);
+    std::uint32_t c = std::size_t(h);
+    t.hash_ = c ? c : 1;
+  }
+  return t.hash_;
+}
+#endif
+
+/// Hash the structure of n into h, even if n is canonical. When the library
+/// is configured with BEAKER_HASH_CACHE, this appends the hash code stored 
+/// in n.
+void
+hash_structure(hasher& h, const name& n)
+{
+#if BEAKER_HASH_CACHE
+  hash(h, get_hash_code(n));
+#else
+  append_structure(h, n);
+#endif
+}
+
+/// Hash the structure of t into h, even if t is canonical. When the library
+/// is configured with BEAKER_HASH_CACHE, this appends the hash code stored 
+/// in t, so that hashing a type takes constant time after its first hash.
+void
+hash_structure(hasher& h, const type& t)
+{
+#if BEAKER_HASH_CACHE
+  hash(h, get_hash_code(t));
+#else
+  append_structure(h, t);
+#endif
+}
+
+/// Hash n into h. Canonical names are hashed by identity.
+void
+hash(hasher& h, const name& n)
+{
+  if (is_canonical_name(n))
+    return hash(h, &n);
+  hash_structure(h, n);
+}
+
+/// Hash t into h. Canonical types are hashed by identity, so the operands
+/// of a term are hashed in constant time.
+void
+hash(hasher& h, const type& t)
+{
+  if (is_canonical_type(t))
+    return hash(h, &t);
+  hash_structure(h, t);
+}
+
 /// Appends the kind of n's hash code and dispatch to an appropriate overload.
 void
 hash(hasher& h, const expr& e)
@@ -52,4 +114,11 @@ hash(hasher& h, const expr& e)
   assert(false && "invalid expression");
 }
 
+/// Hash the structure of e into h. This is the same as hash().
+void
+hash_structure(hasher& h, const expr& e)
+{
+  hash(h, e);
+}
+
 } // namespace
\ No newline at end of file
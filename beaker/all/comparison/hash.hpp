@@ -5,3 +5,4 @@
 #include <beaker/sys.name/comparison/hash.hpp>
 #include <beaker/sys.var/comparison/hash.hpp>
 #include <beaker/sys.fn/comparison/hash.hpp>
+#include <beaker/sys.tuple/comparison/hash.hpp>
@@ -0,0 +1,254 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "iterative.hpp"
+#include "equal.hpp"
+#include "hash.hpp"
+#include "../ast.hpp"
+
+#include <type_traits>
+
+
+namespace beaker {
+
+// -------------------------------------------------------------------------- //
+// Overrides
+//
+// A feature overrides the comparison of an expression by declaring an
+// overload of equal_expr() or hash_expr() for exactly that expression. 
+// Other expressions are compared by the overloads for their structure.
+
+/// True when there is an overload of equal_expr() for exactly T.
+template<typename T, typename = void>
+struct has_equal_override : std::false_type { };
+
+template<typename T>
+struct has_equal_override<T, decltype((void)static_cast<bool (*)(const T&, const T&)>(&equal_expr))>
+  : std::true_type
+{ };
+
+/// True when there is an overload of hash_expr() for exactly T.
+template<typename T, typename = void>
+struct has_hash_override : std::false_type { };
+
+template<typename T>
+struct has_hash_override<T, decltype((void)static_cast<void (*)(hasher&, const T&)>(&hash_expr))>
+  : std::true_type
+{ };
+
+
+// -------------------------------------------------------------------------- //
+// Equality
+//
+// Each function compares the properties of two expressions of the same kind
+// and schedules the comparison of their operands, left to right.
+
+using expr_pair = std::pair<const expr*, const expr*>;
+
+/// Expressions without a structure are compared by equal(), which diagnoses
+/// a missing comparison.
+static bool
+compare_expr(iterative_comparison& c, const expr& a, const expr& b)
+{
+  return equal(a, b);
+}
+
+static bool
+compare_expr(iterative_comparison& c, const nullary_expr& a, const nullary_expr& b)
+{
+  return true;
+}
+
+static bool
+compare_expr(iterative_comparison& c, const literal_expr& a, const literal_expr& b)
+{
+  return a.get_value() == b.get_value();
+}
+
+static bool
+compare_expr(iterative_comparison& c, const unary_expr& a, const unary_expr& b)
+{
+  c.pairs_.push(expr_pair(&a.get_first(), &b.get_first()));
+  return true;
+}
+
+static bool
+compare_expr(iterative_comparison& c, const binary_expr& a, const binary_expr& b)
+{
+  c.pairs_.push(expr_pair(&a.get_second(), &b.get_second()));
+  c.pairs_.push(expr_pair(&a.get_first(), &b.get_first()));
+  return true;
+}
+
+static bool
+compare_expr(iterative_comparison& c, const ternary_expr& a, const ternary_expr& b)
+{
+  c.pairs_.push(expr_pair(&a.get_third(), &b.get_third()));
+  c.pairs_.push(expr_pair(&a.get_second(), &b.get_second()));
+  c.pairs_.push(expr_pair(&a.get_first(), &b.get_first()));
+  return true;
+}
+
+template<typename T>
+static inline bool
+compare(iterative_comparison& c, const T& a, const T& b, std::true_type)
+{
+  return equal_expr(a, b);
+}
+
+template<typename T>
+static inline bool
+compare(iterative_comparison& c, const T& a, const T& b, std::false_type)
+{
+  return compare_expr(c, a, b);
+}
+
+/// Compare the properties of `a` and `b`, which have the same kind.
+static bool
+compare(iterative_comparison& c, const expr& a, const expr& b)
+{
+  switch (a.get_kind()) {
+#define def_expr(NS, E) \
+    case NS::E ## _expr_kind: { \
+      using T = NS::E ## _expr; \
+      return compare(c, cast<T>(a), cast<T>(b), has_equal_override<T>()); \
+    }
+#define def_init(NS, E) \
+    case NS::E ## _init_kind: { \
+      using T = NS::E ## _init; \
+      return compare(c, cast<T>(a), cast<T>(b), has_equal_override<T>()); \
+    }
+#include <beaker/all/expr.def>
+#undef def_expr
+#undef def_init
+  }
+  assert(false && "invalid expression");
+}
+
+/// Returns true if `a` and `b` denote the same computations.
+bool
+iterative_comparison::equal(const expr& a, const expr& b)
+{
+  pairs_.clear();
+  pairs_.push(expr_pair(&a, &b));
+  while (!pairs_.is_empty()) {
+    expr_pair p = pairs_.pop();
+    if (p.first == p.second)
+      continue;
+    if (p.first->get_kind() != p.second->get_kind())
+      return false;
+    if (!compare(*this, *p.first, *p.second))
+      return false;
+  }
+  return true;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Hashing
+//
+// Each function appends the properties of an expression to a hasher and
+// schedules its operands, left to right.
+
+/// Expressions without a structure are hashed by hash_expr(), which
+/// diagnoses a missing hash.
+static void
+hash_operands(iterative_comparison& c, hasher& h, const expr& e)
+{
+  hash_expr(h, e);
+}
+
+static void
+hash_operands(iterative_comparison& c, hasher& h, const nullary_expr& e)
+{ }
+
+static void
+hash_operands(iterative_comparison& c, hasher& h, const literal_expr& e)
+{
+  hash(h, e.get_value());
+}
+
+static void
+hash_operands(iterative_comparison& c, hasher& h, const unary_expr& e)
+{
+  c.exprs_.push(&e.get_first());
+}
+
+static void
+hash_operands(iterative_comparison& c, hasher& h, const binary_expr& e)
+{
+  c.exprs_.push(&e.get_second());
+  c.exprs_.push(&e.get_first());
+}
+
+static void
+hash_operands(iterative_comparison& c, hasher& h, const ternary_expr& e)
+{
+  c.exprs_.push(&e.get_third());
+  c.exprs_.push(&e.get_second());
+  c.exprs_.push(&e.get_first());
+}
+
+template<typename T>
+static inline void
+append(iterative_comparison& c, hasher& h, const T& e, std::true_type)
+{
+  hash_expr(h, e);
+}
+
+template<typename T>
+static inline void
+append(iterative_comparison& c, hasher& h, const T& e, std::false_type)
+{
+  hash_operands(c, h, e);
+}
+
+/// Append the kind and properties of `e` to `h`.
+static void
+append(iterative_comparison& c, hasher& h, const expr& e)
+{
+  hash(h, e.get_kind());
+  switch (e.get_kind()) {
+#define def_expr(NS, E) \
+    case NS::E ## _expr_kind: { \
+      using T = NS::E ## _expr; \
+      return append(c, h, cast<T>(e), has_hash_override<T>()); \
+    }
+#define def_init(NS, E) \
+    case NS::E ## _init_kind: { \
+      using T = NS::E ## _init; \
+      return append(c, h, cast<T>(e), has_hash_override<T>()); \
+    }
+#include <beaker/all/expr.def>
+  }
+  assert(false && "invalid expression");
+}
+
+/// Hash `e` into `h`.
+void
+iterative_comparison::hash(hasher& h, const expr& e)
+{
+  exprs_.clear();
+  exprs_.push(&e);
+  while (!exprs_.is_empty())
+    append(*this, h, *exprs_.pop());
+}
+
+
+/// Returns true if `a` and `b` denote the same computations.
+bool
+equal_iterative(const expr& a, const expr& b)
+{
+  iterative_comparison c;
+  return c.equal(a, b);
+}
+
+/// Hash `e` into `h` without recursion.
+void
+hash_iterative(hasher& h, const expr& e)
+{
+  iterative_comparison c;
+  c.hash(h, e);
+}
+
+} // namespace beaker
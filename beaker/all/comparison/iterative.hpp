@@ -0,0 +1,44 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_ALL_COMPARISON_ITERATIVE_HPP
+#define BEAKER_ALL_COMPARISON_ITERATIVE_HPP
+
+#include <beaker/base/lang.hpp>
+
+#include <beaker/util/hash.hpp>
+#include <beaker/util/work_stack.hpp>
+
+#include <utility>
+
+
+namespace beaker {
+
+/// Compares and hashes expressions without recursing on the call stack.
+///
+/// Expressions whose comparison is determined by their structure (literals 
+/// and expressions with one, two, or three operands) schedule their operands
+/// on a work stack. The results are the same as for equal() and hash(); in
+/// particular, hashing appends the same sequence of bytes. Expressions whose
+/// features override their comparison or hashing are compared and hashed by
+/// that override.
+///
+/// The stacks are retained between uses so that repeated comparisons do not
+/// allocate memory.
+struct iterative_comparison
+{
+  bool equal(const expr&, const expr&);
+  void hash(hasher&, const expr&);
+
+  work_stack<std::pair<const expr*, const expr*>> pairs_;
+  work_stack<const expr*> exprs_;
+};
+
+
+bool equal_iterative(const expr&, const expr&);
+void hash_iterative(hasher&, const expr&);
+
+} // namespace beaker
+
+
+#endif
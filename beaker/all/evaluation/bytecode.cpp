@@ -0,0 +1,446 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "bytecode.hpp"
+#include "../ast.hpp"
+
+
+namespace beaker {
+
+/// Returns the change in the depth of the operand stack caused by executing
+/// an instruction.
+static int
+get_stack_effect(opcode op)
+{
+  switch (op) {
+    case push_void_op:
+    case push_int_op:
+    case walk_op:
+    case trap_op:
+      return 1;
+    case jump_op:
+    case bool_not_op:
+    case bool_assert_op:
+    case neg_int_op:
+    case neg_mod_op:
+    case rec_nat_op:
+    case rec_int_op:
+      return 0;
+    default:
+      // All other operations consume one or two operands and produce at
+      // most one value.
+      return -1;
+  }
+}
+
+/// Append an instruction compiled from `e` to the program. Returns the index
+/// of the new instruction.
+int
+compiler::emit(opcode op, const expr& e, std::intmax_t arg)
+{
+  std::vector<const expr*>& src = prog_->src_;
+  if (src.empty() || src.back() != &e)
+    src.push_back(&e);
+  prog_->code_.push_back({op, std::int32_t(src.size() - 1), arg});
+  int k = get_stack_effect(op);
+  if (k > 0)
+    push(k);
+  else if (k < 0)
+    pop(-k);
+  return prog_->code_.size() - 1;
+}
+
+/// Records that n values were pushed onto the operand stack.
+void
+compiler::push(int n)
+{
+  depth_ += n;
+  if (depth_ > prog_->depth_)
+    prog_->depth_ = depth_;
+}
+
+/// Records that n values were removed from the operand stack.
+void
+compiler::pop(int n)
+{
+  depth_ -= n;
+  assert(depth_ >= 0);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Generic compilation
+
+/// Expressions without a dedicated instruction sequence are evaluated by the
+/// tree walker.
+static void
+compile_expr(compiler& c, const expr& e)
+{
+  c.emit(walk_op, e);
+}
+
+/// Compile the operands of `e` followed by the operation.
+static void
+compile_binary(compiler& c, const binary_expr& e, opcode op, std::intmax_t arg = 0)
+{
+  compile(c, e.get_lhs());
+  compile(c, e.get_rhs());
+  c.emit(op, e, arg);
+}
+
+/// Compile the operand of `e` followed by the operation.
+static void
+compile_unary(compiler& c, const unary_expr& e, opcode op, std::intmax_t arg = 0)
+{
+  compile(c, e.get_operand());
+  c.emit(op, e, arg);
+}
+
+/// Compile the conditional evaluation `e1 ? e2 : e3`. Only one of the two
+/// branches is evaluated, so only one value is counted on the stack.
+static void
+compile_conditional(compiler& c, const expr& e, const expr& e1, const expr& e2, const expr& e3)
+{
+  compile(c, e1);
+  int j1 = c.emit(jump_if_false_op, e);
+  compile(c, e2);
+  int j2 = c.emit(jump_op, e);
+  c.pop();
+  c.patch(j1, c.get_label());
+  compile(c, e3);
+  c.patch(j2, c.get_label());
+}
+
+
+// -------------------------------------------------------------------------- //
+// sys.void
+
+static void
+compile_expr(compiler& c, const sys_void::nop_expr& e)
+{
+  c.emit(push_void_op, e);
+}
+
+static void
+compile_expr(compiler& c, const sys_void::void_expr& e)
+{
+  compile(c, e.get_operand());
+  c.emit(pop_op, e);
+  c.emit(push_void_op, e);
+}
+
+static void
+compile_expr(compiler& c, const sys_void::trap_expr& e)
+{
+  c.emit(trap_op, e);
+}
+
+
+// -------------------------------------------------------------------------- //
+// sys.bool
+
+static void
+compile_expr(compiler& c, const sys_bool::bool_expr& e)
+{
+  c.emit(push_int_op, e, e.get_value().get_int());
+}
+
+static void
+compile_expr(compiler& c, const sys_bool::and_expr& e)
+{
+  compile_binary(c, e, bool_and_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_bool::or_expr& e)
+{
+  compile_binary(c, e, bool_or_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_bool::xor_expr& e)
+{
+  compile_binary(c, e, bool_xor_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_bool::not_expr& e)
+{
+  compile_unary(c, e, bool_not_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_bool::imp_expr& e)
+{
+  compile_binary(c, e, bool_imp_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_bool::eq_expr& e)
+{
+  compile_binary(c, e, bool_eq_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_bool::if_expr& e)
+{
+  compile_conditional(c, e, e.get_condition(), e.get_true_value(), e.get_false_value());
+}
+
+/// The expression `e1 && e2` is compiled as `e1 ? e2 : false`.
+static void
+compile_expr(compiler& c, const sys_bool::and_then_expr& e)
+{
+  compile(c, e.get_lhs());
+  int j1 = c.emit(jump_if_false_op, e);
+  compile(c, e.get_rhs());
+  int j2 = c.emit(jump_op, e);
+  c.pop();
+  c.patch(j1, c.get_label());
+  c.emit(push_int_op, e, 0);
+  c.patch(j2, c.get_label());
+}
+
+/// The expression `e1 || e2` is compiled as `e1 ? true : e2`.
+static void
+compile_expr(compiler& c, const sys_bool::or_else_expr& e)
+{
+  compile(c, e.get_lhs());
+  int j1 = c.emit(jump_if_true_op, e);
+  compile(c, e.get_rhs());
+  int j2 = c.emit(jump_op, e);
+  c.pop();
+  c.patch(j1, c.get_label());
+  c.emit(push_int_op, e, 1);
+  c.patch(j2, c.get_label());
+}
+
+static void
+compile_expr(compiler& c, const sys_bool::assert_expr& e)
+{
+  compile_unary(c, e, bool_assert_op);
+}
+
+
+// -------------------------------------------------------------------------- //
+// sys.int
+//
+// Expressions that compute with integers wider than a machine word are
+// evaluated by the tree walker. Values of unsigned types are ordered by
+// the nat comparisons, which compare the bits of their operands as 
+// unsigned words.
+
+static void
+compile_expr(compiler& c, const sys_int::int_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  c.emit(push_int_op, e, e.get_value().get_int());
+}
+
+static void
+compile_expr(compiler& c, const sys_int::eq_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  compile_binary(c, e, int_eq_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_int::ne_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  compile_binary(c, e, int_ne_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_int::lt_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  if (sys_int::is_unsigned_type(e.get_lhs().get_type()))
+    return compile_binary(c, e, nat_lt_op);
+  compile_binary(c, e, int_lt_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_int::gt_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  if (sys_int::is_unsigned_type(e.get_lhs().get_type()))
+    return compile_binary(c, e, nat_gt_op);
+  compile_binary(c, e, int_gt_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_int::le_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  if (sys_int::is_unsigned_type(e.get_lhs().get_type()))
+    return compile_binary(c, e, nat_le_op);
+  compile_binary(c, e, int_le_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_int::ge_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  if (sys_int::is_unsigned_type(e.get_lhs().get_type()))
+    return compile_binary(c, e, nat_ge_op);
+  compile_binary(c, e, int_ge_op);
+}
+
+static void
+compile_expr(compiler& c, const sys_int::add_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  const type& t = e.get_type();
+  switch (t.get_kind()) {
+    case sys_int::nat_type_kind:
+      return compile_binary(c, e, add_nat_op, cast<sys_int::nat_type>(t).max());
+    case sys_int::int_type_kind:
+      return compile_binary(c, e, add_int_op, cast<sys_int::int_type>(t).max());
+    case sys_int::mod_type_kind:
+      return compile_binary(c, e, add_mod_op, cast<sys_int::mod_type>(t).max());
+  }
+  assert(false && "not an integer expression");
+}
+
+static void
+compile_expr(compiler& c, const sys_int::sub_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  const type& t = e.get_type();
+  switch (t.get_kind()) {
+    case sys_int::nat_type_kind:
+      return compile_binary(c, e, sub_nat_op, cast<sys_int::nat_type>(t).min());
+    case sys_int::int_type_kind:
+      return compile_binary(c, e, sub_int_op, cast<sys_int::int_type>(t).min());
+    case sys_int::mod_type_kind:
+      return compile_binary(c, e, sub_mod_op, cast<sys_int::mod_type>(t).max());
+  }
+  assert(false && "not an integer expression");
+}
+
+static void
+compile_expr(compiler& c, const sys_int::mul_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  const type& t = e.get_type();
+  switch (t.get_kind()) {
+    case sys_int::nat_type_kind:
+      return compile_binary(c, e, mul_nat_op, cast<sys_int::nat_type>(t).max());
+    case sys_int::int_type_kind:
+      return compile_binary(c, e, mul_int_op, cast<sys_int::int_type>(t).max());
+    case sys_int::mod_type_kind:
+      return compile_binary(c, e, mul_mod_op, cast<sys_int::mod_type>(t).max());
+  }
+  assert(false && "not an integer expression");
+}
+
+static void
+compile_expr(compiler& c, const sys_int::quo_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  const type& t = e.get_type();
+  switch (t.get_kind()) {
+    case sys_int::nat_type_kind:
+    case sys_int::mod_type_kind:
+      return compile_binary(c, e, quo_nat_op);
+    case sys_int::int_type_kind:
+      return compile_binary(c, e, quo_int_op, cast<sys_int::int_type>(t).min());
+  }
+  assert(false && "not an integer expression");
+}
+
+static void
+compile_expr(compiler& c, const sys_int::rem_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  const type& t = e.get_type();
+  switch (t.get_kind()) {
+    case sys_int::nat_type_kind:
+    case sys_int::mod_type_kind:
+      return compile_binary(c, e, rem_nat_op);
+    case sys_int::int_type_kind:
+      return compile_binary(c, e, rem_int_op);
+  }
+  assert(false && "not an integer expression");
+}
+
+/// The negation of natural numbers is left to the tree walker, which
+/// diagnoses the error.
+static void
+compile_expr(compiler& c, const sys_int::neg_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  const type& t = e.get_type();
+  switch (t.get_kind()) {
+    case sys_int::nat_type_kind:
+      return compile_expr(c, static_cast<const expr&>(e));
+    case sys_int::int_type_kind:
+      return compile_unary(c, e, neg_int_op, cast<sys_int::int_type>(t).min());
+    case sys_int::mod_type_kind:
+      return compile_unary(c, e, neg_mod_op, cast<sys_int::mod_type>(t).max());
+  }
+  assert(false && "not an negatable expression");
+}
+
+static void
+compile_expr(compiler& c, const sys_int::rec_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return compile_expr(c, static_cast<const expr&>(e));
+  const type& t = e.get_type();
+  switch (t.get_kind()) {
+    case sys_int::nat_type_kind:
+    case sys_int::mod_type_kind:
+      return compile_unary(c, e, rec_nat_op);
+    case sys_int::int_type_kind:
+      return compile_unary(c, e, rec_int_op);
+  }
+  assert(false && "not an negatable expression");
+}
+
+
+// -------------------------------------------------------------------------- //
+// Dispatch
+
+/// Append the instructions that evaluate `e` to the program. The value of
+/// `e` is left on top of the operand stack.
+void
+compile(compiler& c, const expr& e)
+{
+  switch (e.get_kind()) {
+#define def_expr(NS, E) \
+    case NS::E ## _expr_kind: \
+      return compile_expr(c, cast<NS::E ## _expr>(e));
+#define def_init(NS, E) \
+    case NS::E ## _init_kind: \
+      return compile_expr(c, cast<NS::E ## _init>(e));
+#include <beaker/all/expr.def>
+  }
+  assert(false && "invalid expression");
+}
+
+/// Returns a program that computes the value of `e`.
+program
+compile(const expr& e)
+{
+  program p;
+  compiler c(p);
+  compile(c, e);
+  return p;
+}
+
+} // namespace beaker
@@ -0,0 +1,110 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_ALL_EVALUATION_BYTECODE_HPP
+#define BEAKER_ALL_EVALUATION_BYTECODE_HPP
+
+#include <beaker/base/evaluation/evaluate.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+namespace beaker {
+
+// -------------------------------------------------------------------------- //
+// Instructions
+
+/// The operations of the evaluation machine.
+///
+/// Arithmetic operations are selected for a specific integer representation
+/// when an expression is compiled, so the machine never inspects the type of
+/// an expression.
+enum opcode : std::int32_t
+{
+#define def_op(O) O ## _op,
+#include "opcode.def"
+  last_op
+};
+
+
+/// An instruction of the evaluation machine.
+///
+/// The source of an instruction is the index of the expression from which it
+/// was compiled. This is used to report evaluation errors. The argument is an
+/// immediate operand: a literal value, a jump target, the bound of an
+/// arithmetic operation, or the mask of a modular operation.
+struct instruction
+{
+  opcode op;
+  std::int32_t src;
+  std::intmax_t arg;
+};
+
+
+// -------------------------------------------------------------------------- //
+// Programs
+
+/// A program is the linear form of an expression. Programs are evaluated by
+/// a stack machine.
+///
+/// The depth of a program is the maximum number of values on the operand
+/// stack during its evaluation.
+struct program
+{
+  program();
+
+  const std::vector<instruction>& get_code() const;
+  const expr& get_source(int) const;
+  int get_depth() const;
+
+  std::vector<instruction> code_;
+  std::vector<const expr*> src_;
+  int depth_;
+};
+
+inline program::program() : depth_(0) { }
+
+/// Returns the instructions of the program.
+inline const std::vector<instruction>& program::get_code() const { return code_; }
+
+/// Returns the nth source expression of the program.
+inline const expr& program::get_source(int n) const { return *src_[n]; }
+
+/// Returns the maximum depth of the operand stack.
+inline int program::get_depth() const { return depth_; }
+
+
+/// The compiler maintains the program being built and the depth of the operand
+/// stack at the current instruction.
+struct compiler
+{
+  compiler(program&);
+
+  int emit(opcode, const expr&, std::intmax_t = 0);
+  int get_label() const;
+  void patch(int, int);
+
+  void push(int = 1);
+  void pop(int = 1);
+
+  program* prog_;
+  int depth_;
+};
+
+inline compiler::compiler(program& p) : prog_(&p), depth_(0) { }
+
+/// Returns the index of the next instruction.
+inline int compiler::get_label() const { return prog_->code_.size(); }
+
+/// Sets the target of the jump instruction at index n to the label l.
+inline void compiler::patch(int n, int l) { prog_->code_[n].arg = l; }
+
+
+program compile(const expr&);
+void compile(compiler&, const expr&);
+
+} // namespace beaker
+
+
+#endif
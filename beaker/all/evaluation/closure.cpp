@@ -0,0 +1,562 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "closure.hpp"
+#include "evaluate.hpp"
+#include "../ast.hpp"
+
+
+namespace beaker {
+
+/// Create a new closure evaluating `e` with the function `f`.
+closure&
+closure_program::make(closure::eval_fn f, const expr& e, std::intmax_t arg)
+{
+  nodes_.push_back({f, &e, {}, arg});
+  return nodes_.back();
+}
+
+
+// -------------------------------------------------------------------------- //
+// Evaluation functions
+//
+// Each function evaluates one operation. Arithmetic operations are computed
+// by the kernel of their type. Operands are evaluated in order, left to
+// right.
+
+/// Returns the value of the nth operand of `c`.
+static inline std::intmax_t
+get_operand(evaluator& eval, const closure& c, int n)
+{
+  return invoke(eval, *c.ops_[n]).get_int();
+}
+
+/// Evaluate the source expression using the tree walker.
+static value
+eval_walk(evaluator& eval, const closure& c)
+{
+  return evaluate(eval, *c.src_);
+}
+
+static value
+eval_void(evaluator& eval, const closure& c)
+{
+  return value();
+}
+
+static value
+eval_discard(evaluator& eval, const closure& c)
+{
+  invoke(eval, *c.ops_[0]);
+  return value();
+}
+
+static value
+eval_trap(evaluator& eval, const closure& c)
+{
+  throw sys_void::trap_error(*c.src_);
+}
+
+static value
+eval_int(evaluator& eval, const closure& c)
+{
+  return value(c.arg_);
+}
+
+static value
+eval_and(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value(a & get_operand(eval, c, 1));
+}
+
+static value
+eval_or(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value(a | get_operand(eval, c, 1));
+}
+
+static value
+eval_xor(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value(a ^ get_operand(eval, c, 1));
+}
+
+static value
+eval_not(evaluator& eval, const closure& c)
+{
+  return value(!get_operand(eval, c, 0));
+}
+
+static value
+eval_imp(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value((!a) | get_operand(eval, c, 1));
+}
+
+static value
+eval_if(evaluator& eval, const closure& c)
+{
+  if (get_operand(eval, c, 0))
+    return invoke(eval, *c.ops_[1]);
+  else
+    return invoke(eval, *c.ops_[2]);
+}
+
+static value
+eval_and_then(evaluator& eval, const closure& c)
+{
+  if (!get_operand(eval, c, 0))
+    return value(0);
+  return invoke(eval, *c.ops_[1]);
+}
+
+static value
+eval_or_else(evaluator& eval, const closure& c)
+{
+  if (get_operand(eval, c, 0))
+    return value(1);
+  return invoke(eval, *c.ops_[1]);
+}
+
+static value
+eval_assert(evaluator& eval, const closure& c)
+{
+  if (!get_operand(eval, c, 0))
+    throw sys_bool::assertion_error(*c.src_);
+  return value(1);
+}
+
+static value
+eval_eq(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value(a == get_operand(eval, c, 1));
+}
+
+static value
+eval_ne(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value(a != get_operand(eval, c, 1));
+}
+
+static value
+eval_lt(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value(a < get_operand(eval, c, 1));
+}
+
+static value
+eval_gt(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value(a > get_operand(eval, c, 1));
+}
+
+static value
+eval_le(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value(a <= get_operand(eval, c, 1));
+}
+
+static value
+eval_ge(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  return value(a >= get_operand(eval, c, 1));
+}
+
+// Values of unsigned types are ordered as unsigned words.
+static value
+eval_nat_lt(evaluator& eval, const closure& c)
+{
+  std::uintmax_t a = get_operand(eval, c, 0);
+  return value(a < std::uintmax_t(get_operand(eval, c, 1)));
+}
+
+static value
+eval_nat_gt(evaluator& eval, const closure& c)
+{
+  std::uintmax_t a = get_operand(eval, c, 0);
+  return value(a > std::uintmax_t(get_operand(eval, c, 1)));
+}
+
+static value
+eval_nat_le(evaluator& eval, const closure& c)
+{
+  std::uintmax_t a = get_operand(eval, c, 0);
+  return value(a <= std::uintmax_t(get_operand(eval, c, 1)));
+}
+
+static value
+eval_nat_ge(evaluator& eval, const closure& c)
+{
+  std::uintmax_t a = get_operand(eval, c, 0);
+  return value(a >= std::uintmax_t(get_operand(eval, c, 1)));
+}
+
+/// Returns the value `r` computed for `c`, or throws the error indicated by
+/// the status `s`.
+static inline value
+check_result(const closure& c, sys_int::arith_status s, std::intmax_t r)
+{
+  switch (s) {
+    case sys_int::arith_ok: return value(r);
+    case sys_int::arith_overflow: throw sys_int::overflow_error(*c.src_);
+    case sys_int::arith_division: throw sys_int::division_error(*c.src_);
+  }
+  assert(false && "invalid arithmetic status");
+}
+
+/// Evaluate a binary arithmetic operation using the kernel operation bound
+/// to the closure.
+static value
+eval_binary(evaluator& eval, const closure& c)
+{
+  std::intmax_t a = get_operand(eval, c, 0);
+  std::intmax_t b = get_operand(eval, c, 1);
+  std::intmax_t r;
+  sys_int::arith_status s = c.binary_(a, b, r);
+  return check_result(c, s, r);
+}
+
+/// Evaluate a unary arithmetic operation using the kernel operation bound
+/// to the closure.
+static value
+eval_unary(evaluator& eval, const closure& c)
+{
+  std::intmax_t n = get_operand(eval, c, 0);
+  std::intmax_t r;
+  sys_int::arith_status s = c.unary_(n, r);
+  return check_result(c, s, r);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Generic binding
+
+static const closure& bind(closure_program&, const expr&);
+
+/// Expressions without a dedicated closure are evaluated by the tree walker.
+static const closure&
+bind_expr(closure_program& p, const expr& e)
+{
+  return p.make(eval_walk, e);
+}
+
+/// Bind the operand of `e` to the function `f`.
+static closure&
+bind_unary(closure_program& p, const unary_expr& e, closure::eval_fn f, std::intmax_t arg = 0)
+{
+  const closure& c1 = bind(p, e.get_operand());
+  closure& c = p.make(f, e, arg);
+  c.ops_[0] = &c1;
+  return c;
+}
+
+/// Bind the operands of `e` to the function `f`.
+static closure&
+bind_binary(closure_program& p, const binary_expr& e, closure::eval_fn f, std::intmax_t arg = 0)
+{
+  const closure& c1 = bind(p, e.get_lhs());
+  const closure& c2 = bind(p, e.get_rhs());
+  closure& c = p.make(f, e, arg);
+  c.ops_[0] = &c1;
+  c.ops_[1] = &c2;
+  return c;
+}
+
+/// Bind the operands of `e` to the kernel operation `op` of its type.
+static const closure&
+bind_arith(closure_program& p, const binary_expr& e, 
+           sys_int::kernel::binary_fn sys_int::kernel::* op)
+{
+  closure& c = bind_binary(p, e, eval_binary);
+  c.binary_ = sys_int::get_kernel(e.get_type()).*op;
+  return c;
+}
+
+/// Bind the operand of `e` to the kernel operation `op` of its type.
+static const closure&
+bind_arith(closure_program& p, const unary_expr& e, 
+           sys_int::kernel::unary_fn sys_int::kernel::* op)
+{
+  closure& c = bind_unary(p, e, eval_unary);
+  c.unary_ = sys_int::get_kernel(e.get_type()).*op;
+  return c;
+}
+
+
+// -------------------------------------------------------------------------- //
+// sys.void
+
+static const closure&
+bind_expr(closure_program& p, const sys_void::nop_expr& e)
+{
+  return p.make(eval_void, e);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_void::void_expr& e)
+{
+  return bind_unary(p, e, eval_discard);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_void::trap_expr& e)
+{
+  return p.make(eval_trap, e);
+}
+
+
+// -------------------------------------------------------------------------- //
+// sys.bool
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::bool_expr& e)
+{
+  return p.make(eval_int, e, e.get_value().get_int());
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::and_expr& e)
+{
+  return bind_binary(p, e, eval_and);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::or_expr& e)
+{
+  return bind_binary(p, e, eval_or);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::xor_expr& e)
+{
+  return bind_binary(p, e, eval_xor);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::not_expr& e)
+{
+  return bind_unary(p, e, eval_not);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::imp_expr& e)
+{
+  return bind_binary(p, e, eval_imp);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::eq_expr& e)
+{
+  return bind_binary(p, e, eval_eq);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::if_expr& e)
+{
+  const closure& c1 = bind(p, e.get_condition());
+  const closure& c2 = bind(p, e.get_true_value());
+  const closure& c3 = bind(p, e.get_false_value());
+  closure& c = p.make(eval_if, e);
+  c.ops_[0] = &c1;
+  c.ops_[1] = &c2;
+  c.ops_[2] = &c3;
+  return c;
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::and_then_expr& e)
+{
+  return bind_binary(p, e, eval_and_then);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::or_else_expr& e)
+{
+  return bind_binary(p, e, eval_or_else);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_bool::assert_expr& e)
+{
+  return bind_unary(p, e, eval_assert);
+}
+
+
+// -------------------------------------------------------------------------- //
+// sys.int
+//
+// Expressions that compute with integers wider than a machine word are
+// evaluated by the tree walker.
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::int_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return p.make(eval_int, e, e.get_value().get_int());
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::eq_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return bind_binary(p, e, eval_eq);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::ne_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return bind_binary(p, e, eval_ne);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::lt_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  if (sys_int::is_unsigned_type(e.get_lhs().get_type()))
+    return bind_binary(p, e, eval_nat_lt);
+  return bind_binary(p, e, eval_lt);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::gt_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  if (sys_int::is_unsigned_type(e.get_lhs().get_type()))
+    return bind_binary(p, e, eval_nat_gt);
+  return bind_binary(p, e, eval_gt);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::le_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  if (sys_int::is_unsigned_type(e.get_lhs().get_type()))
+    return bind_binary(p, e, eval_nat_le);
+  return bind_binary(p, e, eval_le);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::ge_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_lhs().get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  if (sys_int::is_unsigned_type(e.get_lhs().get_type()))
+    return bind_binary(p, e, eval_nat_ge);
+  return bind_binary(p, e, eval_ge);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::add_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return bind_arith(p, e, &sys_int::kernel::add_);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::sub_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return bind_arith(p, e, &sys_int::kernel::sub_);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::mul_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return bind_arith(p, e, &sys_int::kernel::mul_);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::quo_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return bind_arith(p, e, &sys_int::kernel::quo_);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::rem_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return bind_arith(p, e, &sys_int::kernel::rem_);
+}
+
+/// The negation of natural numbers is left to the tree walker, which
+/// diagnoses the error.
+static const closure&
+bind_expr(closure_program& p, const sys_int::neg_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  if (is<sys_int::nat_type>(e.get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return bind_arith(p, e, &sys_int::kernel::neg_);
+}
+
+static const closure&
+bind_expr(closure_program& p, const sys_int::rec_expr& e)
+{
+  if (sys_int::is_wide_type(e.get_type()))
+    return bind_expr(p, static_cast<const expr&>(e));
+  return bind_arith(p, e, &sys_int::kernel::rec_);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Dispatch
+
+/// Returns the closure evaluating `e`, creating closures for its
+/// subexpressions as needed.
+static const closure&
+bind(closure_program& p, const expr& e)
+{
+  switch (e.get_kind()) {
+#define def_expr(NS, E) \
+    case NS::E ## _expr_kind: \
+      return bind_expr(p, cast<NS::E ## _expr>(e));
+#define def_init(NS, E) \
+    case NS::E ## _init_kind: \
+      return bind_expr(p, cast<NS::E ## _init>(e));
+#include <beaker/all/expr.def>
+  }
+  assert(false && "invalid expression");
+}
+
+/// Returns a closure program that computes the value of `e`.
+closure_program
+make_closure(const expr& e)
+{
+  closure_program p;
+  p.root_ = &bind(p, e);
+  return p;
+}
+
+/// Evaluate the closure program `p`.
+value
+evaluate(evaluator& eval, const closure_program& p)
+{
+  return invoke(eval, p.get_root());
+}
+
+} // namespace beaker
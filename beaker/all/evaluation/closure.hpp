@@ -0,0 +1,87 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_ALL_EVALUATION_CLOSURE_HPP
+#define BEAKER_ALL_EVALUATION_CLOSURE_HPP
+
+#include <beaker/base/evaluation/evaluate.hpp>
+#include <beaker/sys.int/kernel.hpp>
+
+#include <cstdint>
+#include <deque>
+
+
+namespace beaker {
+
+/// A closure is an expression bound to the function that evaluates it.
+///
+/// The function is selected when the closure is created, so evaluating a
+/// closure never switches on the kind or type of an expression. The 
+/// operands of a closure are the closures of its subexpressions, and its
+/// argument is an immediate value (e.g., the value of a literal). The
+/// argument of an arithmetic closure is the operation of its type's kernel,
+/// which is also selected when the closure is created.
+///
+/// The source expression is used to report evaluation errors and to
+/// evaluate expressions that have no dedicated closure.
+struct closure
+{
+  using eval_fn = value (*)(evaluator&, const closure&);
+
+  eval_fn fn_;
+  const expr* src_;
+  const closure* ops_[3];
+  union
+  {
+    std::intmax_t arg_;
+    sys_int::kernel::binary_fn binary_;
+    sys_int::kernel::unary_fn unary_;
+  };
+};
+
+/// Evaluate the closure `c`.
+inline value
+invoke(evaluator& eval, const closure& c)
+{
+  return c.fn_(eval, c);
+}
+
+
+/// A closure program owns the closures created for an expression. Closures
+/// refer to each other, so programs can be moved, but not copied.
+struct closure_program
+{
+  closure_program();
+  closure_program(closure_program&&) = default;
+  closure_program& operator=(closure_program&&) = default;
+
+  explicit operator bool() const;
+
+  const closure& get_root() const;
+  int get_size() const;
+
+  closure& make(closure::eval_fn, const expr&, std::intmax_t = 0);
+
+  std::deque<closure> nodes_;
+  const closure* root_;
+};
+
+inline closure_program::closure_program() : root_() { }
+
+/// Returns true if the program has been created.
+inline closure_program::operator bool() const { return root_; }
+
+/// Returns the closure of the expression from which the program was created.
+inline const closure& closure_program::get_root() const { return *root_; }
+
+/// Returns the number of closures in the program.
+inline int closure_program::get_size() const { return nodes_.size(); }
+
+
+closure_program make_closure(const expr&);
+value evaluate(evaluator&, const closure_program&);
+
+} // namespace beaker
+
+
+#endif
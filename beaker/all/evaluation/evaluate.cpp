@@ -7,9 +7,12 @@
 
 namespace beaker {
 
+/// Evaluate the expression e, returning its value or the failure of its
+/// evaluation.
+///
 /// \todo Should _init functions get special treatment?
-value
-evaluate(evaluator& eval, const expr& e)
+result
+try_evaluate(evaluator& eval, const expr& e)
 {
   switch (e.get_kind()) {
 #define def_expr(NS, E) \
@@ -23,5 +26,64 @@ evaluate(evaluator& eval, const expr& e)
   assert(false && "invalid expression");
 }
 
+/// Evaluate the declaration d. This binds variables to objects initialized
+/// by their initializers.
+result
+try_evaluate(evaluator& eval, const decl& d)
+{
+  switch (d.get_kind()) {
+#define def_decl(NS, D) \
+    case NS::D ## _decl_kind: \
+      return evaluate_decl(eval, cast<NS::D ## _decl>(d));
+#include <beaker/all/decl.def>
+  }
+  assert(false && "invalid declaration");
+}
+
+/// Evaluate the statement s, returning the flow of control that follows.
+control
+try_evaluate(evaluator& eval, const stmt& s)
+{
+  switch (s.get_kind()) {
+#define def_stmt(NS, S) \
+    case NS::S ## _stmt_kind: \
+      return evaluate_stmt(eval, cast<NS::S ## _stmt>(s));
+#include <beaker/all/stmt.def>
+  }
+  assert(false && "invalid statement");
+}
+
+/// Evaluate the expression e. Throws an exception if evaluation fails.
+value
+evaluate(evaluator& eval, const expr& e)
+{
+  auto m = eval.enter();
+  result r = try_evaluate(eval, e);
+  eval.leave(m, r);
+  if (!r)
+    r.get_failure().raise();
+  return r.get_value();
+}
+
+/// Evaluate the declaration d. Throws an exception if evaluation fails.
+value
+evaluate(evaluator& eval, const decl& d)
+{
+  result r = try_evaluate(eval, d);
+  if (!r)
+    r.get_failure().raise();
+  return r.get_value();
+}
+
+/// Evaluate the statement s. Throws an exception if evaluation fails.
+control
+evaluate(evaluator& eval, const stmt& s)
+{
+  control c = try_evaluate(eval, s);
+  if (c == fail_control)
+    eval.get_failure().raise();
+  return c;
+}
+
 
 } // namespace beaker
\ No newline at end of file
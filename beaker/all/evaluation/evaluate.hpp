@@ -4,3 +4,6 @@
 #include <beaker/sys.void/evaluation/evaluate.hpp>
 #include <beaker/sys.bool/evaluation/evaluate.hpp>
 #include <beaker/sys.int/evaluation/evaluate.hpp>
+#include <beaker/sys.var/evaluation/evaluate.hpp>
+#include <beaker/sys.fn/evaluation/evaluate.hpp>
+#include <beaker/sys.tuple/evaluation/evaluate.hpp>
@@ -0,0 +1,477 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "iterative.hpp"
+#include "evaluate.hpp"
+#include "../ast.hpp"
+
+#include <functional>
+
+
+namespace beaker {
+
+// -------------------------------------------------------------------------- //
+// Steps
+//
+// Each step combines the values of the operands of an expression, which are
+// on the top of the value stack, the last operand on top. Arithmetic 
+// operations are computed by the kernel of their type.
+
+/// Pop the value of a word-sized operand.
+static inline std::intmax_t
+pop_int(iterative_evaluator& w)
+{
+  return w.pop_value().get_int();
+}
+
+static void
+step_discard(iterative_evaluator& w, const expr& e)
+{
+  w.pop_value();
+  w.push_value(value());
+}
+
+template<typename Op>
+static void
+step_logical(iterative_evaluator& w, const expr& e)
+{
+  std::intmax_t b = pop_int(w);
+  std::intmax_t a = pop_int(w);
+  w.push_value(value(Op()(a, b)));
+}
+
+/// Computes the logical implication of a and b.
+struct implies
+{
+  std::intmax_t operator()(std::intmax_t a, std::intmax_t b) const
+  {
+    return (!a) | b;
+  }
+};
+
+static void
+step_not(iterative_evaluator& w, const expr& e)
+{
+  w.push_value(value(!pop_int(w)));
+}
+
+/// Expand the selected operand of a conditional expression.
+static void
+step_if(iterative_evaluator& w, const expr& e)
+{
+  const sys_bool::if_expr& c = cast<sys_bool::if_expr>(e);
+  if (pop_int(w))
+    w.push(c.get_true_value());
+  else
+    w.push(c.get_false_value());
+}
+
+/// Expand the second operand only when the first is true.
+static void
+step_and_then(iterative_evaluator& w, const expr& e)
+{
+  if (!pop_int(w))
+    w.push_value(value(0));
+  else
+    w.push(cast<binary_expr>(e).get_rhs());
+}
+
+/// Expand the second operand only when the first is false.
+static void
+step_or_else(iterative_evaluator& w, const expr& e)
+{
+  if (pop_int(w))
+    w.push_value(value(1));
+  else
+    w.push(cast<binary_expr>(e).get_rhs());
+}
+
+static void
+step_assert(iterative_evaluator& w, const expr& e)
+{
+  if (!pop_int(w))
+    throw sys_bool::assertion_error(e);
+  w.push_value(value(1));
+}
+
+/// Compare the operands of `e` using the comparison `C`. Values of 
+/// unsigned types are compared as unsigned integers, and values of types
+/// wider than a machine word are compared as 128-bit integers.
+template<typename C>
+static void
+step_compare(iterative_evaluator& w, const expr& e)
+{
+  value b = w.pop_value();
+  value a = w.pop_value();
+  const type& t = cast<binary_expr>(e).get_lhs().get_type();
+  C cmp;
+  if (!sys_int::is_wide_type(t)) {
+    if (sys_int::is_unsigned_type(t))
+      w.push_value(value(cmp(std::uintmax_t(a.get_int()), 
+                             std::uintmax_t(b.get_int()))));
+    else
+      w.push_value(value(cmp(a.get_int(), b.get_int())));
+  }
+  else if (t.get_kind() == sys_int::int_type_kind)
+    w.push_value(value(cmp(a.get_wide(), b.get_wide())));
+  else
+    w.push_value(value(cmp(a.get_wide_natural(), b.get_wide_natural())));
+}
+
+/// Returns the value `v` of type `t` as a 128-bit integer. Unsigned values
+/// are returned as the bits of their value.
+static inline wide_integer
+get_wide(const type& t, const value& v)
+{
+  if (t.get_kind() == sys_int::int_type_kind)
+    return v.get_wide();
+  else
+    return v.get_wide_natural();
+}
+
+/// Returns the value `r` computed for `e`, or throws the error indicated by
+/// the status `s`.
+static inline value
+check_result(const expr& e, sys_int::arith_status s, std::intmax_t r)
+{
+  switch (s) {
+    case sys_int::arith_ok: return value(r);
+    case sys_int::arith_overflow: throw sys_int::overflow_error(e);
+    case sys_int::arith_division: throw sys_int::division_error(e);
+  }
+  assert(false && "invalid arithmetic status");
+}
+
+/// Returns the wide value `r` computed for `e`, or throws the error 
+/// indicated by the status `s`.
+static value
+check_result(const expr& e, sys_int::arith_status s, wide_integer r)
+{
+  switch (s) {
+    case sys_int::arith_ok:
+      if (e.get_type().get_kind() == sys_int::int_type_kind)
+        return value(r);
+      else
+        return value(wide_natural(r));
+    case sys_int::arith_overflow: throw sys_int::overflow_error(e);
+    case sys_int::arith_division: throw sys_int::division_error(e);
+  }
+  assert(false && "invalid arithmetic status");
+}
+
+/// Computes a binary arithmetic operation using the kernel of the type of
+/// `e`, or its wide kernel for wide types.
+template<sys_int::kernel::binary_fn sys_int::kernel::* Op,
+         sys_int::wide_kernel::binary_fn sys_int::wide_kernel::* Wop>
+static void
+step_binary(iterative_evaluator& w, const expr& e)
+{
+  const type& t = e.get_type();
+  const sys_int::kernel& k = sys_int::get_kernel(t);
+  value b = w.pop_value();
+  value a = w.pop_value();
+  if (k.wide_) {
+    wide_integer r;
+    sys_int::arith_status s = (k.wide_->*Wop)(get_wide(t, a), get_wide(t, b), r);
+    w.push_value(check_result(e, s, r));
+  } else {
+    std::intmax_t r;
+    sys_int::arith_status s = (k.*Op)(a.get_int(), b.get_int(), r);
+    w.push_value(check_result(e, s, r));
+  }
+}
+
+/// Computes a unary arithmetic operation using the kernel of the type of
+/// `e`, or its wide kernel for wide types.
+template<sys_int::kernel::unary_fn sys_int::kernel::* Op,
+         sys_int::wide_kernel::unary_fn sys_int::wide_kernel::* Wop>
+static void
+step_unary(iterative_evaluator& w, const expr& e)
+{
+  const type& t = e.get_type();
+  const sys_int::kernel& k = sys_int::get_kernel(t);
+  value n = w.pop_value();
+  if (k.wide_) {
+    wide_integer r;
+    sys_int::arith_status s = (k.wide_->*Wop)(get_wide(t, n), r);
+    w.push_value(check_result(e, s, r));
+  } else {
+    std::intmax_t r;
+    sys_int::arith_status s = (k.*Op)(n.get_int(), r);
+    w.push_value(check_result(e, s, r));
+  }
+}
+
+
+// -------------------------------------------------------------------------- //
+// Generic expansion
+
+/// Expressions without an expansion are evaluated by the tree walker.
+static const expr*
+expand_expr(iterative_evaluator& w, const expr& e)
+{
+  w.push_value(evaluate(w.get_evaluator(), e));
+  return nullptr;
+}
+
+/// Schedule `f` after the operand of `e`, which is expanded next.
+static const expr*
+expand_unary(iterative_evaluator& w, const unary_expr& e, iterative_evaluator::step_fn f)
+{
+  w.push(f, e);
+  return &e.get_operand();
+}
+
+/// Schedule `f` after the operands of `e`, left to right. The first operand
+/// is expanded next.
+static const expr*
+expand_binary(iterative_evaluator& w, const binary_expr& e, iterative_evaluator::step_fn f)
+{
+  w.push(f, e);
+  w.push(e.get_rhs());
+  return &e.get_lhs();
+}
+
+
+// -------------------------------------------------------------------------- //
+// sys.void
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_void::nop_expr& e)
+{
+  w.push_value(value());
+  return nullptr;
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_void::void_expr& e)
+{
+  return expand_unary(w, e, step_discard);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_void::trap_expr& e)
+{
+  throw sys_void::trap_error(e);
+}
+
+
+// -------------------------------------------------------------------------- //
+// sys.bool
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::bool_expr& e)
+{
+  w.push_value(e.get_value());
+  return nullptr;
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::and_expr& e)
+{
+  return expand_binary(w, e, step_logical<std::bit_and<std::intmax_t>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::or_expr& e)
+{
+  return expand_binary(w, e, step_logical<std::bit_or<std::intmax_t>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::xor_expr& e)
+{
+  return expand_binary(w, e, step_logical<std::bit_xor<std::intmax_t>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::not_expr& e)
+{
+  return expand_unary(w, e, step_not);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::imp_expr& e)
+{
+  return expand_binary(w, e, step_logical<implies>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::eq_expr& e)
+{
+  return expand_binary(w, e, step_logical<std::equal_to<std::intmax_t>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::if_expr& e)
+{
+  w.push(step_if, e);
+  return &e.get_condition();
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::and_then_expr& e)
+{
+  w.push(step_and_then, e);
+  return &e.get_lhs();
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::or_else_expr& e)
+{
+  w.push(step_or_else, e);
+  return &e.get_lhs();
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_bool::assert_expr& e)
+{
+  return expand_unary(w, e, step_assert);
+}
+
+
+// -------------------------------------------------------------------------- //
+// sys.int
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::int_expr& e)
+{
+  w.push_value(e.get_value());
+  return nullptr;
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::eq_expr& e)
+{
+  return expand_binary(w, e, step_compare<std::equal_to<>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::ne_expr& e)
+{
+  return expand_binary(w, e, step_compare<std::not_equal_to<>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::lt_expr& e)
+{
+  return expand_binary(w, e, step_compare<std::less<>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::gt_expr& e)
+{
+  return expand_binary(w, e, step_compare<std::greater<>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::le_expr& e)
+{
+  return expand_binary(w, e, step_compare<std::less_equal<>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::ge_expr& e)
+{
+  return expand_binary(w, e, step_compare<std::greater_equal<>>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::add_expr& e)
+{
+  return expand_binary(w, e, step_binary<&sys_int::kernel::add_, &sys_int::wide_kernel::add_>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::sub_expr& e)
+{
+  return expand_binary(w, e, step_binary<&sys_int::kernel::sub_, &sys_int::wide_kernel::sub_>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::mul_expr& e)
+{
+  return expand_binary(w, e, step_binary<&sys_int::kernel::mul_, &sys_int::wide_kernel::mul_>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::quo_expr& e)
+{
+  return expand_binary(w, e, step_binary<&sys_int::kernel::quo_, &sys_int::wide_kernel::quo_>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::rem_expr& e)
+{
+  return expand_binary(w, e, step_binary<&sys_int::kernel::rem_, &sys_int::wide_kernel::rem_>);
+}
+
+/// The negation of natural numbers is left to the tree walker, which
+/// diagnoses the error.
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::neg_expr& e)
+{
+  if (is<sys_int::nat_type>(e.get_type()))
+    return expand_expr(w, static_cast<const expr&>(e));
+  return expand_unary(w, e, step_unary<&sys_int::kernel::neg_, &sys_int::wide_kernel::neg_>);
+}
+
+static const expr*
+expand_expr(iterative_evaluator& w, const sys_int::rec_expr& e)
+{
+  return expand_unary(w, e, step_unary<&sys_int::kernel::rec_, &sys_int::wide_kernel::rec_>);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Dispatch
+
+/// Schedule the steps that compute the value of `e`. Returns the operand of
+/// `e` to expand next, if any, so that first operands are expanded without
+/// a trip through the work stack.
+static const expr*
+expand(iterative_evaluator& w, const expr& e)
+{
+  switch (e.get_kind()) {
+#define def_expr(NS, E) \
+    case NS::E ## _expr_kind: \
+      return expand_expr(w, cast<NS::E ## _expr>(e));
+#define def_init(NS, E) \
+    case NS::E ## _init_kind: \
+      return expand_expr(w, cast<NS::E ## _init>(e));
+#include <beaker/all/expr.def>
+  }
+  assert(false && "invalid expression");
+}
+
+/// Evaluate `e`. The stacks are cleared before evaluation so that a failed
+/// evaluation does not affect the next.
+value
+iterative_evaluator::evaluate(const expr& e)
+{
+  work_.clear();
+  values_.clear();
+  push(e);
+  while (!work_.is_empty()) {
+    step s = work_.pop();
+    if (s.fn_) {
+      s.fn_(*this, *s.expr_);
+      continue;
+    }
+    const expr* e = s.expr_;
+    while (e)
+      e = expand(*this, *e);
+  }
+  assert(values_.get_size() == 1);
+  return pop_value();
+}
+
+/// Evaluate `e` without recursion.
+value
+evaluate_iterative(evaluator& eval, const expr& e)
+{
+  iterative_evaluator w(eval);
+  return w.evaluate(e);
+}
+
+} // namespace beaker
@@ -0,0 +1,80 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_ALL_EVALUATION_ITERATIVE_HPP
+#define BEAKER_ALL_EVALUATION_ITERATIVE_HPP
+
+#include <beaker/base/evaluation/evaluate.hpp>
+
+#include <beaker/util/work_stack.hpp>
+
+
+namespace beaker {
+
+/// The iterative evaluator computes the value of an expression without 
+/// recursing on the call stack, so the depth of an expression is limited
+/// only by available memory.
+///
+/// Evaluation is driven by a work stack of steps. Expanding an expression
+/// schedules the steps that compute its value: first its operands, then the
+/// operation that combines their values, which are held on a separate value
+/// stack. Conditional expressions schedule their condition and then select
+/// the operand to expand. Expressions that have no expansion are evaluated 
+/// by the tree walker.
+///
+/// The stacks are retained between evaluations so that repeatedly evaluating
+/// expressions does not allocate memory. Evaluation errors are reported by
+/// throwing the same exceptions as the tree walker.
+struct iterative_evaluator
+{
+  using step_fn = void (*)(iterative_evaluator&, const expr&);
+
+  /// A step applies a function to an expression. When the function is null,
+  /// the step expands the expression.
+  struct step
+  {
+    step_fn fn_;
+    const expr* expr_;
+  };
+
+  iterative_evaluator(evaluator&);
+
+  evaluator& get_evaluator();
+
+  value evaluate(const expr&);
+
+  void push(const expr&);
+  void push(step_fn, const expr&);
+
+  void push_value(const value&);
+  value pop_value();
+
+  evaluator* eval_;
+  work_stack<step> work_;
+  work_stack<value> values_;
+};
+
+inline iterative_evaluator::iterative_evaluator(evaluator& e) : eval_(&e) { }
+
+/// Returns the evaluator used for expressions that have no expansion.
+inline evaluator& iterative_evaluator::get_evaluator() { return *eval_; }
+
+/// Schedule the expansion of `e`.
+inline void iterative_evaluator::push(const expr& e) { work_.push({nullptr, &e}); }
+
+/// Schedule the application of `f` to `e`.
+inline void iterative_evaluator::push(step_fn f, const expr& e) { work_.push({f, &e}); }
+
+/// Push the computed value `v`.
+inline void iterative_evaluator::push_value(const value& v) { values_.push(v); }
+
+/// Pop the most recently computed value.
+inline value iterative_evaluator::pop_value() { return values_.pop(); }
+
+
+value evaluate_iterative(evaluator&, const expr&);
+
+} // namespace beaker
+
+
+#endif
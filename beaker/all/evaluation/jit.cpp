@@ -0,0 +1,329 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "jit.hpp"
+#include "evaluate.hpp"
+#include "../generation/gen.hpp"
+#include "../ast.hpp"
+
+#include <beaker/base/module.hpp>
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <mutex>
+
+
+namespace beaker {
+
+/// Returns the message of an LLVM error as a generation error.
+static generation_error
+make_error(llvm::Error err)
+{
+  return generation_error(llvm::toString(std::move(err)));
+}
+
+jit::jit(evaluator& e)
+  : release_listener(e.lang), eval_(&e), cxt_(), jit_(), count_()
+{
+  static std::once_flag init;
+  std::call_once(init, []() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+  });
+
+  auto j = llvm::orc::LLJITBuilder().create();
+  if (!j)
+    throw make_error(j.takeError());
+  jit_ = j->release();
+  cxt_ = new llvm::orc::ThreadSafeContext(std::make_unique<llvm::LLVMContext>());
+}
+
+jit::~jit()
+{
+  delete jit_;
+  delete cxt_;
+}
+
+/// Discard the programs compiled for expressions released from s, and the
+/// functions declared by released declarations. Their native code is not
+/// unloaded.
+void
+jit::release(const node_store& s, const node_store::mark& m)
+{
+  erase_released(progs_, s, m);
+  erase_released(fns_, s, m);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Conversions
+//
+// Values are exchanged with native code as integers of the width of the
+// value representation.
+
+/// Returns the value of `v`, an expression of type t, widened to the value
+/// representation. Void expressions have the value 0.
+static llvm::Value*
+make_result(llvm::Builder& ir, const type& t, llvm::Value* v)
+{
+  llvm::Type* rep = ir.getIntNTy(8 * sizeof(std::intmax_t));
+  if (!v || v->getType()->isVoidTy())
+    return llvm::ConstantInt::get(rep, 0);
+  if (!v->getType()->isIntegerTy() || v->getType()->getIntegerBitWidth() > rep->getIntegerBitWidth())
+    throw generation_error("value not representable");
+  if (t.get_kind() == sys_int::int_type_kind)
+    return ir.CreateSExt(v, rep);
+  else
+    return ir.CreateZExt(v, rep);
+}
+
+/// Returns the argument `v`, a value of the value representation, converted
+/// to the parameter type t.
+static llvm::Value*
+make_argument(llvm::Builder& ir, llvm::Type* t, llvm::Value* v)
+{
+  if (!t->isIntegerTy())
+    throw generation_error("argument not representable");
+  if (t->getIntegerBitWidth() > v->getType()->getIntegerBitWidth())
+    throw generation_error("argument not representable");
+  return ir.CreateTrunc(v, t);
+}
+
+/// Returns the value of an expression of type t computed by native code.
+static value
+make_value(const type& t, std::intmax_t n)
+{
+  if (sys_void::is_void_type(t))
+    return value();
+  return value(n);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Compilation
+
+/// Declare the functions previously loaded into the JIT in the module being
+/// generated.
+static void
+declare_functions(jit& j, generator& gen)
+{
+  for (auto& x : j.fns_) {
+    native_function& f = x.second;
+    llvm::Function* fn = llvm::Function::Create(
+      f.type_, llvm::Function::ExternalLinkage, f.sym_, &gen.get_module()
+    );
+    gen.put_value(*x.first, fn);
+  }
+}
+
+/// Optimize the generated module and add it to the JIT.
+static void
+add_module(jit& j, generator& gen)
+{
+  llvm::Module& mod = gen.get_module();
+  mod.setDataLayout(j.jit_->getDataLayout());
+
+  std::string msg;
+  llvm::raw_string_ostream os(msg);
+  if (llvm::verifyModule(mod, &os))
+    throw generation_error(os.str());
+
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+  llvm::PassBuilder pb;
+  pb.registerModuleAnalyses(mam);
+  pb.registerCGSCCAnalyses(cgam);
+  pb.registerFunctionAnalyses(fam);
+  pb.registerLoopAnalyses(lam);
+  pb.crossRegisterProxies(lam, fam, cgam, mam);
+  llvm::ModulePassManager mpm =
+    pb.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+  mpm.run(mod, mam);
+
+  std::unique_ptr<llvm::Module> m(gen.release_module());
+  llvm::orc::ThreadSafeModule tsm(std::move(m), *j.cxt_);
+  if (llvm::Error err = j.jit_->addIRModule(std::move(tsm)))
+    throw make_error(std::move(err));
+}
+
+/// Returns the address of the symbol `sym`.
+static std::uintptr_t
+lookup(jit& j, const std::string& sym)
+{
+  auto s = j.jit_->lookup(sym);
+  if (!s)
+    throw make_error(s.takeError());
+  return s->getAddress();
+}
+
+/// Generate the entry point of the function `d`, which has been generated
+/// as `fn`. Returns false if the function cannot be called from the host.
+static bool
+generate_entry(generator& gen, const decl& d, llvm::Function* fn)
+{
+  llvm::Context& cxt = gen.get_context();
+  llvm::Type* rep = llvm::Type::getIntNTy(cxt, 8 * sizeof(std::intmax_t));
+  llvm::FunctionType* sig = llvm::FunctionType::get(
+    rep, {llvm::Type::getInt32PtrTy(cxt), llvm::PointerType::getUnqual(rep)}, false
+  );
+  llvm::Function* entry = llvm::Function::Create(
+    sig, llvm::Function::ExternalLinkage, fn->getName() + ".entry", &gen.get_module()
+  );
+  try {
+    llvm::Builder ir(llvm::BasicBlock::Create(cxt, "entry", entry));
+    llvm::Value* argv = entry->getArg(1);
+    std::vector<llvm::Value*> args {entry->getArg(0)};
+    for (unsigned i = 1; i < fn->arg_size(); ++i) {
+      llvm::Value* p = ir.CreateConstGEP1_32(rep, argv, i - 1);
+      llvm::Value* a = ir.CreateLoad(rep, p);
+      args.push_back(make_argument(ir, fn->getArg(i)->getType(), a));
+    }
+    llvm::Value* r = ir.CreateCall(fn, args);
+    const type& t = cast<sys_fn::fn_decl>(d).get_return_type();
+    ir.CreateRet(make_result(ir, t, r));
+    return true;
+  }
+  catch (generation_error&) {
+    entry->eraseFromParent();
+    return false;
+  }
+}
+
+/// Compile the functions of the module `m`.
+void
+jit::load(const module& m)
+{
+  std::string name = "beaker." + std::to_string(count_++);
+  llvm::orc::ThreadSafeContext::Lock lock = cxt_->getLock();
+  generator gen(*cxt_->getContext(), name.c_str(), fails_);
+  declare_functions(*this, gen);
+  generate(gen, m);
+
+  std::vector<std::pair<const decl*, native_function>> fns;
+  for (const decl& d : m.get_declarations()) {
+    if (!is<sys_fn::fn_decl>(d))
+      continue;
+    llvm::Function* fn = llvm::cast<llvm::Function>(gen.get_value(d));
+    native_function f {
+      fn->getName().str(),
+      fn->getFunctionType(),
+      &cast<sys_fn::fn_decl>(d).get_return_type(),
+      generate_entry(gen, d, fn),
+      nullptr
+    };
+    fns.emplace_back(&d, f);
+  }
+
+  add_module(*this, gen);
+  fns_.insert(fns.begin(), fns.end());
+}
+
+/// Compile the expression `e` to native code.
+native_program
+jit::compile(const expr& e)
+{
+  std::string name = "beaker." + std::to_string(count_++);
+  llvm::orc::ThreadSafeContext::Lock lock = cxt_->getLock();
+  generator gen(*cxt_->getContext(), name.c_str(), fails_);
+  declare_functions(*this, gen);
+
+  // Define the entry point of the program.
+  llvm::Context& cxt = gen.get_context();
+  llvm::Type* rep = llvm::Type::getIntNTy(cxt, 8 * sizeof(std::intmax_t));
+  llvm::FunctionType* sig = llvm::FunctionType::get(
+    rep, {llvm::Type::getInt32PtrTy(cxt)}, false
+  );
+  std::string sym = name + ".expr";
+  llvm::Function* fn = llvm::Function::Create(
+    sig, llvm::Function::ExternalLinkage, sym, &gen.get_module()
+  );
+  gen.define_function(fn);
+  cg::value v = generate(gen, e);
+  llvm::Builder ir(gen.get_current_block());
+  ir.CreateRet(make_result(ir, e.get_type(), v));
+  ir.SetInsertPoint(gen.get_exit_block());
+  ir.CreateUnreachable();
+  gen.end_function();
+
+  add_module(*this, gen);
+  auto entry = reinterpret_cast<native_program::entry_fn>(lookup(*this, sym));
+  return native_program(entry, e.get_type());
+}
+
+
+// -------------------------------------------------------------------------- //
+// Execution
+
+/// Raise the error of the failed check identified by a non-zero status.
+void
+jit::check(std::int32_t s)
+{
+  if (s)
+    fails_[s - 1].raise();
+}
+
+/// Execute the compiled program, returning the value of its expression.
+value
+jit::execute(const native_program& p)
+{
+  std::int32_t s = 0;
+  std::intmax_t n = p.get_entry()(&s);
+  check(s);
+  return make_value(p.get_type(), n);
+}
+
+/// Call the loaded function `d` with the given arguments.
+value
+jit::call(const decl& d, const std::vector<value>& args)
+{
+  auto iter = fns_.find(&d);
+  if (iter == fns_.end())
+    throw generation_error("function not loaded");
+  native_function& f = iter->second;
+  if (!f.callable_)
+    throw generation_error("function not callable");
+  if (!f.entry_)
+    f.entry_ = reinterpret_cast<native_function::entry_fn>(lookup(*this, f.sym_ + ".entry"));
+
+  std::vector<std::intmax_t> argv;
+  for (const value& v : args)
+    argv.push_back(v.get_int());
+  assert(argv.size() == f.type_->getNumParams() - 1);
+
+  std::int32_t s = 0;
+  std::intmax_t n = f.entry_(&s, argv.data());
+  check(s);
+  return make_value(*f.ret_, n);
+}
+
+/// Evaluate `e` using native code. The expression is compiled the first time
+/// it is evaluated. Expressions that cannot be compiled are evaluated by the
+/// tree walker.
+value
+evaluate(jit& j, const expr& e)
+{
+  auto iter = j.progs_.find(&e);
+  if (iter == j.progs_.end()) {
+    native_program p;
+    try {
+      p = j.compile(e);
+    } catch (generation_error&) { }
+    iter = j.progs_.emplace(&e, p).first;
+  }
+  const native_program& p = iter->second;
+  if (p)
+    return j.execute(p);
+  return evaluate(j.get_evaluator(), e);
+}
+
+} // namespace beaker
@@ -0,0 +1,140 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_ALL_EVALUATION_JIT_HPP
+#define BEAKER_ALL_EVALUATION_JIT_HPP
+
+#include <beaker/base/evaluation/evaluate.hpp>
+#include <beaker/base/generation/generation.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+namespace llvm {
+
+class FunctionType;
+
+namespace orc {
+
+class LLJIT;
+class ThreadSafeContext;
+
+} // namespace orc
+} // namespace llvm
+
+
+namespace beaker {
+
+// -------------------------------------------------------------------------- //
+// Native programs
+
+/// A native program is an expression compiled to machine code.
+///
+/// The entry point of a native program accepts a pointer to the status of
+/// the evaluation and returns the value of the expression, widened to the 
+/// representation of values. A non-zero status identifies a failed check.
+struct native_program
+{
+  using entry_fn = std::intmax_t (*)(std::int32_t*);
+
+  native_program();
+  native_program(entry_fn, const type&);
+
+  explicit operator bool() const;
+
+  entry_fn get_entry() const;
+  const type& get_type() const;
+
+  entry_fn entry_;
+  const type* type_;
+};
+
+inline native_program::native_program() : entry_(), type_() { }
+
+inline 
+native_program::native_program(entry_fn f, const type& t) 
+  : entry_(f), type_(&t) 
+{ }
+
+/// Returns true if the program has been compiled.
+inline native_program::operator bool() const { return entry_; }
+
+/// Returns the entry point of the program.
+inline native_program::entry_fn native_program::get_entry() const { return entry_; }
+
+/// Returns the type of the compiled expression.
+inline const type& native_program::get_type() const { return *type_; }
+
+
+/// Information about a function loaded into the JIT. 
+///
+/// The entry point of a loaded function unpacks its arguments from an array
+/// of integers, calls the function, and widens its result.
+struct native_function
+{
+  using entry_fn = std::intmax_t (*)(std::int32_t*, const std::intmax_t*);
+
+  std::string sym_;
+  llvm::FunctionType* type_;
+  const type* ret_;
+  bool callable_;
+  entry_fn entry_;
+};
+
+
+// -------------------------------------------------------------------------- //
+// JIT
+
+/// The JIT compiles modules and expressions to native code in memory using
+/// LLVM's ORC JIT. Code is generated by the checked generator, so native
+/// code reports the same errors as the tree walker.
+///
+/// Functions of loaded modules can be called directly or from compiled 
+/// expressions. Compiling an expression that cannot be represented natively
+/// throws a generation error.
+///
+/// Compiled programs are discarded when their expressions are released.
+struct jit : release_listener
+{
+  jit(evaluator&);
+  ~jit();
+
+  void release(const node_store&, const node_store::mark&) override;
+
+  void load(const module&);
+  native_program compile(const expr&);
+
+  value execute(const native_program&);
+  value call(const decl&, const std::vector<value>&);
+
+  evaluator& get_evaluator();
+
+  void check(std::int32_t);
+
+  evaluator* eval_;
+  llvm::orc::ThreadSafeContext* cxt_;
+  llvm::orc::LLJIT* jit_;
+  int count_;
+
+  // Failed checks of all generated code.
+  cg::failure_seq fails_;
+  
+  // Loaded functions.
+  std::unordered_map<const decl*, native_function> fns_;
+
+  // Compiled expressions. See evaluate(jit&, const expr&).
+  std::unordered_map<const expr*, native_program> progs_;
+};
+
+/// Returns the evaluator used for expressions that cannot be compiled.
+inline evaluator& jit::get_evaluator() { return *eval_; }
+
+
+value evaluate(jit&, const expr&);
+
+} // namespace beaker
+
+
+#endif
@@ -0,0 +1,259 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "machine.hpp"
+#include "evaluate.hpp"
+#include "../ast.hpp"
+
+
+namespace beaker {
+
+/// Execute the program, returning the value of the compiled expression.
+value
+machine::execute(const program& p)
+{
+  if ((int)stack_.size() < p.get_depth())
+    stack_.resize(p.get_depth());
+
+  const instruction* code = p.get_code().data();
+  const instruction* ip = code;
+  const instruction* end = code + p.get_code().size();
+  value* sp = stack_.data();
+
+  // Results of checked arithmetic.
+  std::intmax_t z;
+  std::uintmax_t u;
+
+  // Operands of the current instruction. The first is the value below the
+  // top of the stack, and the second is the top of the stack.
+  #define lhs sp[-2].data_.z
+  #define rhs sp[-1].data_.z
+  #define ulhs std::uintmax_t(lhs)
+  #define urhs std::uintmax_t(rhs)
+  #define reduce(x) \
+    sp[-2] = value(x); \
+    --sp;
+
+  while (ip != end) {
+    const instruction& i = *ip++;
+    switch (i.op) {
+      case push_void_op:
+        *sp++ = value();
+        break;
+
+      case push_int_op:
+        *sp++ = value(i.arg);
+        break;
+
+      case pop_op:
+        --sp;
+        break;
+
+      case jump_op:
+        ip = code + i.arg;
+        break;
+
+      case jump_if_false_op:
+        if (!(--sp)->data_.z)
+          ip = code + i.arg;
+        break;
+
+      case jump_if_true_op:
+        if ((--sp)->data_.z)
+          ip = code + i.arg;
+        break;
+
+      case walk_op:
+        *sp++ = evaluate(*eval_, p.get_source(i.src));
+        break;
+
+      case trap_op:
+        throw sys_void::trap_error(p.get_source(i.src));
+
+      case bool_and_op:
+        reduce(lhs & rhs);
+        break;
+
+      case bool_or_op:
+        reduce(lhs | rhs);
+        break;
+
+      case bool_xor_op:
+        reduce(lhs ^ rhs);
+        break;
+
+      case bool_not_op:
+        sp[-1] = value(!rhs);
+        break;
+
+      case bool_imp_op:
+        reduce((!lhs) | rhs);
+        break;
+
+      case bool_assert_op:
+        if (!rhs)
+          throw sys_bool::assertion_error(p.get_source(i.src));
+        sp[-1] = value(1);
+        break;
+
+      case bool_eq_op:
+      case int_eq_op:
+        reduce(lhs == rhs);
+        break;
+
+      case int_ne_op:
+        reduce(lhs != rhs);
+        break;
+
+      case int_lt_op:
+        reduce(lhs < rhs);
+        break;
+
+      case int_gt_op:
+        reduce(lhs > rhs);
+        break;
+
+      case int_le_op:
+        reduce(lhs <= rhs);
+        break;
+
+      case int_ge_op:
+        reduce(lhs >= rhs);
+        break;
+
+      case nat_lt_op:
+        reduce(ulhs < urhs);
+        break;
+
+      case nat_gt_op:
+        reduce(ulhs > urhs);
+        break;
+
+      case nat_le_op:
+        reduce(ulhs <= urhs);
+        break;
+
+      case nat_ge_op:
+        reduce(ulhs >= urhs);
+        break;
+
+      case add_nat_op:
+        if (__builtin_add_overflow(ulhs, urhs, &u) || u > std::uintmax_t(i.arg))
+          throw sys_int::overflow_error(p.get_source(i.src));
+        reduce(u);
+        break;
+
+      case add_int_op:
+        if (__builtin_add_overflow(lhs, rhs, &z) || z > i.arg || z < -i.arg - 1)
+          throw sys_int::overflow_error(p.get_source(i.src));
+        reduce(z);
+        break;
+
+      case add_mod_op:
+        reduce((ulhs + urhs) & std::uintmax_t(i.arg));
+        break;
+
+      case sub_nat_op:
+        if (__builtin_sub_overflow(ulhs, urhs, &u) || u < std::uintmax_t(i.arg))
+          throw sys_int::overflow_error(p.get_source(i.src));
+        reduce(u);
+        break;
+
+      case sub_int_op:
+        if (__builtin_sub_overflow(lhs, rhs, &z) || z < i.arg || z > -(i.arg + 1))
+          throw sys_int::overflow_error(p.get_source(i.src));
+        reduce(z);
+        break;
+
+      case sub_mod_op:
+        reduce((ulhs - urhs) & std::uintmax_t(i.arg));
+        break;
+
+      case mul_nat_op:
+        if (__builtin_mul_overflow(ulhs, urhs, &u) || u > std::uintmax_t(i.arg))
+          throw sys_int::overflow_error(p.get_source(i.src));
+        reduce(u);
+        break;
+
+      case mul_int_op:
+        if (__builtin_mul_overflow(lhs, rhs, &z) || z > i.arg || z < -i.arg - 1)
+          throw sys_int::overflow_error(p.get_source(i.src));
+        reduce(z);
+        break;
+
+      case mul_mod_op:
+        reduce((ulhs * urhs) & std::uintmax_t(i.arg));
+        break;
+
+      case quo_nat_op:
+        if (urhs == 0)
+          throw sys_int::division_error(p.get_source(i.src));
+        reduce(ulhs / urhs);
+        break;
+
+      case quo_int_op:
+        if (rhs == 0)
+          throw sys_int::division_error(p.get_source(i.src));
+        if (lhs == i.arg && rhs == -1)
+          throw sys_int::overflow_error(p.get_source(i.src));
+        reduce(lhs / rhs);
+        break;
+
+      case rem_nat_op:
+        if (urhs == 0)
+          throw sys_int::division_error(p.get_source(i.src));
+        reduce(ulhs % urhs);
+        break;
+
+      case rem_int_op:
+        if (rhs == 0)
+          throw sys_int::division_error(p.get_source(i.src));
+        reduce(rhs == -1 ? 0 : lhs % rhs);
+        break;
+
+      case neg_int_op:
+        if (rhs == i.arg)
+          throw sys_int::overflow_error(p.get_source(i.src));
+        sp[-1] = value(-rhs);
+        break;
+
+      case neg_mod_op:
+        sp[-1] = value(-urhs & std::uintmax_t(i.arg));
+        break;
+
+      case rec_nat_op:
+        if (urhs == 0)
+          throw sys_int::division_error(p.get_source(i.src));
+        sp[-1] = value(1 / urhs);
+        break;
+
+      case rec_int_op:
+        if (rhs == 0)
+          throw sys_int::division_error(p.get_source(i.src));
+        sp[-1] = value(1 / rhs);
+        break;
+
+      default:
+        assert(false && "invalid instruction");
+    }
+  }
+
+  #undef lhs
+  #undef rhs
+  #undef ulhs
+  #undef urhs
+  #undef reduce
+
+  assert(sp == stack_.data() + 1);
+  return stack_.front();
+}
+
+/// Execute the program `p` using a new machine.
+value
+execute(evaluator& eval, const program& p)
+{
+  machine m(eval);
+  return m.execute(p);
+}
+
+} // namespace beaker
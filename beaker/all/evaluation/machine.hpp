@@ -0,0 +1,38 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_ALL_EVALUATION_MACHINE_HPP
+#define BEAKER_ALL_EVALUATION_MACHINE_HPP
+
+#include <beaker/all/evaluation/bytecode.hpp>
+
+
+namespace beaker {
+
+/// The evaluation machine executes compiled programs.
+///
+/// The operand stack is retained between executions so that repeatedly
+/// evaluating a program does not allocate memory.
+///
+/// Evaluation errors are reported by throwing the same exceptions as the
+/// tree walker, referring to the expression from which the failing
+/// instruction was compiled.
+struct machine
+{
+  machine(evaluator&);
+
+  value execute(const program&);
+
+  evaluator* eval_;
+  std::vector<value> stack_;
+};
+
+inline machine::machine(evaluator& e) : eval_(&e) { }
+
+
+value execute(evaluator&, const program&);
+
+} // namespace beaker
+
+
+#endif
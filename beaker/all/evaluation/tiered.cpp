@@ -0,0 +1,199 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "tiered.hpp"
+#include "evaluate.hpp"
+#include "../ast.hpp"
+
+#include <beaker/base/module.hpp>
+
+#include <algorithm>
+
+
+namespace beaker {
+
+/// Returns the name of the tier.
+const char*
+get_tier_name(tier t)
+{
+  switch (t) {
+    case walk_tier: return "walk";
+    case machine_tier: return "machine";
+    case native_tier: return "native";
+  }
+  assert(false && "invalid tier");
+}
+
+/// Returns true if the threshold `n` is enabled and has been reached by
+/// the count `c`.
+static inline bool
+reached(int c, int n)
+{
+  return n && c >= n;
+}
+
+/// Construct a tiered evaluator with no native tier.
+tiered_evaluator::tiered_evaluator(evaluator& e)
+  : release_listener(e.lang), 
+    eval_(&e), jit_(), vm_(e), machine_(2), native_(0)
+{ }
+
+/// Construct a tiered evaluator that uses the JIT `j` for its native tier.
+tiered_evaluator::tiered_evaluator(evaluator& e, jit& j)
+  : release_listener(e.lang), 
+    eval_(&e), jit_(&j), vm_(e), machine_(2), native_(1000)
+{ }
+
+/// Discard the profiles and transitions of terms released from s.
+void
+tiered_evaluator::release(const node_store& s, const node_store::mark& m)
+{
+  erase_released(exprs_, s, m);
+  erase_released(fns_, s, m);
+  erase_released(mods_, s, m);
+  auto released = [&](const transition& t) {
+    return s.allocated_since(m, t.expr_) || s.allocated_since(m, t.decl_);
+  };
+  auto last = std::remove_if(trans_.begin(), trans_.end(), released);
+  trans_.erase(last, trans_.end());
+}
+
+/// Evaluate `e` in its current tier, promoting it first if it has become
+/// hot enough.
+value
+tiered_evaluator::evaluate(const expr& e)
+{
+  profile& p = exprs_[&e];
+  ++p.count_;
+  if (p.tier_ != native_tier)
+    promote(e, p);
+
+  switch (p.tier_) {
+    case walk_tier:
+      return beaker::evaluate(*eval_, e);
+    case machine_tier:
+      return vm_.execute(p.prog_);
+    case native_tier:
+      return jit_->execute(p.native_);
+  }
+  assert(false && "invalid tier");
+}
+
+/// Call the function `d`. Functions are interpreted until they have been 
+/// called `native_threshold` times, and are then called natively. A function
+/// whose module cannot be loaded remains interpreted.
+value
+tiered_evaluator::call(const decl& d, const std::vector<value>& args)
+{
+  profile& p = fns_[&d];
+  ++p.count_;
+  if (!p.pinned_ && p.tier_ != native_tier && jit_ && reached(p.count_, native_)) {
+    try {
+      promote(d, p);
+    } catch (generation_error&) {
+      p.pinned_ = true;
+    }
+  }
+  if (p.tier_ == native_tier)
+    return jit_->call(d, args);
+  return beaker::call(*eval_, d, args);
+}
+
+/// Make the functions of `m` available to call.
+void
+tiered_evaluator::load(const module& m)
+{
+  for (const decl& d : m.get_declarations())
+    mods_.emplace(&d, &m);
+}
+
+/// Promote the expression `e` to the highest tier whose threshold has been
+/// reached. If the expression cannot be compiled to native code, it is
+/// pinned: it is never compiled natively, but it can still be promoted to
+/// the evaluation machine.
+void
+tiered_evaluator::promote(const expr& e, profile& p)
+{
+  tier t = p.tier_;
+  if (jit_ && !p.pinned_ && reached(p.count_, native_)) {
+    try {
+      p.native_ = jit_->compile(e);
+      p.tier_ = native_tier;
+    } catch (generation_error&) {
+      p.pinned_ = true;
+    }
+  }
+  if (p.tier_ == walk_tier && reached(p.count_, machine_)) {
+    p.prog_ = compile(e);
+    p.tier_ = machine_tier;
+  }
+  if (p.tier_ != t)
+    trans_.push_back({&e, nullptr, t, p.tier_, p.count_});
+}
+
+/// Promote the function `d` to native code by loading its module into the
+/// JIT. Every function in the module is promoted.
+void
+tiered_evaluator::promote(const decl& d, profile& p)
+{
+  assert(jit_ && "no native tier");
+  if (jit_->fns_.count(&d)) {
+    // The function was loaded into the JIT directly.
+    p.tier_ = native_tier;
+    trans_.push_back({nullptr, &d, walk_tier, native_tier, p.count_});
+    return;
+  }
+  auto iter = mods_.find(&d);
+  if (iter == mods_.end())
+    throw generation_error("function not loaded");
+  const module& m = *iter->second;
+  jit_->load(m);
+  for (const decl& x : m.get_declarations()) {
+    mods_.erase(&x);
+    if (!is<sys_fn::fn_decl>(x))
+      continue;
+    profile& q = fns_[&x];
+    q.tier_ = native_tier;
+    trans_.push_back({nullptr, &x, walk_tier, native_tier, q.count_});
+  }
+}
+
+/// Returns the profile of `e` or null if it has never been evaluated.
+const profile*
+tiered_evaluator::get_profile(const expr& e) const
+{
+  auto iter = exprs_.find(&e);
+  if (iter == exprs_.end())
+    return nullptr;
+  return &iter->second;
+}
+
+/// Returns the profile of `d` or null if it has never been called.
+const profile*
+tiered_evaluator::get_profile(const decl& d) const
+{
+  auto iter = fns_.find(&d);
+  if (iter == fns_.end())
+    return nullptr;
+  return &iter->second;
+}
+
+/// Discard the profiles of expressions and the recorded transitions.
+/// Functions that have been loaded remain native.
+void
+tiered_evaluator::reset()
+{
+  exprs_.clear();
+  for (auto& x : fns_)
+    x.second.count_ = 0;
+  trans_.clear();
+}
+
+/// Evaluate `e` using the tiered evaluator.
+value
+evaluate(tiered_evaluator& eval, const expr& e)
+{
+  return eval.evaluate(e);
+}
+
+} // namespace beaker
@@ -0,0 +1,166 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_ALL_EVALUATION_TIERED_HPP
+#define BEAKER_ALL_EVALUATION_TIERED_HPP
+
+#include <beaker/all/evaluation/machine.hpp>
+#include <beaker/all/evaluation/jit.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+
+namespace beaker {
+
+/// The tiers of execution, ordered from the cheapest to start to the
+/// fastest to run.
+///
+/// - walk: the tree walking evaluator.
+/// - machine: a program compiled for the evaluation machine.
+/// - native: native code compiled by the JIT.
+enum tier
+{
+  walk_tier,
+  machine_tier,
+  native_tier,
+};
+
+const char* get_tier_name(tier);
+
+
+/// The execution profile of an expression or function.
+///
+/// The count is the number of times the entity has been executed. The
+/// tier is the tier at which it will next be executed. An entity is pinned
+/// when it could not be compiled to native code; it is never considered for
+/// the native tier again, but a pinned expression can still be promoted to
+/// the evaluation machine.
+struct profile
+{
+  profile();
+
+  int get_count() const;
+  tier get_tier() const;
+  bool is_pinned() const;
+
+  int count_;
+  tier tier_;
+  bool pinned_;
+  program prog_;
+  native_program native_;
+};
+
+inline profile::profile() : count_(), tier_(walk_tier), pinned_() { }
+
+/// Returns the number of times the entity has been executed.
+inline int profile::get_count() const { return count_; }
+
+/// Returns the current tier of the entity.
+inline tier profile::get_tier() const { return tier_; }
+
+/// Returns true if the entity will not be promoted further.
+inline bool profile::is_pinned() const { return pinned_; }
+
+
+/// Records the promotion of an expression or function to a new tier.
+/// Exactly one of the expression or declaration is non-null.
+struct transition
+{
+  const expr* expr_;
+  const decl* decl_;
+  tier from_;
+  tier to_;
+  int count_;
+};
+
+
+/// The tiered evaluator counts the executions of expressions and functions
+/// and promotes those that are executed frequently to faster tiers.
+///
+/// Expressions start in the tree walker. An expression is compiled for
+/// the evaluation machine once it has been executed `machine_threshold`
+/// times and compiled to native code once it has been executed
+/// `native_threshold` times. A threshold of 0 disables the tier. One-shot
+/// evaluations never pay for compilation.
+///
+/// Functions are interpreted by the tree walker until they cross the native
+/// threshold. The JIT then loads the module defining them, and the
+/// functions of that module are called natively.
+///
+/// Every promotion is recorded as a transition. The profiles and 
+/// transitions of released terms are discarded.
+struct tiered_evaluator : release_listener
+{
+  tiered_evaluator(evaluator&);
+  tiered_evaluator(evaluator&, jit&);
+
+  void release(const node_store&, const node_store::mark&) override;
+
+  value evaluate(const expr&);
+  value call(const decl&, const std::vector<value>&);
+
+  void load(const module&);
+
+  // Configuration
+  int get_machine_threshold() const;
+  int get_native_threshold() const;
+  void set_thresholds(int, int);
+
+  // Profiles
+  const profile* get_profile(const expr&) const;
+  const profile* get_profile(const decl&) const;
+  const std::vector<transition>& get_transitions() const;
+  void reset();
+
+  evaluator& get_evaluator();
+
+  void promote(const expr&, profile&);
+  void promote(const decl&, profile&);
+
+  evaluator* eval_;
+  jit* jit_;
+  machine vm_;
+  int machine_;
+  int native_;
+
+  // Modules whose functions can be called.
+  std::unordered_map<const decl*, const module*> mods_;
+
+  std::unordered_map<const expr*, profile> exprs_;
+  std::unordered_map<const decl*, profile> fns_;
+  std::vector<transition> trans_;
+};
+
+/// Returns the number of executions after which an expression is compiled
+/// for the evaluation machine.
+inline int
+tiered_evaluator::get_machine_threshold() const { return machine_; }
+
+/// Returns the number of executions after which an expression or function
+/// is compiled to native code.
+inline int
+tiered_evaluator::get_native_threshold() const { return native_; }
+
+/// Set the thresholds for the machine and native tiers.
+inline void
+tiered_evaluator::set_thresholds(int m, int n)
+{
+  machine_ = m;
+  native_ = n;
+}
+
+/// Returns the recorded tier transitions in the order they occurred.
+inline const std::vector<transition>&
+tiered_evaluator::get_transitions() const { return trans_; }
+
+/// Returns the underlying tree walking evaluator.
+inline evaluator& tiered_evaluator::get_evaluator() { return *eval_; }
+
+
+value evaluate(tiered_evaluator&, const expr&);
+
+} // namespace beaker
+
+
+#endif
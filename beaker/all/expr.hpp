@@ -9,5 +9,6 @@
 #include <beaker/sys.int/expr.hpp>
 #include <beaker/sys.var/expr.hpp>
 #include <beaker/sys.fn/expr.hpp>
+#include <beaker/sys.tuple/expr.hpp>
 
 #endif
@@ -0,0 +1,90 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "gen.hpp"
+#include "../ast.hpp"
+
+
+namespace beaker {
+
+/// Generate the LLVM representation of t.
+///
+/// If the type has previously been seen, return its cached version.
+cg::type
+generate(generator& gen, const type& t)
+{
+  type_map& types = gen.get_types();
+  auto iter = types.find(&t);
+  if (iter != types.end())
+    return iter->second;
+  cg::type ret = nullptr;
+  switch (t.get_kind()) {
+#define def_type(NS, T) \
+    case NS::T ## _type_kind: \
+      ret = generate_type(gen, cast<NS::T ## _type>(t)); \
+      break;
+#include <beaker/all/type.def>
+    default:
+      assert(false && "invalid type");
+  }
+  types.emplace(&t, ret);
+  return ret;
+}
+
+/// Generate a sequence of LLVM instructions for e.
+cg::value
+generate(generator& gen, const expr& e)
+{
+  switch (e.get_kind()) {
+#define def_expr(NS, E) \
+    case NS::E ## _expr_kind: \
+      return generate_expr(gen, cast<NS::E ## _expr>(e));
+#define def_init(NS, E) \
+    case NS::E ## _init_kind: \
+      return generate_expr(gen, cast<NS::E ## _init>(e));
+#include <beaker/all/expr.def>
+  }
+  assert(false && "invalid expression");
+}
+
+/// Generate an LLVM declaration for d. 
+cg::value
+generate(generator& gen, const decl& d)
+{
+  switch (d.get_kind()) {
+#define def_decl(NS, D) \
+    case NS::D ## _decl_kind: \
+      return generate_decl(gen, cast<NS::D ## _decl>(d));
+#include <beaker/all/decl.def>
+#undef def_decl
+  }
+  assert(false && "invalid declaration");
+}
+
+/// Declare d without generating its definition. 
+cg::value
+declare(generator& gen, const decl& d)
+{
+  switch (d.get_kind()) {
+#define def_decl(NS, D) \
+    case NS::D ## _decl_kind: \
+      return declare_decl(gen, cast<NS::D ## _decl>(d));
+#include <beaker/all/decl.def>
+  }
+  assert(false && "invalid declaration");
+}
+
+/// Generate a sequence of blocks and instructions for s.
+void
+generate(generator& gen, const stmt& s)
+{
+  switch (s.get_kind()) {
+#define def_stmt(NS, S) \
+    case NS::S ## _stmt_kind: \
+      return generate_stmt(gen, cast<NS::S ## _stmt>(s));
+#include <beaker/all/stmt.def>
+  }
+  assert(false && "invalid statement");
+}
+
+} // namespace beaker
@@ -0,0 +1,9 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include <beaker/sys.void/generation/gen.hpp>
+#include <beaker/sys.bool/generation/gen.hpp>
+#include <beaker/sys.int/generation/gen.hpp>
+#include <beaker/sys.var/generation/gen.hpp>
+#include <beaker/sys.fn/generation/gen.hpp>
+#include <beaker/sys.tuple/generation/gen.hpp>
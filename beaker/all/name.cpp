@@ -2,3 +2,21 @@
 // All rights reserved
 
 #include "name.hpp"
+
+
+namespace beaker {
+
+/// Returns true if the kind of `n` is canonical. See is_canonical_term.
+bool
+is_canonical_name(const name& n)
+{
+  switch (n.get_kind()) {
+#define def_name(NS, N) \
+    case NS::N ## _name_kind: \
+      return is_canonical_term<NS::N ## _name>::value;
+#include <beaker/all/name.def>
+  }
+  assert(false && "invalid name");
+}
+
+} // namespace beaker
@@ -7,3 +7,4 @@
 #include <beaker/sys.name/printing/print.hpp>
 #include <beaker/sys.var/printing/print.hpp>
 #include <beaker/sys.fn/printing/print.hpp>
+#include <beaker/sys.tuple/printing/print.hpp>
@@ -2,3 +2,21 @@
 // All rights reserved
 
 #include "type.hpp"
+
+
+namespace beaker {
+
+/// Returns true if the kind of `t` is canonical. See is_canonical_term.
+bool
+is_canonical_type(const type& t)
+{
+  switch (t.get_kind()) {
+#define def_type(NS, T) \
+    case NS::T ## _type_kind: \
+      return is_canonical_term<NS::T ## _type>::value;
+#include <beaker/all/type.def>
+  }
+  assert(false && "invalid type");
+}
+
+} // namespace beaker
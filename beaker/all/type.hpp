@@ -9,5 +9,6 @@
 #include <beaker/sys.int/type.hpp>
 #include <beaker/sys.var/type.hpp>
 #include <beaker/sys.fn/type.hpp>
+#include <beaker/sys.tuple/type.hpp>
 
 #endif
@@ -11,11 +11,18 @@
 #include <beaker/base/expr.hpp>
 #include <beaker/base/decl.hpp>
 #include <beaker/base/stmt.hpp>
+#include <beaker/base/expr_table.hpp>
 #include <beaker/base/comparison/equal.hpp>
 #include <beaker/base/comparison/hash.hpp>
+#include <beaker/base/comparison/shallow.hpp>
 #include <beaker/util/singleton_set.hpp>
 #include <beaker/util/canonical_set.hpp>
 
+#include <initializer_list>
+#include <type_traits>
+#include <memory>
+#include <unordered_map>
+
 
 namespace beaker {
 
@@ -27,6 +34,154 @@ using singleton_term_set = singleton_set<T>;
 template<typename T>
 using canonical_term_set = canonical_set<T, term_hash, term_equal>;
 
+template<typename T>
+using shared_term_set = canonical_set<T, shallow_hash, shallow_equal>;
+
+
+/// Designates a sequence of operands that is stored immediately after the
+/// node created by factory::make(). The corresponding constructor parameter
+/// of the node is a term_span<T>. See trailing().
+template<typename T>
+struct trailing_seq
+{
+  const seq<T>* seq_;
+};
+
+/// Returns the family of terms to which the node type T belongs.
+template<typename T>
+constexpr node_family
+get_node_family()
+{
+  return std::is_base_of<name, T>::value ? name_family
+       : std::is_base_of<type, T>::value ? type_family
+       : std::is_base_of<expr, T>::value ? expr_family
+       : std::is_base_of<decl, T>::value ? decl_family
+       : std::is_base_of<stmt, T>::value ? stmt_family
+       : other_family;
+}
+
+/// Returns a designator for operands stored after a node.
+template<typename T>
+inline trailing_seq<T> trailing(const seq<T>& s) { return {&s}; }
+
+namespace detail {
+
+template<typename T>
+struct is_trailing : std::false_type { };
+
+template<typename T>
+struct is_trailing<trailing_seq<T>> : std::true_type { };
+
+/// Returns the number of trailing sequences in Args.
+template<typename... Args>
+constexpr int
+count_trailing()
+{
+  int n = 0;
+  for (bool b : {false, is_trailing<std::decay_t<Args>>::value...})
+    n += b;
+  return n;
+}
+
+inline int trailing_size() { return 0; }
+
+template<typename A, typename... Args>
+int trailing_size(const A&, const Args&...);
+
+template<typename T, typename... Args>
+int trailing_size(const trailing_seq<T>&, const Args&...);
+
+/// Returns the number of bytes needed to store trailing operands.
+template<typename A, typename... Args>
+inline int 
+trailing_size(const A&, const Args&... args) 
+{ 
+  return trailing_size(args...); 
+}
+
+template<typename T, typename... Args>
+inline int 
+trailing_size(const trailing_seq<T>& s, const Args&... args) 
+{ 
+  return term_span<T>::storage_size(*s.seq_) + trailing_size(args...); 
+}
+
+/// Returns the argument a.
+template<typename A>
+inline A&& 
+bind_operand(A&& a, char*, std::false_type) 
+{ 
+  return std::forward<A>(a); 
+}
+
+/// Returns a span whose elements are stored at p.
+template<typename T>
+inline term_span<T>
+bind_operand(const trailing_seq<T>& s, char* p, std::true_type)
+{
+  return term_span<T>(reinterpret_cast<T**>(p), *s.seq_);
+}
+
+/// Adds the expression e to the table t, if any.
+inline void
+record_node(expr_table* t, const expr& e, std::true_type)
+{
+  if (t)
+    t->add(e);
+}
+
+/// Only expressions are recorded.
+template<typename T>
+inline void
+record_node(expr_table*, const T&, std::false_type)
+{ }
+
+} // namespace detail
+
+
+/// The base class of the factory's sets of shared expressions, one for each
+/// kind of expression.
+struct shared_set_base
+{
+  virtual ~shared_set_base() = default;
+  virtual void release(const node_store&, const node_store::mark&) = 0;
+};
+
+/// The shared expressions of type T. The expressions are allocated by the
+/// factory, not the set, so they are never destroyed by it. The slots of 
+/// the set are allocated from the default allocator, so that releasing the
+/// factory's memory does not free them.
+template<typename T>
+struct shared_set : shared_set_base
+{
+  shared_set();
+  ~shared_set() override;
+
+  void release(const node_store&, const node_store::mark&) override;
+
+  shared_term_set<T> terms_;
+};
+
+template<typename T>
+inline 
+shared_set<T>::shared_set() 
+  : terms_(shallow_hash(), shallow_equal(), default_allocator())
+{ }
+
+template<typename T>
+shared_set<T>::~shared_set()
+{
+  terms_.remove_if([](const T&) { return true; });
+}
+
+/// Removes the expressions allocated by s after the mark m.
+template<typename T>
+void
+shared_set<T>::release(const node_store& s, const node_store::mark& m)
+{
+  terms_.remove_if([&](const T& t) { return s.allocated_since(m, &t); });
+}
+
 
 /// The base class of all builder objects. This class provides access to the
 /// owning module (and hence language) as well also a local allocator. All 
@@ -51,21 +206,58 @@ struct factory : node_store
   int generate_id();
 
   template<typename T>
-  singleton_term_set<T>& make_singleton_set(allocator&);
+  singleton_term_set<T>& get_singleton_set(allocator&);
 
   template<typename T>
-  canonical_term_set<T>& make_canonical_set(allocator&);
+  canonical_term_set<T>& get_canonical_set(allocator&);
+
+  template<typename T>
+  shared_term_set<T>& get_shared_set();
 
   template<typename T, typename... Args>
   T& make(Args&&... args);
 
+  template<typename T, typename... Args>
+  T& make_node(Args&&... args);
+
+  template<typename T, typename... Args>
+  T& make_shared_node(std::true_type, Args&... args);
+
+  template<typename T, typename... Args>
+  T& make_shared_node(std::false_type, Args&... args);
+
+  expr_table* get_expr_table() const;
+  void set_expr_table(expr_table*);
+
+  bool is_hash_consing() const;
+  void set_hash_consing(bool);
+
+  layout_map& get_layout_map();
+
+  void release(mark) override;
+
   module* mod_;
   term_equal eq_;
   term_hash hash_;
+  expr_table* table_;
+  bool consing_;
+  std::unordered_map<int, std::unique_ptr<shared_set_base>> shared_;
+  layout_map layouts_;
 };
 
-/// Initialize the builder object.
-inline factory::factory(module& m) : mod_(&m), eq_(), hash_() { }
+/// Initialize the builder object. Blocks of memory are allocated from the
+/// module's block allocator.
+inline 
+factory::factory(module& m) 
+  : node_store(m.get_block_allocator()), 
+    mod_(&m), 
+    eq_(), 
+    hash_(), 
+    table_(), 
+    consing_(false), 
+    shared_(), 
+    layouts_()
+{ }
 
 /// Returns the equality comparison function.
 inline term_equal factory::get_equal_fn() const { return eq_; }
@@ -88,35 +280,145 @@ inline allocator& factory::get_language_allocator() { return get_language().get_
 /// Returns the allocator for the module.
 inline allocator& factory::get_module_allocator() { return mod_->get_allocator(); }
 
+/// Returns the table in which expressions are recorded, if any.
+inline expr_table* factory::get_expr_table() const { return table_; }
+
+/// Record the expressions made by the factory, in the order they are made,
+/// in the table t. If t is null, expressions are not recorded.
+inline void factory::set_expr_table(expr_table* t) { table_ = t; }
+
+/// Returns true if the factory shares pure expressions.
+inline bool factory::is_hash_consing() const { return consing_; }
+
+/// When b is true, pure expressions (see is_pure_term) are hash-consed: 
+/// making an expression equal to one that the factory has already made
+/// while hash-consing returns that expression. Operands made the same way
+/// are shared too, so repeated subexpressions form a DAG.
+///
+/// A shared expression can occur at several places in the source code. Its
+/// layouts should be added to the factory's layout map, not to the 
+/// expression.
+inline void factory::set_hash_consing(bool b) { consing_ = b; }
+
+/// Returns the layouts of shared expressions.
+inline layout_map& factory::get_layout_map() { return layouts_; }
+
 /// Generate a unique identifier from the module.
 inline int factory::generate_id() { return mod_->generate_id(); }
 
-/// Create a singleton set whose allocator is gi
+/// Returns the language's singleton set for T, creating it with the given
+/// allocator if needed.
 template<typename T>
 singleton_term_set<T>& 
-factory::make_singleton_set(allocator& alloc)
+factory::get_singleton_set(allocator& alloc)
 {
-  return *new singleton_term_set<T>(alloc);
+  auto result = get_language().sets_.emplace(int(T::node_kind), nullptr);
+  if (result.second)
+    result.first->second = std::make_shared<singleton_term_set<T>>(alloc);
+  return *static_cast<singleton_term_set<T>*>(result.first->second.get());
 }
 
+/// Returns the language's canonical set for T, creating it with the given
+/// allocator if needed. Every module of a language shares the same set, so
+/// canonical terms can be compared by identity across modules.
 template<typename T>
 canonical_term_set<T>& 
-factory::make_canonical_set(allocator& alloc)
+factory::get_canonical_set(allocator& alloc)
 {
-  return *new canonical_term_set<T>(hash_, eq_, alloc);
+  auto result = get_language().sets_.emplace(int(T::node_kind), nullptr);
+  if (result.second)
+    result.first->second = std::make_shared<canonical_term_set<T>>(hash_, eq_, alloc);
+  return *static_cast<canonical_term_set<T>*>(result.first->second.get());
+}
+
+/// Returns the set of shared expressions of type T.
+template<typename T>
+shared_term_set<T>&
+factory::get_shared_set()
+{
+  auto result = shared_.emplace(int(T::node_kind), nullptr);
+  if (result.second)
+    result.first->second.reset(new shared_set<T>());
+  return static_cast<shared_set<T>&>(*result.first->second).terms_;
 }
 
 /// Construct an object from b, using the given arguments.
 ///
 /// This is intended for use internally within builder objects to allocate
 /// and construct AST nodes.
+///
+/// When the factory is hash-consing, pure expressions are shared. See
+/// set_hash_consing.
 template<typename T, typename... Args>
-T& 
+inline T& 
 factory::make(Args&&... args)
 {
-  typed_allocator<T> alloc(alloc_);
-  T* ptr = alloc.allocate(1);
-  return *new (ptr) T(std::forward<Args>(args)...);
+  if (is_pure_term<T>::value && consing_)
+    return make_shared_node<T>(is_pure_term<T>(), args...);
+  return make_node<T>(std::forward<Args>(args)...);
+}
+
+/// Returns the shared expression constructed from args, making it if 
+/// needed. The expression is looked up with a key on the stack, so nothing
+/// is allocated when it is found.
+template<typename T, typename... Args>
+T&
+factory::make_shared_node(std::true_type, Args&... args)
+{
+  T key(args...);
+  return get_shared_set<T>().intern(key, [&](allocator&) {
+    return &make_node<T>(args...);
+  });
+}
+
+/// Terms that are not pure are never shared.
+template<typename T, typename... Args>
+inline T&
+factory::make_shared_node(std::false_type, Args&... args)
+{
+  return make_node<T>(args...);
+}
+
+/// Release all terms allocated by the factory after the mark m. Released
+/// expressions are removed from the factory's expression table, along with
+/// every expression added after them. They are also removed from the sets
+/// of shared expressions and the layout map, and the language's release
+/// listeners are notified.
+inline void
+factory::release(mark m)
+{
+  if (table_)
+    table_->remove_if([&](const expr& e) { return allocated_since(m, &e); });
+  for (auto& entry : shared_)
+    entry.second->release(*this, m);
+  layouts_.remove_if([&](const locatable& t) { return allocated_since(m, &t); });
+  get_language().notify_release(*this, m);
+  node_store::release(m);
+}
+
+/// Allocate and construct a node from the given arguments.
+///
+/// The node is allocated in the arena for its family of terms. If the
+/// factory has an expression table, expressions are also added to it.
+///
+/// An argument of the form trailing(s) designates a sequence of operands.
+/// If they cannot be stored inline, they are stored immediately after the 
+/// node, in the same allocation, so that the node and its operands share
+/// cache lines. A node can have at most one trailing sequence.
+template<typename T, typename... Args>
+T& 
+factory::make_node(Args&&... args)
+{
+  static_assert(detail::count_trailing<Args...>() <= 1, "too many trailing sequences");
+  int n = detail::trailing_size(args...);
+  allocator& a = node_store::get_allocator(get_node_family<T>());
+  char* p = (char*)a.allocate(sizeof(T) + n, alignof(T));
+  char* q = p + sizeof(T);
+  T* t = new (p) T(detail::bind_operand(
+    std::forward<Args>(args), q, detail::is_trailing<std::decay_t<Args>>()
+  )...);
+  detail::record_node(table_, *t, std::is_base_of<expr, T>());
+  return *t;
 }
 
 
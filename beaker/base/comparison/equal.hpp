@@ -13,10 +13,31 @@ namespace beaker {
 // -------------------------------------------------------------------------- //
 // Primary interface
 
-bool equal(const name&, const name&);
-bool equal(const type&, const type&);
+bool equal_distinct(const name&, const name&);
+bool equal_distinct(const type&, const type&);
 bool equal(const expr&, const expr&);
 
+bool equal_structure(const name&, const name&);
+bool equal_structure(const type&, const type&);
+bool equal_structure(const expr&, const expr&);
+
+/// Returns true if `a` and `b` are equal names. Equal canonical names are
+/// the same object, so the comparison of equal names is usually a single
+/// pointer comparison.
+inline bool
+equal(const name& a, const name& b)
+{
+  return &a == &b || equal_distinct(a, b);
+}
+
+/// Returns true if `a` and `b` are equal types. Every kind of type is 
+/// canonical, so this is usually a single pointer comparison.
+inline bool
+equal(const type& a, const type& b)
+{
+  return &a == &b || equal_distinct(a, b);
+}
+
 /// Returns truen if `a` and `b` have equal elements.
 template<typename T>
 bool 
@@ -28,6 +49,17 @@ equal(const seq<T>& a, const seq<T>& b)
   return std::equal(a.begin(), a.end(), b.begin(), b.end(), cmp);
 }
 
+/// Returns true if `a` and `b` have equal elements.
+template<typename T>
+bool 
+equal(const term_span<T>& a, const term_span<T>& b)
+{
+  auto cmp = [](const T& x, const T& y) {
+    return equal(x, y);
+  };
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), cmp);
+}
+
 
 // -------------------------------------------------------------------------- //
 // Dispatch interface
@@ -85,13 +117,14 @@ bool equal_expr(const ternary_expr&, const ternary_expr&);
 // Functional
 
 /// A function object for term comparison that can be used with standard
-/// algorithms and containers.
+/// algorithms and containers. Terms are compared by their structure, even 
+/// when they are canonical, so this can be used to find canonical terms.
 struct term_equal
 {
   template<typename T>
   bool operator()(const T& a, const T& b) const noexcept
   {
-    return equal(a, b);
+    return equal_structure(a, b);
   }
 };
 
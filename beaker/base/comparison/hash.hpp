@@ -23,6 +23,10 @@ void hash(hasher&, const name&);
 void hash(hasher&, const type&);
 void hash(hasher&, const expr&);
 
+void hash_structure(hasher&, const name&);
+void hash_structure(hasher&, const type&);
+void hash_structure(hasher&, const expr&);
+
 /// Hash the elements of s into h.
 template<typename T>
 inline void
@@ -33,6 +37,16 @@ hash(hasher& h, const seq<T>& s)
   hash(h, s.size());
 }
 
+/// Hash the elements of s into h.
+template<typename T>
+inline void
+hash(hasher& h, const term_span<T>& s) 
+{
+  for (const T& t : s)
+    hash(h, t);
+  hash(h, s.size());
+}
+
 
 // -------------------------------------------------------------------------- //
 // Dispatch interface
@@ -91,14 +105,15 @@ void hash_expr(hasher&, const ternary_expr&);
 // Functional
 
 /// A function object for term hashing that can be used with standard
-/// algorithms and containers.
+/// algorithms and containers. Terms are hashed by their structure, even
+/// when they are canonical, so this can be used to find canonical terms.
 struct term_hash
 {
   template<typename T>
   std::size_t operator()(const T& t) const noexcept
   {
     hasher algo;
-    hash(algo, t);
+    hash_structure(algo, t);
     return algo;
   }
 };
@@ -0,0 +1,115 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_BASE_COMPARISON_SHALLOW_HPP
+#define BEAKER_BASE_COMPARISON_SHALLOW_HPP
+
+#include <beaker/base/expr.hpp>
+#include <beaker/base/value.hpp>
+#include <beaker/util/hash.hpp>
+
+
+namespace beaker {
+
+// -------------------------------------------------------------------------- //
+// Shallow comparison
+//
+// Shallow comparison and hashing consider the kind, type, and value of an
+// expression, and the identity of its operands. When the operands of two
+// expressions are shared (i.e., equal operands are the same object), this
+// is the same as comparing their structure, but it takes constant time.
+
+/// Appends the value of a literal.
+inline void hash_shallow(hasher& h, const literal_expr& e) { hash(h, e.get_value()); }
+
+/// Appends nothing for nullary expressions.
+inline void hash_shallow(hasher&, const nullary_expr&) { }
+
+/// Appends the address of the operand of `e`.
+inline void hash_shallow(hasher& h, const unary_expr& e) { hash(h, &e.get_first()); }
+
+/// Appends the addresses of the operands of `e`.
+inline void
+hash_shallow(hasher& h, const binary_expr& e)
+{
+  hash(h, &e.get_first());
+  hash(h, &e.get_second());
+}
+
+/// Appends the addresses of the operands of `e`.
+inline void
+hash_shallow(hasher& h, const ternary_expr& e)
+{
+  hash(h, &e.get_first());
+  hash(h, &e.get_second());
+  hash(h, &e.get_third());
+}
+
+/// Returns true if the literals `a` and `b` have equal values.
+inline bool
+equal_shallow(const literal_expr& a, const literal_expr& b)
+{
+  return a.get_value() == b.get_value();
+}
+
+/// Nullary expressions of the same kind are equal.
+inline bool equal_shallow(const nullary_expr&, const nullary_expr&) { return true; }
+
+/// Returns true if `a` and `b` have the same operand.
+inline bool
+equal_shallow(const unary_expr& a, const unary_expr& b)
+{
+  return &a.get_first() == &b.get_first();
+}
+
+/// Returns true if `a` and `b` have the same operands.
+inline bool
+equal_shallow(const binary_expr& a, const binary_expr& b)
+{
+  return &a.get_first() == &b.get_first() &&
+         &a.get_second() == &b.get_second();
+}
+
+/// Returns true if `a` and `b` have the same operands.
+inline bool
+equal_shallow(const ternary_expr& a, const ternary_expr& b)
+{
+  return &a.get_first() == &b.get_first() &&
+         &a.get_second() == &b.get_second() &&
+         &a.get_third() == &b.get_third();
+}
+
+
+// -------------------------------------------------------------------------- //
+// Functional
+
+/// A function object for shallow hashing of expressions.
+struct shallow_hash
+{
+  template<typename T>
+  std::size_t operator()(const T& e) const noexcept
+  {
+    hasher h;
+    hash(h, e.get_kind());
+    hash(h, &e.get_type());
+    hash_shallow(h, e);
+    return h;
+  }
+};
+
+/// A function object for shallow comparison of expressions.
+struct shallow_equal
+{
+  template<typename T>
+  bool operator()(const T& a, const T& b) const noexcept
+  {
+    return a.get_kind() == b.get_kind() &&
+           &a.get_type() == &b.get_type() &&
+           equal_shallow(a, b);
+  }
+};
+
+} // namespace beaker
+
+
+#endif
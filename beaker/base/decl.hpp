@@ -165,6 +165,9 @@ inline decl* decl::get_lexical_context() { return cxt_.get_lexical_context(); }
 // A sequence of declarations.
 using decl_seq = seq<decl>;
 
+// An immutable sequence of declarations, stored in a term.
+using decl_span = term_span<decl>;
+
 
 // -------------------------------------------------------------------------- //
 // Named declarations
@@ -425,13 +428,11 @@ value_decl_impl<K>::value_decl_impl(uid id, dc cxt, linkage l, storage s, name&
 /// programming) or statements (to support imperative programming).
 struct mapping_decl : typed_decl
 {
-  mapping_decl(int, uid, dc, name&, type&, const decl_seq&, decl&);
-  mapping_decl(int, uid, dc, name&, type&, decl_seq&&, decl&);
-  mapping_decl(int, uid, dc, linkage, name&, type&, const decl_seq&, decl&, stmt&);
-  mapping_decl(int, uid, dc, linkage, name&, type&, decl_seq&&, decl&, stmt&);
+  mapping_decl(int, uid, dc, name&, type&, const decl_span&, decl&);
+  mapping_decl(int, uid, dc, linkage, name&, type&, const decl_span&, decl&, stmt&);
 
-  const decl_seq& get_parameters() const;
-  decl_seq& get_parameters();
+  const decl_span& get_parameters() const;
+  decl_span& get_parameters();
   
   const decl& get_return() const;
   decl& get_return();
@@ -447,7 +448,7 @@ private:
   void finish_parms();
 public:
 
-  decl_seq parms_;
+  decl_span parms_;
   decl* ret_;
   stmt* def_;
 };
@@ -467,42 +468,25 @@ mapping_decl::finish_parms()
 /// Initialize this mapping declaration, having no definition. When not
 /// defined, the mapping has external linkage by default.
 inline
-mapping_decl::mapping_decl(int k, uid id, dc cxt, name& n, type& t, const decl_seq& p, decl& r)
+mapping_decl::mapping_decl(int k, uid id, dc cxt, name& n, type& t, const decl_span& p, decl& r)
   : typed_decl(k, id, cxt, external_link, n, t), parms_(p), ret_(&r), def_()
 {
   finish_parms();
 }
 
-/// Initialize this mapping declaration, having no definition. When not
-/// defined, the mapping has external linkage by default.
-inline
-mapping_decl::mapping_decl(int k, uid id, dc cxt, name& n, type& t, decl_seq&& p, decl& r)
-  : typed_decl(k, id, cxt, external_link, n, t), parms_(std::move(p)), ret_(&r), def_()
-{ 
-  finish_parms();
-}
-
 /// Initialize this mapping declaration.
 inline
-mapping_decl::mapping_decl(int k, uid id, dc cxt, linkage l, name& n, type& t, const decl_seq& p, decl& r, stmt& s)
+mapping_decl::mapping_decl(int k, uid id, dc cxt, linkage l, name& n, type& t, const decl_span& p, decl& r, stmt& s)
   : typed_decl(k, id, cxt, l, n, t), parms_(p), ret_(&r), def_(&s)
 { 
   finish_parms();
 }
 
-/// Initialize this mapping declaration.
-inline
-mapping_decl::mapping_decl(int k, uid id, dc cxt, linkage l, name& n, type& t, decl_seq&& p, decl& r, stmt& s)
-  : typed_decl(k, id, cxt, l, n, t), parms_(std::move(p)), ret_(&r), def_(&s)
-{ 
-  finish_parms();
-}
-
 /// Returns the mapping's parameters.
-inline const decl_seq& mapping_decl::get_parameters() const { return parms_; }
+inline const decl_span& mapping_decl::get_parameters() const { return parms_; }
 
 /// Returns the mapping's parameters.
-inline decl_seq& mapping_decl::get_parameters() { return parms_; }
+inline decl_span& mapping_decl::get_parameters() { return parms_; }
 
 /// Returns the mappings return declaration.
 inline const decl& mapping_decl::get_return() const { return *ret_; }
@@ -528,36 +512,22 @@ struct mapping_decl_impl : mapping_decl
 {
   static constexpr int node_kind = K;
 
-  mapping_decl_impl(uid, dc, name&, type&, const decl_seq&, decl&);
-  mapping_decl_impl(uid, dc, name&, type&, decl_seq&&, decl&);
-  mapping_decl_impl(uid, dc, linkage, name&, type&, const decl_seq&, decl&, stmt&);
-  mapping_decl_impl(uid, dc, linkage, name&, type&, decl_seq&&, decl&, stmt&);
+  mapping_decl_impl(uid, dc, name&, type&, const decl_span&, decl&);
+  mapping_decl_impl(uid, dc, linkage, name&, type&, const decl_span&, decl&, stmt&);
 };
 
 template<int K>
 inline
-mapping_decl_impl<K>::mapping_decl_impl(uid id, dc cxt, name& n, type& t, const decl_seq& p, decl& r)
+mapping_decl_impl<K>::mapping_decl_impl(uid id, dc cxt, name& n, type& t, const decl_span& p, decl& r)
   : mapping_decl(K, id, cxt, n, t, p, r)
 { }
 
 template<int K>
 inline
-mapping_decl_impl<K>::mapping_decl_impl(uid id, dc cxt, name& n, type& t, decl_seq&& p, decl& r)
-  : mapping_decl(K, id, cxt, n, t, std::move(p), r)
-{ }
-
-template<int K>
-inline
-mapping_decl_impl<K>::mapping_decl_impl(uid id, dc cxt, linkage l, name& n, type& t, const decl_seq& p, decl& r, stmt& s)
+mapping_decl_impl<K>::mapping_decl_impl(uid id, dc cxt, linkage l, name& n, type& t, const decl_span& p, decl& r, stmt& s)
   : mapping_decl(K, id, cxt, l, n, t, p, r, s)
 { }
 
-template<int K>
-inline
-mapping_decl_impl<K>::mapping_decl_impl(uid id, dc cxt, linkage l, name& n, type& t, decl_seq&& p, decl& r, stmt& s)
-  : mapping_decl(K, id, cxt, l, n, t, std::move(p), r, s)
-{ }
-
 
 // -------------------------------------------------------------------------- //
 // Operations
@@ -2,3 +2,37 @@
 // All rights reserved
 
 #include "evaluate.hpp"
+
+
+namespace beaker {
+
+/// Bind d to a new object initialized with v. If there is a current frame,
+/// the object is local to that frame. Otherwise, d is bound globally.
+value&
+evaluator::bind(const decl& d, const value& v)
+{
+  if (frame_)
+    return bind(*frame_, d, v);
+  escape();
+  value*& p = globals_[&d];
+  if (!p)
+    p = new (alloc_.allocate(sizeof(value), alignof(value))) value();
+  *p = v;
+  return *p;
+}
+
+/// Returns the object bound to d in the current frame or globally, or nullptr
+/// if d is not bound.
+value*
+evaluator::lookup(const decl& d)
+{
+  if (frame_)
+    if (value* p = frame_->lookup(d))
+      return p;
+  auto iter = globals_.find(&d);
+  if (iter != globals_.end())
+    return iter->second;
+  return nullptr;
+}
+
+} // namespace beaker
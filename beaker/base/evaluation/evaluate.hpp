@@ -7,6 +7,10 @@
 #include <beaker/base/lang.hpp>
 #include <beaker/base/error.hpp>
 #include <beaker/base/value.hpp>
+#include <beaker/base/evaluation/frame.hpp>
+#include <beaker/util/memory.hpp>
+
+#include <unordered_map>
 
 
 namespace beaker {
@@ -21,25 +25,308 @@ struct evaluation_error : error
 };
 
 
+// -------------------------------------------------------------------------- //
+// Failures
+
+/// A failure records why the evaluation of an expression failed: either the
+/// expression whose evaluation failed, or a message when there is no such
+/// expression.
+///
+/// Failures are returned, not thrown, so that expressions can be evaluated 
+/// speculatively (e.g., to fold constants) without the cost of unwinding. 
+/// The throwing interface raises a failure as the exception that describes 
+/// it.
+struct failure
+{
+  using raise_fn = void (*)(const failure&);
+
+  void raise() const;
+
+  raise_fn raise_;
+  const expr* expr_;
+  const char* what_;
+};
+
+/// Throw the exception describing the failure.
+inline void failure::raise() const { raise_(*this); }
+
+/// Throws the exception E for the expression whose evaluation failed.
+template<typename E>
+void 
+raise_error(const failure& f)
+{
+  throw E(*f.expr_);
+}
+
+/// Throws an evaluation error with the message of the failure.
+inline void 
+raise_message(const failure& f)
+{
+  throw evaluation_error(f.what_);
+}
+
+
+/// The result of evaluating an expression or declaration is either a value
+/// or a failure. A result is tested before its value is used, and a failed
+/// result is propagated to the caller:
+///
+///   result r = try_evaluate(eval, e);
+///   if (!r)
+///     return r;
+///
+/// A failed result refers to the failure recorded by the evaluator, which 
+/// is valid until the next failure.
+struct result
+{
+  result(const value&);
+  explicit result(const failure&);
+
+  explicit operator bool() const;
+
+  const value& get_value() const;
+  const failure& get_failure() const;
+
+  value val_;
+  const failure* fail_;
+};
+
+/// Initialize the result with the value v.
+inline result::result(const value& v) : val_(v), fail_() { }
+
+/// Initialize the result with the failure f.
+inline result::result(const failure& f) : val_(), fail_(&f) { }
+
+/// Returns true if evaluation succeeded.
+inline result::operator bool() const { return !fail_; }
+
+/// Returns the computed value.
+inline const value& 
+result::get_value() const 
+{ 
+  assert(!fail_);
+  return val_; 
+}
+
+/// Returns the failure.
+inline const failure& 
+result::get_failure() const 
+{ 
+  assert(fail_);
+  return *fail_; 
+}
+
+
 /// The evaluator maintains the evaluation context for the evaluation of the
 /// expressions, declarations, and statements.
 ///
 /// The evaluator maintains a reference to the language. This allows evaluation
 /// to be defined in terms of the parameterization of the language by 
 /// translation and compilation options.
+///
+/// The evaluator also owns the arena in which aggregate values and global
+/// objects are allocated. The storage allocated by a top-level evaluation
+/// (see evaluate() and call()) is released when it finishes, unless its
+/// result is an aggregate or it stored a value that may refer to that
+/// storage (i.e., it bound a global or assigned an aggregate). Otherwise,
+/// aggregates computed by an evaluator are valid for its lifetime.
+///
+/// Function calls push frames onto the evaluator's frame stack. Variables
+/// declared outside of any function are bound globally, and their objects
+/// are valid for the lifetime of the evaluator.
+///
+/// The evaluator records the expression in tail position of the current
+/// return statement, if any. A call in tail position does not call its
+/// function; it saves the function and its arguments as a pending tail call, 
+/// which is made by the caller after the current frame has been released.
+///
+/// The evaluator records the most recent failure. Results that refer to it
+/// are valid until the next failure.
 struct evaluator
 {
+  struct frame_guard;
+
   evaluator(const language&);
+  evaluator(const evaluator&) = delete;
+  evaluator& operator=(const evaluator&) = delete;
+
+  // Storage
+  allocator& get_allocator();
+  sequential_allocator<>::mark enter();
+  void leave(sequential_allocator<>::mark, const result&);
+  void escape();
+
+  // Frames and bindings
+  frame* get_frame();
+  frame& make_frame();
+  value& bind(frame&, const decl&, const value&);
+  value& bind(const decl&, const value&);
+  value* lookup(const decl&);
+
+  // Tail calls
+  bool in_tail_position(const expr&) const;
+  void set_tail_position(const expr*);
+
+  // Failures
+  template<typename E>
+  result fail(const expr&);
+  result fail(const char*);
+  const failure& get_failure() const;
   
   const language& lang;
+  sequential_allocator<> alloc_;
+  int depth_;
+  bool escaped_;
+  frame_stack stack_;
+  frame* frame_;
+  std::unordered_map<const decl*, value*> globals_;
+  const expr* tail_;
+  const decl* tail_fn_;
+  std::vector<value> tail_args_;
+  failure failure_;
+};
+
+inline 
+evaluator::evaluator(const language& lang) 
+  : lang(lang), depth_(), escaped_(), frame_(), tail_(), tail_fn_(), failure_()
+{ }
+
+/// Returns the allocator used for aggregate values.
+inline allocator& evaluator::get_allocator() { return alloc_; }
+
+/// Begin an evaluation. Returns the position of the allocator, which is
+/// passed to leave() when the evaluation finishes.
+inline sequential_allocator<>::mark
+evaluator::enter()
+{
+  if (depth_++ == 0)
+    escaped_ = false;
+  return alloc_.get_mark();
+}
+
+/// Finish an evaluation that produced r. If this is a top-level evaluation,
+/// the storage allocated after m is released unless r or a stored value may
+/// refer to it.
+inline void
+evaluator::leave(sequential_allocator<>::mark m, const result& r)
+{
+  if (--depth_ != 0 || escaped_)
+    return;
+  if (r && r.get_value().is_aggregate())
+    return;
+  alloc_.release(m);
+}
+
+/// Indicate that the current evaluation stored a value that may refer to
+/// storage allocated during the evaluation.
+inline void evaluator::escape() { escaped_ = true; }
+
+/// Returns the current stack frame, or nullptr if no function is being
+/// evaluated.
+inline frame* evaluator::get_frame() { return frame_; }
+
+/// Allocate a new frame whose caller is the current frame. The new frame 
+/// does not become the current frame.
+inline frame& 
+evaluator::make_frame()
+{
+  return *new (stack_.allocate(sizeof(frame))) frame(frame_);
+}
+
+/// Bind d to a new object in f, initialized with v. Returns the object.
+inline value&
+evaluator::bind(frame& f, const decl& d, const value& v)
+{
+  binding* b = new (stack_.allocate(sizeof(binding))) binding {f.top_, &d, v};
+  f.top_ = b;
+  return b->val_;
+}
+
+/// Returns true if e is in tail position in the current frame.
+inline bool 
+evaluator::in_tail_position(const expr& e) const 
+{ 
+  return frame_ && tail_ == &e; 
+}
+
+/// Set the expression in tail position.
+inline void evaluator::set_tail_position(const expr* e) { tail_ = e; }
+
+/// Record the failure of the evaluation of e, which is raised by throwing
+/// the exception E. Returns the failed result.
+template<typename E>
+inline result
+evaluator::fail(const expr& e)
+{
+  failure_ = {raise_error<E>, &e, nullptr};
+  return result(failure_);
+}
+
+/// Record a failure described by the message msg, which is raised by
+/// throwing an evaluation error. Returns the failed result.
+inline result
+evaluator::fail(const char* msg)
+{
+  failure_ = {raise_message, nullptr, msg};
+  return result(failure_);
+}
+
+/// Returns the most recent failure.
+inline const failure& evaluator::get_failure() const { return failure_; }
+
+
+/// Establishes a new frame as the current frame. When the guard is destroyed,
+/// the caller's frame is restored and the storage of the frame, and all 
+/// storage allocated after the mark, is released.
+struct evaluator::frame_guard
+{
+  frame_guard(evaluator&, frame&, frame_stack::mark);
+  ~frame_guard();
+
+  evaluator& eval;
+  frame* prev;
+  frame_stack::mark mark;
+};
+
+inline
+evaluator::frame_guard::frame_guard(evaluator& e, frame& f, frame_stack::mark m)
+  : eval(e), prev(e.frame_), mark(m)
+{ 
+  eval.frame_ = &f;
+}
+
+inline
+evaluator::frame_guard::~frame_guard()
+{
+  eval.frame_ = prev;
+  eval.tail_ = nullptr;
+  eval.stack_.release(mark);
+}
+
+
+/// The flow of control following the evaluation of a statement.
+///
+/// - next: control passes to the next statement.
+/// - return: the function returns; its return value has been initialized.
+/// - tail: the function returns by making the pending tail call.
+/// - fail: evaluation failed; the failure is recorded by the evaluator.
+enum control
+{
+  next_control,
+  return_control,
+  tail_control,
+  fail_control,
 };
 
-inline evaluator::evaluator(const language& lang) : lang(lang) { }
 
+// Evaluation returns failures.
+result try_evaluate(evaluator&, const expr&);
+result try_evaluate(evaluator&, const decl&);
+control try_evaluate(evaluator&, const stmt&);
 
+// Evaluation throws failures.
 value evaluate(evaluator&, const expr&);
 value evaluate(evaluator&, const decl&);
-value evaluate(evaluator&, const stmt&);
+control evaluate(evaluator&, const stmt&);
 
 
 // -------------------------------------------------------------------------- //
@@ -47,7 +334,7 @@ value evaluate(evaluator&, const stmt&);
 
 /// Evaluate the given expression. Behavior is undefined if overload resolution
 /// selects this function.
-inline value 
+inline result 
 evaluate_expr(evaluator&, const expr&)
 {
   assert(false && "function not defined");
@@ -55,7 +342,7 @@ evaluate_expr(evaluator&, const expr&)
 
 /// Elaborate the given declaration. Behavior is undefined if overload 
 /// resolution selects this function.
-inline value 
+inline result 
 evaluate_decl(evaluator&, const decl&)
 {
   assert(false && "function not defined");
@@ -63,7 +350,7 @@ evaluate_decl(evaluator&, const decl&)
 
 /// Evaluate the given statement. Behavior is undefined if overload resolution
 /// selects this function.
-inline value 
+inline control 
 evaluate_stmt(evaluator&, const stmt&)
 {
   assert(false && "function not defined");
@@ -0,0 +1,38 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "frame.hpp"
+
+#include <algorithm>
+
+
+namespace beaker {
+
+constexpr int frame_stack::block_size;
+
+frame_stack::~frame_stack()
+{
+  for (block& b : blocks_)
+    delete[] b.base_;
+}
+
+/// Move to the next block, allocating it if needed. The block has at least
+/// n bytes. A retained block that is too small is replaced; it contains no
+/// objects because it follows the current block.
+void
+frame_stack::extend(int n)
+{
+  ++block_;
+  int size = std::max(n, block_size);
+  if (block_ == (int)blocks_.size()) {
+    blocks_.push_back({new char[size], size});
+  }
+  else if (blocks_[block_].size_ < n) {
+    delete[] blocks_[block_].base_;
+    blocks_[block_] = {new char[size], size};
+  }
+  ptr_ = blocks_[block_].base_;
+  limit_ = ptr_ + blocks_[block_].size_;
+}
+
+} // namespace beaker
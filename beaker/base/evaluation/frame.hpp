@@ -0,0 +1,153 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_EVALUATION_FRAME_HPP
+#define BEAKER_EVALUATION_FRAME_HPP
+
+#include <beaker/base/value.hpp>
+
+#include <vector>
+
+
+namespace beaker {
+
+struct decl;
+
+
+// -------------------------------------------------------------------------- //
+// Frame stack
+
+/// The frame stack is the arena in which the stack frames of function calls 
+/// and their local objects are allocated.
+///
+/// Memory is allocated by bumping a pointer within a sequence of blocks.
+/// Blocks have a fixed size, except that a request larger than a block 
+/// (e.g., the arguments of a call with many parameters) is given a block 
+/// of its own. Memory is released by rewinding the stack to a mark taken
+/// before the allocation; this happens when a function returns or a block
+/// exits. Blocks are retained after memory is released, so recursion to a
+/// previous depth does not allocate, unless a retained block is too small
+/// for the request that reaches it, in which case it is replaced. Blocks 
+/// never move, so objects in the stack keep their addresses until they are
+/// released.
+struct frame_stack
+{
+  static constexpr int block_size = 64 * 1024;
+
+  /// A block of storage.
+  struct block
+  {
+    char* base_;
+    int size_;
+  };
+
+  /// A position in the frame stack.
+  struct mark
+  {
+    int block_;
+    char* ptr_;
+  };
+
+  frame_stack();
+  frame_stack(const frame_stack&) = delete;
+  frame_stack& operator=(const frame_stack&) = delete;
+  ~frame_stack();
+
+  void* allocate(int);
+
+  mark get_mark() const;
+  void release(mark);
+
+  void extend(int);
+
+  std::vector<block> blocks_;
+  int block_;
+  char* ptr_;
+  char* limit_;
+};
+
+inline frame_stack::frame_stack() : block_(-1), ptr_(), limit_() { }
+
+/// Returns the current position in the stack.
+inline frame_stack::mark 
+frame_stack::get_mark() const { return {block_, ptr_}; }
+
+/// Allocate n bytes of storage suitably aligned for values.
+inline void*
+frame_stack::allocate(int n)
+{
+  n = (n + alignof(value) - 1) & ~(alignof(value) - 1);
+  if (limit_ - ptr_ < n)
+    extend(n);
+  char* p = ptr_;
+  ptr_ += n;
+  return p;
+}
+
+/// Release all memory allocated after the mark m.
+inline void
+frame_stack::release(mark m)
+{
+  block_ = m.block_;
+  ptr_ = m.ptr_;
+  limit_ = block_ < 0 ? nullptr : blocks_[block_].base_ + blocks_[block_].size_;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Stack frames
+
+/// A binding associates a declaration with the object that stores its 
+/// value. For references, that value is the address of the referred to
+/// object.
+///
+/// The bindings of a frame form a list, ordered from the most recent.
+struct binding
+{
+  binding* prev_;
+  const decl* decl_;
+  value val_;
+};
+
+
+/// A stack frame contains the parameters and local variables of a function
+/// call, and the object initialized by its return statement. Frames and 
+/// bindings are allocated in the frame stack.
+struct frame
+{
+  frame(frame*);
+
+  value* lookup(const decl&);
+  bool contains(const value*) const;
+
+  frame* prev_;
+  binding* top_;
+  value* ret_;
+};
+
+inline frame::frame(frame* p) : prev_(p), top_(), ret_() { }
+
+/// Returns the object bound to d in this frame or nullptr if d is not bound.
+inline value*
+frame::lookup(const decl& d)
+{
+  for (binding* b = top_; b; b = b->prev_)
+    if (b->decl_ == &d)
+      return &b->val_;
+  return nullptr;
+}
+
+/// Returns true if p is the address of an object in this frame.
+inline bool
+frame::contains(const value* p) const
+{
+  for (binding* b = top_; b; b = b->prev_)
+    if (&b->val_ == p)
+      return true;
+  return false;
+}
+
+} // namespace beaker
+
+
+#endif
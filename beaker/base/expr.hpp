@@ -34,11 +34,11 @@ struct expr : locatable
   int get_type_kind() const;
 
   const int kind_;
-  type* type_;
+  node_ref<type> type_;
 };
 
 // Construct an expression with kind k.
-inline expr::expr(int k, type& t) : kind_(k), type_(&t) { }
+inline expr::expr(int k, type& t) : kind_(k), type_(t) { }
 
 // Returns the language pack that defines the expression.
 inline int expr::get_feature() const { return get_language(kind_); }
@@ -59,6 +59,9 @@ inline type& expr::get_type() { return *type_; }
 // A sequence of expressions.
 using expr_seq = seq<expr>;
 
+// An immutable sequence of expressions, stored in a term.
+using expr_span = term_span<expr>;
+
 
 // -------------------------------------------------------------------------- //
 // Literal expressions
@@ -163,12 +166,12 @@ struct unary_expr : expr {
   const expr& get_first() const;
   expr& get_first();
 
-  expr* arg_;
+  node_ref<expr> arg_;
 };
 
 // Initialize the the unary expression of kind k.
 inline unary_expr::unary_expr(int k, type& t, expr& e)
-  : expr(k, t), arg_(&e) 
+  : expr(k, t), arg_(e) 
 { }
 
 // Returns the operand of the unary expression.
@@ -218,13 +221,13 @@ struct binary_expr : expr {
   const expr& get_second() const;
   expr& get_second();
 
-  expr* args_[2];
+  node_ref<expr> args_[2];
 };
 
 // Initialize the the binary expression of kind k.
 inline
 binary_expr::binary_expr(int k, type& t, expr& e1, expr& e2)
-  : expr(k, t), args_{&e1, &e2}
+  : expr(k, t), args_{e1, e2}
 { }
 
 // Returns the left operand.
@@ -284,13 +287,13 @@ struct ternary_expr : expr {
   const expr& get_third() const;
   expr& get_third();
 
-  expr* args_[3];
+  node_ref<expr> args_[3];
 };
 
 // Initialize the the binary expression of kind k.
 inline
 ternary_expr::ternary_expr(int k, type& t, expr& e1, expr& e2, expr& e3)
-  : expr(k, t), args_{&e1, &e2, &e3}
+  : expr(k, t), args_{e1, e2, e3}
 { }
 
 // Returns the left operand.
@@ -455,7 +458,7 @@ struct conversion_expr : expr {
   const expr& get_source() const;
   expr& get_source();
 
-  expr* arg_;
+  node_ref<expr> arg_;
 };
 
 // Initialize the conversion expression.
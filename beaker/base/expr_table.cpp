@@ -0,0 +1,176 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "expr_table.hpp"
+
+#include <beaker/util/hash.hpp>
+
+
+namespace beaker {
+
+constexpr int expr_table::no_operand;
+
+/// Adds the expression e and its operands to the table, and returns the
+/// index of e. If e is already in the table, this returns its index.
+int
+expr_table::add(const expr& e)
+{
+  auto iter = index_.find(&e);
+  if (iter != index_.end())
+    return iter->second;
+
+  // Add the operands first, so that they precede e.
+  expr_form f;
+  int ops[3] {no_operand, no_operand, no_operand};
+  if (const literal_expr* l = dynamic_cast<const literal_expr*>(&e)) {
+    f = literal_form;
+    ops[0] = values_.size();
+    values_.push_back(l->get_value());
+  }
+  else if (dynamic_cast<const nullary_expr*>(&e)) {
+    f = nullary_form;
+  }
+  else if (const unary_expr* u = dynamic_cast<const unary_expr*>(&e)) {
+    f = unary_form;
+    ops[0] = add(u->get_first());
+  }
+  else if (const binary_expr* b = dynamic_cast<const binary_expr*>(&e)) {
+    f = binary_form;
+    ops[0] = add(b->get_first());
+    ops[1] = add(b->get_second());
+  }
+  else if (const ternary_expr* t = dynamic_cast<const ternary_expr*>(&e)) {
+    f = ternary_form;
+    ops[0] = add(t->get_first());
+    ops[1] = add(t->get_second());
+    ops[2] = add(t->get_third());
+  }
+  else {
+    f = opaque_form;
+    ops[0] = opaque_.size();
+    opaque_.push_back(&e);
+  }
+
+  int n = size();
+  kinds_.push_back(e.get_kind());
+  forms_.push_back(f);
+  types_.push_back(&e.get_type());
+  for (int i = 0; i < 3; ++i)
+    ops_[i].push_back(ops[i]);
+  index_.emplace(&e, n);
+  return n;
+}
+
+/// Returns the index of e in the table, or no_operand if e has not been
+/// added.
+int
+expr_table::find(const expr& e) const
+{
+  auto iter = index_.find(&e);
+  return iter != index_.end() ? iter->second : no_operand;
+}
+
+/// Removes the expressions at index n and above.
+void
+expr_table::truncate(int n)
+{
+  if (n >= size())
+    return;
+
+  // Values and opaque references are stored in the order of their
+  // expressions, so the first removed one marks the new size.
+  int v = -1;
+  int o = -1;
+  for (int i = n; i < size(); ++i) {
+    if (v < 0 && forms_[i] == literal_form)
+      v = ops_[0][i];
+    if (o < 0 && forms_[i] == opaque_form)
+      o = ops_[0][i];
+  }
+  if (v >= 0)
+    values_.resize(v);
+  if (o >= 0)
+    opaque_.resize(o);
+
+  kinds_.resize(n);
+  forms_.resize(n);
+  types_.resize(n);
+  for (int i = 0; i < 3; ++i)
+    ops_[i].resize(n);
+  for (auto iter = index_.begin(); iter != index_.end(); ) {
+    if (iter->second >= n)
+      iter = index_.erase(iter);
+    else
+      ++iter;
+  }
+}
+
+/// Returns the hash codes of all expressions in the table. The code of each
+/// expression is computed from its kind, its type (types are canonical),
+/// and the codes of its operands or the value of a literal. Opaque
+/// expressions are hashed by identity.
+std::vector<std::size_t>
+expr_table::hash_all() const
+{
+  int n = size();
+  std::vector<std::size_t> codes(n);
+  for (int i = 0; i < n; ++i) {
+    hasher h;
+    hash(h, kinds_[i]);
+    hash(h, types_[i]);
+    switch (forms_[i]) {
+      case literal_form:
+        hash(h, values_[ops_[0][i]]);
+        break;
+      case ternary_form:
+        hash(h, codes[ops_[2][i]]);
+        // fallthrough
+      case binary_form:
+        hash(h, codes[ops_[1][i]]);
+        // fallthrough
+      case unary_form:
+        hash(h, codes[ops_[0][i]]);
+        break;
+      case opaque_form:
+        hash(h, opaque_[ops_[0][i]]);
+        break;
+      default:
+        break;
+    }
+    codes[i] = h;
+  }
+  return codes;
+}
+
+/// Returns, for each expression in the table, 1 if the expression is
+/// constant and 0 otherwise. An expression is constant when it is a literal
+/// or when all of its operands are constant. Nullary and opaque expressions
+/// are not constant.
+std::vector<std::uint8_t>
+expr_table::constant_all() const
+{
+  int n = size();
+  std::vector<std::uint8_t> r(n);
+  for (int i = 0; i < n; ++i) {
+    switch (forms_[i]) {
+      case literal_form:
+        r[i] = 1;
+        break;
+      case unary_form:
+        r[i] = r[ops_[0][i]];
+        break;
+      case binary_form:
+        r[i] = r[ops_[0][i]] & r[ops_[1][i]];
+        break;
+      case ternary_form:
+        r[i] = r[ops_[0][i]] & r[ops_[1][i]] & r[ops_[2][i]];
+        break;
+      default:
+        r[i] = 0;
+        break;
+    }
+  }
+  return r;
+}
+
+} // namespace beaker
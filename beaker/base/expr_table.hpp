@@ -0,0 +1,186 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_BASE_EXPR_TABLE_HPP
+#define BEAKER_BASE_EXPR_TABLE_HPP
+
+#include <beaker/base/expr.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+namespace beaker {
+
+struct expr_table;
+
+
+/// The storage classes of expressions in an expression table.
+enum expr_form : std::uint8_t
+{
+  literal_form,
+  nullary_form,
+  unary_form,
+  binary_form,
+  ternary_form,
+  opaque_form,
+};
+
+
+/// A handle to an expression stored in an expression table.
+struct flat_expr
+{
+  flat_expr(const expr_table&, int);
+
+  int get_index() const;
+  int get_kind() const;
+  expr_form get_form() const;
+  const type& get_type() const;
+
+  int get_arity() const;
+  flat_expr get_operand(int) const;
+
+  bool is_literal() const;
+  const value& get_value() const;
+
+  bool is_opaque() const;
+  const expr& get_expr() const;
+
+  const expr_table* table_;
+  int index_;
+};
+
+
+/// An expression table stores expression trees in parallel arrays: the
+/// kind, form, type, and operands of the nth expression are the nth
+/// elements of those arrays. Operands are indexes of expressions in the
+/// table, and every expression follows its operands, so passes over whole
+/// trees (e.g., hashing or finding constant subexpressions) are linear
+/// scans of the arrays.
+///
+/// Expressions are added to the table from their tree representation.
+/// Literal, nullary, unary, binary, and ternary expressions are stored in
+/// the arrays. The values of literals are stored in a separate array, and
+/// the first operand of a literal is the index of its value. All other
+/// expressions are opaque: the table refers to their tree representation,
+/// and the first operand of an opaque expression is the index of that
+/// reference. An expression that is added more than once is stored once.
+///
+/// A factory can record the expressions it creates in a table (see
+/// factory::set_expr_table). The table sits beside the tree representation,
+/// which is unchanged. When the factory releases expressions (e.g., at the
+/// end of a checkpoint), they are removed from the table.
+struct expr_table
+{
+  static constexpr int no_operand = -1;
+
+  int add(const expr&);
+
+  int size() const;
+  flat_expr get(int) const;
+  int find(const expr&) const;
+
+  std::vector<std::size_t> hash_all() const;
+  std::vector<std::uint8_t> constant_all() const;
+
+  template<typename P>
+  void remove_if(P);
+  void truncate(int);
+
+  std::vector<int> kinds_;
+  std::vector<expr_form> forms_;
+  std::vector<const type*> types_;
+  std::vector<int> ops_[3];
+  std::vector<value> values_;
+  std::vector<const expr*> opaque_;
+  std::unordered_map<const expr*, int> index_;
+};
+
+/// Returns the number of expressions in the table.
+inline int expr_table::size() const { return kinds_.size(); }
+
+/// Returns the nth expression in the table.
+inline flat_expr expr_table::get(int n) const { return flat_expr(*this, n); }
+
+/// Removes the expressions that satisfy the predicate p, and every 
+/// expression added after the first of them. This is used when expressions
+/// are released (see factory::release).
+template<typename P>
+void
+expr_table::remove_if(P p)
+{
+  int n = size();
+  for (const auto& x : index_)
+    if (x.second < n && p(*x.first))
+      n = x.second;
+  truncate(n);
+}
+
+
+/// Initialize the handle for the nth expression in t.
+inline flat_expr::flat_expr(const expr_table& t, int n) : table_(&t), index_(n) { }
+
+/// Returns the index of the expression in its table.
+inline int flat_expr::get_index() const { return index_; }
+
+/// Returns the kind of the expression.
+inline int flat_expr::get_kind() const { return table_->kinds_[index_]; }
+
+/// Returns the storage class of the expression.
+inline expr_form flat_expr::get_form() const { return table_->forms_[index_]; }
+
+/// Returns the type of the expression.
+inline const type& flat_expr::get_type() const { return *table_->types_[index_]; }
+
+/// Returns the number of operands of the expression. Literal and opaque
+/// expressions have no operands in the table.
+inline int
+flat_expr::get_arity() const
+{
+  switch (get_form()) {
+    case unary_form:
+      return 1;
+    case binary_form:
+      return 2;
+    case ternary_form:
+      return 3;
+    default:
+      return 0;
+  }
+}
+
+/// Returns the nth operand of the expression.
+inline flat_expr
+flat_expr::get_operand(int n) const
+{
+  assert(0 <= n && n < get_arity());
+  return flat_expr(*table_, table_->ops_[n][index_]);
+}
+
+/// Returns true if the expression is a literal.
+inline bool flat_expr::is_literal() const { return get_form() == literal_form; }
+
+/// Returns the value of a literal expression.
+inline const value&
+flat_expr::get_value() const
+{
+  assert(is_literal());
+  return table_->values_[table_->ops_[0][index_]];
+}
+
+/// Returns true if the expression is stored as a tree.
+inline bool flat_expr::is_opaque() const { return get_form() == opaque_form; }
+
+/// Returns the tree representation of an opaque expression.
+inline const expr&
+flat_expr::get_expr() const
+{
+  assert(is_opaque());
+  return *table_->opaque_[table_->ops_[0][index_]];
+}
+
+} // namespace beaker
+
+
+#endif
@@ -0,0 +1,58 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_BASE_GENERATION_FAILURE_HPP
+#define BEAKER_BASE_GENERATION_FAILURE_HPP
+
+#include <vector>
+
+
+namespace beaker {
+
+struct expr;
+
+namespace cg {
+
+/// A function that throws the evaluation error for an expression.
+using raise_fn = void (*)(const expr&);
+
+
+/// A failure records a check in generated code that can fail at run time.
+/// Checked code stores the (1-based) index of the failure in its status
+/// argument and returns to the host, which raises the corresponding error.
+///
+/// This allows native code to report the same errors as the tree walker
+/// without unwinding through generated frames.
+struct failure
+{
+  failure(const expr&, raise_fn);
+
+  const expr& get_expression() const;
+  [[noreturn]] void raise() const;
+
+  const expr* expr_;
+  raise_fn raise_;
+};
+
+inline failure::failure(const expr& e, raise_fn f) : expr_(&e), raise_(f) { }
+
+/// Returns the expression whose evaluation failed.
+inline const expr& failure::get_expression() const { return *expr_; }
+
+/// Throw the error associated with the failure.
+inline void
+failure::raise() const
+{
+  raise_(*expr_);
+  __builtin_unreachable();
+}
+
+
+/// A sequence of failures.
+using failure_seq = std::vector<failure>;
+
+} // namespace cg
+} // namespace beaker
+
+
+#endif
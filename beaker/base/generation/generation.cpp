@@ -9,11 +9,12 @@
 #include <beaker/base/decl.hpp>
 #include <beaker/base/stmt.hpp>
 #include <beaker/base/module.hpp>
-#include <beaker/util/symbol.hpp>
 
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/raw_os_ostream.h>
 
@@ -28,9 +29,13 @@ generator::generator(const char* n)
   : parent_(nullptr),
     cxt_(new llvm::Context()), 
     mod_(new llvm::Module(n, *cxt_)),
+    own_cxt_(true),
+    fails_(),
     fn_(),
     entry_(),
     exit_(),
+    abort_(),
+    status_(),
     block_(),
     top_(),
     bottom_(),
@@ -39,14 +44,48 @@ generator::generator(const char* n)
   enter_decl_context();
 }
 
+// Initialize the generator so that it creates a new module in the context
+// `cxt`, which is not owned by the generator.
+generator::generator(llvm::Context& cxt, const char* n)
+  : parent_(nullptr),
+    cxt_(&cxt), 
+    mod_(new llvm::Module(n, *cxt_)),
+    own_cxt_(false),
+    fails_(),
+    fn_(),
+    entry_(),
+    exit_(),
+    abort_(),
+    status_(),
+    block_(),
+    top_(),
+    bottom_(),
+    init_()
+{
+  enter_decl_context();
+}
+
+// Initialize the generator so that it creates a new module in the context
+// `cxt`, and generates checked code. Failures are appended to `fs`.
+generator::generator(llvm::Context& cxt, const char* n, cg::failure_seq& fs)
+  : generator(cxt, n)
+{
+  fails_ = &fs;
+}
+
 // Initialize the generator so that it shares the LLVM context, module,
 // and global name binding environment as gen.
 generator::generator(generator& gen)
   : parent_(&gen),
     cxt_(gen.cxt_),
     mod_(gen.mod_),
+    own_cxt_(false),
+    fails_(gen.fails_),
     fn_(),
     entry_(),
+    exit_(),
+    abort_(),
+    status_(),
     block_(),
     top_(),
     bottom_(),
@@ -69,19 +108,47 @@ generator::~generator()
 
   if (parent_) {
     // Merge any notes into the parent module before going away. 
-    parent_->notes_.insert(notes_.end(), notes_.begin(), notes_.end());
+    parent_->notes_.insert(parent_->notes_.end(), notes_.begin(), notes_.end());
   }
   else {
-    // Only delete the context if this is the root generator. Otherwise, this
-    // would delete the module.
-    delete cxt_;
-
-    // Now, we can delete the notes.
+    // Delete the module unless it was released. Deleting an owned context
+    // would also delete the module.
+    if (own_cxt_)
+      delete cxt_;
+    else
+      delete mod_;
+
+    // Now, we can destroy the notes. Their storage is released with the
+    // pool.
     for (cg::note* p : notes_)
-      delete p;
+      p->~note();
   }
 }
 
+/// Releases ownership of the generated module, e.g., to pass it to a JIT.
+/// The module must be deleted by the caller.
+llvm::Module*
+generator::release_module()
+{
+  assert(!parent_ && !own_cxt_);
+  llvm::Module* m = mod_;
+  mod_ = nullptr;
+  return m;
+}
+
+/// Returns the symbol name for the declaration d. Symbols are qualified by
+/// the name of the generated module so that declarations generated into
+/// different modules do not collide.
+///
+/// TODO: The formation of the name is determined by the ABI. In order to be
+/// C++ compliant, for example, we would need to mangle as per the Itanium
+/// ABI specification (among many other things).
+std::string
+generator::get_symbol(const decl& d)
+{
+  return mod_->getModuleIdentifier() + "." + std::to_string(d.get_id());
+}
+
 /// Returns the function information associated with t.
 const cg::fn_info& 
 generator::get_function_info(const type& t)
@@ -191,6 +258,10 @@ generator::define_function(llvm::Function* f)
   // that when the function is complete.
   exit_ = llvm::BasicBlock::Create(*cxt_, "exit");
   block_ = entry_;
+
+  // In checked code, the status is the first argument.
+  if (is_checked())
+    status_ = &*fn_->arg_begin();
 }
 
 /// Exit the scope of the current function and reset all info relative
@@ -200,12 +271,20 @@ generator::end_function()
 {
   assert(fn_);
 
-  // Link the exit block into the function.
-  exit_->insertInto(fn_);
+  // Link the exit block into the function, unless it was already made
+  // the current block.
+  if (!exit_->getParent())
+    exit_->insertInto(fn_);
+
+  // Link the abort block into the function if any check used it.
+  if (abort_)
+    abort_->insertInto(fn_);
 
   fn_ = nullptr;
   entry_ = nullptr;
   exit_ = nullptr;
+  abort_ = nullptr;
+  status_ = nullptr;
   block_ = nullptr;
   leave_decl_context();
 }
@@ -221,6 +300,86 @@ generator::set_current_block(llvm::BasicBlock* b)
 }
 
 
+/// Returns the block that returns from the current function after a failed
+/// check. The returned value (if any) is undefined.
+llvm::BasicBlock*
+generator::get_abort_block()
+{
+  if (!abort_) {
+    abort_ = llvm::BasicBlock::Create(*cxt_, "abort");
+    llvm::Builder ir(abort_);
+    llvm::Type* t = fn_->getReturnType();
+    if (t->isVoidTy())
+      ir.CreateRetVoid();
+    else
+      ir.CreateRet(llvm::UndefValue::get(t));
+  }
+  return abort_;
+}
+
+/// Terminate the current block with the failure of a check, raising the
+/// error raised by `f` for the expression e.
+static void
+terminate_block(generator& gen, const expr& e, cg::raise_fn f)
+{
+  llvm::Builder ir(gen.get_current_block());
+  if (gen.is_checked()) {
+    cg::failure_seq& fails = *gen.fails_;
+    fails.emplace_back(e, f);
+    ir.CreateStore(ir.getInt32(fails.size()), gen.get_status());
+    ir.CreateBr(gen.get_abort_block());
+  }
+  else {
+    llvm::Module* mod = &gen.get_module();
+    ir.CreateCall(llvm::Intrinsic::getDeclaration(mod, llvm::Intrinsic::trap));
+    ir.CreateUnreachable();
+  }
+}
+
+/// Emit a run-time check that `ok` is true, failing with the error raised
+/// by `f` for the expression e. Code following the check is emitted into
+/// a new block.
+///
+/// In unchecked code, a failed check executes a trap.
+void
+generator::make_check(llvm::Value* ok, const expr& e, cg::raise_fn f)
+{
+  llvm::BasicBlock* pass = llvm::BasicBlock::Create(*cxt_, "check.pass");
+  llvm::BasicBlock* fail = llvm::BasicBlock::Create(*cxt_, "check.fail");
+  llvm::Builder ir(get_current_block());
+  ir.CreateCondBr(ok, pass, fail, 
+                  llvm::MDBuilder(*cxt_).createBranchWeights(1 << 20, 1));
+  set_current_block(fail);
+  terminate_block(*this, e, f);
+  set_current_block(pass);
+}
+
+/// Emit an unconditional failure, raising the error raised by `f` for the
+/// expression e. Subsequent code is emitted into a new (unreachable) block.
+void
+generator::make_failure(const expr& e, cg::raise_fn f)
+{
+  terminate_block(*this, e, f);
+  set_current_block(llvm::BasicBlock::Create(*cxt_, "cont"));
+}
+
+/// Emit a check that the status of checked code is still zero. If not, the
+/// current function returns immediately, propagating the failure to the
+/// caller. This is used after calls to generated functions.
+void
+generator::make_status_check()
+{
+  if (!is_checked())
+    return;
+  llvm::BasicBlock* pass = llvm::BasicBlock::Create(*cxt_, "call.pass");
+  llvm::Builder ir(get_current_block());
+  llvm::Value* s = ir.CreateLoad(ir.getInt32Ty(), status_);
+  llvm::Value* ok = ir.CreateICmpEQ(s, ir.getInt32(0));
+  ir.CreateCondBr(ok, pass, get_abort_block(),
+                  llvm::MDBuilder(*cxt_).createBranchWeights(1 << 20, 1));
+  set_current_block(pass);
+}
+
 /// Create a local object for the type `t`. Local variables are always inserted
 /// into the front of the entry block.
 cg::value
@@ -253,117 +412,20 @@ generator::print(std::ostream& os)
 }
 
 // -------------------------------------------------------------------------- //
-// Dispatch infrastructure
-
-/// The default behavior is not defined.
-std::string
-generate_algorithm::operator()(generator&, const name&) const
-{
-  assert(false && "not defined");
-}
-
-/// The default behavior is not defined.
-cg::type
-generate_algorithm::operator()(generator&, const type&) const
-{
-  assert(false && "not defined");
-}
-
-/// The default behavior is not defined.
-cg::value
-generate_algorithm::operator()(generator&, const expr&) const
-{
-  assert(false && "not defined");
-}
-
-/// The default behavior is not defined.
-cg::value
-generate_algorithm::operator()(generator&, const decl&) const
-{
-  assert(false && "not defined");
-}
-
-/// The default behavior is not defined.
-void
-generate_algorithm::operator()(generator&, const stmt&) const
-{
-  assert(false && "not defined");
-}
+// Operations
 
-/// Generate code for the declarations in m.
+/// Generate code for the declarations in m. All declarations are declared
+/// before any are defined, so that definitions can refer to declarations
+/// that appear later in the module.
 void
 generate(generator& gen, const module& m)
 {
   gen.enter_source_module(m);
+  for (const decl& d : m.get_declarations())
+    declare(gen, d);
   for (const decl& d : m.get_declarations())
     generate(gen, d);
   gen.leave_source_module();
 }
 
-// Returns the codegen algorithm associated with the node t.
-template<typename T>
-static inline const generate_algorithm&
-get_generate(const T& t)
-{
-  feature& feat = language::get_feature(t);
-  return feat.template get_algorithm<generate_algorithm>();
-}
-
-/// Generate a symbol name from n.
-///
-/// TODO: The formation of the name is determined by the ABI. In order to be
-/// C++ compliant, for example, we would need to mangle as per the Itanium
-/// ABI specification (among many other things).
-std::string
-generate(generator& gen, const name& n)
-{
-  return get_generate(n)(gen, n);
-}
-
-// Generate an LLVM type from t.
-static cg::type
-do_generate_type(generator& gen, const type& t)
-{
-  return get_generate(t)(gen, t);
-}
-
-/// Generate the LLVM representation of t.
-///
-/// If the type has previously been seen, return its cached version.
-///
-/// TODO: Verify that t is a canonical type.
-cg::type
-generate(generator& gen, const type& t)
-{
-  type_map& types = gen.get_types();
-  auto iter = types.find(&t);
-  if (iter != types.end())
-    return iter->second;
-  cg::type ret = do_generate_type(gen, t);
-  types.emplace(&t, ret);
-  return ret;
-}
-
-/// Generate a sequence of LLVM instructions for e.
-cg::value
-generate(generator& gen, const expr& e)
-{
-  return get_generate(e)(gen, e);
-}
-
-/// Generate an LLVM declaration for d. 
-cg::value
-generate(generator& gen, const decl& d)
-{
-  // FIXME: Don't generate the declaration more than once.
-  return get_generate(d)(gen, d);
-}
-
-/// Generate a sequence of blocks and instructions for s.
-void
-generate(generator& gen, const stmt& s)
-{
-  return get_generate(s)(gen, s);
-}
-
 } // namespace beaker
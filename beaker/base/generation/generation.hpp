@@ -5,9 +5,13 @@
 #define BEAKER_BASE_GENERATION_GENERATION_HPP
 
 #include <beaker/base/lang.hpp>
+#include <beaker/base/error.hpp>
 #include <beaker/base/generation/type.hpp>
 #include <beaker/base/generation/value.hpp>
 #include <beaker/base/generation/function.hpp>
+#include <beaker/base/generation/failure.hpp>
+
+#include <beaker/util/memory.hpp>
 
 #include <llvm/IR/IRBuilder.h>
 
@@ -47,7 +51,22 @@ using fn_info_map = std::unordered_map<const type*, cg::fn_info>;
 using decl_env = std::unordered_map<const decl*, cg::value>;
 using decl_stack = std::vector<std::vector<const decl*>>;
 
+
+/// Represents an error that occurred during code generation. This is thrown
+/// when a construct has no native representation, which allows clients to
+/// fall back to other forms of evaluation.
+struct generation_error : error
+{
+  using error::error;
+};
+
+
 // Provides context and facilities for generating LLVM bitcode.
+//
+// A checked generator records the failures of run-time checks (overflow,
+// division by zero, assertions, etc.) in a failure table. Every generated
+// function accepts a leading status argument, which is set to the index
+// of the failing check before returning to the caller.
 struct generator
 {
   struct decl_context_guard;
@@ -55,11 +74,17 @@ struct generator
   struct init_guard;
 
   generator(const char*);
+  generator(llvm::Context&, const char*);
+  generator(llvm::Context&, const char*, cg::failure_seq&);
   generator(generator&);
   ~generator();
 
   llvm::Context& get_context();
   llvm::Module& get_module();
+  llvm::Module* release_module();
+
+  // Symbols
+  std::string get_symbol(const decl&);
 
   // Type information
   const type_map& get_types() const;
@@ -67,6 +92,8 @@ struct generator
   const cg::type& get_type(const type&);
 
   // Annnotations
+  allocator& get_note_allocator();
+
   template<typename T, typename... Args>
   cg::type& annotate(cg::type&, Args&&... args);
 
@@ -94,6 +121,15 @@ struct generator
   void set_exit_block(llvm::BasicBlock*);
   void end_function();
 
+  // Run-time checks
+  bool is_checked() const;
+  llvm::Value* get_status();
+  void set_status(llvm::Value*);
+  llvm::BasicBlock* get_abort_block();
+  void make_check(llvm::Value*, const expr&, cg::raise_fn);
+  void make_failure(const expr&, cg::raise_fn);
+  void make_status_check();
+
   // Instruction builders.
   cg::value make_alloca(cg::type, const char* = "");
   cg::value make_alloca(cg::type, const std::string&);
@@ -122,6 +158,10 @@ struct generator
   generator* parent_;  // The parent generation context.
   llvm::Context* cxt_; // The context
   llvm::Module* mod_;  // The module
+  bool own_cxt_;       // True if the generator owns the context.
+
+  // Failures of run-time checks. Null for unchecked generation.
+  cg::failure_seq* fails_;
 
   // Mapping of declarations to values.
   decl_env decl_env_;
@@ -131,7 +171,9 @@ struct generator
   type_map types_;
   fn_info_map fn_info_;
   
-  // Annotations
+  // Annotations. Notes are allocated by the pool of the root generator,
+  // which owns them.
+  pool_allocator note_pool_;
   std::vector<cg::note*> notes_;
 
   // TODO: Coalesce these into a structure.
@@ -139,6 +181,8 @@ struct generator
   llvm::Value* return_; // The return value.
   llvm::BasicBlock* entry_; // Function entry block
   llvm::BasicBlock* exit_; // Function exit block
+  llvm::BasicBlock* abort_; // Function abort block (checked only)
+  llvm::Value* status_; // The status argument (checked only)
   llvm::BasicBlock* block_; // The current block
   llvm::BasicBlock* top_; // The top of the current loop.
   llvm::BasicBlock* bottom_; // The bottom of the current loop.
@@ -156,6 +200,16 @@ inline llvm::Context& generator::get_context() { return *cxt_; }
 /// Returns the current module.
 inline llvm::Module& generator::get_module() { return *mod_; }
 
+/// Returns true if generated code reports the failure of run-time checks
+/// through a status argument.
+inline bool generator::is_checked() const { return fails_; }
+
+/// Returns the status argument of the current function.
+inline llvm::Value* generator::get_status() { return status_; }
+
+/// Sets the status argument of the current function.
+inline void generator::set_status(llvm::Value* v) { status_ = v; }
+
 /// Returns the set of generated types.
 inline const type_map& generator::get_types() const { return types_; }
 
@@ -170,6 +224,16 @@ generator::get_type(const type& t)
   return types_.find(&t)->second;
 }
 
+/// Returns the allocator for notes, which is the pool of the root generator.
+inline allocator&
+generator::get_note_allocator()
+{
+  generator* g = this;
+  while (g->parent_)
+    g = g->parent_;
+  return g->note_pool_;
+}
+
 /// Annotate the type t with the given value.
 ///
 /// Note that an object should be annotated only once, when it is created.
@@ -177,7 +241,8 @@ template<typename T, typename... Args>
 inline cg::type&
 generator::annotate(cg::type& t, Args&&... args)
 {
-  cg::note* n = new T(std::forward<Args>(args)...);
+  void* p = get_note_allocator().allocate(sizeof(T), alignof(T));
+  cg::note* n = new (p) T(std::forward<Args>(args)...);
   notes_.push_back(n);
   t.annotate(*n);
   return t;
@@ -190,7 +255,8 @@ template<typename T, typename... Args>
 inline cg::value&
 generator::annotate(cg::value& v, Args&&... args)
 {
-  cg::note* n = new cg::note(std::forward<Args>(args)...);
+  void* p = get_note_allocator().allocate(sizeof(T), alignof(T));
+  cg::note* n = new (p) T(std::forward<Args>(args)...);
   notes_.push_back(n);
   v.annotate(*n);
   return v;
@@ -316,25 +382,61 @@ struct generator::init_guard
 // -------------------------------------------------------------------------- //
 // Operations
 
-/// Defines the dispatch signature for codegen algorithms.
-struct generate_algorithm : algorithm
-{
-  struct tag { };
-
-  virtual std::string operator()(generator&, const name&) const;
-  virtual cg::type operator()(generator&, const type&) const;
-  virtual cg::value operator()(generator&, const expr&) const;
-  virtual cg::value operator()(generator&, const decl&) const;
-  virtual void operator()(generator&, const stmt&) const;
-};
-
 void generate(generator&, const module&);
-std::string generate(generator&, const name&);
 cg::type generate(generator&, const type&);
 cg::value generate(generator&, const expr&);
 cg::value generate(generator&, const decl&);
 void generate(generator&, const stmt&);
 
+cg::value declare(generator&, const decl&);
+
+
+// -------------------------------------------------------------------------- //
+// Dispatch interface
+//
+// Unlike evaluation, not every feature has a native representation. The
+// default behavior is to report that the construct cannot be generated.
+
+/// Generate the given type. Throws a generation error if overload resolution
+/// selects this function.
+inline cg::type
+generate_type(generator&, const type&)
+{
+  throw generation_error("type not supported");
+}
+
+/// Generate the given expression. Throws a generation error if overload
+/// resolution selects this function.
+inline cg::value
+generate_expr(generator&, const expr&)
+{
+  throw generation_error("expression not supported");
+}
+
+/// Generate the given declaration. Throws a generation error if overload
+/// resolution selects this function.
+inline cg::value
+generate_decl(generator&, const decl&)
+{
+  throw generation_error("declaration not supported");
+}
+
+/// Declare the given declaration. By default, declarations do not need to
+/// be declared before they are generated.
+inline cg::value
+declare_decl(generator&, const decl&)
+{
+  return nullptr;
+}
+
+/// Generate the given statement. Throws a generation error if overload
+/// resolution selects this function.
+inline void
+generate_stmt(generator&, const stmt&)
+{
+  throw generation_error("statement not supported");
+}
+
 } // namespace beaker
 
 
@@ -8,8 +8,11 @@
 #include <beaker/util/class_graph.hpp>
 #include <beaker/util/dispatch_table.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <memory>
 #include <typeindex>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -102,6 +105,30 @@ inline feature& feature_set::get_feature() {return *map_.find(typeid(T))->second
 /// A client program must register the set of features needed by the language
 /// at program startup.
 ///
+/// A release listener is notified when the terms of a node store are
+/// released (see checkpoint). This is implemented by objects that cache 
+/// information about terms by their address (e.g., compiled programs), 
+/// since released addresses are reused for new terms. A listener registers
+/// itself with a language for its lifetime, and it is notified of the
+/// releases of every factory of the language's modules.
+struct release_listener
+{
+  release_listener(const language&);
+  release_listener(const release_listener&) = delete;
+  virtual ~release_listener();
+
+  /// Discard information about the terms allocated by s after the mark m.
+  /// This is called before those terms are released.
+  virtual void release(const node_store& s, const node_store::mark& m) = 0;
+
+  const language* lang_;
+};
+
+
+/// The language also owns the canonical and singleton term sets, keyed by
+/// the kind of term they contain. These are shared by the builders of every
+/// module, so that a canonical term is unique within the language.
+///
 /// \todo The language should own a string table.
 struct language : feature_set, node_store
 {
@@ -110,7 +137,16 @@ struct language : feature_set, node_store
   const symbol_table& get_symbol_table() const;
   symbol_table& get_symbol_table();
 
+  void add_listener(release_listener&) const;
+  void remove_listener(release_listener&) const;
+  void notify_release(const node_store&, const node_store::mark&) const;
+
   symbol_table* syms_;
+  std::unordered_map<int, std::shared_ptr<void>> sets_;
+
+  // Listeners are registered by objects that only have a const reference
+  // to the language (e.g., evaluators).
+  mutable std::vector<release_listener*> listeners_;
 };
 
 inline language::language(symbol_table& syms, const feature_list& feats)
@@ -123,6 +159,53 @@ inline const symbol_table& language::get_symbol_table() const { return *syms_; }
 /// Returns the symbols for the language.
 inline symbol_table& language::get_symbol_table() { return *syms_; }
 
+/// Register the listener `l`.
+inline void 
+language::add_listener(release_listener& l) const
+{ 
+  listeners_.push_back(&l); 
+}
+
+/// Unregister the listener `l`.
+inline void 
+language::remove_listener(release_listener& l) const
+{
+  listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), &l), 
+                   listeners_.end());
+}
+
+/// Notify each listener that the terms allocated by s after the mark m are
+/// about to be released.
+inline void
+language::notify_release(const node_store& s, const node_store::mark& m) const
+{
+  for (release_listener* l : listeners_)
+    l->release(s, m);
+}
+
+inline
+release_listener::release_listener(const language& lang)
+  : lang_(&lang)
+{
+  lang.add_listener(*this);
+}
+
+inline release_listener::~release_listener() { lang_->remove_listener(*this); }
+
+/// Removes the entries of the map `map` whose keys are terms allocated by s
+/// after the mark m.
+template<typename M>
+void
+erase_released(M& map, const node_store& s, const node_store::mark& m)
+{
+  for (auto iter = map.begin(); iter != map.end(); ) {
+    if (s.allocated_since(m, iter->first))
+      iter = map.erase(iter);
+    else
+      ++iter;
+  }
+}
+
 
 // -------------------------------------------------------------------------- //
 // Language and term identification
@@ -149,6 +232,21 @@ enum {
 constexpr int
 get_language(int k) { return k / lang_block_size; }
 
+/// True when terms of type T are unique by construction, so that equal
+/// terms are the same object. Features specialize this for the kinds of 
+/// terms that their builders create in canonical or singleton sets, or 
+/// otherwise never duplicate. Canonical terms are compared and hashed by 
+/// identity.
+template<typename T>
+struct is_canonical_term : std::false_type { };
+
+/// True when T is an expression whose value depends only on its kind, type,
+/// value, and operands, and whose evaluation has no other effects. Pure 
+/// expressions can be shared (see factory::set_hash_consing). Features 
+/// specialize this for their pure expressions.
+template<typename T>
+struct is_pure_term : std::false_type { };
+
 } // namespace beaker
 
 
@@ -3,13 +3,39 @@
 
 #include "module.hpp"
 #include "symbol_table.hpp"
+#include "build.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__)
+#  include <cxxabi.h>
+#endif
 
 
 namespace beaker {
 
+/// Destroy the builders in the set.
+builder_set::~builder_set()
+{
+  for (auto& entry : map_)
+    delete entry.second;
+}
+
 /// Initialize the module. 
 module::module(language& lang)
+  : module(lang, default_node_allocator())
+{ }
+
+/// Initialize the module so that the memory of its terms is allocated in
+/// blocks acquired from a.
+module::module(language& lang, allocator& a)
   : decl(node_kind),
+    node_store(a),
     lang_(&lang),
     name_(nullptr), 
     decls_()
@@ -18,5 +44,64 @@ module::module(language& lang)
     add_builder(typeid(*f), f->make_builder(*this));
 }
 
+
+/// Returns the name of the feature whose type is ti. For example, the name 
+/// of beaker::sys_int::feature is sys_int.
+static std::string
+get_feature_name(std::type_index ti)
+{
+  std::string name = ti.name();
+#if defined(__GNUC__)
+  int status;
+  char* str = abi::__cxa_demangle(ti.name(), nullptr, nullptr, &status);
+  if (status == 0)
+    name = str;
+  std::free(str);
+#endif
+  const std::string prefix = "beaker::";
+  const std::string suffix = "::feature";
+  if (name.compare(0, prefix.size(), prefix) == 0)
+    name.erase(0, prefix.size());
+  if (name.size() > suffix.size() &&
+      name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+    name.erase(name.size() - suffix.size());
+  return name;
+}
+
+/// Write the allocation statistics of the module as a JSON object. The 
+/// object has one entry for the language, which stores canonical terms, one
+/// for the module, and one for the terms stored by each feature's factory,
+/// in order of feature name, and their total. The total peak is the sum of
+/// the peaks, which bounds the actual peak.
+void
+write_allocation_stats(std::ostream& os, const module& m)
+{
+  std::vector<std::pair<std::string, allocation_stats>> facs;
+  for (const auto& entry : m.map_)
+    facs.emplace_back(get_feature_name(entry.first), entry.second->get_stats());
+  std::sort(facs.begin(), facs.end(), [](const auto& a, const auto& b) {
+    return a.first < b.first;
+  });
+
+  allocation_stats total = m.get_language().get_stats();
+  total += m.get_stats();
+
+  os << "{\"language\": ";
+  write_json(os, m.get_language().get_stats());
+  os << ", \"module\": ";
+  write_json(os, m.get_stats());
+  os << ", \"factories\": {";
+  for (std::size_t i = 0; i < facs.size(); ++i) {
+    if (i != 0)
+      os << ", ";
+    os << '"' << facs[i].first << "\": ";
+    write_json(os, facs[i].second);
+    total += facs[i].second;
+  }
+  os << "}, \"total\": ";
+  write_json(os, total);
+  os << '}';
+}
+
 } // namespace beaker
 
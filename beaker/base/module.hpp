@@ -8,6 +8,7 @@
 #include <beaker/base/type.hpp>
 #include <beaker/base/decl.hpp>
 
+#include <iosfwd>
 #include <unordered_map>
 
 
@@ -24,13 +25,18 @@ struct builder;
 // Term builders
 
 /// A builder set is a collection of functions that allocate builder objects, 
-/// as needed.
+/// as needed. The set owns its builders, so the memory of the terms they
+/// allocated is released with the set.
 ///
 /// \todo: Can we unify this with the feature set in some way?
 struct builder_set
 {
   using map_type = std::unordered_map<std::type_index, factory*>;
 
+  builder_set() = default;
+  builder_set(const builder_set&) = delete;
+  ~builder_set();
+
   void add_builder(std::type_index, factory&);
 
   template<typename T>
@@ -100,11 +106,20 @@ enum {
 /// Represents a named collection of types, values, and functions. A module
 /// is the root container of declarations for a translation; it is equivalent
 /// to a translation unit in C/C++.
+///
+/// The terms of a module, including those allocated by its builders, are 
+/// stored in blocks of memory acquired from the module's block allocator. 
+/// For large translations, this can be a mapped_allocator, which must 
+/// outlive the module. Destroying that allocator releases the memory of 
+/// all terms at once. With compact references (BEAKER_COMPACT_REFS), all
+/// terms are allocated in the node region, and no other block allocator
+/// can be used.
 struct module : decl, builder_set, node_store
 {
   static constexpr int node_kind = module_decl_kind;
 
   module(language&);
+  module(language&, allocator&);
 
   const language& get_language() const;
   language& get_language();
@@ -162,6 +177,12 @@ inline decl_seq& module::get_declarations() { return decls_; }
 /// Adds a declaration to the module.
 inline void module::add_declaration(decl& d) { decls_.push_back(d); }
 
+
+// -------------------------------------------------------------------------- //
+// Allocation statistics
+
+void write_allocation_stats(std::ostream&, const module&);
+
 } // namespace beaker
 
 
@@ -8,6 +8,8 @@
 #include <beaker/base/seq.hpp>
 #include <beaker/util/cast.hpp>
 
+#include <cstdint>
+
 
 namespace beaker {
 
@@ -15,6 +17,9 @@ namespace beaker {
 // Name base class
 
 // Represents the set of declaration names.
+//
+// When the library is configured with BEAKER_HASH_CACHE, a name stores its
+// hash code after it is first hashed, as types do.
 struct name
 {
   explicit name(int);
@@ -24,6 +29,9 @@ struct name
   int get_kind() const;
 
   int kind_;
+#if BEAKER_HASH_CACHE
+  mutable std::uint32_t hash_ = 0;
+#endif
 };
 
 // Construct a name with kind k.
@@ -35,6 +43,9 @@ inline int name::get_feature() const { return get_language(kind_); }
 // Returns the kind of name.
 inline int name::get_kind() const { return kind_; }
 
+
+bool is_canonical_name(const name&);
+
 } // namespace beaker
 
 
@@ -2,3 +2,36 @@
 // All rights reserved
 
 #include "node.hpp"
+
+
+namespace beaker {
+
+#if BEAKER_COMPACT_REFS
+
+char* node_region_base;
+
+/// The size of the node region, which is the range addressed by a node
+/// reference.
+constexpr std::size_t node_region_size = std::size_t(1) << (32 + node_ref_shift);
+
+/// Returns the node region. The region is reserved when it is first used,
+/// before any node can be allocated.
+allocator&
+default_node_allocator()
+{
+  static mapped_allocator region(node_region_size);
+  node_region_base = const_cast<char*>(region.begin());
+  return region;
+}
+
+#else
+
+allocator&
+default_node_allocator()
+{
+  return default_allocator();
+}
+
+#endif
+
+} // namespace beaker
@@ -6,26 +6,202 @@
 
 #include <beaker/util/memory.hpp>
 
+#include <cassert>
+#include <cstdint>
+
 // #include <unordered_map>
 
 
 namespace beaker {
 
 
+// -------------------------------------------------------------------------- //
+// Node references
+
+/// Returns the allocator from which node stores acquire blocks of memory,
+/// unless otherwise specified. 
+///
+/// When the library is configured with BEAKER_COMPACT_REFS, this is the
+/// node region: a single range of virtual memory from which all nodes are
+/// allocated. Otherwise, this is the default allocator.
+allocator& default_node_allocator();
+
+#if BEAKER_COMPACT_REFS
+/// The beginning of the node region. 
+extern char* node_region_base;
+
+/// The log of the granularity of node references. Nodes are aligned to at
+/// least 8 bytes, so a 32-bit reference addresses 32 GB of nodes.
+constexpr int node_ref_shift = 3;
+#endif
+
+
+/// A reference to a node, or null.
+///
+/// By default, this is a pointer. When the library is configured with 
+/// BEAKER_COMPACT_REFS, this is a 32-bit offset from the beginning of the
+/// node region, which halves the size of links between nodes. The referred 
+/// to node must then be allocated by a node store that acquires blocks from
+/// the node region (the default).
+///
+/// Nodes store references to their operands in this form, and their 
+/// accessors return references, so the representation does not affect
+/// the interface of nodes.
+template<typename T>
+struct node_ref
+{
+  node_ref();
+  node_ref(T*);
+  node_ref(T&);
+
+  explicit operator bool() const;
+
+  T* get() const;
+  T& operator*() const;
+  T* operator->() const;
+
+#if BEAKER_COMPACT_REFS
+  std::uint32_t off_;
+#else
+  T* ptr_;
+#endif
+};
+
+#if BEAKER_COMPACT_REFS
+
+/// Initialize a null reference.
+template<typename T>
+inline node_ref<T>::node_ref() : off_() { }
+
+/// Initialize a reference to p. 
+template<typename T>
+inline 
+node_ref<T>::node_ref(T* p)
+{
+  std::uintptr_t n = reinterpret_cast<char*>(p) - node_region_base;
+  assert((!p || (n % (1 << node_ref_shift) == 0 && (n >> node_ref_shift) >> 32 == 0))
+         && "node is not in the node region");
+  off_ = p ? std::uint32_t(n >> node_ref_shift) : 0;
+}
+
+/// Returns the referred to node.
+template<typename T>
+inline T* 
+node_ref<T>::get() const
+{
+  if (!off_)
+    return nullptr;
+  return reinterpret_cast<T*>(node_region_base + (std::uintptr_t(off_) << node_ref_shift));
+}
+
+/// Returns true if the reference is not null.
+template<typename T>
+inline node_ref<T>::operator bool() const { return off_; }
+
+#else
+
+/// Initialize a null reference.
+template<typename T>
+inline node_ref<T>::node_ref() : ptr_() { }
+
+/// Initialize a reference to p.
+template<typename T>
+inline node_ref<T>::node_ref(T* p) : ptr_(p) { }
+
+/// Returns the referred to node.
+template<typename T>
+inline T* node_ref<T>::get() const { return ptr_; }
+
+/// Returns true if the reference is not null.
+template<typename T>
+inline node_ref<T>::operator bool() const { return ptr_; }
+
+#endif
+
+/// Initialize a reference to x.
+template<typename T>
+inline node_ref<T>::node_ref(T& x) : node_ref(&x) { }
+
+/// Returns the referred to node.
+template<typename T>
+inline T& node_ref<T>::operator*() const { return *get(); }
+
+/// Returns the referred to node.
+template<typename T>
+inline T* node_ref<T>::operator->() const { return get(); }
+
+
+// -------------------------------------------------------------------------- //
+// Node stores
+
+/// The families of terms. A node store can allocate each family of terms in
+/// its own arena. Other objects allocated by the store (e.g., the values of
+/// literals) belong to no family.
+enum node_family
+{
+  name_family,
+  type_family,
+  expr_family,
+  decl_family,
+  stmt_family,
+  other_family,
+  num_node_families
+};
+
+/// Determines where a node store allocates terms.
+///
+/// With the shared policy, all terms are allocated in a single arena, in the
+/// order they are created. With the family policy, each family of terms is
+/// allocated in a separate arena, so that algorithms that visit only one 
+/// family of terms (e.g., hashing expressions) touch dense memory.
+enum arena_policy
+{
+  shared_arena_policy,
+  family_arena_policy,
+};
+
+
 /// Provides storage allocation strategies for terms of different types.
 ///
 /// This also includes facilities for registering language- and module-level 
 /// canonical sets for specific kinds of nodes.
 ///
-/// A set registry provides contains its own sequential allocator. This is
-/// used to provide memory for all canonically allocated terms.
+/// A set registry provides contains its own sequential allocators. These are
+/// used to provide memory for all canonically allocated terms. The arena 
+/// policy determines which allocator is used for each family of terms; it
+/// should be set before terms are created. The blocks of memory used by the 
+/// sequential allocators are allocated from the block allocator of the 
+/// store, which is the default node allocator unless otherwise specified.
 ///
 /// \todo This abstraction is a little weird because it acts as both an
 /// allocation facility and registry. It might be a good idea to separate
 /// these ideas.
 struct node_store
 {
+  /// A position in each of the store's arenas.
+  struct mark
+  {
+    sequential_allocator<>::mark arenas_[num_node_families];
+  };
+
+  node_store();
+  node_store(allocator&);
+  virtual ~node_store() = default;
+
+  allocator& get_block_allocator() const;
+
   allocator& get_allocator();
+  allocator& get_allocator(node_family);
+
+  arena_policy get_arena_policy() const;
+  void set_arena_policy(arena_policy);
+
+  mark get_mark() const;
+  virtual void release(mark);
+  bool allocated_since(const mark&, const void*) const;
+
+  allocation_stats get_stats() const;
+  allocation_stats get_stats(node_family) const;
 
   // template<typename T> 
   // singleton_term_set<T>& get_singleton_set();
@@ -33,12 +209,141 @@ struct node_store
   // template<typename T> 
   // canonical_term_set<T>& get_canonical_set(const language& lang);
 
-  sequential_allocator<> alloc_;
+  arena_policy policy_;
+  sequential_allocator<> arenas_[num_node_families];
   // std::unordered_map<int, void*> map_;
 };
 
-/// Returns the allocator for the node store.
-inline allocator& node_store::get_allocator() { return alloc_; }
+/// Initialize the store so that its arenas acquire blocks of memory from
+/// the default node allocator.
+inline node_store::node_store() : node_store(default_node_allocator()) { }
+
+/// Initialize the store so that its arenas acquire blocks of memory from a.
+/// With compact references, nodes must be allocated in the node region, so
+/// a shall be the default node allocator.
+inline 
+node_store::node_store(allocator& a) 
+  : policy_(shared_arena_policy) 
+{ 
+#if BEAKER_COMPACT_REFS
+  assert(&a == &default_node_allocator() && "nodes must be in the node region");
+#endif
+  for (auto& arena : arenas_)
+    arena.set_block_allocator(a);
+}
+
+/// Returns the allocator from which the arenas acquire blocks of memory.
+inline allocator& 
+node_store::get_block_allocator() const
+{
+  return arenas_[other_family].get_block_allocator();
+}
+
+/// Returns the allocator for objects that belong to no family of terms.
+/// This is also the allocator for all terms when arenas are shared.
+inline allocator& node_store::get_allocator() { return arenas_[other_family]; }
+
+/// Returns the allocator for terms in the family f.
+inline allocator& 
+node_store::get_allocator(node_family f) 
+{ 
+  return arenas_[policy_ == family_arena_policy ? f : other_family]; 
+}
+
+/// Returns the arena policy of the store.
+inline arena_policy node_store::get_arena_policy() const { return policy_; }
+
+/// Sets the arena policy of the store. Terms that have been allocated are
+/// not moved.
+inline void node_store::set_arena_policy(arena_policy p) { policy_ = p; }
+
+/// Returns statistics about the memory allocated for terms in the store.
+inline allocation_stats 
+node_store::get_stats() const 
+{ 
+  allocation_stats s;
+  for (const auto& a : arenas_)
+    s += a.get_stats();
+  return s;
+}
+
+/// Returns statistics about the memory allocated in the arena for the family
+/// f. When arenas are shared, terms of all families are allocated in the
+/// arena for other objects.
+inline allocation_stats 
+node_store::get_stats(node_family f) const 
+{ 
+  return arenas_[f].get_stats();
+}
+
+/// Returns the current position in the store's allocators.
+inline node_store::mark 
+node_store::get_mark() const 
+{ 
+  mark m;
+  for (int i = 0; i < num_node_families; ++i)
+    m.arenas_[i] = arenas_[i].get_mark();
+  return m;
+}
+
+/// Release all terms allocated in the store after the mark m. Those terms
+/// are not destroyed, and no references to them may remain. Derived stores
+/// override this to remove released terms from their side tables.
+inline void 
+node_store::release(mark m) 
+{ 
+  for (int i = 0; i < num_node_families; ++i)
+    arenas_[i].release(m.arenas_[i]);
+}
+
+/// Returns true if p was allocated in the store after the mark m.
+inline bool
+node_store::allocated_since(const mark& m, const void* p) const
+{
+  for (int i = 0; i < num_node_families; ++i)
+    if (arenas_[i].allocated_since(m.arenas_[i], p))
+      return true;
+  return false;
+}
+
+
+/// A checkpoint releases all terms allocated in a node store (e.g., a 
+/// factory or module) during its lifetime, unless it is committed. This is 
+/// used to build speculative or transient terms.
+///
+/// Only terms allocated by the store are released. Canonical terms (e.g., 
+/// types) are allocated by the language, and are not affected. Checkpoints
+/// on the same store must be nested.
+///
+/// Released terms are not destroyed. In particular, a layout set on a term
+/// (see locatable) is not freed when the term is released. The layouts of
+/// transient terms should be kept in a layout map that is cleared with them.
+struct checkpoint
+{
+  checkpoint(node_store&);
+  checkpoint(const checkpoint&) = delete;
+  ~checkpoint();
+
+  void commit();
+
+  node_store* store_;
+  node_store::mark mark_;
+};
+
+inline 
+checkpoint::checkpoint(node_store& s)
+  : store_(&s), mark_(s.get_mark())
+{ }
+
+inline
+checkpoint::~checkpoint()
+{
+  if (store_)
+    store_->release(mark_);
+}
+
+/// Retain the terms allocated since the checkpoint was created.
+inline void checkpoint::commit() { store_ = nullptr; }
 
 /*
 /// Register a new singleton set for the given node id. If such a set already
@@ -113,9 +113,9 @@ void print_prefix_expr(pretty_printer&, const unary_expr&, const char*);
 void print_suffix_expr(pretty_printer&, const unary_expr&, const char*);
 void print_infix_expr(pretty_printer&, const binary_expr&, const char*);
 
-template<typename T>
+template<typename S>
 void 
-print_comma_separated(pretty_printer& pp, const seq<T>& s)
+print_comma_separated(pretty_printer& pp, const S& s)
 {
   for (auto iter = s.begin(); iter != s.end(); ++iter) {
     print(pp, *iter);
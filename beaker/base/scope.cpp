@@ -25,7 +25,7 @@ lexical_environment::add(scope& s, decl& d)
   s.add(d);
 
   // Push the declaration onto the bindings.
-  auto result = map.emplace(&nd.get_name(), bindings{});
+  auto result = map.emplace(&nd.get_name(), bindings(pool));
   bindings& decls = result.first->second;
   assert((decls.empty() ? true : (decls.top().s != &s)) && "cannot rebind declaration");
   decls.push(s, d);
@@ -6,6 +6,8 @@
 
 #include <beaker/base/decl.hpp>
 
+#include <beaker/util/memory.hpp>
+
 #include <cassert>
 #include <memory>
 #include <unordered_map>
@@ -84,6 +86,9 @@ scope::add(decl& d)
 ///
 /// Note that the declaration may in fact be a declaration set or an overload
 /// set. The semantics of these types must handled by the source language.
+///
+/// Bindings are pushed and popped as scopes are entered and left, so their
+/// storage, and the entries of the map, are recycled by a pool.
 struct lexical_environment
 {
   /// Represents a declaration within a particular scope.
@@ -94,8 +99,10 @@ struct lexical_environment
   };
 
   /// The list of declarations bound to a given name.
-  struct bindings : std::vector<entry>
+  struct bindings : std::vector<entry, typed_allocator<entry>>
   {
+    explicit bindings(allocator&);
+
     const entry& top() const;
     entry& top();
 
@@ -116,7 +123,12 @@ struct lexical_environment
     scope& top();
   };
 
-  using map_type = std::unordered_map<const name*, bindings>;
+  using map_alloc = typed_allocator<std::pair<const name* const, bindings>>;
+  using map_type = std::unordered_map<
+    const name*, bindings, std::hash<const name*>, std::equal_to<const name*>, map_alloc
+  >;
+
+  lexical_environment();
 
   void add(decl&);
   void add(scope&, decl&);
@@ -134,10 +146,19 @@ struct lexical_environment
   const scope& current_scope() const;
   scope& current_scope();
 
+  pool_allocator pool;
   map_type map;
   stack ss;
 };
 
+inline lexical_environment::lexical_environment() : map(map_alloc(pool)) { }
+
+/// Initialize an empty list of bindings whose storage is allocated by a.
+inline 
+lexical_environment::bindings::bindings(allocator& a)
+  : std::vector<entry, typed_allocator<entry>>(typed_allocator<entry>(a))
+{ }
+
 /// Returns the top (innermost) bindings for the name.
 inline auto 
 lexical_environment::bindings::top() const -> const entry&
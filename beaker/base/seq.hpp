@@ -4,6 +4,10 @@
 #ifndef BEAKER_BASE_SEQ_HPP
 #define BEAKER_BASE_SEQ_HPP
 
+#include <beaker/util/memory.hpp>
+
+#include <algorithm>
+#include <initializer_list>
 #include <vector>
 
 
@@ -67,6 +71,9 @@ struct seq_iterator<T const>
   seq_iterator& operator++()    { ++iter; return *this; }
   seq_iterator operator++(int) { auto x = *this; ++iter; return x; }
 
+  seq_iterator& operator--()    { --iter; return *this; }
+  seq_iterator operator--(int) { auto x = *this; --iter; return x; }
+
   seq_iterator& operator+=(std::ptrdiff_t n) { iter += n; return *this; }
   seq_iterator& operator-=(std::ptrdiff_t n) { iter -= n; return *this; }
 
@@ -151,6 +158,10 @@ struct seq
     : elems_(list)
   { }
 
+  seq(T* const* first, T* const* limit)
+    : elems_(first, limit)
+  { }
+
   // Returns this object, which can be used to disambiguation conversions.
   seq const& form() const { return *this; }
   seq& form() { return *this; }
@@ -198,6 +209,111 @@ struct seq
   std::vector<T*> elems_;
 };
 
+
+// An immutable sequence of terms. This is used to store the operands of a
+// term (e.g., the arguments of a call), and is initialized by copying a
+// sequence when that term is created.
+//
+// Sequences of up to two terms are stored inline. Longer sequences are 
+// copied into an array allocated by the factory that creates the term. In 
+// either case, creating a term requires no heap allocation, and the sequence
+// never needs to be destroyed. Copies share that array.
+template<typename T>
+struct term_span
+{
+  using iterator = seq_iterator<T>;
+  using const_iterator = seq_iterator<const T>;
+
+  static constexpr int inline_size = 2;
+
+  term_span() : size_(0), ptr_() { }
+  term_span(allocator&, const seq<T>&);
+  term_span(T**, const seq<T>&);
+
+  // Returns the number of bytes needed to store s outside of the span.
+  static int storage_size(const seq<T>& s);
+
+  // Returns a span that refers to the elements of s instead of copying
+  // them. The span is valid only while s is unchanged.
+  static term_span view(const seq<T>& s);
+
+  // Returns true if the sequence is empty.
+  bool is_empty() const { return size_ == 0; }
+  
+  // Returns the number of elements in the sequence.
+  int size() const { return size_; }
+
+  // Returns the nth term in the sequence.
+  T const& operator[](int n) const { return *data()[n]; }
+  T& operator[](int n) { return *data()[n]; }
+
+  // Returns the first element in the sequence.
+  T const& front() const { return *data()[0]; }
+  T& front() { return *data()[0]; }
+
+  // Returns the last element in the sequence.
+  T const& back() const { return *data()[size_ - 1]; }
+  T& back() { return *data()[size_ - 1]; }
+
+  // Returns a pointer to the first node pointer.
+  T* const* data() const { return size_ <= inline_size ? inline_ : ptr_; }
+  T** data() { return size_ <= inline_size ? inline_ : ptr_; }
+
+  // Returns a sequence with the same elements.
+  seq<T> to_seq() const { return seq<T>(data(), data() + size_); }
+
+  // Iterators
+  const_iterator begin() const { return data(); }
+  const_iterator end() const { return data() + size_; }
+
+  iterator begin() { return data(); }
+  iterator end() { return data() + size_; }
+
+  int size_;
+  union {
+    T* inline_[inline_size];
+    T** ptr_;
+  };
+};
+
+template<typename T>
+constexpr int term_span<T>::inline_size;
+
+// Copy the elements of s, allocating from a if they cannot be stored inline.
+template<typename T>
+term_span<T>::term_span(allocator& a, const seq<T>& s)
+  : term_span(static_cast<T**>(a.allocate(storage_size(s), alignof(T*))), s)
+{ }
+
+// Copy the elements of s. If they cannot be stored inline, they are copied
+// into p, which has at least storage_size(s) bytes, unless p is the storage
+// of s.
+template<typename T>
+term_span<T>::term_span(T** p, const seq<T>& s)
+  : size_(s.size())
+{
+  if (size_ > inline_size)
+    ptr_ = p;
+  else
+    p = inline_;
+  if (p != s.base().data())
+    std::copy(s.base().begin(), s.base().end(), p);
+}
+
+template<typename T>
+inline term_span<T>
+term_span<T>::view(const seq<T>& s)
+{
+  return term_span(const_cast<T**>(s.base().data()), s);
+}
+
+template<typename T>
+inline int
+term_span<T>::storage_size(const seq<T>& s)
+{
+  return s.size() > inline_size ? s.size() * sizeof(T*) : 0;
+}
+
 } // namespace beaker
 
 
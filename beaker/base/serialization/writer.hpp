@@ -154,12 +154,12 @@ write_string(archive_writer& ar, const symbol& s)
   ar.write_string(s); 
 }
 
-template<typename T>
+template<typename S>
 inline void
-write_seq(archive_writer& ar, const seq<T>& seq)
+write_seq(archive_writer& ar, const S& seq)
 {
   write_int(ar, seq.size());
-  for (const T& t : seq)
+  for (const auto& t : seq)
     write_term(ar, t);
 }
 
@@ -44,6 +44,9 @@ inline int stmt::get_kind() const { return kind_; }
 // A sequence of statements.
 using stmt_seq = seq<stmt>;
 
+// An immutable sequence of statements, stored in a term.
+using stmt_span = term_span<stmt>;
+
 } // namespace beaker
 
 
@@ -8,6 +8,8 @@
 #include <beaker/base/seq.hpp>
 #include <beaker/util/cast.hpp>
 
+#include <cstdint>
+
 
 namespace beaker {
 
@@ -21,6 +23,10 @@ struct function_type;
 
 // Represents the set of types in a language. Specific kinds of types are
 // defined as derived classes.
+//
+// When the library is configured with BEAKER_HASH_CACHE, a type stores its
+// hash code after it is first hashed. The code is 0 until then. Types are
+// not modified after construction, so the code does not change.
 struct type 
 {
   using node_set = type;
@@ -41,6 +47,9 @@ struct type
   function_type* as_function_type();
 
   int kind_;
+#if BEAKER_HASH_CACHE
+  mutable std::uint32_t hash_ = 0;
+#endif
 };
 
 // Construct a type with kind k.
@@ -59,6 +68,9 @@ inline int type::get_kind() const { return kind_; }
 // A sequence of types.
 using type_seq = seq<type>;
 
+// An immutable sequence of types, stored in a term.
+using type_span = term_span<type>;
+
 
 // -------------------------------------------------------------------------- //
 // Base types
@@ -177,6 +189,8 @@ inline function_type_impl<K>::function_type_impl() : function_type(K) { }
 // -------------------------------------------------------------------------- //
 // Operations
 
+bool is_canonical_type(const type&);
+
 /// Returns true if t is an object type.
 inline bool 
 is_object_type(const type& t)
@@ -4,12 +4,46 @@
 #include "value.hpp"
 
 #include <beaker/util/hash.hpp>
+#include <beaker/util/memory.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <new>
 
 
 namespace beaker {
 
+// -------------------------------------------------------------------------- //
+// Aggregates
+
+/// Returns a new aggregate of `n` void elements allocated using `a`. The 
+/// allocator must be an arena that outlives the aggregate's values (e.g., the
+/// allocator of an evaluator).
+aggregate&
+make_aggregate(allocator& a, int n)
+{
+  int size = sizeof(aggregate) + n * sizeof(value);
+  void* mem = a.allocate(size, alignof(aggregate));
+  aggregate* agg = new (mem) aggregate {n};
+  value* p = const_cast<value*>(agg->begin());
+  for (int i = 0; i < n; ++i)
+    new (p + i) value();
+  return *agg;
+}
+
+/// Two aggregates are equal when they have equal elements.
+bool
+operator==(const aggregate& a, const aggregate& b)
+{
+  if (a.get_size() != b.get_size())
+    return false;
+  return std::equal(a.begin(), a.end(), b.begin());
+}
+
+
+// -------------------------------------------------------------------------- //
+// Hashing
+
 void
 hash(hasher& h, const value& v)
 {
@@ -19,13 +53,52 @@ hash(hasher& h, const value& v)
       return;
     case int_value_kind:
       return hash(h, v.get_int());
+    case wide_value_kind:
+      hash(h, v.data_.w.lo);
+      return hash(h, v.data_.w.hi);
     case float_value_kind:
       return hash(h, v.get_float());
+    case aggregate_value_kind: {
+      const aggregate& a = v.get_aggregate();
+      hash(h, a.get_size());
+      for (const value& x : a)
+        hash(h, x);
+      return;
+    }
+    case ref_value_kind:
+      return hash(h, &v.get_reference());
+    case fn_value_kind:
+      return hash(h, &v.get_function());
   }
   assert(false && "invalid value kind");
 }
 
 
+// -------------------------------------------------------------------------- //
+// Streaming
+
+/// Returns the decimal representation of n.
+std::string
+to_string(wide_natural n)
+{
+  char buf[40];
+  char* p = buf + sizeof(buf);
+  do {
+    *--p = '0' + int(n % 10);
+    n /= 10;
+  } while (n);
+  return std::string(p, buf + sizeof(buf));
+}
+
+/// Returns the decimal representation of n.
+std::string
+to_string(wide_integer n)
+{
+  if (n < 0)
+    return '-' + to_string(wide_natural(0) - wide_natural(n));
+  return to_string(wide_natural(n));
+}
+
 std::ostream&
 operator<<(std::ostream& os, const value& val)
 {
@@ -34,8 +107,24 @@ operator<<(std::ostream& os, const value& val)
       return os << "<void>";
     case int_value_kind:
       return os << "<int " << val.get_int() << '>';
+    case wide_value_kind:
+      return os << "<int " << to_string(val.get_wide()) << '>';
     case float_value_kind:
       return os << "<float " << val.get_float() << '>';
+    case aggregate_value_kind: {
+      const aggregate& a = val.get_aggregate();
+      os << '{';
+      for (const value* p = a.begin(); p != a.end(); ++p) {
+        os << *p;
+        if (p + 1 != a.end())
+          os << ", ";
+      }
+      return os << '}';
+    }
+    case ref_value_kind:
+      return os << "<ref " << &val.get_reference() << '>';
+    case fn_value_kind:
+      return os << "<fn " << &val.get_function() << '>';
   }
   assert(false && "invalid value kind");
 }
@@ -8,17 +8,25 @@
 #include <cstdint>
 #include <cstring>
 #include <iosfwd>
+#include <string>
 #include <vector>
 
 
 namespace beaker {
 
+struct allocator;
+struct decl;
+
 // Kinds of values.
 enum value_kind 
 {
   void_value_kind,
   int_value_kind,
+  wide_value_kind,
   float_value_kind,
+  aggregate_value_kind,
+  ref_value_kind,
+  fn_value_kind,
 };
 
 // Represents the absence of value.
@@ -27,20 +35,44 @@ struct void_value { };
 // Represents integer values.
 using integer_value = std::intmax_t;
 
+// Represents integer values of up to 128 bits.
+using wide_integer = __int128;
+using wide_natural = unsigned __int128;
+
 // Represents floating point values.
 using float_value = double;
 
 
+/// The inline storage of a wide integer. The value is stored as two words
+/// so that values are not over-aligned.
+struct wide_value
+{
+  std::uint64_t lo;
+  std::int64_t hi;
+};
+
+struct aggregate;
+struct value;
+
+
 // Representation of values.
 union value_data
 {
   explicit value_data() : v() { }
   explicit value_data(integer_value n) : z(n) { }
+  explicit value_data(wide_natural n) : w {std::uint64_t(n), std::int64_t(n >> 64)} { }
   explicit value_data(float_value n) : f(n) { }
+  explicit value_data(const aggregate* p) : a(p) { }
+  explicit value_data(value* p) : r(p) { }
+  explicit value_data(const decl* p) : d(p) { }
   
   void_value v;
   integer_value z;
+  wide_value w;
   float_value f;
+  const aggregate* a;
+  value* r;
+  const decl* d;
 };
 
 
@@ -48,7 +80,17 @@ union value_data
 //
 // Values are used to represent literals, constants, and to perform
 // compile-time evaluation. A value can be one of several different 
-// kinds: integers, reals, and composites.
+// kinds: integers, reals, aggregates (the values of tuples and arrays),
+// references (the addresses of objects), and functions.
+//
+// Integers that fit in a signed machine word are always stored as int 
+// values, and other integers are only stored as wide values, whether they
+// are given as signed or unsigned 128-bit integers. Each integer therefore
+// has exactly one representation. Evaluators test is_small() to select a
+// path for word-sized arithmetic. The exception is a value of a word-sized
+// unsigned type (e.g., nat64), which is stored as the bits of the word
+// (see value(std::uintmax_t)), and is interpreted by the type of its 
+// expression.
 struct value
 {
   value();
@@ -57,7 +99,12 @@ struct value
   explicit value(int);
   explicit value(std::intmax_t);
   explicit value(std::uintmax_t);
+  explicit value(wide_integer);
+  explicit value(wide_natural);
   explicit value(double);
+  explicit value(const aggregate&);
+  explicit value(value*);
+  explicit value(const decl&);
 
   value& operator=(const value&);
   value& operator=(value&&);
@@ -65,10 +112,20 @@ struct value
   value_kind get_kind() const;
   bool is_void() const;
   bool is_integer() const;
+  bool is_small() const;
+  bool is_wide() const;
   bool is_float() const;
+  bool is_aggregate() const;
+  bool is_reference() const;
+  bool is_function() const;
 
   integer_value get_int() const;
+  wide_integer get_wide() const;
+  wide_natural get_wide_natural() const;
   float_value get_float() const;
+  const aggregate& get_aggregate() const;
+  value& get_reference() const;
+  const decl& get_function() const;
 
   value_kind kind_;
   value_data data_;
@@ -107,16 +164,61 @@ value::value(std::intmax_t n)
   : kind_(int_value_kind), data_(n)
 { }
 
+/// Initialize the value from the bits of the unsigned word n. This is the
+/// representation of values of word-sized unsigned types.
 inline
 value::value(std::uintmax_t n)
   : kind_(int_value_kind), data_(std::intmax_t(n))
 { }
 
+/// Initialize the value from the integer n. The value is small if n fits in
+/// a machine word.
+inline
+value::value(wide_integer n)
+  : kind_(int_value_kind), data_(integer_value(n))
+{ 
+  if (integer_value(n) != n) {
+    kind_ = wide_value_kind;
+    data_ = value_data(wide_natural(n));
+  }
+}
+
+/// Initialize the value from the unsigned integer n. The value is small if
+/// n fits in a signed machine word.
+inline
+value::value(wide_natural n)
+  : kind_(int_value_kind), data_(integer_value(std::uintmax_t(n)))
+{ 
+  if (n >> 63) {
+    kind_ = wide_value_kind;
+    data_ = value_data(n);
+  }
+}
+
 inline
 value::value(double n)
   : kind_(float_value_kind), data_(n)
 { }
 
+/// Initialize the value from the aggregate a. The value refers to, and does
+/// not copy, the aggregate.
+inline
+value::value(const aggregate& a)
+  : kind_(aggregate_value_kind), data_(&a)
+{ }
+
+/// Initialize the value as a reference to the object p.
+inline
+value::value(value* p)
+  : kind_(ref_value_kind), data_(p)
+{ }
+
+/// Initialize the value as the function declared by d.
+inline
+value::value(const decl& d)
+  : kind_(fn_value_kind), data_(&d)
+{ }
+
 inline value&
 value::operator=(const value& v) 
 {
@@ -140,19 +242,60 @@ inline value_kind value::get_kind() const { return kind_; }
 inline bool value::is_void() const { return kind_ == void_value_kind; }
 
 /// Returns the true if the value is an integer.
-inline bool value::is_integer() const { return kind_ == int_value_kind; }
+inline bool 
+value::is_integer() const 
+{ 
+  return kind_ == int_value_kind || kind_ == wide_value_kind;
+}
+
+/// Returns true if the value is an integer that fits in a machine word.
+inline bool value::is_small() const { return kind_ == int_value_kind; }
+
+/// Returns true if the value is an integer stored in 128 bits.
+inline bool value::is_wide() const { return kind_ == wide_value_kind; }
 
 /// Returns true if the value is a floating point value.
 inline bool value::is_float() const { return kind_ == float_value_kind; }
 
-/// Returns the integer representation of the value.
+/// Returns true if the value is an aggregate.
+inline bool value::is_aggregate() const { return kind_ == aggregate_value_kind; }
+
+/// Returns true if the value is a reference.
+inline bool value::is_reference() const { return kind_ == ref_value_kind; }
+
+/// Returns true if the value is a function.
+inline bool value::is_function() const { return kind_ == fn_value_kind; }
+
+/// Returns the integer representation of the value. The value shall fit in
+/// a machine word.
 inline integer_value
 value::get_int() const 
 { 
-  assert(is_integer());
+  assert(is_small());
   return data_.z;
 }
 
+/// Returns the value as a signed 128-bit integer. Word-sized values are
+/// sign extended.
+inline wide_integer
+value::get_wide() const
+{
+  if (is_small())
+    return data_.z;
+  return wide_integer(get_wide_natural());
+}
+
+/// Returns the value as an unsigned 128-bit integer. Word-sized values are
+/// zero extended.
+inline wide_natural
+value::get_wide_natural() const
+{
+  if (is_small())
+    return std::uintmax_t(data_.z);
+  assert(is_wide());
+  return (wide_natural(std::uint64_t(data_.w.hi)) << 64) | data_.w.lo;
+}
+
 // Returns the floating point representation of the value.
 inline float_value
 value::get_float() const 
@@ -161,6 +304,87 @@ value::get_float() const
   return data_.f;
 }
 
+/// Returns the aggregate representation of the value.
+inline const aggregate&
+value::get_aggregate() const
+{
+  assert(is_aggregate());
+  return *data_.a;
+}
+
+/// Returns the object referred to by the value.
+inline value&
+value::get_reference() const
+{
+  assert(is_reference());
+  return *data_.r;
+}
+
+/// Returns the declaration of the function denoted by the value.
+inline const decl&
+value::get_function() const
+{
+  assert(is_function());
+  return *data_.d;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Aggregates
+
+/// An aggregate is a fixed-length sequence of values. Aggregates are the
+/// values of tuples and arrays.
+///
+/// The elements are stored contiguously, immediately following the object,
+/// so projection and indexing take constant time. Aggregates are allocated
+/// in an arena by make_aggregate(), and the elements are initialized once,
+/// when the aggregate is created.
+struct alignas(value) aggregate
+{
+  int get_size() const;
+
+  const value* begin() const;
+  const value* end() const;
+
+  const value& get_element(int) const;
+  value& get_element(int);
+
+  int size_;
+};
+
+/// Returns the number of elements in the aggregate.
+inline int aggregate::get_size() const { return size_; }
+
+/// Returns a pointer to the first element.
+inline const value* 
+aggregate::begin() const 
+{ 
+  return reinterpret_cast<const value*>(this + 1); 
+}
+
+/// Returns a pointer past the last element.
+inline const value* aggregate::end() const { return begin() + size_; }
+
+/// Returns the nth element.
+inline const value& 
+aggregate::get_element(int n) const 
+{ 
+  assert(0 <= n && n < size_);
+  return begin()[n];
+}
+
+/// Returns the nth element.
+inline value& 
+aggregate::get_element(int n)
+{ 
+  assert(0 <= n && n < size_);
+  return const_cast<value*>(begin())[n];
+}
+
+aggregate& make_aggregate(allocator&, int);
+
+bool operator==(const aggregate&, const aggregate&);
+
 
 // -------------------------------------------------------------------------- //
 // Equality comparison
@@ -176,8 +400,16 @@ operator==(const value& a, const value& b)
       return true;
     case int_value_kind:
       return a.get_int() == b.get_int();
+    case wide_value_kind:
+      return a.get_wide() == b.get_wide();
     case float_value_kind:
       return a.get_float() == b.get_float();
+    case aggregate_value_kind:
+      return a.get_aggregate() == b.get_aggregate();
+    case ref_value_kind:
+      return &a.get_reference() == &b.get_reference();
+    case fn_value_kind:
+      return &a.get_function() == &b.get_function();
     default:
       break;
   }
@@ -202,6 +434,9 @@ void hash(hasher&, const value&);
 // -------------------------------------------------------------------------- //
 // Streaming
 
+std::string to_string(wide_integer);
+std::string to_string(wide_natural);
+
 std::ostream& operator<<(std::ostream&, const value&);
 
 } // namespace beaker
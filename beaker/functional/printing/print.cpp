@@ -37,7 +37,7 @@ static void
 print_type(std::ostream& os, const fn_type& t)
 {
   os << '(';
-  const type_seq& parms = t.get_parameter_types();
+  const type_span& parms = t.get_parameter_types();
   for (auto iter = parms.begin(); iter != parms.end(); ++iter) {
     print(os, *iter);
     if (std::next(iter) == parms.end())
@@ -70,7 +70,7 @@ print_call_expr(std::ostream& os, const call_expr& e)
 {
   print(os, e.get_function());
   os << '(';
-  const expr_seq& args = e.get_arguments();
+  const expr_span& args = e.get_arguments();
   for (auto iter = args.begin(); iter != args.end(); ++iter) {
     print(os, *iter);
     if (std::next(iter) != args.end())
@@ -119,7 +119,7 @@ print_fn_decl(std::ostream& os, const fn_decl& d)
   os << "fn" << ' ';
   print(os, d.get_name());
   os << '(';
-  decl_seq const& parms = d.get_parameters();
+  decl_span const& parms = d.get_parameters();
   for (auto iter = parms.begin(); iter != parms.end(); ++iter) {
     print(os, *iter);
     if (std::next(iter) != parms.end())
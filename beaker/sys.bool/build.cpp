@@ -11,7 +11,7 @@ namespace sys_bool {
 
 builder::builder(module& m)
   : factory(m),
-    bool_(&make_singleton_set<bool_type>(get_language_allocator())) 
+    bool_(&get_singleton_set<bool_type>(get_language_allocator())) 
 { }
 
 /// Returns a new boolean type.
@@ -4,107 +4,132 @@
 #include "evaluate.hpp"
 #include "../expr.hpp"
 
+#include <functional>
+
 
 namespace beaker {
 
+namespace sys_bool {
+
+/// Evaluate the operands of `e` in order and combine their values using 
+/// `op`.
+template<typename Op>
+static inline result
+eval_binary(evaluator& eval, const binary_expr& e, Op op)
+{
+  result r1 = try_evaluate(eval, e.get_lhs());
+  if (!r1)
+    return r1;
+  result r2 = try_evaluate(eval, e.get_rhs());
+  if (!r2)
+    return r2;
+  return value(op(r1.get_value().get_int(), r2.get_value().get_int()));
+}
+
+} // namespace sys_bool
+
 // Evaluate the expressions `true` and `false`.
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::bool_expr& e)
 {
   return e.get_value();  
 }
 
 // Evaluate the expression `e1 & e2`.
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::and_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() & v2.get_int());
+  return sys_bool::eval_binary(eval, e, std::bit_and<std::intmax_t>());
 }
 
 // Evaluate the expression `e1 | e2`.
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::or_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() | v2.get_int());
+  return sys_bool::eval_binary(eval, e, std::bit_or<std::intmax_t>());
 }
 
 /// Evaluates the expression `e1 ^ e2`.
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::xor_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() ^ v2.get_int());
+  return sys_bool::eval_binary(eval, e, std::bit_xor<std::intmax_t>());
 }
 
 // Evaluate the expression `!e`.
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::not_expr& e)
 {
-  value v = evaluate(eval, e.get_operand());
-  return value(!v.get_int());
+  result r = try_evaluate(eval, e.get_operand());
+  if (!r)
+    return r;
+  return value(!r.get_value().get_int());
 }
 
 // Evaluate the expression `e1 => e2`.
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::imp_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value((!v1.get_int()) | v2.get_int());
+  auto imp = [](std::intmax_t a, std::intmax_t b) { return (!a) | b; };
+  return sys_bool::eval_binary(eval, e, imp);
 }
 
 // Evaluate the expression `e1 <=> e2`.
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::eq_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() == v2.get_int());
+  return sys_bool::eval_binary(eval, e, std::equal_to<std::intmax_t>());
 }
 
-value
+/// Evaluate the conditional `if e1 then e2 else e3`. When the conditional 
+/// is in tail position, so is the selected operand.
+result
 evaluate_expr(evaluator& eval, const sys_bool::if_expr& e)
 {
-  value p = evaluate(eval, e.get_condition());
-  if (p.get_int())
-    return evaluate(eval, e.get_true_value());
-  else
-    return evaluate(eval, e.get_false_value());
+  bool tail = eval.in_tail_position(e);
+  result p = try_evaluate(eval, e.get_condition());
+  if (!p)
+    return p;
+  const expr& r = p.get_value().get_int() ? e.get_true_value() : e.get_false_value();
+  if (tail)
+    eval.set_tail_position(&r);
+  return try_evaluate(eval, r);
 }
 
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::and_then_expr& e)
 {
-  value v = evaluate(eval, e.get_lhs());
-  if (v.get_int())
-    return evaluate(eval, e.get_rhs());
+  result r = try_evaluate(eval, e.get_lhs());
+  if (!r)
+    return r;
+  if (r.get_value().get_int())
+    return try_evaluate(eval, e.get_rhs());
   else
     return value(0); // false
 }
 
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::or_else_expr& e)
 {
-  value v = evaluate(eval, e.get_lhs());
-  if (v.get_int())
+  result r = try_evaluate(eval, e.get_lhs());
+  if (!r)
+    return r;
+  if (r.get_value().get_int())
     return value(1); // true
   else
-    return evaluate(eval, e.get_rhs());
+    return try_evaluate(eval, e.get_rhs());
 }
 
-value
+result
 evaluate_expr(evaluator& eval, const sys_bool::assert_expr& e)
 {
-  value v = evaluate(eval, e.get_operand());
-  if (v.get_int())
+  result r = try_evaluate(eval, e.get_operand());
+  if (!r)
+    return r;
+  if (r.get_value().get_int())
     return value(1);
   else
-    throw sys_bool::assertion_error(e);
+    return eval.fail<sys_bool::assertion_error>(e);
 }
 
 } // namespace beaker
@@ -182,6 +182,19 @@ struct assert_expr : unary_expr_impl<assert_expr_kind>
 bool is_boolean_expression(const expr&);
 
 } // namespace sys_bool
+
+/// Boolean literals and logical operators are pure. Assertions are not.
+template<> struct is_pure_term<sys_bool::bool_expr> : std::true_type { };
+template<> struct is_pure_term<sys_bool::and_expr> : std::true_type { };
+template<> struct is_pure_term<sys_bool::or_expr> : std::true_type { };
+template<> struct is_pure_term<sys_bool::xor_expr> : std::true_type { };
+template<> struct is_pure_term<sys_bool::not_expr> : std::true_type { };
+template<> struct is_pure_term<sys_bool::imp_expr> : std::true_type { };
+template<> struct is_pure_term<sys_bool::eq_expr> : std::true_type { };
+template<> struct is_pure_term<sys_bool::if_expr> : std::true_type { };
+template<> struct is_pure_term<sys_bool::and_then_expr> : std::true_type { };
+template<> struct is_pure_term<sys_bool::or_else_expr> : std::true_type { };
+
 } // namespace beaker
 
 
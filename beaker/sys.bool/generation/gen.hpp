@@ -4,20 +4,30 @@
 #ifndef BEAKER_SYS_BOOL_GENERATION_GEN_HPP
 #define BEAKER_SYS_BOOL_GENERATION_GEN_HPP
 
+#include <beaker/sys.bool/fwd.hpp>
+
 #include <beaker/base/generation/generation.hpp>
 
 
 namespace beaker {
-namespace sys_bool {
 
-struct gen_algo : generate_algorithm
-{
-  cg::type operator()(generator&, const type&) const;
-  cg::value operator()(generator&, const expr&) const;
-  cg::value operator()(generator&, const decl&) const;
-};
+// -------------------------------------------------------------------------- //
+// Overrides
+
+cg::type generate_type(generator&, const sys_bool::bool_type&);
+
+cg::value generate_expr(generator&, const sys_bool::bool_expr&);
+cg::value generate_expr(generator&, const sys_bool::and_expr&);
+cg::value generate_expr(generator&, const sys_bool::or_expr&);
+cg::value generate_expr(generator&, const sys_bool::xor_expr&);
+cg::value generate_expr(generator&, const sys_bool::not_expr&);
+cg::value generate_expr(generator&, const sys_bool::imp_expr&);
+cg::value generate_expr(generator&, const sys_bool::eq_expr&);
+cg::value generate_expr(generator&, const sys_bool::if_expr&);
+cg::value generate_expr(generator&, const sys_bool::and_then_expr&);
+cg::value generate_expr(generator&, const sys_bool::or_else_expr&);
+cg::value generate_expr(generator&, const sys_bool::assert_expr&);
 
-} // namespace sys_bool
 } // namespace beaker
 
 
@@ -39,6 +39,10 @@ is_boolean_type(const type& t)
 }
 
 } // namespace sys_bool
+
+/// The bool type is a singleton.
+template<> struct is_canonical_term<sys_bool::bool_type> : std::true_type { };
+
 } // namespace beaker
 
 
@@ -63,7 +63,7 @@ get_name(builder& b)
 
 builder::builder(module& m)
   : factory(m),
-    fn_(&make_canonical_set<fn_type>(get_language_allocator()))
+    fn_(&get_canonical_set<fn_type>(get_language_allocator()))
 { }
 
 // Check that no parameters have void type.
@@ -74,19 +74,18 @@ has_void_parm(const type_seq& ts)
 }
 
 /// Returns the canonical type `(p) -> r`. Note that `p` is a sequence of types.
+/// The types in `p` are copied into the language's memory only when the
+/// function type is new.
 fn_type&
 builder::get_fn_type(const type_seq& p, type& r)
 {
   assert(!has_void_parm(p));
-  return fn_->get(p, r);
-}
-
-/// Returns the canonical type `(p) -> r`. Note that `p` is a sequence of types.
-fn_type&
-builder::get_fn_type(type_seq&& p, type& r)
-{
-  assert(!has_void_parm(p));
-  return fn_->get(std::move(p), r);
+  fn_type key(type_span::view(p), r);
+  return fn_->intern(key, [&key, &p](allocator& a) {
+    fn_type* t = new (a.allocate(sizeof(fn_type), alignof(fn_type))) fn_type(key);
+    t->parms_ = type_span(a, p);
+    return t;
+  });
 }
 
 /// Returns the canonical type `(a) -> b` where `a` is the sequence of types
@@ -111,15 +110,7 @@ call_expr&
 builder::make_call_expr(expr& f, const expr_seq& a)
 {
   type& t = f.get_type();
-  return make<call_expr>(get_return_type(t), f, a);
-}
-
-/// FIXME: Guarantee that arguments match parameters.
-call_expr&
-builder::make_call_expr(expr& f, expr_seq&& a)
-{
-  type& t = f.get_type();
-  return make<call_expr>(get_return_type(t), f, std::move(a));
+  return make<call_expr>(get_return_type(t), f, trailing(a));
 }
 
 /// Returns the expression `e1 == e2` where e1 and e2 have function type.
@@ -148,7 +139,7 @@ builder::make_ne_expr(expr& e1, expr& e2)
 fn_decl&
 builder::make_fn_decl(dc cxt, name& n, type& t, const decl_seq& p, decl& r)
 {
-  return make<fn_decl>(generate_id(), cxt, n, t, p, r);
+  return make<fn_decl>(generate_id(), cxt, n, t, trailing(p), r);
 }
 
 /// Returns a new function that has no definition. By default, a function with 
@@ -159,28 +150,12 @@ builder::make_fn_decl(dc cxt, const char* n, type& t, const decl_seq& p, decl& r
   return make_fn_decl(cxt, get_name(*this, n), t, p, r);
 }
 
-/// Returns a new function that has no definition. By default, a function with 
-/// no definition has external linkage.
-fn_decl&
-builder::make_fn_decl(dc cxt, name& n, type& t, decl_seq&& p, decl& r)
-{
-  return make<fn_decl>(generate_id(), cxt, n, t, std::move(p), r);
-}
-
-/// Returns a new function that has no definition. By default, a function with 
-/// no definition has external linkage.
-fn_decl&
-builder::make_fn_decl(dc cxt, const char* n, type& t, decl_seq&& p, decl& r)
-{
-  return make_fn_decl(cxt, get_name(*this, n), t, std::move(p), r);
-}
-
 /// Returns a new function with external linkage and defined by a block 
 /// statement.
 fn_decl&
 builder::make_fn_decl(dc cxt, name& n, type& t, const decl_seq& p, decl& r, stmt& s)
 {
-  return make<fn_decl>(generate_id(), cxt, external_link, n, t, p, r, s);
+  return make<fn_decl>(generate_id(), cxt, external_link, n, t, trailing(p), r, s);
 }
 
 /// Returns a new function with external linkage and defined by a block 
@@ -191,22 +166,6 @@ builder::make_fn_decl(dc cxt, const char* n, type& t, const decl_seq& p, decl& r
   return make_fn_decl(cxt, get_name(*this, n), t, p, r, s);
 }
 
-/// Returns a new function with external linkage and defined by a block 
-/// statement.
-fn_decl&
-builder::make_fn_decl(dc cxt, name& n, type& t, decl_seq&& p, decl& r, stmt& s)
-{
-  return make<fn_decl>(generate_id(), cxt, external_link, n, t, std::move(p), r, s);
-}
-
-/// Returns a new function with external linkage and defined by a block 
-/// statement.
-fn_decl&
-builder::make_fn_decl(dc cxt, const char* n, type& t, decl_seq&& p, decl& r, stmt& s)
-{
-  return make_fn_decl(cxt, get_name(*this, n), t, std::move(p), r, s);
-}
-
 /// Returns an unnamed parameter with the given type.
 parm_decl&
 builder::make_parm_decl(type& t)
@@ -295,21 +254,14 @@ builder::make_var_decl(dc cxt, const char* n, type& t, expr& e)
 block_stmt& 
 builder::make_block_stmt()
 {
-  return make<block_stmt>(stmt_seq{});
+  return make<block_stmt>(stmt_span());
 }
 
 /// Returns a new block statement with statements s.
 block_stmt& 
 builder::make_block_stmt(const stmt_seq& s)
 {
-  return make<block_stmt>(s);
-}
-
-/// Returns a new block statement with statements s.
-block_stmt& 
-builder::make_block_stmt(stmt_seq&& s)
-{
-  return make<block_stmt>(std::move(s));
+  return make<block_stmt>(trailing(s));
 }
 
 /// Returns a new expression statement.
@@ -21,26 +21,20 @@ struct builder : factory
 
   // Canonical types
   fn_type& get_fn_type(const type_seq&, type&);
-  fn_type& get_fn_type(type_seq&&, type&);
   fn_type& get_fn_type(decl_seq&, decl&);
 
   // Expressions
   call_expr& make_call_expr(expr&, const expr_seq&);
-  call_expr& make_call_expr(expr&, expr_seq&&);
   eq_expr& make_eq_expr(expr&, expr&);
   ne_expr& make_ne_expr(expr&, expr&);
 
   // Function declarations
   fn_decl& make_fn_decl(dc, name&, type&, const decl_seq&, decl&);
   fn_decl& make_fn_decl(dc, const char*, type&, const decl_seq&, decl&);
-  fn_decl& make_fn_decl(dc, name&, type&, decl_seq&&, decl&);
-  fn_decl& make_fn_decl(dc, const char*, type&, decl_seq&&, decl&);
 
   // Function definitions
   fn_decl& make_fn_decl(dc, name&, type&, const decl_seq&, decl&, stmt&);
   fn_decl& make_fn_decl(dc, const char*, type&, const decl_seq&, decl&, stmt&);
-  fn_decl& make_fn_decl(dc, name&, type&, decl_seq&&, decl&, stmt&);
-  fn_decl& make_fn_decl(dc, const char*, type&, decl_seq&&, decl&, stmt&);
   
   // Parameters
   parm_decl& make_parm_decl(type&);
@@ -56,7 +50,6 @@ struct builder : factory
   // Statements
   block_stmt& make_block_stmt();
   block_stmt& make_block_stmt(const stmt_seq&);
-  block_stmt& make_block_stmt(stmt_seq&&);
   expr_stmt& make_expr_stmt(expr&);
   decl_stmt& make_decl_stmt(decl&);
   ret_stmt& make_ret_stmt();
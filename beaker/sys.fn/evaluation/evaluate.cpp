@@ -0,0 +1,279 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "evaluate.hpp"
+#include "../type.hpp"
+#include "../expr.hpp"
+#include "../decl.hpp"
+#include "../stmt.hpp"
+
+
+namespace beaker {
+
+// -------------------------------------------------------------------------- //
+// Function calls
+
+namespace sys_fn {
+
+/// Returns the function denoted by the value v.
+static inline const fn_decl&
+get_function(const value& v)
+{
+  return cast<fn_decl>(v.get_function());
+}
+
+/// Bind the parameters of fn in the frame f to the values in args.
+static inline void
+bind_parameters(evaluator& eval, const fn_decl& fn, frame& f, const value* args)
+{
+  for (const decl& p : fn.get_parameters())
+    eval.bind(f, p, *args++);
+}
+
+/// Returns true if any of the n arguments in args is a reference to an
+/// object in the current frame. Those references would not survive a tail
+/// call.
+static bool
+has_local_reference(evaluator& eval, const value* args, int n)
+{
+  const frame& f = *eval.get_frame();
+  for (int i = 0; i < n; ++i)
+    if (args[i].is_reference() && f.contains(&args[i].get_reference()))
+      return true;
+  return false;
+}
+
+/// Call the function fn, whose parameters are bound in the frame f. The
+/// frame, and all storage allocated after the mark m, is released when the
+/// function returns.
+///
+/// When the function returns by making a tail call, the call is made here,
+/// in a new frame allocated at the same position as the released one. Tail 
+/// recursion runs in constant space and does not grow the native stack.
+static result
+invoke(evaluator& eval, const fn_decl* fn, frame* f, frame_stack::mark m)
+{
+  while (true) {
+    {
+      evaluator::frame_guard guard(eval, *f, m);
+      if (!fn->has_definition())
+        return eval.fail("call to undefined function");
+      f->ret_ = &eval.bind(*f, fn->get_return(), value());
+      control c = try_evaluate(eval, fn->get_definition());
+      if (c == fail_control)
+        return result(eval.get_failure());
+      if (c != tail_control)
+        return *f->ret_;
+    }
+    fn = &cast<fn_decl>(*eval.tail_fn_);
+    eval.tail_fn_ = nullptr;
+    f = &eval.make_frame();
+    bind_parameters(eval, *fn, *f, eval.tail_args_.data());
+  }
+}
+
+} // namespace sys_fn
+
+/// Call the function d with the given arguments, returning its value or the
+/// failure of its evaluation.
+result
+try_call(evaluator& eval, const decl& d, const std::vector<value>& args)
+{
+  const sys_fn::fn_decl& fn = cast<sys_fn::fn_decl>(d);
+  assert((int)args.size() == fn.get_parameters().size());
+  auto a = eval.enter();
+  frame_stack::mark m = eval.stack_.get_mark();
+  frame& f = eval.make_frame();
+  sys_fn::bind_parameters(eval, fn, f, args.data());
+  result r = sys_fn::invoke(eval, &fn, &f, m);
+  eval.leave(a, r);
+  return r;
+}
+
+/// Call the function d with the given arguments. This is the entry point
+/// for the evaluation of programs. Throws an exception if evaluation fails.
+value
+call(evaluator& eval, const decl& d, const std::vector<value>& args)
+{
+  result r = try_call(eval, d, args);
+  if (!r)
+    r.get_failure().raise();
+  return r.get_value();
+}
+
+
+// -------------------------------------------------------------------------- //
+// Expressions
+
+/// Evaluate the function, then evaluate each argument in turn to initialize
+/// the parameters of a new frame, and call the function.
+///
+/// A call in tail position is deferred: its arguments are saved as the
+/// pending tail call, which is made by the caller after the current frame
+/// has been released. A call whose arguments refer to objects in the
+/// current frame is always made directly.
+result
+evaluate_expr(evaluator& eval, const sys_fn::call_expr& e)
+{
+  bool tail = eval.in_tail_position(e);
+  eval.set_tail_position(nullptr);
+  result r = try_evaluate(eval, e.get_function());
+  if (!r)
+    return r;
+  const sys_fn::fn_decl& fn = sys_fn::get_function(r.get_value());
+  const expr_span& args = e.get_arguments();
+  assert(args.size() == fn.get_parameters().size());
+  frame_stack::mark m = eval.stack_.get_mark();
+  if (tail) {
+    int n = args.size();
+    value* vals = static_cast<value*>(eval.stack_.allocate(n * sizeof(value)));
+    for (int i = 0; i < n; ++i) {
+      result a = try_evaluate(eval, args[i]);
+      if (!a) {
+        eval.stack_.release(m);
+        return a;
+      }
+      new (&vals[i]) value(a.get_value());
+    }
+    if (!sys_fn::has_local_reference(eval, vals, n)) {
+      eval.tail_fn_ = &fn;
+      eval.tail_args_.assign(vals, vals + n);
+      eval.stack_.release(m);
+      return value();
+    }
+    frame& f = eval.make_frame();
+    sys_fn::bind_parameters(eval, fn, f, vals);
+    return sys_fn::invoke(eval, &fn, &f, m);
+  }
+
+  frame& f = eval.make_frame();
+  auto p = fn.get_parameters().begin();
+  for (const expr& a : args) {
+    result v = try_evaluate(eval, a);
+    if (!v) {
+      eval.stack_.release(m);
+      return v;
+    }
+    eval.bind(f, *p++, v.get_value());
+  }
+  return sys_fn::invoke(eval, &fn, &f, m);
+}
+
+/// Functions are equal when they are the same function.
+result
+evaluate_expr(evaluator& eval, const sys_fn::eq_expr& e)
+{
+  result r1 = try_evaluate(eval, e.get_lhs());
+  if (!r1)
+    return r1;
+  result r2 = try_evaluate(eval, e.get_rhs());
+  if (!r2)
+    return r2;
+  return value(&r1.get_value().get_function() == &r2.get_value().get_function());
+}
+
+/// Functions are unequal when they are different functions.
+result
+evaluate_expr(evaluator& eval, const sys_fn::ne_expr& e)
+{
+  result r1 = try_evaluate(eval, e.get_lhs());
+  if (!r1)
+    return r1;
+  result r2 = try_evaluate(eval, e.get_rhs());
+  if (!r2)
+    return r2;
+  return value(&r1.get_value().get_function() != &r2.get_value().get_function());
+}
+
+
+// -------------------------------------------------------------------------- //
+// Declarations
+
+/// The value of a function declaration is the function.
+result
+evaluate_decl(evaluator& eval, const sys_fn::fn_decl& d)
+{
+  return value(d);
+}
+
+/// Bind the variable to a new object initialized by its initializer, if 
+/// any. Returns the initial value.
+result
+evaluate_decl(evaluator& eval, const sys_fn::var_decl& d)
+{
+  value v;
+  if (d.has_initializer()) {
+    result r = try_evaluate(eval, d.get_initializer());
+    if (!r)
+      return r;
+    v = r.get_value();
+  }
+  eval.bind(d, v);
+  return v;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Statements
+
+/// Evaluate each statement in turn until one transfers control out of the
+/// block. The objects of variables declared in the block are released when 
+/// the block exits.
+control
+evaluate_stmt(evaluator& eval, const sys_fn::block_stmt& s)
+{
+  frame* f = eval.get_frame();
+  binding* top = f ? f->top_ : nullptr;
+  frame_stack::mark m = eval.stack_.get_mark();
+  control c = next_control;
+  for (const stmt& s1 : s.get_statements()) {
+    c = try_evaluate(eval, s1);
+    if (c != next_control)
+      break;
+  }
+  if (f) {
+    f->top_ = top;
+    eval.stack_.release(m);
+  }
+  return c;
+}
+
+control
+evaluate_stmt(evaluator& eval, const sys_fn::expr_stmt& s)
+{
+  if (!try_evaluate(eval, s.get_expression()))
+    return fail_control;
+  return next_control;
+}
+
+control
+evaluate_stmt(evaluator& eval, const sys_fn::decl_stmt& s)
+{
+  if (!try_evaluate(eval, s.get_declaration()))
+    return fail_control;
+  return next_control;
+}
+
+/// Initialize the return value of the current function. The returned 
+/// expression is in tail position; if it makes a tail call, the call is
+/// made after the function returns.
+control
+evaluate_stmt(evaluator& eval, const sys_fn::ret_stmt& s)
+{
+  frame* f = eval.get_frame();
+  if (!f) {
+    eval.fail("return outside of a function");
+    return fail_control;
+  }
+  eval.set_tail_position(&s.get_return());
+  result r = try_evaluate(eval, s.get_return());
+  eval.set_tail_position(nullptr);
+  if (!r)
+    return fail_control;
+  if (eval.tail_fn_)
+    return tail_control;
+  *f->ret_ = r.get_value();
+  return return_control;
+}
+
+} // namespace beaker
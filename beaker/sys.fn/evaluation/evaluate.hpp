@@ -0,0 +1,41 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_SYS_FN_EVALUATION_EVALUATE_HPP
+#define BEAKER_SYS_FN_EVALUATION_EVALUATE_HPP
+
+#include <beaker/sys.fn/fwd.hpp>
+
+#include <beaker/base/evaluation/evaluate.hpp>
+
+#include <vector>
+
+
+namespace beaker {
+
+// -------------------------------------------------------------------------- //
+// Function calls
+
+result try_call(evaluator&, const decl&, const std::vector<value>&);
+value call(evaluator&, const decl&, const std::vector<value>&);
+
+
+// -------------------------------------------------------------------------- //
+// Overrides
+
+result evaluate_expr(evaluator&, const sys_fn::call_expr&);
+result evaluate_expr(evaluator&, const sys_fn::eq_expr&);
+result evaluate_expr(evaluator&, const sys_fn::ne_expr&);
+
+result evaluate_decl(evaluator&, const sys_fn::fn_decl&);
+result evaluate_decl(evaluator&, const sys_fn::var_decl&);
+
+control evaluate_stmt(evaluator&, const sys_fn::block_stmt&);
+control evaluate_stmt(evaluator&, const sys_fn::expr_stmt&);
+control evaluate_stmt(evaluator&, const sys_fn::decl_stmt&);
+control evaluate_stmt(evaluator&, const sys_fn::ret_stmt&);
+
+} // namespace beaker
+
+
+#endif
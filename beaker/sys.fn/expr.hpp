@@ -30,29 +30,23 @@ struct call_expr : expr
 {
   static constexpr int node_kind = call_expr_kind;
 
-  call_expr(type&, expr&, const expr_seq&);
-  call_expr(type&, expr&, expr_seq&&);
+  call_expr(type&, expr&, const expr_span&);
 
   const expr& get_function() const;
   expr& get_function();
 
-  const expr_seq& get_arguments() const;
-  expr_seq& get_arguments();
+  const expr_span& get_arguments() const;
+  expr_span& get_arguments();
 
   expr* fn_;
-  expr_seq args_;
+  expr_span args_;
 };
 
 inline
-call_expr::call_expr(type& t, expr& f, const expr_seq& a)
+call_expr::call_expr(type& t, expr& f, const expr_span& a)
   : expr(node_kind, t), fn_(&f), args_(a)
 { }
 
-inline
-call_expr::call_expr(type& t, expr& f, expr_seq&& a)
-  : expr(node_kind, t), fn_(&f), args_(std::move(a))
-{ }
-
 // Returns the called function.
 inline const expr& call_expr::get_function() const { return *fn_; }
 
@@ -60,10 +54,10 @@ inline const expr& call_expr::get_function() const { return *fn_; }
 inline expr& call_expr::get_function() { return *fn_; }
 
 // Returns the sequence of call arguments.
-inline const expr_seq& call_expr::get_arguments() const { return args_; }
+inline const expr_span& call_expr::get_arguments() const { return args_; }
 
 // Returns the sequence of call arguments.
-inline expr_seq& call_expr::get_arguments() { return args_; }
+inline expr_span& call_expr::get_arguments() { return args_; }
 
 
 /// Represents the expression `e1 == e2`.
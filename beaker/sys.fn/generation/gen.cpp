@@ -8,79 +8,67 @@
 #include "../stmt.hpp"
 
 #include <beaker/sys.void/type.hpp>
-#include <beaker/util/symbol.hpp>
 
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Argument.h>
 
-#include <sstream>
-
 
 namespace beaker {
-namespace sys_fn {
-
-/// Generate the return type of a function type.
-static cg::type
-generate_return_type(generator& gen, const type& t, std::vector<llvm::Type*>& parms)
-{
-  cg::type ret = generate(gen, t);
-  if (is_object_type(t)) {
-    // The function has a return value whose type is indirect, then adjust the 
-    // function to accept that value as an argument and make the function void.
-    if (ret.is_indirect()) {
-      ret = llvm::PointerType::getUnqual(ret);
-      parms.push_back(ret);
-      ret = llvm::Type::getVoidTy(gen.get_context());
-    }
-  }
-  return ret;
-}
 
-/// Generate a parameter type of a function type.
-static cg::type
-generate_parm_type(generator& gen, const type& t, std::vector<llvm::Type*>& parms)
-{
-  cg::type parm = generate(gen, t);
-  if (is_object_type(t)) {
-    // Passing by value and passing require similar adjustments. If the 
-    // parameter type is indirect, adjust the type to be passed indirectly.
-    if (parm.is_indirect())
-      parm = llvm::PointerType::getUnqual(parm);
-  }
-  parms.push_back(parm);
-  return parm;
-}
+// -------------------------------------------------------------------------- //
+// Types
 
-/// Generates a function type.
-static cg::type
-generate_fn_type(generator& gen, const fn_type& t)
+/// Generates a function type. Checked functions accept a pointer to the
+/// status as their first argument. All parameter and return types are 
+/// passed directly.
+cg::type
+generate_type(generator& gen, const sys_fn::fn_type& t)
 {
   std::vector<llvm::Type*> parms;
-  
-  // Generate the return type.
-  cg::type ret = generate_return_type(gen, t.get_return_type(), parms);
-  
-  // Generate parameter types.
+  if (gen.is_checked())
+    parms.push_back(llvm::Type::getInt32PtrTy(gen.get_context()));
   for (const type& p : t.get_parameter_types())
-    generate_parm_type(gen, p, parms);
-
-  // Create and annotate the function type.
+    parms.push_back(generate(gen, p));
+  cg::type ret = generate(gen, t.get_return_type());
   return llvm::FunctionType::get(ret, parms, false);
 }
 
-// Generate a common type from t.
-cg::type
-gen_algo::operator()(generator& gen, const type& t) const
+
+// -------------------------------------------------------------------------- //
+// Expressions
+
+/// Generate a call expression. Arguments are initialized directly. After
+/// a call in checked code, a failure in the callee returns from the caller.
+///
+/// TODO: Consider how exceptions should be handled. If the function can
+/// propagate C++ exceptions, then we'll need to establish (or have established)
+/// a landing pad. If the language has no exceptions, then call is sufficient.
+cg::value
+generate_expr(generator& gen, const sys_fn::call_expr& e)
 {
-  assert(is<fn_type>(t));
-  return generate_fn_type(gen, cast<fn_type>(t));
-}
+  const expr& f = e.get_function();
+  llvm::Type* type = generate(gen, f.get_type());
+  cg::value fn = generate(gen, f);
 
+  std::vector<llvm::Value*> args;
+  if (gen.is_checked())
+    args.push_back(gen.get_status());
+  for (const expr& a : e.get_arguments()) {
+    generator::init_guard guard(gen, nullptr);
+    args.push_back(generate(gen, a));
+  }
 
-static cg::value generate_call_expr(generator& gen, const call_expr&);
+  llvm::Builder ir(gen.get_current_block());
+  llvm::Value* ret = ir.CreateCall(llvm::cast<llvm::FunctionType>(type), fn, args);
+  gen.make_status_check();
+  if (sys_void::is_void_type(e.get_type()))
+    return nullptr;
+  return ret;
+}
 
-static cg::value
-generate_eq_expr(generator& gen, const eq_expr& e)
+/// Functions are equal when they have the same address.
+cg::value
+generate_expr(generator& gen, const sys_fn::eq_expr& e)
 {
   cg::value v1 = generate(gen, e.get_lhs());
   cg::value v2 = generate(gen, e.get_rhs());
@@ -88,100 +76,205 @@ generate_eq_expr(generator& gen, const eq_expr& e)
   return ir.CreateICmpEQ(v1, v2);
 }
 
-static cg::value
-generate_ne_expr(generator& gen, const ne_expr& e)
+/// Functions are unequal when they have different addresses.
+cg::value
+generate_expr(generator& gen, const sys_fn::ne_expr& e)
 {
   cg::value v1 = generate(gen, e.get_lhs());
   cg::value v2 = generate(gen, e.get_rhs());
   llvm::Builder ir(gen.get_current_block());
-  return ir.CreateICmpEQ(v1, v2);  
+  return ir.CreateICmpNE(v1, v2);  
 }
 
-// Generate an LLVM instruction for the common expression e.
+
+// -------------------------------------------------------------------------- //
+// Declarations
+
+/// Declares the function `d`, binding it to an LLVM function. A function is
+/// declared at most once.
+///
+/// TODO: We probably want an explicit notion of name linkage so that we can 
+/// make better decisions about the linkage of the function.
 cg::value
-gen_algo::operator()(generator& gen, const expr& e) const
-{
-  switch (e.get_kind()) {
-#define def_expr(E) \
-    case E ## _expr_kind: \
-      return generate_## E ##_expr(gen, cast<E ## _expr>(e));
-#include "../expr.def"
-    default:
-      break;
+declare_decl(generator& gen, const sys_fn::fn_decl& d)
+{
+  if (gen.seen_decl(d))
+    return gen.get_value(d);
+  llvm::Type* type = generate(gen, d.get_type());
+  llvm::Function* fn = llvm::Function::Create(
+    llvm::cast<llvm::FunctionType>(type), 
+    llvm::Function::ExternalLinkage, 
+    gen.get_symbol(d), 
+    &gen.get_module()
+  );
+  gen.put_value(d, fn);
+  return fn;
+}
+
+namespace sys_fn {
+
+/// Initialize the object at `ptr` with e. If e is not an initializer, its
+/// value is stored in the object.
+static void
+generate_init(generator& gen, llvm::Value* ptr, const expr& e)
+{
+  generator::init_guard guard(gen, ptr);
+  cg::value val = generate(gen, e);
+  if (val && val != ptr) {
+    llvm::Builder ir(gen.get_current_block());
+    ir.CreateStore(val, ptr);
+  }
+}
+
+/// Bind the parameters of d to the arguments of the current function. 
+/// Parameters of object type are copied into local storage. References are 
+/// bound directly to their arguments.
+static void
+generate_parms(generator& gen, const fn_decl& d)
+{
+  llvm::Function* fn = gen.get_function();
+  auto ai = fn->arg_begin();
+  if (gen.is_checked())
+    ++ai;
+  for (const decl& p : d.get_parameters()) {
+    llvm::Argument& arg = *ai++;
+    const type& t = get_declared_type(p);
+    if (is_object_type(t)) {
+      cg::value ptr = gen.make_alloca(generate(gen, t), "parm");
+      llvm::Builder ir(gen.get_current_block());
+      ir.CreateStore(&arg, ptr);
+      gen.put_value(p, ptr);
+    }
+    else {
+      gen.put_value(p, &arg);
+    }
+  }
+}
+
+/// Allocate local storage for the return value of d, if any.
+static void
+generate_return(generator& gen, const fn_decl& d)
+{
+  const type& t = d.get_return_type();
+  if (sys_void::is_void_type(t))
+    return;
+  if (!is_object_type(t))
+    throw generation_error("return by reference not supported");
+  cg::value ptr = gen.make_alloca(generate(gen, t), "ret");
+  gen.set_return_value(ptr);
+  gen.put_value(d.get_return(), ptr);
+}
+
+/// Generate the body of d. Falling off the end of the function returns.
+static void
+generate_body(generator& gen, const fn_decl& d)
+{
+  generate(gen, d.get_definition());
+  llvm::BasicBlock* last = gen.get_current_block();
+  if (!last->getTerminator()) {
+    llvm::Builder ir(last);
+    ir.CreateBr(gen.get_exit_block());
+  }
+}
+
+// Generate the final return from the function.
+static void
+generate_exit(generator& gen, const fn_decl& d)
+{
+  gen.set_current_block(gen.get_exit_block());
+  llvm::Builder ir(gen.get_current_block());
+  if (llvm::Value* ptr = gen.get_return_value()) {
+    llvm::Type* t = gen.get_function()->getReturnType();
+    ir.CreateRet(ir.CreateLoad(t, ptr));
+  }
+  else {
+    ir.CreateRetVoid();
   }
-  assert(false && "expression not supported");
 }
 
+} // namespace sys_fn
 
-static cg::value generate_fn_decl(generator&, const fn_decl&);
+/// Generate the function d and its definition, if any.
+cg::value
+generate_decl(generator& gen, const sys_fn::fn_decl& d)
+{
+  llvm::Function* fn = llvm::cast<llvm::Function>(declare(gen, d).val_);
+  if (!d.has_definition() || !fn->empty())
+    return fn;
+  gen.define_function(fn);
+  gen.set_return_value(nullptr);
+  sys_fn::generate_parms(gen, d);
+  sys_fn::generate_return(gen, d);
+  sys_fn::generate_body(gen, d);
+  sys_fn::generate_exit(gen, d);
+  gen.end_function();
+  return fn;
+}
 
-// Generate an LLVM declaration from the common declaration d.
-//
-// Note that parameter declarations can only appear in function declarations
-// and are generated explicitly in generate_fn_decl.
+/// Generate a local variable. Objects are allocated in the entry block and
+/// initialized at the current instruction. References are bound to the 
+/// address computed by their initializer.
 cg::value
-gen_algo::operator()(generator& gen, const decl& d) const
+generate_decl(generator& gen, const sys_fn::var_decl& d)
 {
-  assert(is<fn_decl>(d));
-  return generate_fn_decl(gen, cast<fn_decl>(d));
+  if (!d.has_automatic_storage())
+    throw generation_error("global variables not supported");
+  const type& t = d.get_type();
+  if (is_object_type(t)) {
+    cg::value ptr = gen.make_alloca(generate(gen, t), "var");
+    gen.put_value(d, ptr);
+    if (d.has_initializer())
+      sys_fn::generate_init(gen, ptr, d.get_initializer());
+    return ptr;
+  }
+  else {
+    generator::init_guard guard(gen, nullptr);
+    cg::value ptr = generate(gen, d.get_initializer());
+    gen.put_value(d, ptr);
+    return ptr;
+  }
 }
 
 
+// -------------------------------------------------------------------------- //
+// Statements
+
 /// Generate each of the statements in turn.
 ///
 /// A block statement establishes a new declaration context.
-static void
-generate_block_stmt(generator& gen, const block_stmt& s)
+void
+generate_stmt(generator& gen, const sys_fn::block_stmt& s)
 {
   generator::decl_context_guard guard(gen);
   for (const stmt& s1 : s.get_statements())
     generate(gen, s1);
 }
 
-static inline void
-generate_expr_stmt(generator& gen, const expr_stmt& s)
+void
+generate_stmt(generator& gen, const sys_fn::expr_stmt& s)
 {
+  generator::init_guard guard(gen, nullptr);
   generate(gen, s.get_expression());
 }
 
-static inline void
-generate_decl_stmt(generator& gen, const decl_stmt& s)
+void
+generate_stmt(generator& gen, const sys_fn::decl_stmt& s)
 {
   generate(gen, s.get_declaration());
 }
 
-// Generate code for the statement `return e`.
+/// Initialize the return value and jump to the exit block. Code following
+/// the return is emitted into a new (unreachable) block.
 void
-generate_ret_stmt(generator& gen, const ret_stmt& s)
-{
-  cg::value ret = gen.get_return_value();
-  
-  // Initialize the return value. No special cases are needed for void returns.
-  generator::init_guard guard(gen, ret);
-  generate(gen, s.get_return());
-  
-  // And jump to the exit block.
+generate_stmt(generator& gen, const sys_fn::ret_stmt& s)
+{
+  if (llvm::Value* ptr = gen.get_return_value())
+    sys_fn::generate_init(gen, ptr, s.get_return());
+  else
+    generate(gen, s.get_return());
   llvm::Builder ir(gen.get_current_block());
   ir.CreateBr(gen.get_exit_block());
+  gen.set_current_block(llvm::BasicBlock::Create(gen.get_context(), "ret.cont"));
 }
 
-void
-gen_algo::operator()(generator& gen, const stmt& s) const
-{
-  switch (s.get_kind()) {
-#define def_stmt(S) \
-    case S ## _stmt_kind: \
-      return generate_## S ##_stmt(gen, cast<S ##_stmt>(s));
-#include "../stmt.def"
-    default:
-      break;
-  }
-  assert(false && "not a sys_fn statement");
-}
-
-} // namespace sys_fn
 } // namespace beaker
-
-
-#include "gen_call.cpp"
-#include "gen_fn.cpp"
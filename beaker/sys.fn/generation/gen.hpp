@@ -4,21 +4,32 @@
 #ifndef BEAKER_SYS_FN_GENERATION_GEN_HPP
 #define BEAKER_SYS_FN_GENERATION_GEN_HPP
 
+#include <beaker/sys.fn/fwd.hpp>
+
 #include <beaker/base/generation/generation.hpp>
 
 
 namespace beaker {
-namespace sys_fn {
 
-struct gen_algo : generate_algorithm
-{
-  cg::type operator()(generator&, const type&) const;
-  cg::value operator()(generator&, const expr&) const;
-  cg::value operator()(generator&, const decl&) const;
-  void operator()(generator&, const stmt&) const;
-};
+// -------------------------------------------------------------------------- //
+// Overrides
+
+cg::type generate_type(generator&, const sys_fn::fn_type&);
+
+cg::value generate_expr(generator&, const sys_fn::call_expr&);
+cg::value generate_expr(generator&, const sys_fn::eq_expr&);
+cg::value generate_expr(generator&, const sys_fn::ne_expr&);
+
+cg::value declare_decl(generator&, const sys_fn::fn_decl&);
+
+cg::value generate_decl(generator&, const sys_fn::fn_decl&);
+cg::value generate_decl(generator&, const sys_fn::var_decl&);
+
+void generate_stmt(generator&, const sys_fn::block_stmt&);
+void generate_stmt(generator&, const sys_fn::expr_stmt&);
+void generate_stmt(generator&, const sys_fn::decl_stmt&);
+void generate_stmt(generator&, const sys_fn::ret_stmt&);
 
-} // namespace sys_fn
 } // namespace beaker
 
 
@@ -1,204 +0,0 @@
-// Copyright (c) 2015-2017 Andrew Sutton
-// All rights reserved
-
-namespace beaker {
-namespace sys_fn {
-
-using arg_iterator = llvm::Function::arg_iterator;
-
-// If needed, adjust parameter information the return type. Returns an iterator
-// referring to the first non-parameter function.
-static arg_iterator
-adjust_return_parm(generator& gen, const decl& d)
-{
-  llvm::Function* fn = gen.get_function();
-  arg_iterator ai = fn->arg_begin();
- 
-  const type& t = get_declared_type(d);
-  if (is_object_type(t)) {
-    cg::type ret = generate(gen, t);
-    if (ret.is_indirect()) {
-      // If the return type is indirect, the first parameter is the caller's
-      // return object. The first actual argument is past this return.
-      llvm::Argument& arg = *ai++;
-      std::string name = generate(gen, get_declaration_name(d));
-      arg.setName(name);
-
-      // Indicate that the return value is a struct return. 
-      //
-      // TODO: Is this actually valid on non-struct types?
-      fn->addAttribute(arg.getArgNo() + 1, llvm::Attribute::StructRet);
-
-      // Set the return value.
-      gen.set_return_value(&arg);
-    }
-    else {
-      // Allocate a local return value.
-      //
-      // FIXME: If the function is defined by an expression, then we don't
-      // need to generate the object.
-      cg::type ret = generate(gen, t);
-      std::string name = generate(gen, get_declaration_name(d));
-      cg::value ptr = gen.make_alloca(ret, name);
-
-      // Set the return value.
-      gen.set_return_value(ptr);
-    }
-  }
-  return ai;
-}
-
-static void
-adjust_function_parm(generator& gen, const decl& d, arg_iterator ai)
-{
-  llvm::Function* fn = gen.get_function();
-  llvm::Argument& arg = *ai;
-
-  // Set the name of the argument and create a binding for it.
-  std::string name = generate(gen, get_declaration_name(d));
-  arg.setName(name);
-
-  const type& t = get_declared_type(d);
-  if (is_object_type(t)) {
-    cg::type type = generate(gen, t);
-    if (type.is_indirect()) {
-      // Note that byval implies that a copy has actually been created
-      // and that the calling function is free to modify it. When types
-      // are passed directly, the copy is made by the callee.
-      //
-      // TODO: nonnull is not sufficiently strong for indirect arguments.
-      // It should be dereferenceable.
-      //
-      // TODO: If the parameter is const, then we should be able to omit
-      // the copy, because the callee is not permitted to modify it. However,
-      // we don't have const types in core.
-      fn->addAttribute(arg.getArgNo() + 1, llvm::Attribute::ByVal);
-      fn->addAttribute(arg.getArgNo() + 1, llvm::Attribute::NonNull);
-
-      // Bind the parameter directly to the argument.
-      gen.put_value(d, &arg);
-    }
-    else {
-      // Create local storage for the parameter variable. Note that we don't 
-      // need complex initialization because the argument is passed directly.
-      std::stringstream ss;
-      cg::value ptr = gen.make_alloca(type, "var." + name);
-      llvm::Builder ir(gen.get_current_block());
-      ir.CreateStore(&arg, ptr);
-      
-      // Bind the parameter to the automatic storage.
-      gen.put_value(d, ptr);
-    }
-  }
-  else if (is_reference_type(t)) {
-    // Arguments passed by reference are guaranteed to be nonnull.
-    //
-    // TODO: See above. This is also dereferenceable.
-    fn->addAttribute(arg.getArgNo() + 1, llvm::Attribute::NonNull);
-
-    // Bind the parameter directly to the argument.
-    gen.put_value(d, &arg);
-  }
-}
-
-
-// Generate formal parameters.
-static void
-generate_parms(generator& gen, const fn_decl& d)
-{
-  // Adjust the return parameter if needed.
-  auto ai = adjust_return_parm(gen, d.get_return());
-
-  // Generate/annotate each parameter in turn.
-  for (const decl& parm : d.get_parameters())
-    adjust_function_parm(gen, parm, ai++);
-}
-
-/// Generate the function definition.
-static void
-generate_body(generator& gen, const fn_decl& d)
-{
-  // Generate the statement body.
-  generate(gen, d.get_definition());
-
-  // Insert a terminator, if needed.
-  llvm::BasicBlock* last = gen.get_current_block();
-  if (!last->getTerminator()) {
-    llvm::Builder ir(last);
-    ir.CreateBr(gen.get_exit_block());
-  }
-}
-
-// Generate the final return from the function.
-static void
-generate_exit(generator& gen, const fn_decl& d)
-{
-  llvm::Builder ir(gen.get_exit_block());    
-
-  const type& t = d.get_return_type();
-  if (sys_void::is_void_type(t)) {
-    // For void returns, do nothing.
-    ir.CreateRetVoid();
-  }
-  else if (is_object_type(t)) {
-    // Return by value depends on whether the return is direct or indirect.
-    cg::type ret = generate(gen, t);
-    if (ret.is_direct()) {
-      // Load the value so it can be returned directly.
-      cg::value ret = ir.CreateLoad(gen.get_return_value());
-      ir.CreateRet(ret);
-    }
-    else {
-      // We've stored the return value in the caller's frame. Just exit.
-      ir.CreateRetVoid();
-    }
-  }
-  else {
-    assert(false && "return by reference not implemented");
-  }
-}
-
-// Generate a function definition.
-static void
-generate_fn_def(generator& gen, const fn_decl& d, llvm::Function* f)
-{
-  if (!d.has_definition())
-    return;
-  gen.define_function(f);
-  generate_parms(gen, d);
-  generate_body(gen, d);  
-  generate_exit(gen, d);
-  gen.end_function();
-}
-
-// Generate an LLVM function from d.
-static cg::value
-generate_fn_decl(generator& gen, const fn_decl& d)
-{
-  std::string name = generate(gen, d.get_name());
-
-  // Determine the linkage of the name.
-  //
-  // TODO: We probably want an explicit notion of name linkage so
-  // that we can make better decisions here.
-  llvm::Function::LinkageTypes linkage = llvm::Function::ExternalLinkage;
-
-  // Get the function type.
-  llvm::Type* type = generate(gen, d.get_type());
-
-  // Create and declare the function.
-  llvm::Function* fn = llvm::Function::Create(
-    llvm::cast<llvm::FunctionType>(type), 
-    linkage, 
-    name, 
-    &gen.get_module()
-  );
-  gen.put_value(d, fn);
-
-  // Emit the definition (if needed).
-  generate_fn_def(gen, d, fn);
-  return fn;
-}
-
-} // namespace sys_fn
-} // namespace beaker
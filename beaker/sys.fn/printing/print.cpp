@@ -15,7 +15,7 @@ void
 print_type(pretty_printer& pp, const sys_fn::fn_type& t)
 {
   pp.print('(');
-  const type_seq& parms = t.get_parameter_types();
+  const type_span& parms = t.get_parameter_types();
   for (auto iter = parms.begin(); iter != parms.end(); ++iter) {
     print(pp, *iter);
     if (std::next(iter) != parms.end())
@@ -32,7 +32,7 @@ print_expr(pretty_printer& pp, const sys_fn::call_expr& e)
 {
   print(pp, e.get_function());
   pp.print('(');
-  const expr_seq& args = e.get_arguments();
+  const expr_span& args = e.get_arguments();
   for (auto iter = args.begin(); iter != args.end(); ++iter) {
     print(pp, *iter);
     if (std::next(iter) != args.end())
@@ -60,7 +60,7 @@ print_decl(pretty_printer& pp, const sys_fn::fn_decl& d)
   pp.print_space();
   print(pp, d.get_name());
   pp.print('(');
-  decl_seq const& parms = d.get_parameters();
+  decl_span const& parms = d.get_parameters();
   for (auto iter = parms.begin(); iter != parms.end(); ++iter) {
     print(pp, *iter);
     if (std::next(iter) != parms.end())
@@ -108,7 +108,7 @@ print_decl(pretty_printer& pp, const sys_fn::var_decl& d)
 void
 print_stmt(pretty_printer& pp, const sys_fn::block_stmt& s)
 {
-  const stmt_seq& ss = s.get_statements();
+  const stmt_span& ss = s.get_statements();
   pp.print('{');
   if (!ss.is_empty())
     pp.indent();
@@ -27,30 +27,24 @@ struct block_stmt : stmt
 {
   static constexpr int node_kind = block_stmt_kind;
 
-  block_stmt(const stmt_seq&);
-  block_stmt(stmt_seq&&);
+  block_stmt(const stmt_span&);
 
-  const stmt_seq& get_statements() const;
-  stmt_seq& get_statements();
+  const stmt_span& get_statements() const;
+  stmt_span& get_statements();
 
-  stmt_seq stmts_;
+  stmt_span stmts_;
 };
 
 inline
-block_stmt::block_stmt(const stmt_seq& s)
+block_stmt::block_stmt(const stmt_span& s)
  : stmt(node_kind), stmts_(s)
  { }
 
-inline
-block_stmt::block_stmt(stmt_seq&& s) 
-: stmt(node_kind), stmts_(std::move(s))
-{ }
-
 /// Returns the sequence of statements in the block.
-inline const stmt_seq& block_stmt::get_statements() const { return stmts_; }
+inline const stmt_span& block_stmt::get_statements() const { return stmts_; }
 
 /// Returns the sequence of statements in the block.
-inline stmt_seq& block_stmt::get_statements() { return stmts_; }
+inline stmt_span& block_stmt::get_statements() { return stmts_; }
 
 
 /// Represents the statement `e;`.
@@ -23,36 +23,30 @@ enum
 /// describes entities that map inputs to outputs.
 struct fn_type : function_type_impl<fn_type_kind>
 {
-  fn_type(const type_seq&, type&);
-  fn_type(type_seq&&, type&);
+  fn_type(const type_span&, type&);
 
-  const type_seq& get_parameter_types() const;
-  type_seq& get_parameter_types();
+  const type_span& get_parameter_types() const;
+  type_span& get_parameter_types();
 
   const type& get_return_type() const;
   type& get_return_type();
 
-  type_seq parms_;
+  type_span parms_;
   type* ret_;
 };
 
 // Initialize the function type with parameters p and return type t.
 inline
-fn_type::fn_type(const type_seq& p, type& t)
+fn_type::fn_type(const type_span& p, type& t)
   : function_type_impl<node_kind>(), parms_(p), ret_(&t)
 { }
 
 // Initialize the function type with parameters p and return type t.
-inline
-fn_type::fn_type(type_seq&& p, type& t)
-  : function_type_impl<node_kind>(), parms_(std::move(p)), ret_(&t)
-{ }
-
 // Returns the sequence of parameter types.
-inline const type_seq& fn_type::get_parameter_types() const { return parms_; }
+inline const type_span& fn_type::get_parameter_types() const { return parms_; }
 
 // Returns the sequence of parameter types.
-inline type_seq& fn_type::get_parameter_types() { return parms_; }
+inline type_span& fn_type::get_parameter_types() { return parms_; }
 
 // Returns the return type.
 inline const type& fn_type::get_return_type() const { return *ret_; }
@@ -80,6 +74,10 @@ get_return_type(type& t)
 }
 
 } // namespace sys_fn
+
+/// Function types are canonical.
+template<> struct is_canonical_term<sys_fn::fn_type> : std::true_type { };
+
 } // namespace beaker
 
 
@@ -19,9 +19,9 @@ get_logic_builder(module& m)
 
 builder::builder(module& m)
   : factory(m),
-    nat_(&make_canonical_set<nat_type>(get_language_allocator())),
-    int_(&make_canonical_set<int_type>(get_language_allocator())),
-    mod_(&make_canonical_set<mod_type>(get_language_allocator()))
+    nat_(&get_canonical_set<nat_type>(get_language_allocator())),
+    int_(&get_canonical_set<int_type>(get_language_allocator())),
+    mod_(&get_canonical_set<mod_type>(get_language_allocator()))
 { }
 
 // Returns true when p is an acceptable integer type.
@@ -69,24 +69,28 @@ builder::get_mod_type(int p)
   return mod_->get(p);
 }
 
+// Values are checked as wide integers, which also covers types of 128 bits.
+// Word-sized values are interpreted by the type (see value).
+
 static inline bool
-check_nat_value(const nat_type& t, std::uintmax_t n)
+check_nat_value(const nat_type& t, const value& v)
 {
-  return t.min() <= n && n <= t.max();
+  return v.get_wide_natural() <= t.wide_max();
 }
 
 static inline bool
-check_int_value(const int_type& t, std::intmax_t n)
+check_int_value(const int_type& t, const value& v)
 {
-  return t.min() <= n && n <= t.max();
+  wide_integer n = v.get_wide();
+  return t.wide_min() <= n && n <= t.wide_max();
 }
 
 // FIXME: If the value exceeds the representation, why don't we just apply
 // the modulus to make it wrap?
 static inline bool
-check_mod_value(const mod_type& t, std::uintmax_t n)
+check_mod_value(const mod_type& t, const value& v)
 {
-  return t.min() <= n && n <= t.max();
+  return v.get_wide_natural() <= t.wide_max();
 }
 
 static bool
@@ -94,22 +98,40 @@ check_value(const type& t, const value& v)
 {
   switch (t.get_kind()) {
     case nat_type_kind:
-      return check_nat_value(cast<nat_type>(t), v.get_int());
+      return check_nat_value(cast<nat_type>(t), v);
     case int_type_kind:
-      return check_int_value(cast<int_type>(t), v.get_int());
+      return check_int_value(cast<int_type>(t), v);
     case mod_type_kind:
-      return check_mod_value(cast<mod_type>(t), v.get_int());
+      return check_mod_value(cast<mod_type>(t), v);
   }
   assert(false && "not an integer type");
 }
 
+/// Returns the value `v` in the representation of values of type `t`. 
+/// Values of word-sized types are the bits of a word. Values of wider types
+/// are small only when they fit in a signed word, so that equal literals
+/// have equal values.
+static value
+normalize_value(const type& t, const value& v)
+{
+  if (!is_wide_type(t)) {
+    if (v.is_small())
+      return v;
+    return value(std::uintmax_t(v.get_wide_natural()));
+  }
+  if (t.get_kind() == int_type_kind)
+    return value(v.get_wide());
+  else
+    return value(v.get_wide_natural());
+}
+
 int_expr&
 builder::make_int_expr(type& t, const value& v)
 {
   assert(is_integral_type(t));
   assert(v.is_integer());
   assert(check_value(t, v));
-  return make<int_expr>(t, v);
+  return make<int_expr>(t, normalize_value(t, v));
 }
 
 int_expr&
@@ -118,7 +140,7 @@ builder::make_int_expr(type& t, value&& v)
   assert(is_integral_type(t));
   assert(v.is_integer());
   assert(check_value(t, v));
-  return make<int_expr>(t, std::move(v));
+  return make<int_expr>(t, normalize_value(t, v));
 }
 
 /// Returns the integer literal `n` with type t. The type of the expression 
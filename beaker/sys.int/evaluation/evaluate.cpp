@@ -7,389 +7,269 @@
 
 #include <beaker/base/printing/print.hpp>
 
+#include <functional>
 #include <iostream>
 
 
 namespace beaker {
 
 /// Evaluate the literal expression `e`.
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::int_expr& e)
 {
   return e.get_value();
 }
 
-value
+namespace sys_int {
+
+/// Returns true if `t` is an integral type whose values are wider than a
+/// machine word.
+static inline bool
+is_wide(const type& t)
+{
+  return get_kernel(t).wide_;
+}
+
+/// Returns the value `v` of type `t` as a 128-bit integer. Unsigned values
+/// are returned as the bits of their value.
+static inline wide_integer
+get_wide(const type& t, const value& v)
+{
+  if (t.get_kind() == int_type_kind)
+    return v.get_wide();
+  else
+    return v.get_wide_natural();
+}
+
+/// Returns the 128-bit integer `n` as a value of type `t`.
+static inline value
+make_wide(const type& t, wide_integer n)
+{
+  if (t.get_kind() == int_type_kind)
+    return value(n);
+  else
+    return value(wide_natural(n));
+}
+
+/// Compare the operands of `e` using the comparison `cmp`. Values of 
+/// unsigned types are compared as unsigned integers, and values of types
+/// wider than a machine word are compared as 128-bit integers.
+template<typename C>
+static inline result
+eval_compare(evaluator& eval, const binary_expr& e, C cmp)
+{
+  result r1 = try_evaluate(eval, e.get_lhs());
+  if (!r1)
+    return r1;
+  result r2 = try_evaluate(eval, e.get_rhs());
+  if (!r2)
+    return r2;
+  const value& v1 = r1.get_value();
+  const value& v2 = r2.get_value();
+  const type& t = e.get_lhs().get_type();
+  if (!is_wide(t)) {
+    if (is_unsigned_type(t)) {
+      std::uintmax_t n1 = v1.get_int();
+      std::uintmax_t n2 = v2.get_int();
+      return value(cmp(n1, n2));
+    }
+    return value(cmp(v1.get_int(), v2.get_int()));
+  }
+  if (t.get_kind() == int_type_kind)
+    return value(cmp(v1.get_wide(), v2.get_wide()));
+  else
+    return value(cmp(v1.get_wide_natural(), v2.get_wide_natural()));
+}
+
+} // namespace sys_int
+
+result
 evaluate_expr(evaluator& eval, const sys_int::eq_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() == v2.get_int());
+  return sys_int::eval_compare(eval, e, std::equal_to<>());
 }
 
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::ne_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() != v2.get_int());
+  return sys_int::eval_compare(eval, e, std::not_equal_to<>());
 }
 
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::lt_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() < v2.get_int());
+  return sys_int::eval_compare(eval, e, std::less<>());
 }
 
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::gt_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() > v2.get_int());
+  return sys_int::eval_compare(eval, e, std::greater<>());
 }
 
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::le_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() <= v2.get_int());
+  return sys_int::eval_compare(eval, e, std::less_equal<>());
 }
 
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::ge_expr& e)
 {
-  value v1 = evaluate(eval, e.get_lhs());
-  value v2 = evaluate(eval, e.get_rhs());
-  return value(v1.get_int() >= v2.get_int());
+  return sys_int::eval_compare(eval, e, std::greater_equal<>());
 }
 
 
 // -------------------------------------------------------------------------- //
-// Addition
+// Arithmetic
+//
+// Arithmetic is performed by the kernel of the expression's type, which
+// computes at the native width of the type. Types wider than a machine word
+// are computed by their wide kernel; the test for a wide kernel is the only
+// cost of wide arithmetic for word-sized types.
 
 namespace sys_int {
 
-template<typename T>
-static value
-add_overflow(evaluator& eval, const add_expr& e, const T& t)
-{
-  using int_t = typename T::rep_type;
-  int_t a = evaluate(eval, e.get_lhs()).get_int();
-  int_t b = evaluate(eval, e.get_rhs()).get_int();
-  if (a > t.max() - b)
-    throw overflow_error(e);
-  return value(a + b);
-}
-
-static value
-add_modular(evaluator& eval, const add_expr& e, const mod_type& t)
-{
-  std::uintmax_t a = evaluate(eval, e.get_lhs()).get_int();
-  std::uintmax_t b = evaluate(eval, e.get_rhs()).get_int();
-  return value((a + b) % t.mod());
-}
-
-value
-evaluate(evaluator& eval, const add_expr& e)
+/// Returns the value `r` computed for `e`, or the failure indicated by the
+/// status `s`.
+static inline result
+check_result(evaluator& eval, const expr& e, arith_status s, std::intmax_t r)
 {
-  const type& t = e.get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind: return add_overflow(eval, e, cast<nat_type>(t));
-    case int_type_kind: return add_overflow(eval, e, cast<int_type>(t));
-    case mod_type_kind: return add_modular(eval, e, cast<mod_type>(t));
+  switch (s) {
+    case arith_ok: return value(r);
+    case arith_overflow: return eval.fail<overflow_error>(e);
+    case arith_division: return eval.fail<division_error>(e);
   }
-  assert(false && "not an integer expression");
-}
-
-} // namespace sys_int
-
-value
-evaluate_expr(evaluator& eval, const sys_int::add_expr& e)
-{
-  return sys_int::evaluate(eval, e);
-}
-
-
-// -------------------------------------------------------------------------- //
-// Subtraction
-
-namespace sys_int {
-
-template<typename T>
-static value
-sub_overflow(evaluator& eval, const sub_expr& e, const T& t)
-{
-  using int_t = typename T::rep_type;
-  int_t a = evaluate(eval, e.get_lhs()).get_int();
-  int_t b = evaluate(eval, e.get_rhs()).get_int();
-  if (a < t.min() + b)
-    throw overflow_error(e);
-  return value(a - b);
-}
-
-static value
-sub_modular(evaluator& eval, const sub_expr& e, const mod_type& t)
-{
-  std::uintmax_t a = evaluate(eval, e.get_lhs()).get_int();
-  std::uintmax_t b = evaluate(eval, e.get_rhs()).get_int();
-  // FIXME: Is this right?
-  return value((a - b) % t.mod());
+  assert(false && "invalid arithmetic status");
 }
 
-value
-evaluate(evaluator& eval, const sub_expr& e)
+/// Returns the value `r` of type `t` computed for `e`, or the failure 
+/// indicated by the status `s`.
+static result
+check_wide_result(evaluator& eval, const expr& e, arith_status s, wide_integer r)
 {
-  const type& t = e.get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind: return sub_overflow(eval, e, cast<nat_type>(t));
-    case int_type_kind: return sub_overflow(eval, e, cast<int_type>(t));
-    case mod_type_kind: return sub_modular(eval, e, cast<mod_type>(t));
+  switch (s) {
+    case arith_ok: return make_wide(e.get_type(), r);
+    case arith_overflow: return eval.fail<overflow_error>(e);
+    case arith_division: return eval.fail<division_error>(e);
   }
-  assert(false && "not an integer expression");
-}
-
-} // namespace sys_int
-
-value
-evaluate_expr(evaluator& eval, const sys_int::sub_expr& e)
-{
-  return sys_int::evaluate(eval, e);
-}
-
-
-// -------------------------------------------------------------------------- //
-// Multiplication
-
-namespace sys_int {
-
-static value
-mul_nat(evaluator& eval, const mul_expr& e, const nat_type& t)
-{
-  std::uintmax_t a = evaluate(eval, e.get_lhs()).get_int();
-  std::uintmax_t b = evaluate(eval, e.get_rhs()).get_int();
-  if (a > t.max() / b)
-    throw overflow_error(e);
-  return value(a * b);
+  assert(false && "invalid arithmetic status");
 }
 
-static value
-mul_int(evaluator& eval, const mul_expr& e, const int_type& t)
+/// Evaluate the binary expression `e` using the wide kernel operation `op`.
+static result
+eval_wide_binary(evaluator& eval, const binary_expr& e, wide_kernel::binary_fn wide_kernel::* op)
 {
-  std::intmax_t a = evaluate(eval, e.get_lhs()).get_int();
-  std::intmax_t b = evaluate(eval, e.get_rhs()).get_int();
-  if (b > 0 && a > t.max() / b)
-    throw overflow_error(e);
-  if (b < 0 && a < t.max() / b)
-    throw overflow_error(e);
-  return value(a * b);
-}
-
-static value
-mul_mod(evaluator& eval, const mul_expr& e, const mod_type& t)
-{
-  std::uintmax_t a = evaluate(eval, e.get_lhs()).get_int();
-  std::uintmax_t b = evaluate(eval, e.get_rhs()).get_int();
-  // FIXME: I don't think that this is right.
-  return value((a * b) % t.mod()); 
-}
-
-value
-evaluate(evaluator& eval, const mul_expr& e)
+  const type& t = e.get_type();
+  result r1 = try_evaluate(eval, e.get_lhs());
+  if (!r1)
+    return r1;
+  result r2 = try_evaluate(eval, e.get_rhs());
+  if (!r2)
+    return r2;
+  wide_integer a = get_wide(t, r1.get_value());
+  wide_integer b = get_wide(t, r2.get_value());
+  wide_integer r;
+  arith_status s = (get_kernel(t).wide_->*op)(a, b, r);
+  return check_wide_result(eval, e, s, r);
+}
+
+/// Evaluate the unary expression `e` using the wide kernel operation `op`.
+static result
+eval_wide_unary(evaluator& eval, const unary_expr& e, wide_kernel::unary_fn wide_kernel::* op)
 {
   const type& t = e.get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind: return mul_nat(eval, e, cast<nat_type>(t));
-    case int_type_kind: return mul_int(eval, e, cast<int_type>(t));
-    case mod_type_kind: return mul_mod(eval, e, cast<mod_type>(t));
-  }
-  assert(false && "not an integer expression");
+  result r1 = try_evaluate(eval, e.get_operand());
+  if (!r1)
+    return r1;
+  wide_integer n = get_wide(t, r1.get_value());
+  wide_integer r;
+  arith_status s = (get_kernel(t).wide_->*op)(n, r);
+  return check_wide_result(eval, e, s, r);
+}
+
+/// Evaluate the binary expression `e` using the kernel operation `op`, or
+/// the wide kernel operation `wop` for wide types.
+static inline result
+eval_binary(evaluator& eval, const binary_expr& e, 
+            kernel::binary_fn kernel::* op, 
+            wide_kernel::binary_fn wide_kernel::* wop)
+{
+  const kernel& k = get_kernel(e.get_type());
+  if (k.wide_)
+    return eval_wide_binary(eval, e, wop);
+  result r1 = try_evaluate(eval, e.get_lhs());
+  if (!r1)
+    return r1;
+  result r2 = try_evaluate(eval, e.get_rhs());
+  if (!r2)
+    return r2;
+  std::intmax_t r;
+  arith_status s = (k.*op)(r1.get_value().get_int(), r2.get_value().get_int(), r);
+  return check_result(eval, e, s, r);
+}
+
+/// Evaluate the unary expression `e` using the kernel operation `op`, or
+/// the wide kernel operation `wop` for wide types.
+static inline result
+eval_unary(evaluator& eval, const unary_expr& e, 
+           kernel::unary_fn kernel::* op, 
+           wide_kernel::unary_fn wide_kernel::* wop)
+{
+  const kernel& k = get_kernel(e.get_type());
+  if (k.wide_)
+    return eval_wide_unary(eval, e, wop);
+  result r1 = try_evaluate(eval, e.get_operand());
+  if (!r1)
+    return r1;
+  std::intmax_t r;
+  arith_status s = (k.*op)(r1.get_value().get_int(), r);
+  return check_result(eval, e, s, r);
 }
 
 } // namespace sys_int
 
-
-value
-evaluate_expr(evaluator& eval, const sys_int::mul_expr& e)
-{
-  return sys_int::evaluate(eval, e);
-}
-
-
-// -------------------------------------------------------------------------- //
-// Quotient
-
-namespace sys_int {
-
-template<typename T>
-static value
-quo_unsigned(evaluator& eval, const quo_expr& e, const T& t)
+result
+evaluate_expr(evaluator& eval, const sys_int::add_expr& e)
 {
-  using int_t = typename T::rep_type;
-  int_t a = evaluate(eval, e.get_lhs()).get_int();
-  int_t b = evaluate(eval, e.get_rhs()).get_int();
-  if (b == 0)
-    throw division_error(e);
-  return value(a / b);
+  return sys_int::eval_binary(eval, e, &sys_int::kernel::add_, &sys_int::wide_kernel::add_);
 }
 
-static value
-quo_signed(evaluator& eval, const quo_expr& e, const int_type& t)
+result
+evaluate_expr(evaluator& eval, const sys_int::sub_expr& e)
 {
-  std::intmax_t a = evaluate(eval, e.get_lhs()).get_int();
-  std::intmax_t b = evaluate(eval, e.get_rhs()).get_int();
-  if (b == 0)
-    throw division_error(e);
-  if (a == t.min() && b == -1)
-    throw overflow_error(e);
-  return value(a / b);
+  return sys_int::eval_binary(eval, e, &sys_int::kernel::sub_, &sys_int::wide_kernel::sub_);
 }
 
-value
-evaluate(evaluator& eval, const quo_expr& e)
+result
+evaluate_expr(evaluator& eval, const sys_int::mul_expr& e)
 {
-  const type& t = e.get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind: return quo_unsigned(eval, e, cast<nat_type>(t));
-    case int_type_kind: return quo_signed(eval, e, cast<int_type>(t));
-    case mod_type_kind: return quo_unsigned(eval, e, cast<mod_type>(t));
-  }
-  assert(false && "not an integer expression");
+  return sys_int::eval_binary(eval, e, &sys_int::kernel::mul_, &sys_int::wide_kernel::mul_);
 }
 
-} // namespace sys_int
-
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::quo_expr& e)
 {
-  return sys_int::evaluate(eval, e);
-}
-
-
-// -------------------------------------------------------------------------- //
-// Remainder
-
-namespace sys_int {
-
-template<typename T>
-static value
-rem(evaluator& eval, const rem_expr& e, const T& t)
-{
-  using int_t = typename T::rep_type;
-  int_t a = evaluate(eval, e.get_lhs()).get_int();
-  int_t b = evaluate(eval, e.get_rhs()).get_int();
-  if (b == 0)
-    throw sys_int::division_error(e);
-  return value(a % b);
-}
-
-value
-evaluate(evaluator& eval, const rem_expr& e)
-{
-  const type& t = e.get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind: return rem(eval, e, cast<nat_type>(t));
-    case int_type_kind: return rem(eval, e, cast<int_type>(t));
-    case mod_type_kind: return rem(eval, e, cast<mod_type>(t));
-  }
-  assert(false && "not an integer expression");
+  return sys_int::eval_binary(eval, e, &sys_int::kernel::quo_, &sys_int::wide_kernel::quo_);
 }
 
-} // namespace sys_int
-
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::rem_expr& e)
 {
-  return sys_int::evaluate(eval, e);
-}
-
-
-// -------------------------------------------------------------------------- //
-// Negation
-
-namespace sys_int {
-
-static value
-neg_nat(evaluator& eval, const neg_expr& e, const nat_type& t)
-{
-  assert(false && "negation of natural number");
-}
-
-static value
-neg_int(evaluator& eval, const neg_expr& e, const int_type& t)
-{
-  std::intmax_t n = evaluate(eval, e.get_operand()).get_int();
-  if (n == t.min())
-    throw overflow_error(e);
-  return value(-n);
-}
-
-static value
-neg_mod(evaluator& eval, const neg_expr& e, const mod_type& t)
-{
-  std::uintmax_t n = evaluate(eval, e.get_operand()).get_int();
-  // FIXME: Is this right?
-  return value(-n % t.mod());
+  return sys_int::eval_binary(eval, e, &sys_int::kernel::rem_, &sys_int::wide_kernel::rem_);
 }
 
-value
-evaluate(evaluator& eval, const neg_expr& e)
-{
-  const type& t = e.get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind: return neg_nat(eval, e, cast<nat_type>(t));
-    case int_type_kind: return neg_int(eval, e, cast<int_type>(t));
-    case mod_type_kind: return neg_mod(eval, e, cast<mod_type>(t));
-  }
-  assert(false && "not an negatable expression");
-}
-
-} // namespace sys_int
-
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::neg_expr& e)
 {
-  return sys_int::evaluate(eval, e);
+  assert(!is<sys_int::nat_type>(e.get_type()) && "negation of natural number");
+  return sys_int::eval_unary(eval, e, &sys_int::kernel::neg_, &sys_int::wide_kernel::neg_);
 }
 
-
-// -------------------------------------------------------------------------- //
-// Reciprocal
-
-namespace sys_int {
-
-template<typename T>
-static value
-eval_rec(evaluator& eval, const rec_expr& e, const T& t)
-{
-  using int_t = typename T::rep_type;
-  int_t n = evaluate(eval, e.get_operand()).get_int();
-  if (n == 0)
-    throw division_error(e);
-  return value(1 / n);
-}
-
-value
-evaluate(evaluator& eval, const rec_expr& e)
-{
-  const type& t = e.get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind: return eval_rec(eval, e, cast<nat_type>(t));
-    case int_type_kind: return eval_rec(eval, e, cast<int_type>(t));
-    case mod_type_kind: return eval_rec(eval, e, cast<mod_type>(t));
-  }
-  assert(false && "not an negatable expression");
-}
-
-} // namespace sys_int
-
-value
+result
 evaluate_expr(evaluator& eval, const sys_int::rec_expr& e)
 {
-  return sys_int::evaluate(eval, e);
+  return sys_int::eval_unary(eval, e, &sys_int::kernel::rec_, &sys_int::wide_kernel::rec_);
 }
 
 
@@ -30,7 +30,8 @@ struct int_expr : literal_expr_impl<int_expr_kind>
   std::intmax_t get_integer() const;
 };
 
-/// Returns the integer value of the expression.
+/// Returns the integer value of the expression. The value shall fit in a
+/// machine word.
 inline std::intmax_t int_expr::get_integer() const { return get_value().get_int(); }
 
 
@@ -187,6 +188,23 @@ struct rec_expr : unary_expr_impl<rec_expr_kind>
 bool is_integral_expression(const expr&);
 
 } // namespace numeric
+
+/// Integer literals and operators are pure.
+template<> struct is_pure_term<sys_int::int_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::eq_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::ne_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::lt_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::gt_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::le_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::ge_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::add_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::sub_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::mul_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::quo_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::rem_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::neg_expr> : std::true_type { };
+template<> struct is_pure_term<sys_int::rec_expr> : std::true_type { };
+
 } // namespace beaker
 
 
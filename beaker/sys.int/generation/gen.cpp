@@ -4,88 +4,74 @@
 #include "gen.hpp"
 #include "../type.hpp"
 #include "../expr.hpp"
+#include "../evaluation/evaluate.hpp"
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Intrinsics.h>
 
 
 namespace beaker {
+
+// -------------------------------------------------------------------------- //
+// Types
+
 namespace sys_int {
 
-/// Generate an integer type. If the precision is greater than 128, the type
-/// will be indirect.
+/// Generate an integer type with the precision of t.
 static inline cg::type
-generate_int_type(generator& g, const integral_type& t)
+generate_int_type(generator& gen, const integral_type& t)
 {
-  int prec = t.get_precision();
-  return {llvm::Type::getIntNTy(g.get_context(), prec)};
+  return llvm::Type::getIntNTy(gen.get_context(), t.get_precision());
 }
 
-// Generate a numeric type.
+} // namespace sys_int
+
 cg::type
-gen_algo::operator()(generator& gen, const type& t) const
+generate_type(generator& gen, const sys_int::nat_type& t)
 {
-  switch (t.get_kind()) {
-    case nat_type_kind:
-      return generate_int_type(gen, static_cast<const integral_type&>(t));
-    case int_type_kind:
-      return generate_int_type(gen, static_cast<const integral_type&>(t));
-    case mod_type_kind:
-      return generate_int_type(gen, static_cast<const integral_type&>(t));
-    default:
-      break;
-  }
-  assert(false && "not an integral type");
+  return sys_int::generate_int_type(gen, t);
 }
 
-/// Generate an integer literal. These are always passed directly since the
-/// sys.int feature does not have support integer types that would be passed
-/// indirectly.
-static cg::value 
-generate_int_expr(generator& gen, const int_expr& e)
+cg::type
+generate_type(generator& gen, const sys_int::int_type& t)
 {
-  int prec = get_precision(e.get_type());
-  llvm::Builder ir(gen.get_current_block());
-  cg::value val = ir.getIntN(prec, e.get_value().get_integer());
-  return val;
-
-#if 0
-    // Large integers are passed indirectly, so allocate the temporary, store
-    // the computed value, and return the pointer.
-    //
-    // Copy ellision: don't create a new temporary we're initializing an
-    // existing object.
-    //
-    // TODO: Factor this out so we can reuse it everywhere.
-    cg::value ptr = gen.get_initialized_object();
-    if (!ptr) {
-      llvm::Builder entry(gen.get_entry_block());
-      ptr = entry.CreateAlloca(type, nullptr, "temp");
-    }
-    ir.CreateStore(val, ptr);
-    return ptr;
-#endif
+  return sys_int::generate_int_type(gen, t);
 }
 
-/// Generate an equality comparison.
-static cg::value
-generate_eq_expr(generator& gen, const eq_expr& e)
+cg::type
+generate_type(generator& gen, const sys_int::mod_type& t)
 {
-  cg::value v1 = generate(gen, e.get_lhs());
-  cg::value v2 = generate(gen, e.get_rhs());
-  llvm::Builder ir(gen.get_current_block());
-  return ir.CreateICmpEQ(v1, v2);
+  return sys_int::generate_int_type(gen, t);
 }
 
-/// Generate a not-equals comparison.
-static cg::value
-generate_ne_expr(generator& gen, const ne_expr& e)
+
+// -------------------------------------------------------------------------- //
+// Literals and comparisons
+
+/// Generate an integer literal. Integers are always passed directly. Small
+/// values of unsigned types are the bits of a word, so they are zero
+/// extended to wider types.
+cg::value
+generate_expr(generator& gen, const sys_int::int_expr& e)
 {
-  cg::value v1 = generate(gen, e.get_lhs());
-  cg::value v2 = generate(gen, e.get_rhs());
-  llvm::Builder ir(gen.get_current_block());
-  return ir.CreateICmpNE(v1, v2);
+  llvm::Type* t = generate(gen, e.get_type());
+  const value& v = e.get_value();
+  if (v.is_small()) {
+    bool s = e.get_type().get_kind() == sys_int::int_type_kind;
+    return llvm::ConstantInt::get(t, v.get_int(), s);
+  }
+  wide_natural n = v.get_wide_natural();
+  std::uint64_t words[] {std::uint64_t(n), std::uint64_t(n >> 64)};
+  return llvm::ConstantInt::get(t, llvm::APInt(128, words));
 }
 
+namespace sys_int {
+
+/// Generate a comparison of the operands of e. The predicates `u` and `s` 
+/// select the comparison of unsigned and signed integers, respectively.
 static cg::value
-generate_lt_expr(generator& gen, const lt_expr& e)
+generate_compare(generator& gen, const binary_expr& e, 
+                 llvm::CmpInst::Predicate u, llvm::CmpInst::Predicate s)
 {
   cg::value v1 = generate(gen, e.get_lhs());
   cg::value v2 = generate(gen, e.get_rhs());
@@ -94,207 +80,234 @@ generate_lt_expr(generator& gen, const lt_expr& e)
   switch (t.get_kind()) {
     case nat_type_kind:
     case mod_type_kind:
-      return ir.CreateICmpULT(v1, v2);
+      return ir.CreateICmp(u, v1, v2);
     case int_type_kind:
-      return ir.CreateICmpSLT(v1, v2);
-    default:
-      break;
+      return ir.CreateICmp(s, v1, v2);
   }
   assert(false && "not an integral type");
-  return {};
 }
 
-static cg::value
-generate_gt_expr(generator& gen, const gt_expr& e)
+} // namespace sys_int
+
+cg::value
+generate_expr(generator& gen, const sys_int::eq_expr& e)
 {
-  cg::value v1 = generate(gen, e.get_lhs());
-  cg::value v2 = generate(gen, e.get_rhs());
-  llvm::Builder ir(gen.get_current_block());
-  const type& t = e.get_lhs().get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind:
-    case mod_type_kind:
-      return ir.CreateICmpUGT(v1, v2);
-    case int_type_kind:
-      return ir.CreateICmpSGT(v1, v2);
-    default:
-      break;
-  }
-  assert(false && "not an integral type");
-  return {};
+  return sys_int::generate_compare(gen, e, llvm::CmpInst::ICMP_EQ, llvm::CmpInst::ICMP_EQ);
 }
 
-static cg::value
-generate_le_expr(generator& gen, const le_expr& e)
+cg::value
+generate_expr(generator& gen, const sys_int::ne_expr& e)
 {
-  cg::value v1 = generate(gen, e.get_lhs());
-  cg::value v2 = generate(gen, e.get_rhs());
-  llvm::Builder ir(gen.get_current_block());
-  const type& t = e.get_lhs().get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind:
-    case mod_type_kind:
-      return ir.CreateICmpULE(v1, v2);
-    case int_type_kind:
-      return ir.CreateICmpSLE(v1, v2);
-    default:
-      break;
-  }
-  assert(false && "not an integral type");
-  return {};
+  return sys_int::generate_compare(gen, e, llvm::CmpInst::ICMP_NE, llvm::CmpInst::ICMP_NE);
 }
 
-static cg::value
-generate_ge_expr(generator& gen, const ge_expr& e)
+cg::value
+generate_expr(generator& gen, const sys_int::lt_expr& e)
 {
-  cg::value v1 = generate(gen, e.get_lhs());
-  cg::value v2 = generate(gen, e.get_rhs());
-  llvm::Builder ir(gen.get_current_block());
-  const type& t = e.get_lhs().get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind:
-    case mod_type_kind:
-      return ir.CreateICmpUGE(v1, v2);
-    case int_type_kind:
-      return ir.CreateICmpSGE(v1, v2);
-    default:
-      break;
-  }
-  assert(false && "not an integral type");
-  return {};
+  return sys_int::generate_compare(gen, e, llvm::CmpInst::ICMP_ULT, llvm::CmpInst::ICMP_SLT);
 }
 
-/// Generate an add expression.
+cg::value
+generate_expr(generator& gen, const sys_int::gt_expr& e)
+{
+  return sys_int::generate_compare(gen, e, llvm::CmpInst::ICMP_UGT, llvm::CmpInst::ICMP_SGT);
+}
+
+cg::value
+generate_expr(generator& gen, const sys_int::le_expr& e)
+{
+  return sys_int::generate_compare(gen, e, llvm::CmpInst::ICMP_ULE, llvm::CmpInst::ICMP_SLE);
+}
+
+cg::value
+generate_expr(generator& gen, const sys_int::ge_expr& e)
+{
+  return sys_int::generate_compare(gen, e, llvm::CmpInst::ICMP_UGE, llvm::CmpInst::ICMP_SGE);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Arithmetic
+
+namespace sys_int {
+
+[[noreturn]] static void
+raise_overflow(const expr& e)
+{
+  throw overflow_error(e);
+}
+
+[[noreturn]] static void
+raise_division(const expr& e)
+{
+  throw division_error(e);
+}
+
+/// Generate an arithmetic operation that fails when its result cannot be
+/// represented by the type of e. Because the LLVM type has the precision
+/// of the integer type, overflow of the operation is overflow of the type.
 static cg::value
-generate_add_expr(generator& gen, const add_expr& e)
+generate_checked(generator& gen, const expr& e, llvm::Intrinsic::ID id, 
+                 llvm::Value* v1, llvm::Value* v2)
 {
-  cg::value v1 = generate(gen, e.get_lhs());
-  cg::value v2 = generate(gen, e.get_rhs());
   llvm::Builder ir(gen.get_current_block());
-  const type& t = e.get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind:
-      return ir.CreateNUWAdd(v1, v2);
-    case int_type_kind:
-      return ir.CreateNSWAdd(v1, v2);
-    case mod_type_kind:
-      return ir.CreateAdd(v1, v2);
-    default:
-      break;
-  }
-  assert(false && "not an integral type");
-  return {};
+  llvm::Value* r = ir.CreateBinaryIntrinsic(id, v1, v2);
+  llvm::Value* val = ir.CreateExtractValue(r, 0);
+  llvm::Value* ovf = ir.CreateExtractValue(r, 1);
+  gen.make_check(ir.CreateNot(ovf), e, raise_overflow);
+  return val;
 }
 
+/// Generate an arithmetic operation. Operations on natural and integer 
+/// types are checked with the intrinsic `u` or `s`, respectively. Modular 
+/// arithmetic wraps, so operations on modular types use the instruction `m`.
 static cg::value
-generate_sub_expr(generator& gen, const sub_expr& e)
+generate_arithmetic(generator& gen, const binary_expr& e,
+                    llvm::Intrinsic::ID u, llvm::Intrinsic::ID s, 
+                    llvm::Instruction::BinaryOps m)
 {
   cg::value v1 = generate(gen, e.get_lhs());
   cg::value v2 = generate(gen, e.get_rhs());
-  llvm::Builder ir(gen.get_current_block());
   const type& t = e.get_type();
   switch (t.get_kind()) {
     case nat_type_kind:
-      return ir.CreateNUWSub(v1, v2);
+      return generate_checked(gen, e, u, v1, v2);
     case int_type_kind:
-      return ir.CreateNSWSub(v1, v2);
-    case mod_type_kind:
-      return ir.CreateSub(v1, v2);
-    default:
-      break;
+      return generate_checked(gen, e, s, v1, v2);
+    case mod_type_kind: {
+      llvm::Builder ir(gen.get_current_block());
+      return ir.CreateBinOp(m, v1, v2);
+    }
   }
   assert(false && "not an integral type");
-  return {};
 }
 
-static cg::value
-generate_mul_expr(generator& gen, const mul_expr& e)
+/// Generate a check that the divisor `v` is not zero.
+static void
+generate_divisor_check(generator& gen, const expr& e, llvm::Value* v)
 {
-  cg::value v1 = generate(gen, e.get_lhs());
-  cg::value v2 = generate(gen, e.get_rhs());
   llvm::Builder ir(gen.get_current_block());
-  const type& t = e.get_type();
-  switch (t.get_kind()) {
-    case nat_type_kind:
-      return ir.CreateNUWMul(v1, v2);
-    case int_type_kind:
-      return ir.CreateNSWMul(v1, v2);
-    case mod_type_kind:
-      return ir.CreateMul(v1, v2);
-    default:
-      break;
-  }
-  assert(false && "not an integral type");
-  return {};
+  llvm::Value* zero = llvm::ConstantInt::get(v->getType(), 0);
+  gen.make_check(ir.CreateICmpNE(v, zero), e, raise_division);
 }
 
-static cg::value
-generate_div_expr(generator& gen, const div_expr& e)
+} // namespace sys_int
+
+cg::value
+generate_expr(generator& gen, const sys_int::add_expr& e)
+{
+  return sys_int::generate_arithmetic(gen, e, 
+    llvm::Intrinsic::uadd_with_overflow, 
+    llvm::Intrinsic::sadd_with_overflow,
+    llvm::Instruction::Add);
+}
+
+cg::value
+generate_expr(generator& gen, const sys_int::sub_expr& e)
+{
+  return sys_int::generate_arithmetic(gen, e, 
+    llvm::Intrinsic::usub_with_overflow, 
+    llvm::Intrinsic::ssub_with_overflow,
+    llvm::Instruction::Sub);
+}
+
+cg::value
+generate_expr(generator& gen, const sys_int::mul_expr& e)
+{
+  return sys_int::generate_arithmetic(gen, e, 
+    llvm::Intrinsic::umul_with_overflow, 
+    llvm::Intrinsic::smul_with_overflow,
+    llvm::Instruction::Mul);
+}
+
+/// Division fails when the divisor is zero. Signed division also fails when
+/// dividing the minimum value by -1.
+cg::value
+generate_expr(generator& gen, const sys_int::quo_expr& e)
 {
   cg::value v1 = generate(gen, e.get_lhs());
   cg::value v2 = generate(gen, e.get_rhs());
+  sys_int::generate_divisor_check(gen, e, v2);
   llvm::Builder ir(gen.get_current_block());
   const type& t = e.get_type();
   switch (t.get_kind()) {
-    case nat_type_kind:
-    case mod_type_kind:
+    case sys_int::nat_type_kind:
+    case sys_int::mod_type_kind:
       return ir.CreateUDiv(v1, v2);
-    case int_type_kind:
+    case sys_int::int_type_kind: {
+      llvm::Type* t = v1->getType();
+      llvm::Value* min = llvm::ConstantInt::get(t, llvm::APInt::getSignedMinValue(t->getIntegerBitWidth()));
+      llvm::Value* neg = llvm::ConstantInt::get(t, -1, true);
+      llvm::Value* ovf = ir.CreateAnd(ir.CreateICmpEQ(v1, min), ir.CreateICmpEQ(v2, neg));
+      gen.make_check(ir.CreateNot(ovf), e, sys_int::raise_overflow);
+      ir.SetInsertPoint(gen.get_current_block());
       return ir.CreateSDiv(v1, v2);
-    default:
-      break;
+    }
   }
   assert(false && "not an integral type");
-  return {};
 }
 
-static cg::value
-generate_rem_expr(generator& gen, const rem_expr& e)
+/// The remainder fails when the divisor is zero. The remainder of a signed
+/// division by -1 is always 0, so that case is not computed by `srem`, which
+/// would overflow for the minimum value.
+cg::value
+generate_expr(generator& gen, const sys_int::rem_expr& e)
 {
   cg::value v1 = generate(gen, e.get_lhs());
   cg::value v2 = generate(gen, e.get_rhs());
+  sys_int::generate_divisor_check(gen, e, v2);
   llvm::Builder ir(gen.get_current_block());
   const type& t = e.get_type();
   switch (t.get_kind()) {
-    case nat_type_kind:
-    case mod_type_kind:
+    case sys_int::nat_type_kind:
+    case sys_int::mod_type_kind:
       return ir.CreateURem(v1, v2);
-    case int_type_kind:
-      return ir.CreateSRem(v1, v2);
-    default:
-      break;
+    case sys_int::int_type_kind: {
+      llvm::Type* t = v1->getType();
+      llvm::Value* one = llvm::ConstantInt::get(t, 1);
+      llvm::Value* neg = ir.CreateICmpEQ(v2, llvm::ConstantInt::get(t, -1, true));
+      return ir.CreateSRem(v1, ir.CreateSelect(neg, one, v2));
+    }
   }
   assert(false && "not an integral type");
-  return {};
-}
-
-static cg::value
-generate_neg_expr(generator& gen, const neg_expr& e)
-{
-  assert(false && "not implemented");
 }
 
-static cg::value
-generate_rec_expr(generator& gen, const rec_expr& e)
+/// Negation of integers fails for the minimum value. Negation of modular
+/// integers wraps. The negation of natural numbers is not supported.
+cg::value
+generate_expr(generator& gen, const sys_int::neg_expr& e)
 {
-  assert(false && "not implemented");
+  const type& t = e.get_type();
+  if (t.get_kind() == sys_int::nat_type_kind)
+    throw generation_error("negation of natural number");
+  cg::value v = generate(gen, e.get_operand());
+  llvm::Builder ir(gen.get_current_block());
+  if (t.get_kind() == sys_int::int_type_kind) {
+    llvm::Type* t = v->getType();
+    llvm::Value* min = llvm::ConstantInt::get(t, llvm::APInt::getSignedMinValue(t->getIntegerBitWidth()));
+    gen.make_check(ir.CreateICmpNE(v, min), e, sys_int::raise_overflow);
+    ir.SetInsertPoint(gen.get_current_block());
+  }
+  return ir.CreateNeg(v);
 }
 
-// Generate code for the integral expression e.
+/// The reciprocal fails when the operand is zero.
 cg::value
-gen_algo::operator()(generator& gen, const expr& e) const
+generate_expr(generator& gen, const sys_int::rec_expr& e)
 {
-  switch (e.get_kind()) {
-#define def_expr(E) \
-    case E ## _expr_kind: \
-      return generate_ ## E ## _expr(gen, cast<E ## _expr>(e));
-#include "../expr.def"
-    default:
-      break;
+  cg::value v = generate(gen, e.get_operand());
+  sys_int::generate_divisor_check(gen, e, v);
+  llvm::Builder ir(gen.get_current_block());
+  llvm::Value* one = llvm::ConstantInt::get(v->getType(), 1);
+  const type& t = e.get_type();
+  switch (t.get_kind()) {
+    case sys_int::nat_type_kind:
+    case sys_int::mod_type_kind:
+      return ir.CreateUDiv(one, v);
+    case sys_int::int_type_kind:
+      return ir.CreateSDiv(one, v);
   }
-  assert(false && "not a integral expression");
+  assert(false && "not an integral type");
 }
 
-} // namespace sys_int
 } // namespace beaker
-
@@ -4,19 +4,35 @@
 #ifndef BEAKER_SYS_INT_GENERATION_GEN_HPP
 #define BEAKER_SYS_INT_GENERATION_GEN_HPP
 
+#include <beaker/sys.int/fwd.hpp>
+
 #include <beaker/base/generation/generation.hpp>
 
 
 namespace beaker {
-namespace sys_int {
 
-struct gen_algo : generate_algorithm
-{
-  cg::type operator()(generator&, const type&) const;
-  cg::value operator()(generator&, const expr&) const;
-};
+// -------------------------------------------------------------------------- //
+// Overrides
+
+cg::type generate_type(generator&, const sys_int::nat_type&);
+cg::type generate_type(generator&, const sys_int::int_type&);
+cg::type generate_type(generator&, const sys_int::mod_type&);
+
+cg::value generate_expr(generator&, const sys_int::int_expr&);
+cg::value generate_expr(generator&, const sys_int::eq_expr&);
+cg::value generate_expr(generator&, const sys_int::ne_expr&);
+cg::value generate_expr(generator&, const sys_int::lt_expr&);
+cg::value generate_expr(generator&, const sys_int::gt_expr&);
+cg::value generate_expr(generator&, const sys_int::le_expr&);
+cg::value generate_expr(generator&, const sys_int::ge_expr&);
+cg::value generate_expr(generator&, const sys_int::add_expr&);
+cg::value generate_expr(generator&, const sys_int::sub_expr&);
+cg::value generate_expr(generator&, const sys_int::mul_expr&);
+cg::value generate_expr(generator&, const sys_int::quo_expr&);
+cg::value generate_expr(generator&, const sys_int::rem_expr&);
+cg::value generate_expr(generator&, const sys_int::neg_expr&);
+cg::value generate_expr(generator&, const sys_int::rec_expr&);
 
-} // namespace sys_int
 } // namespace beaker
 
 
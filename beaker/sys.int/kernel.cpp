@@ -0,0 +1,70 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "kernel.hpp"
+#include "type.hpp"
+
+
+namespace beaker {
+namespace sys_int {
+
+static constexpr wide_kernel wide_kernels[] {
+  make_wide_kernel<nat_ops<wide_natural, wide_integer>>(),
+  make_wide_kernel<int_ops<wide_integer, wide_integer>>(),
+  make_wide_kernel<mod_ops<wide_natural, wide_integer>>(),
+};
+
+static constexpr kernel nat_kernels[] {
+  make_kernel<nat_ops<std::uint8_t>>(),
+  make_kernel<nat_ops<std::uint16_t>>(),
+  make_kernel<nat_ops<std::uint32_t>>(),
+  make_kernel<nat_ops<std::uint64_t>>(),
+  make_kernel(&wide_kernels[0]),
+};
+
+static constexpr kernel int_kernels[] {
+  make_kernel<int_ops<std::int8_t>>(),
+  make_kernel<int_ops<std::int16_t>>(),
+  make_kernel<int_ops<std::int32_t>>(),
+  make_kernel<int_ops<std::int64_t>>(),
+  make_kernel(&wide_kernels[1]),
+};
+
+static constexpr kernel mod_kernels[] {
+  make_kernel<mod_ops<std::uint8_t>>(),
+  make_kernel<mod_ops<std::uint16_t>>(),
+  make_kernel<mod_ops<std::uint32_t>>(),
+  make_kernel<mod_ops<std::uint64_t>>(),
+  make_kernel(&wide_kernels[2]),
+};
+
+/// Returns the index of the kernel for the precision p.
+static inline int
+get_width_index(int p)
+{
+  switch (p) {
+    case 8: return 0;
+    case 16: return 1;
+    case 32: return 2;
+    case 64: return 3;
+    case 128: return 4;
+  }
+  assert(false && "invalid precision");
+}
+
+/// Returns the arithmetic kernel for the integral type of kind `k` with
+/// precision `p`.
+const kernel&
+get_kernel(int k, int p)
+{
+  int n = get_width_index(p);
+  switch (k) {
+    case nat_type_kind: return nat_kernels[n];
+    case int_type_kind: return int_kernels[n];
+    case mod_type_kind: return mod_kernels[n];
+  }
+  assert(false && "not an integral type");
+}
+
+} // namespace sys_int
+} // namespace beaker
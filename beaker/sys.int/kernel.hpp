@@ -0,0 +1,321 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_SYS_INT_KERNEL_HPP
+#define BEAKER_SYS_INT_KERNEL_HPP
+
+#include <beaker/base/value.hpp>
+
+#include <cstdint>
+
+
+namespace beaker {
+namespace sys_int {
+
+/// The outcome of an arithmetic operation.
+enum arith_status
+{
+  arith_ok,
+  arith_overflow,
+  arith_division,
+};
+
+
+struct wide_kernel;
+
+/// An arithmetic kernel implements the arithmetic operations of one integral
+/// type. Operands and results are exchanged in the value representation
+/// (i.e., as std::intmax_t), but each operation is computed at the native
+/// width of the type, and overflow is detected by the compiler's checked
+/// arithmetic builtins.
+///
+/// A kernel is selected once for each integral type when the type is
+/// created. See integral_type::get_kernel().
+///
+/// The kernel of a type wider than a machine word has no word-sized
+/// operations. Its operations are given by its wide kernel, which exchanges
+/// operands as 128-bit integers. Evaluators test for a wide kernel to select
+/// the slow path, so arithmetic on word-sized types is not affected.
+struct kernel
+{
+  using binary_fn = arith_status (*)(std::intmax_t, std::intmax_t, std::intmax_t&);
+  using unary_fn = arith_status (*)(std::intmax_t, std::intmax_t&);
+
+  binary_fn add_;
+  binary_fn sub_;
+  binary_fn mul_;
+  binary_fn quo_;
+  binary_fn rem_;
+  unary_fn neg_;
+  unary_fn rec_;
+  const wide_kernel* wide_;
+};
+
+/// The arithmetic operations of a type wider than a machine word. Operands
+/// are exchanged as signed 128-bit integers; the operands of unsigned types
+/// are the bits of their value.
+struct wide_kernel
+{
+  using binary_fn = arith_status (*)(wide_integer, wide_integer, wide_integer&);
+  using unary_fn = arith_status (*)(wide_integer, wide_integer&);
+
+  binary_fn add_;
+  binary_fn sub_;
+  binary_fn mul_;
+  binary_fn quo_;
+  binary_fn rem_;
+  unary_fn neg_;
+  unary_fn rec_;
+};
+
+const kernel& get_kernel(int, int);
+
+
+// -------------------------------------------------------------------------- //
+// Operations
+//
+// The operations of natural number, integer, and modular types whose value
+// representation is the native type T. Operands and results are exchanged
+// as values of type X.
+
+/// Operations on natural numbers. Results outside [0, max] overflow. The
+/// only natural number that can be negated is 0.
+template<typename T, typename X = std::intmax_t>
+struct nat_ops
+{
+  static arith_status
+  add(X a, X b, X& r)
+  {
+    T x;
+    if (__builtin_add_overflow(T(a), T(b), &x))
+      return arith_overflow;
+    r = x;
+    return arith_ok;
+  }
+
+  static arith_status
+  sub(X a, X b, X& r)
+  {
+    T x;
+    if (__builtin_sub_overflow(T(a), T(b), &x))
+      return arith_overflow;
+    r = x;
+    return arith_ok;
+  }
+
+  static arith_status
+  mul(X a, X b, X& r)
+  {
+    T x;
+    if (__builtin_mul_overflow(T(a), T(b), &x))
+      return arith_overflow;
+    r = x;
+    return arith_ok;
+  }
+
+  static arith_status
+  quo(X a, X b, X& r)
+  {
+    if (T(b) == 0)
+      return arith_division;
+    r = T(T(a) / T(b));
+    return arith_ok;
+  }
+
+  static arith_status
+  rem(X a, X b, X& r)
+  {
+    if (T(b) == 0)
+      return arith_division;
+    r = T(T(a) % T(b));
+    return arith_ok;
+  }
+
+  static arith_status
+  neg(X a, X& r)
+  {
+    if (T(a) != 0)
+      return arith_overflow;
+    r = 0;
+    return arith_ok;
+  }
+
+  static arith_status
+  rec(X a, X& r)
+  {
+    if (T(a) == 0)
+      return arith_division;
+    r = T(1 / T(a));
+    return arith_ok;
+  }
+};
+
+
+/// Operations on integers. Results outside [min, max] overflow. Note that
+/// `min % -1` is 0 and does not overflow.
+template<typename T, typename X = std::intmax_t>
+struct int_ops
+{
+  static arith_status
+  add(X a, X b, X& r)
+  {
+    T x;
+    if (__builtin_add_overflow(T(a), T(b), &x))
+      return arith_overflow;
+    r = x;
+    return arith_ok;
+  }
+
+  static arith_status
+  sub(X a, X b, X& r)
+  {
+    T x;
+    if (__builtin_sub_overflow(T(a), T(b), &x))
+      return arith_overflow;
+    r = x;
+    return arith_ok;
+  }
+
+  static arith_status
+  mul(X a, X b, X& r)
+  {
+    T x;
+    if (__builtin_mul_overflow(T(a), T(b), &x))
+      return arith_overflow;
+    r = x;
+    return arith_ok;
+  }
+
+  static arith_status
+  quo(X a, X b, X& r)
+  {
+    if (T(b) == 0)
+      return arith_division;
+    if (T(b) == -1)
+      return neg(a, r);
+    r = T(T(a) / T(b));
+    return arith_ok;
+  }
+
+  static arith_status
+  rem(X a, X b, X& r)
+  {
+    if (T(b) == 0)
+      return arith_division;
+    if (T(b) == -1)
+      r = 0;
+    else
+      r = T(T(a) % T(b));
+    return arith_ok;
+  }
+
+  static arith_status
+  neg(X a, X& r)
+  {
+    T x;
+    if (__builtin_sub_overflow(T(0), T(a), &x))
+      return arith_overflow;
+    r = x;
+    return arith_ok;
+  }
+
+  static arith_status
+  rec(X a, X& r)
+  {
+    if (T(a) == 0)
+      return arith_division;
+    r = T(1 / T(a));
+    return arith_ok;
+  }
+};
+
+
+/// Operations on integers modulo 2^k. Addition, subtraction, multiplication
+/// and negation wrap and never overflow.
+template<typename T, typename X = std::intmax_t>
+struct mod_ops
+{
+  static arith_status
+  add(X a, X b, X& r)
+  {
+    r = T(T(a) + T(b));
+    return arith_ok;
+  }
+
+  static arith_status
+  sub(X a, X b, X& r)
+  {
+    r = T(T(a) - T(b));
+    return arith_ok;
+  }
+
+  static arith_status
+  mul(X a, X b, X& r)
+  {
+    // Promote to avoid signed overflow when T is narrower than int.
+    using U = decltype(T() + 0u);
+    r = T(U(T(a)) * U(T(b)));
+    return arith_ok;
+  }
+
+  static arith_status
+  quo(X a, X b, X& r)
+  {
+    return nat_ops<T, X>::quo(a, b, r);
+  }
+
+  static arith_status
+  rem(X a, X b, X& r)
+  {
+    return nat_ops<T, X>::rem(a, b, r);
+  }
+
+  static arith_status
+  neg(X a, X& r)
+  {
+    r = T(0u - T(a));
+    return arith_ok;
+  }
+
+  static arith_status
+  rec(X a, X& r)
+  {
+    return nat_ops<T, X>::rec(a, r);
+  }
+};
+
+
+/// Returns the kernel implementing the operations `Ops`.
+template<typename Ops>
+constexpr kernel
+make_kernel()
+{
+  return kernel {
+    Ops::add, Ops::sub, Ops::mul, Ops::quo, Ops::rem, Ops::neg, Ops::rec, nullptr
+  };
+}
+
+/// Returns the kernel of a wide type whose operations are given by `k`.
+constexpr kernel
+make_kernel(const wide_kernel* k)
+{
+  return kernel {
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, k
+  };
+}
+
+/// Returns the wide kernel implementing the operations `Ops`.
+template<typename Ops>
+constexpr wide_kernel
+make_wide_kernel()
+{
+  return wide_kernel {
+    Ops::add, Ops::sub, Ops::mul, Ops::quo, Ops::rem, Ops::neg, Ops::rec
+  };
+}
+
+} // namespace sys_int
+} // namespace beaker
+
+
+#endif
@@ -31,10 +31,21 @@ print_type(pretty_printer& pp, const sys_int::mod_type& t)
   pp.print((std::uintmax_t)t.get_precision()); // FIXME: Remove this cast
 }
 
+/// Print an integer literal. Values are printed as signed or unsigned
+/// according to the type of the literal.
 void
 print_expr(pretty_printer& pp, const sys_int::int_expr& e)
 {
-  pp.print(e.get_integer());
+  const value& v = e.get_value();
+  bool s = sys_int::is_signed_type(e.get_type());
+  if (v.is_small() && s)
+    pp.print(e.get_integer());
+  else if (v.is_small())
+    pp.print(std::uintmax_t(e.get_integer()));
+  else if (s)
+    pp.print(to_string(v.get_wide()).c_str());
+  else
+    pp.print(to_string(v.get_wide_natural()).c_str());
 }
 
 void
@@ -6,6 +6,9 @@
 
 #include <beaker/base/type.hpp>
 #include <beaker/base/value.hpp>
+#include <beaker/sys.int/kernel.hpp>
+
+#include <limits>
 
 
 namespace beaker {
@@ -27,24 +30,33 @@ enum
 /// however, languages with byte-oriented objects may not support unaligned
 /// integer sizes.
 ///
+/// The arithmetic kernel of an integral type is selected when the type is
+/// created, so that arithmetic expressions do not need to inspect the kind
+/// or precision of their type.
+///
 /// \todo Add an integer class for saturating arithmetic.
 struct integral_type : object_type
 {
   integral_type(int, int);
 
   int get_precision() const;
+  const kernel& get_kernel() const;
 
   int prec_;
+  const kernel* kern_;
 };
 
 inline
 integral_type::integral_type(int k, int p) 
-  : object_type(k), prec_(p)
+  : object_type(k), prec_(p), kern_(&sys_int::get_kernel(k, p))
 { }
 
 /// Returns the precision of the numeric type.
 inline int integral_type::get_precision() const { return prec_; }
 
+/// Returns the arithmetic kernel of the type.
+inline const kernel& integral_type::get_kernel() const { return *kern_; }
+
 
 /// A helper class for defining integral types.
 template<int K>
@@ -76,13 +88,28 @@ struct nat_type : integral_type_impl<nat_type_kind>
 
   std::uintmax_t min() const;
   std::uintmax_t max() const;
+  wide_natural wide_max() const;
 };
 
 /// Returns the minimum integer value for the type.
 inline std::uintmax_t nat_type::min() const { return 0; }
 
-/// Returns the maximum integer value for the type.
-inline std::uintmax_t nat_type::max() const { return (std::uintmax_t(1) << prec_) -1; }
+/// Returns the maximum integer value for the type. For types wider than the
+/// value representation, this is the maximum value of a machine word.
+inline std::uintmax_t 
+nat_type::max() const 
+{ 
+  if (prec_ >= std::numeric_limits<std::uintmax_t>::digits)
+    return ~std::uintmax_t(0);
+  return ~std::uintmax_t(0) >> (std::numeric_limits<std::uintmax_t>::digits - prec_);
+}
+
+/// Returns the maximum value of the type as a wide integer.
+inline wide_natural
+nat_type::wide_max() const
+{
+  return ~wide_natural(0) >> (128 - prec_);
+}
 
 
 /// Represents integer types with k bits of precision.
@@ -96,13 +123,39 @@ struct int_type : integral_type_impl<int_type_kind>
 
   std::intmax_t min() const;
   std::intmax_t max() const;
+  wide_integer wide_min() const;
+  wide_integer wide_max() const;
 };
 
-/// Returns the minimum integer value for the type.
-inline std::intmax_t int_type::min() const { return -(std::uintmax_t(1) << (prec_ - 1)); }
+/// Returns the minimum integer value for the type. For types wider than the
+/// value representation, this is the minimum value of a machine word.
+inline std::intmax_t 
+int_type::min() const 
+{ 
+  if (prec_ > std::numeric_limits<std::intmax_t>::digits)
+    return std::numeric_limits<std::intmax_t>::min();
+  return -(std::uintmax_t(1) << (prec_ - 1)); 
+}
 
-/// Returns the maximum integer value for the type.
-inline std::intmax_t int_type::max() const { return (std::uintmax_t(1) << (prec_ - 1)) -1; }
+/// Returns the maximum integer value for the type. For types wider than the
+/// value representation, this is the maximum value of a machine word.
+inline std::intmax_t 
+int_type::max() const 
+{ 
+  if (prec_ > std::numeric_limits<std::intmax_t>::digits)
+    return std::numeric_limits<std::intmax_t>::max();
+  return (std::uintmax_t(1) << (prec_ - 1)) -1; 
+}
+
+/// Returns the minimum value of the type as a wide integer.
+inline wide_integer int_type::wide_min() const { return -wide_max() - 1; }
+
+/// Returns the maximum value of the type as a wide integer.
+inline wide_integer 
+int_type::wide_max() const 
+{ 
+  return (wide_natural(1) << (prec_ - 1)) - 1; 
+}
 
 
 /// Represents integers mod k where k is the number of bits of precision.
@@ -117,15 +170,32 @@ struct mod_type : integral_type_impl<mod_type_kind>
   std::uintmax_t min() const;
   std::uintmax_t max() const;
   std::uintmax_t mod() const;
+  wide_natural wide_max() const;
 };
 
 /// Returns the minimum integer value for the type.
 inline std::uintmax_t mod_type::min() const { return 0; }
 
-/// Returns the maximum integer value for the type.
-inline std::uintmax_t mod_type::max() const { return (std::uintmax_t(1) << prec_) - 1; }
+/// Returns the maximum integer value for the type. For types wider than the
+/// value representation, this is the maximum value of a machine word.
+inline std::uintmax_t 
+mod_type::max() const 
+{ 
+  if (prec_ >= std::numeric_limits<std::uintmax_t>::digits)
+    return ~std::uintmax_t(0);
+  return ~std::uintmax_t(0) >> (std::numeric_limits<std::uintmax_t>::digits - prec_);
+}
 
-/// Returns the modulus of integer type.
+/// Returns the maximum value of the type as a wide integer.
+inline wide_natural
+mod_type::wide_max() const
+{
+  return ~wide_natural(0) >> (128 - prec_);
+}
+
+/// Returns the modulus of integer type. The modulus of a type whose precision
+/// is the width of the value representation is not representable; prefer
+/// masking with max().
 inline std::uintmax_t mod_type::mod() const { return std::uintmax_t(1) << prec_; }
 
 
@@ -169,7 +239,30 @@ get_precision(const type& t)
   return static_cast<const integral_type&>(t).get_precision();
 }
 
+/// Returns the arithmetic kernel of the type `t`.
+inline const kernel&
+get_kernel(const type& t)
+{
+  assert(is_integral_type(t));
+  return static_cast<const integral_type&>(t).get_kernel();
+}
+
+/// Returns true if `t` is an integral type whose values do not fit in a
+/// machine word. Evaluators that compute only with words defer expressions
+/// of these types to the tree walker.
+inline bool
+is_wide_type(const type& t)
+{
+  return is_integral_type(t) && get_kernel(t).wide_;
+}
+
 } // namespace sys_int
+
+/// Integral types are canonical.
+template<> struct is_canonical_term<sys_int::nat_type> : std::true_type { };
+template<> struct is_canonical_term<sys_int::int_type> : std::true_type { };
+template<> struct is_canonical_term<sys_int::mod_type> : std::true_type { };
+
 } // namespace beaker
 
 
@@ -15,7 +15,7 @@ namespace sys_name {
 
 builder::builder(module& m)
   : factory(m),
-    name_(&make_canonical_set<basic_name>(get_language_allocator())),
+    name_(&get_canonical_set<basic_name>(get_language_allocator())),
     current_id_()
 { }
 
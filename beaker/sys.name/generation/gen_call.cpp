@@ -34,8 +34,8 @@ generate_call_expr(generator& gen, const call_expr& e)
   if (ret.is_indirect())
     fargs.push_back(gen.make_alloca(ret));
 
-  const expr_seq& args = e.get_arguments();
-  const type_seq& parms = ftype.get_parameter_types();
+  const expr_span& args = e.get_arguments();
+  const type_span& parms = ftype.get_parameter_types();
   auto ai = args.begin(), ae = args.end();
   auto pi = parms.begin(), pe = parms.end();
   while (ai != ae && pi != pe) {
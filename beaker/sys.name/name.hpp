@@ -64,6 +64,11 @@ inline int internal_name::get_id() const { return id_; }
 
 
 } // namespace sys_name
+
+/// Basic names are canonical. Internal names are not: builders for 
+/// different modules can create internal names with the same id.
+template<> struct is_canonical_term<sys_name::basic_name> : std::true_type { };
+
 } // namespace beaker
 
 
@@ -12,71 +12,69 @@ namespace beaker {
 namespace sys_tuple {
 
 builder::builder(module& m)
-  : basic_builder<sys_tuple_lang>(m),
-    tup_(&get_language().make_canonical_set<tuple_type>())
+  : factory(m),
+    tup_(&get_canonical_set<tuple_type>(get_language_allocator()))
 { }
 
-/// FIXME: Check for non-void types.
+/// Returns true if `t` is an object type.
+static inline bool
+is_object_type(const type& t)
+{
+  return dynamic_cast<const object_type*>(&t);
+}
+
+/// Returns true if each type in `ts` is an object type.
 static bool
 check_element_types(const type_seq& ts)
 {
   return std::all_of(ts.begin(), ts.end(), is_object_type);
 }
 
+/// Returns the canonical tuple type `{t1, t2, ..., tn}`. The types in `ts`
+/// are copied into the language's memory only when the tuple type is new.
 tuple_type& 
 builder::get_tuple_type(const type_seq& ts)
 {
   assert(check_element_types(ts));
-  return tup_->get(ts);
-}
-
-tuple_type& 
-builder::get_tuple_type(type_seq&& ts)
-{
-  assert(check_element_types(ts));
-  return tup_->get(std::move(ts));
+  tuple_type key(type_span::view(ts));
+  return tup_->intern(key, [&key, &ts](allocator& a) {
+    tuple_type* t = new (a.allocate(sizeof(tuple_type), alignof(tuple_type))) tuple_type(key);
+    t->elems_ = type_span(a, ts);
+    return t;
+  });
 }
 
-/// Returns a tuple type for a sequence of expressions. Reference types are
-/// automatically adjusted object types.
+/// Returns the tuple type whose element types are the types of the 
+/// expressions in `es`.
+///
+/// \todo Apply reference-to-object conversions to the elements.
 tuple_type& 
 builder::get_tuple_type(const expr_seq& es)
 {
   type_seq ts;
-  for (const expr& e : es) {
-    expr& elem = modifiable(e);
-    type& type = get_object_type(elem.get_type());
-    ts.push_back(type);
-  }
+  for (const expr& e : es)
+    ts.push_back(const_cast<type&>(e.get_type()));
   return get_tuple_type(std::move(ts));
 }
 
-/// Returns a new tuple expr.
-///
-/// \todo Apply object-to-reference conversions as needed.
+/// Returns the expression `{e1, e2, ..., en}`.
 tuple_expr& 
 builder::make_tuple_expr(const expr_seq& es)
-{
-  tuple_type& type = get_tuple_type(es);
-  return make<tuple_expr>(type, es);
-}
-
-tuple_expr& 
-builder::make_tuple_expr(expr_seq&& es)
 {
   tuple_type& t = get_tuple_type(es);
-  return make<tuple_expr>(t, std::move(es));
+  return make<tuple_expr>(t, trailing(es));
 }
 
-/// Returns a new expression that computes the nth value of a tuple.
+/// Returns the expression `e.n`. The type of `e` shall be a tuple type 
+/// with more than `n` elements. The type of the expression is the type of
+/// the nth element.
 proj_expr& 
 builder::make_proj_expr(expr& e, int n)
 {
   tuple_type& t = cast<tuple_type>(e.get_type());
-  return make<proj_expr>(t, e, n);
+  assert(0 <= n && n < t.get_element_types().size());
+  return make<proj_expr>(t.get_element_type(n), e, n);
 }
 
-
-
 } // namespace sys_tuple
 } // namespace beaker
@@ -12,24 +12,23 @@
 namespace beaker {
 namespace sys_tuple {
 
-struct builder : basic_builder<sys_tuple_lang>
+// Provides access to resources needed to construct, validate, and
+// evaluate tuple terms.
+struct builder : factory
 {
   builder(module&);
 
-  // Types
+  // Canonical types
   tuple_type& get_tuple_type(const type_seq&);
-  tuple_type& get_tuple_type(type_seq&&);
   tuple_type& get_tuple_type(const expr_seq&);
 
   // Expressions
   tuple_expr& make_tuple_expr(const expr_seq&);
-  tuple_expr& make_tuple_expr(expr_seq&&);
   proj_expr& make_proj_expr(expr&, int);
 
-  canonical_set<tuple_type>* tup_;
+  canonical_term_set<tuple_type>* tup_;
 };
 
-
 } // namespace sys_tuple
 } // namespace beaker
 
@@ -0,0 +1,33 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "equal.hpp"
+#include "../type.hpp"
+#include "../expr.hpp"
+
+
+namespace beaker {
+
+/// Returns true if `a` and `b` have the same element types.
+bool
+equal_type(const sys_tuple::tuple_type& a, const sys_tuple::tuple_type& b)
+{
+  return equal(a.get_element_types(), b.get_element_types());
+}
+
+/// Returns true if `a` and `b` have equal elements.
+bool
+equal_expr(const sys_tuple::tuple_expr& a, const sys_tuple::tuple_expr& b)
+{
+  return equal(a.get_elements(), b.get_elements());
+}
+
+/// Returns true if `a` and `b` project the same element of equal objects.
+bool
+equal_expr(const sys_tuple::proj_expr& a, const sys_tuple::proj_expr& b)
+{
+  return a.get_element() == b.get_element() && 
+         equal(a.get_object(), b.get_object());
+}
+
+} // namespace beaker
@@ -0,0 +1,22 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_SYS_TUPLE_COMPARISON_EQUAL_HPP
+#define BEAKER_SYS_TUPLE_COMPARISON_EQUAL_HPP
+
+#include <beaker/sys.tuple/fwd.hpp>
+
+#include <beaker/base/comparison/equal.hpp>
+
+
+namespace beaker {
+
+bool equal_type(const sys_tuple::tuple_type&, const sys_tuple::tuple_type&);
+
+bool equal_expr(const sys_tuple::tuple_expr&, const sys_tuple::tuple_expr&);
+bool equal_expr(const sys_tuple::proj_expr&, const sys_tuple::proj_expr&);
+
+} // namespace beaker
+
+
+#endif
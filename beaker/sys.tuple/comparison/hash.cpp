@@ -7,25 +7,27 @@
 
 
 namespace beaker {
-namespace sys_tuple {
 
-static void
-hash_tuple_type(hasher& h, const tuple_type& t)
+/// Appends the element types of `t` to `h`.
+void
+hash_type(hasher& h, const sys_tuple::tuple_type& t)
 {
   hash(h, t.get_element_types());
 }
 
+/// Appends the elements of `e` to `h`.
 void
-hash_algo::operator()(hasher& h, const type& t) const
+hash_expr(hasher& h, const sys_tuple::tuple_expr& e)
 {
-  hash_tuple_type(h, cast<tuple_type>(t));
+  hash(h, e.get_elements());
 }
 
+/// Appends the object and element of `e` to `h`.
 void
-hash_algo::operator()(hasher& h, const expr& n) const
+hash_expr(hasher& h, const sys_tuple::proj_expr& e)
 {
-  assert(false && "not implemented");
+  hash(h, e.get_object());
+  hash(h, e.get_element());
 }
 
-} // namespace sys_tuple
 } // namespace beaker
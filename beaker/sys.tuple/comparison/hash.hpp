@@ -4,19 +4,18 @@
 #ifndef BEAKER_SYS_TUPLE_COMPARISON_HASH_HPP
 #define BEAKER_SYS_TUPLE_COMPARISON_HASH_HPP
 
+#include <beaker/sys.tuple/fwd.hpp>
+
 #include <beaker/base/comparison/hash.hpp>
 
 
 namespace beaker {
-namespace sys_tuple {
 
-struct hash_algo : hash_algorithm
-{
-  void operator()(hasher&, const type&) const override;
-  void operator()(hasher&, const expr&) const override;
-};
+void hash_type(hasher&, const sys_tuple::tuple_type&);
+
+void hash_expr(hasher&, const sys_tuple::tuple_expr&);
+void hash_expr(hasher&, const sys_tuple::proj_expr&);
 
-} // namespace sys_tuple
 } // namespace beaker
 
 
@@ -0,0 +1,37 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "evaluate.hpp"
+#include "../type.hpp"
+#include "../expr.hpp"
+
+
+namespace beaker {
+
+/// The value of `{e1, e2, ..., en}` is an aggregate containing the values of
+/// each subexpression. Subexpressions are evaluated in lexical order.
+result
+evaluate_expr(evaluator& eval, const sys_tuple::tuple_expr& e)
+{
+  const expr_span& es = e.get_elements();
+  aggregate& a = make_aggregate(eval.get_allocator(), es.size());
+  for (int i = 0; i < (int)es.size(); ++i) {
+    result r = try_evaluate(eval, es[i]);
+    if (!r)
+      return r;
+    a.get_element(i) = r.get_value();
+  }
+  return value(a);
+}
+
+/// The value of `e.n` is the nth element of the value of `e`.
+result
+evaluate_expr(evaluator& eval, const sys_tuple::proj_expr& e)
+{
+  result r = try_evaluate(eval, e.get_object());
+  if (!r)
+    return r;
+  return r.get_value().get_aggregate().get_element(e.get_element());
+}
+
+} // namespace beaker
@@ -0,0 +1,20 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_SYS_TUPLE_EVALUATION_EVALUATE_HPP
+#define BEAKER_SYS_TUPLE_EVALUATION_EVALUATE_HPP
+
+#include <beaker/sys.tuple/fwd.hpp>
+
+#include <beaker/base/evaluation/evaluate.hpp>
+
+
+namespace beaker {
+
+result evaluate_expr(evaluator&, const sys_tuple::tuple_expr&);
+result evaluate_expr(evaluator&, const sys_tuple::proj_expr&);
+
+} // namespace beaker
+
+
+#endif
@@ -12,7 +12,7 @@ namespace sys_tuple {
 
 enum {
   first_expr_kind = sys_tuple_lang_block,
-#define def_expr(e) e ## _expr_kind,
+#define def_expr(NS, E) E ## _expr_kind,
 #include "expr.def"
   last_expr_kind
 };
@@ -33,33 +33,27 @@ struct tuple_expr : expr
 {
   static constexpr int node_kind = tuple_expr_kind;
 
-  tuple_expr(type&, const expr_seq&);
-  tuple_expr(type&, expr_seq&&);
+  tuple_expr(type&, const expr_span&);
 
-  const expr_seq& get_elements() const;
-  expr_seq& get_elements();
+  const expr_span& get_elements() const;
+  expr_span& get_elements();
 
   const expr& get_element(int) const;
   expr& get_element(int);
 
-  expr_seq elems_;
+  expr_span elems_;
 };
 
 inline
-tuple_expr::tuple_expr(type& t, const expr_seq& es)
+tuple_expr::tuple_expr(type& t, const expr_span& es)
   : expr(node_kind, t), elems_(es)
 { }
 
-inline
-tuple_expr::tuple_expr(type& t, expr_seq&& es)
-  : expr(node_kind, t), elems_(std::move(es))
-{ }
-
-/// Returns the sequence of elemens in the tuple expression.
-inline const expr_seq& tuple_expr::get_elements() const { return elems_; }
+/// Returns the sequence of elements in the tuple expression.
+inline const expr_span& tuple_expr::get_elements() const { return elems_; }
 
-/// Returns the sequence of elemens in the tuple expression.
-inline expr_seq& tuple_expr::get_elements() { return elems_; }
+/// Returns the sequence of elements in the tuple expression.
+inline expr_span& tuple_expr::get_elements() { return elems_; }
 
 /// Returns the nth subexpression of the tuple.
 inline const expr& tuple_expr::get_element(int n) const { return elems_[n]; }
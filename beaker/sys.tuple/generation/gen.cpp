@@ -5,105 +5,46 @@
 #include "../type.hpp"
 #include "../expr.hpp"
 
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+
 
 namespace beaker {
-namespace sys_tuple {
 
-/// Returns an annamed struct type. Note that tuples are always passed
-/// indirectly.
+/// Returns an unnamed struct type whose members are the element types of t.
 cg::type
-generate_tuple_type(generator& gen, const tuple_type& t)
+generate_type(generator& gen, const sys_tuple::tuple_type& t)
 {
   std::vector<llvm::Type*> types;
   for (const type& elem : t.get_element_types())
     types.push_back(generate(gen, elem));
-  llvm::Context& cxt = gen.get_context();
-  return {llvm::StructType::create(cxt, types, "__tuple"), true};
-}
-
-cg::type
-gen_algo::operator()(generator& gen, const type& t) const
-{
-  return generate_tuple_type(gen, cast<tuple_type>(t));
+  return llvm::StructType::get(gen.get_context(), types);
 }
 
-
-/// The expression `{e1, e2, ..., en}` results in an object containing
-/// the values of the given expressions.  Each subexpression is evaluated
-/// in lexical order.
+/// The expression `{e1, e2, ..., en}` results in a struct value containing
+/// the values of the given expressions. Each subexpression is evaluated in
+/// lexical order.
 cg::value
-generate_tuple_expr(generator& gen, const tuple_expr& e)
+generate_expr(generator& gen, const sys_tuple::tuple_expr& e)
 {
-  assert(is<tuple_type>(e.get_type()));
-
-  // Genrate the object that will store those values.
-  cg::value obj = gen.make_alloca(generate(gen, e.get_type()));
-
-  // Generate the subexpressions in the order in which they appear.
-  const expr_seq& args = e.get_elements();
-  for (int i = 0; i < args.size(); ++i) {
-      // Get the address of the sub-object being initialized.
-      llvm::Builder ir(gen.get_current_block());
-      llvm::Value *ix[] {
-        ir.getInt32(0),
-        ir.getInt32(i)
-      };
-      cg::value sub = ir.CreateInBoundsGEP(obj, ix);
-
-      // Initialize the sub-object.
-      generator::init_guard guard(gen, sub);
-      generate(gen, args[i]);
+  llvm::Type* t = generate(gen, e.get_type());
+  llvm::Value* obj = llvm::UndefValue::get(t);
+  const expr_span& args = e.get_elements();
+  for (int i = 0; i < (int)args.size(); ++i) {
+    cg::value v = generate(gen, args[i]);
+    llvm::Builder ir(gen.get_current_block());
+    obj = ir.CreateInsertValue(obj, v, i);
   }
   return obj;
 }
 
-// Returns the projection of the nth term from the object denoted by `e`. Since
-// tuples are always stored, the generated object will always be a reference.
+/// Returns the nth element of the struct value denoted by `e`.
 cg::value
-generate_proj_expr(generator& gen, const proj_expr& e)
+generate_expr(generator& gen, const sys_tuple::proj_expr& e)
 {
-  const type& t = e.get_object().get_type();
-  const tuple_type& tt = cast<tuple_type>(t);
-  assert(e.get_element() < tt.get_element_types().size());
-
   cg::value obj = generate(gen, e.get_object());
-  
-  // Get the nth sub-object.
   llvm::Builder ir(gen.get_current_block());
-  llvm::Value *ix[] {
-    ir.getInt32(0),
-    ir.getInt32(e.get_element())
-  };
-  cg::value sub = ir.CreateInBoundsGEP(obj, ix);
-  
-  if (is_reference_expression(e.get_object())) {
-    // When e is a reference, return a reference to the subobject.
-    return sub;
-  }
-  else {
-    // Otherwise, return the value of the object. This also depends on whether
-    // or not the type of the nth element is indirect or not.
-    const type& et = tt.get_element_type(e.get_element());
-    cg::type elem = generate(gen, et);
-    if (elem.is_indirect())
-      return sub;
-    else
-      return ir.CreateLoad(sub);
-  }
+  return ir.CreateExtractValue(obj, e.get_element());
 }
 
-cg::value
-gen_algo::operator()(generator& gen, const expr& e) const
-{
-  switch (e.get_kind()) {
-    case tuple_expr_kind:
-      return generate_tuple_expr(gen, cast<tuple_expr>(e));
-    case proj_expr_kind:
-      return generate_proj_expr(gen, cast<proj_expr>(e));
-  }
-  assert(false && "not a tuple expression");
-}
-
-} // namespace sys_tuple
 } // namespace beaker
-
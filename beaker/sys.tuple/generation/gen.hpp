@@ -4,19 +4,21 @@
 #ifndef BEAKER_SYS_TUPLE_GENERATION_GEN_HPP
 #define BEAKER_SYS_TUPLE_GENERATION_GEN_HPP
 
+#include <beaker/sys.tuple/fwd.hpp>
+
 #include <beaker/base/generation/generation.hpp>
 
 
 namespace beaker {
-namespace sys_tuple {
 
-struct gen_algo : generate_algorithm
-{
-  cg::type operator()(generator&, const type&) const;
-  cg::value operator()(generator&, const expr&) const;
-};
+// -------------------------------------------------------------------------- //
+// Overrides
+
+cg::type generate_type(generator&, const sys_tuple::tuple_type&);
+
+cg::value generate_expr(generator&, const sys_tuple::tuple_expr&);
+cg::value generate_expr(generator&, const sys_tuple::proj_expr&);
 
-} // namespace sys_tuple
 } // namespace beaker
 
 
@@ -10,12 +10,14 @@
 namespace beaker {
 namespace sys_tuple {
 
-/// A feature defines an extensible set of terms that can be used with the
-/// beaker language runtime. In particular, this exposes a core set of 
-/// algorithms and facilities needed to operate on those terms.
-struct feature : feature_impl<sys_tuple_lang>
+struct builder;
+
+/// Adds support for tuple types and expressions.
+struct feature : beaker::feature
 {
-  feature(language&);
+  using builder_type = builder;
+
+  factory& make_builder(module&) const override;
 };
 
 } // namespace sys_tuple
@@ -9,54 +9,32 @@
 
 
 namespace beaker {
-namespace sys_tuple {
 
+/// Pretty print a tuple type `{t1, t2, ..., tn}`.
 void
-print_tuple_type(std::ostream& os, const tuple_type& t)
+print_type(pretty_printer& pp, const sys_tuple::tuple_type& t)
 {
-  print(os, '{');
-  print_comma_separated(os, t.get_element_types());
-  print(os, '}');
-}
-
-void 
-print_algo::operator()(std::ostream& os, const type& t) const
-{
-  print_tuple_type(os, cast<tuple_type>(t));
-}
-
-
-void
-print_tuple_expr(std::ostream& os, const tuple_expr& e)
-{
-  print(os, '{');
-  print_comma_separated(os, e.get_elements());
-  print(os, '}');
+  pp.print('{');
+  print_comma_separated(pp, t.get_element_types());
+  pp.print('}');
 }
 
+/// Pretty print a tuple expression `{e1, e2, ..., en}`.
 void
-print_proj_expr(std::ostream& os, const proj_expr& e)
+print_expr(pretty_printer& pp, const sys_tuple::tuple_expr& e)
 {
-  print(os, e.get_object());
-  print(os, '.');
-  print(os, e.get_element());
+  pp.print('{');
+  print_comma_separated(pp, e.get_elements());
+  pp.print('}');
 }
 
+/// Pretty print a projection `e.n`.
 void
-print_algo::operator()(std::ostream& os, const expr& e) const
+print_expr(pretty_printer& pp, const sys_tuple::proj_expr& e)
 {
-  switch (e.get_kind()) {
-    case tuple_expr_kind:
-      return print_tuple_expr(os, cast<tuple_expr>(e));
-    case proj_expr_kind:
-      return print_proj_expr(os, cast<proj_expr>(e));
-    default:
-      break;
-  }
-  assert(false && "not an tuple expression");
+  print_grouped_expr(pp, e.get_object());
+  pp.print('.');
+  pp.print((std::intmax_t)e.get_element()); // FIXME: Remove this cast
 }
 
-} // namespace sys_tuple
 } // namespace beaker
-
-
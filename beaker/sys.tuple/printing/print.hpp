@@ -4,19 +4,18 @@
 #ifndef BEAKER_SYS_TUPLE_PRINTING_PRINT_HPP
 #define BEAKER_SYS_TUPLE_PRINTING_PRINT_HPP
 
+#include <beaker/sys.tuple/fwd.hpp>
+
 #include <beaker/base/printing/print.hpp>
 
 
 namespace beaker {
-namespace sys_tuple {
 
-struct print_algo : print_algorithm
-{
-  void operator()(std::ostream&, const type&) const;
-  void operator()(std::ostream&, const expr&) const;
-};
+void print_type(pretty_printer&, const sys_tuple::tuple_type&);
+
+void print_expr(pretty_printer&, const sys_tuple::tuple_expr&);
+void print_expr(pretty_printer&, const sys_tuple::proj_expr&);
 
-} // namespace sys_tuple
 } // namespace beaker
 
 
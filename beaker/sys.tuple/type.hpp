@@ -13,7 +13,7 @@ namespace sys_tuple {
 enum 
 {
   first_type_kind = sys_tuple_lang_block,
-#define def_type(e) e ## _type_kind,
+#define def_type(NS, T) T ## _type_kind,
 #include "type.def"
   last_type_kind
 };
@@ -29,33 +29,27 @@ enum
 /// modeling their values as function pointers.
 struct tuple_type : object_type_impl<tuple_type_kind> 
 {
-  tuple_type(const type_seq&);
-  tuple_type(type_seq&&);
+  tuple_type(const type_span&);
 
-  const type_seq& get_element_types() const;
-  type_seq& get_element_types();
+  const type_span& get_element_types() const;
+  type_span& get_element_types();
 
   const type& get_element_type(int) const;
   type& get_element_type(int);
 
-  type_seq elems_;
+  type_span elems_;
 };
 
 inline 
-tuple_type::tuple_type(const type_seq& ts)
+tuple_type::tuple_type(const type_span& ts)
   : object_type_impl<tuple_type_kind>(), elems_(ts)
 { }
 
-inline 
-tuple_type::tuple_type(type_seq&& ts)
-  : object_type_impl<tuple_type_kind>(), elems_(std::move(ts))
-{ }
-
 /// Returns the sequence of element types.
-inline const type_seq& tuple_type::get_element_types() const { return elems_; }
+inline const type_span& tuple_type::get_element_types() const { return elems_; }
 
-// Returns the sequence of element types.
-inline type_seq& tuple_type::get_element_types() { return elems_; }
+/// Returns the sequence of element types.
+inline type_span& tuple_type::get_element_types() { return elems_; }
 
 /// Returns the nth element type.
 inline const type& tuple_type::get_element_type(int n) const { return elems_[n]; }
@@ -64,7 +58,22 @@ inline const type& tuple_type::get_element_type(int n) const { return elems_[n];
 inline type& tuple_type::get_element_type(int n) { return elems_[n]; }
 
 
+// -------------------------------------------------------------------------- //
+// Operations
+
+/// Returns true if `t` is a tuple type.
+inline bool
+is_tuple_type(const type& t)
+{
+  return t.get_kind() == tuple_type_kind;
+}
+
+
 } // namespace sys_tuple
+
+/// Tuple types are canonical.
+template<> struct is_canonical_term<sys_tuple::tuple_type> : std::true_type { };
+
 } // namespace beaker
 
 
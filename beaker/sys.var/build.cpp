@@ -13,7 +13,7 @@ namespace sys_var {
 
 builder::builder(module& m)
   : factory(m),
-    ref_(&make_canonical_set<ref_type>(get_language_allocator())) 
+    ref_(&get_canonical_set<ref_type>(get_language_allocator())) 
 { }
 
 /// Returns the canonical type `t&`.
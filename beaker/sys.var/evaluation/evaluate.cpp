@@ -0,0 +1,94 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "evaluate.hpp"
+#include "../type.hpp"
+#include "../expr.hpp"
+
+#include <beaker/base/decl.hpp>
+
+
+namespace beaker {
+
+/// The value of a reference to a variable is the address of the object
+/// bound to that variable. A reference variable already stores an address.
+/// The value of a reference to a function is the function.
+result
+evaluate_expr(evaluator& eval, const sys_var::ref_expr& e)
+{
+  const typed_decl& d = e.get_declaration();
+  const type& t = d.get_type();
+  if (is_function_type(t))
+    return value(d);
+  value* p = eval.lookup(d);
+  if (!p)
+    return eval.fail("reference to unbound declaration");
+  if (is_reference_type(t))
+    return *p;
+  return value(p);
+}
+
+/// The value of `val(e)` is the value stored in the object referred to by
+/// `e`. Functions are values, and are not dereferenced.
+result
+evaluate_expr(evaluator& eval, const sys_var::val_expr& e)
+{
+  result r = try_evaluate(eval, e.get_source());
+  if (!r || !is_object_type(e.get_type()))
+    return r;
+  return r.get_value().get_reference();
+}
+
+/// Stores the value of the RHS in the object referred to by the LHS. The
+/// value of the expression is the reference.
+result
+evaluate_expr(evaluator& eval, const sys_var::assign_expr& e)
+{
+  result r1 = try_evaluate(eval, e.get_lhs());
+  if (!r1)
+    return r1;
+  result r2 = try_evaluate(eval, e.get_rhs());
+  if (!r2)
+    return r2;
+  if (r2.get_value().is_aggregate())
+    eval.escape();
+  r1.get_value().get_reference() = r2.get_value();
+  return r1;
+}
+
+/// Trivial initialization leaves the object with an indeterminate value,
+/// which is represented by the void value.
+result
+evaluate_expr(evaluator& eval, const sys_var::nop_init& e)
+{
+  return value();
+}
+
+/// Zero initialization produces the integer 0, which represents the zero 
+/// value of every scalar type.
+///
+/// \todo Zero initialize aggregates.
+result
+evaluate_expr(evaluator& eval, const sys_var::zero_init& e)
+{
+  return value(0);
+}
+
+/// Copy initialization produces the value of its operand. When the 
+/// initializer is in tail position, so is its operand.
+result
+evaluate_expr(evaluator& eval, const sys_var::copy_init& e)
+{
+  if (eval.in_tail_position(e))
+    eval.set_tail_position(&e.get_expression());
+  return try_evaluate(eval, e.get_expression());
+}
+
+/// Reference initialization produces the address computed by its operand.
+result
+evaluate_expr(evaluator& eval, const sys_var::ref_init& e)
+{
+  return try_evaluate(eval, e.get_expression());
+}
+
+} // namespace beaker
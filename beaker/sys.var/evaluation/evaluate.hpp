@@ -0,0 +1,28 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_SYS_VAR_EVALUATION_EVALUATE_HPP
+#define BEAKER_SYS_VAR_EVALUATION_EVALUATE_HPP
+
+#include <beaker/sys.var/fwd.hpp>
+
+#include <beaker/base/evaluation/evaluate.hpp>
+
+
+namespace beaker {
+
+// -------------------------------------------------------------------------- //
+// Overrides
+
+result evaluate_expr(evaluator&, const sys_var::ref_expr&);
+result evaluate_expr(evaluator&, const sys_var::val_expr&);
+result evaluate_expr(evaluator&, const sys_var::assign_expr&);
+result evaluate_expr(evaluator&, const sys_var::nop_init&);
+result evaluate_expr(evaluator&, const sys_var::zero_init&);
+result evaluate_expr(evaluator&, const sys_var::copy_init&);
+result evaluate_expr(evaluator&, const sys_var::ref_init&);
+
+} // namespace beaker
+
+
+#endif
@@ -4,20 +4,26 @@
 #ifndef BEAKER_SYS_VAR_GENERATION_GEN_HPP
 #define BEAKER_SYS_VAR_GENERATION_GEN_HPP
 
+#include <beaker/sys.var/fwd.hpp>
+
 #include <beaker/base/generation/generation.hpp>
 
 
 namespace beaker {
-namespace sys_var {
 
-struct gen_algo : generate_algorithm
-{
-  cg::type operator()(generator&, const type&) const;
-  cg::value operator()(generator&, const expr&) const;
-  cg::value operator()(generator&, const decl&) const;
-};
+// -------------------------------------------------------------------------- //
+// Overrides
+
+cg::type generate_type(generator&, const sys_var::ref_type&);
+
+cg::value generate_expr(generator&, const sys_var::ref_expr&);
+cg::value generate_expr(generator&, const sys_var::val_expr&);
+cg::value generate_expr(generator&, const sys_var::assign_expr&);
+cg::value generate_expr(generator&, const sys_var::nop_init&);
+cg::value generate_expr(generator&, const sys_var::zero_init&);
+cg::value generate_expr(generator&, const sys_var::copy_init&);
+cg::value generate_expr(generator&, const sys_var::ref_init&);
 
-} // namespace sys_var
 } // namespace beaker
 
 
@@ -54,6 +54,10 @@ inline type& ref_type::get_object_type() { return *type_; }
 
 
 } // namespace sys_var
+
+/// Reference types are canonical.
+template<> struct is_canonical_term<sys_var::ref_type> : std::true_type { };
+
 } // namespace beaker
 
 
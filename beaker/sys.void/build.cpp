@@ -10,7 +10,7 @@ namespace sys_void {
 
 builder::builder(module& m)
   : factory(m),
-    void_(&make_singleton_set<void_type>(get_language_allocator()))
+    void_(&get_singleton_set<void_type>(get_language_allocator()))
 { }
 
 /// Returns a the `void` type.
@@ -8,25 +8,27 @@
 namespace beaker {
 
 /// Returns the void value.
-value
+result
 evaluate_expr(evaluator& eval, const sys_void::nop_expr& e)
 {
-  return {};
+  return value();
 }
 
 /// Evaluates the operand and returns the void value.
-value
+result
 evaluate_expr(evaluator& eval, const sys_void::void_expr& e)
 {
-  evaluate(eval, e.get_operand());
-  return {};
+  result r = try_evaluate(eval, e.get_operand());
+  if (!r)
+    return r;
+  return value();
 }
 
-/// Evaluation fails with a trap exception.
-value
+/// Evaluation fails with a trap.
+result
 evaluate_expr(evaluator& eval, const sys_void::trap_expr& e)
 {
-  throw sys_void::trap_error(e);
+  return eval.fail<sys_void::trap_error>(e);
 }
 
 
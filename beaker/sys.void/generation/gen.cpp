@@ -1,62 +1,52 @@
-// Copyright (c) 2015-2016 Andrew Sutton
+// Copyright (c) 2015-2017 Andrew Sutton
 // All rights reserved
 
 #include "gen.hpp"
 #include "../type.hpp"
 #include "../expr.hpp"
+#include "../evaluation/evaluate.hpp"
 
-#include <llvm/IR/Function.h>
-#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/Type.h>
 
 
 namespace beaker {
-namespace sys_void {
 
+/// Generates the LLVM void type.
 cg::type
-gen_algo::operator()(generator& gen, const type& t) const
+generate_type(generator& gen, const sys_void::void_type& t)
 {
-  assert(is_void_type(t));
   return llvm::Type::getVoidTy(gen.get_context());
 }
 
-/// Generate the code for the expression e and return nullptr.
-static cg::value
-generate_void_expr(generator& gen, const void_expr& e)
+/// Void expressions have no value.
+cg::value
+generate_expr(generator& gen, const sys_void::nop_expr& e)
 {
-  generate(gen, e.get_operand());
   return nullptr;
 }
 
-// Emits a trap instruction.
-//
-// FIXME: Emit a debug trap when debugging is enabled.
-static cg::value
-generate_trap_expr(generator& gen, const trap_expr& e)
+/// Generate the code for the operand and return no value.
+cg::value
+generate_expr(generator& gen, const sys_void::void_expr& e)
 {
-  llvm::Module& mod = gen.get_module();
-  llvm::Builder ir(gen.get_current_block());
-  cg::value op = llvm::Intrinsic::getDeclaration(&mod, llvm::Intrinsic::trap);
-  std::vector<llvm::Value*> args;
-  ir.CreateCall(op, args);
+  generate(gen, e.get_operand());
   return nullptr;
 }
 
+/// Raises a trap error.
+[[noreturn]] static void
+raise_trap(const expr& e)
+{
+  throw sys_void::trap_error(e);
+}
+
+/// Emits an unconditional failure. In unchecked code, this is a trap
+/// instruction.
 cg::value
-gen_algo::operator()(generator& gen, const expr& e) const
+generate_expr(generator& gen, const sys_void::trap_expr& e)
 {
-  switch (e.get_kind()) {
-    case nop_expr_kind:
-      return nullptr;
-    case void_expr_kind:
-      return generate_void_expr(gen, cast<void_expr>(e));
-    case trap_expr_kind:
-      return generate_trap_expr(gen, cast<trap_expr>(e));
-    default:
-      break;
-  }
-  assert(false && "not a void epxression");
+  gen.make_failure(e, raise_trap);
+  return nullptr;
 }
 
-} // namespace sys_void
 } // namespace beaker
-
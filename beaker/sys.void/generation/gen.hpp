@@ -4,19 +4,22 @@
 #ifndef BEAKER_SYS_VOID_GENERATION_GEN_HPP
 #define BEAKER_SYS_VOID_GENERATION_GEN_HPP
 
+#include <beaker/sys.void/fwd.hpp>
+
 #include <beaker/base/generation/generation.hpp>
 
 
 namespace beaker {
-namespace sys_void {
 
-struct gen_algo : generate_algorithm
-{
-  cg::type operator()(generator&, const type&) const override;
-  cg::value operator()(generator&, const expr&) const override;
-};
+// -------------------------------------------------------------------------- //
+// Overrides
+
+cg::type generate_type(generator&, const sys_void::void_type&);
+
+cg::value generate_expr(generator&, const sys_void::nop_expr&);
+cg::value generate_expr(generator&, const sys_void::void_expr&);
+cg::value generate_expr(generator&, const sys_void::trap_expr&);
 
-} // namespace sys_void
 } // namespace beaker
 
 
@@ -40,6 +40,10 @@ is_void_type(const type& t)
 }
 
 } // namespace sys_void
+
+/// The void type is a singleton.
+template<> struct is_canonical_term<sys_void::void_type> : std::true_type { };
+
 } // namespace beaker
 
 
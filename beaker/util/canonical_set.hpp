@@ -6,67 +6,228 @@
 
 #include <beaker/util/memory.hpp>
 #include <beaker/util/hash.hpp>
-#include <beaker/util/cast.hpp>
 
-#include <unordered_set>
+#include <cassert>
+#include <new>
+#include <utility>
 
 
 namespace beaker {
 
-/// A canonical set guarantees the uniqueness of objects based on their 
+/// A canonical set guarantees the uniqueness of objects based on their
 /// attributes.
 ///
 /// Canonical terms cannot be modified after construction. Doing so will
 /// result in undefined behavior.
 ///
-/// \note This uses an extra indirection as a compiler firewall due to the
-/// fact that libstdc++'s hash table requires T to be complete type. We would
-/// very much like to use this with only forward declarations available.
+/// The set is an open addressing hash table with linear probing. Its slots
+/// store the hash code of a term and a pointer to it, contiguously, so a
+/// probe compares terms only when their hash codes are equal. A term is
+/// looked up before it is allocated: the lookup uses a key, which is a
+/// temporary term, and new terms are allocated from the set's allocator.
+/// The slots are allocated from the same allocator.
+///
+/// \note The set needs T to be complete only where get() and intern() are
+/// used, so it can be declared with only forward declarations available.
 template<typename T, typename H, typename C>
 struct canonical_set
 {
   using hash_fn = H;
   using comp_fn = C;
-  using alloc_type = typed_allocator<T>;
-  using set_type = std::unordered_set<T, hash_fn, comp_fn, alloc_type>;
+
+  /// An entry in the table. A slot is empty when it has no term.
+  struct slot
+  {
+    std::size_t code;
+    T* term;
+  };
+
+  static constexpr int initial_capacity = 8;
 
   canonical_set(const H&, const C&);
   canonical_set(const H&, const C&, allocator&);
   ~canonical_set();
 
-  template<typename... Args> 
+  template<typename... Args>
   T& get(Args&&...);
 
-  set_type* set_;
+  template<typename F>
+  T& intern(const T&, F);
+
+  template<typename P>
+  void remove_if(P);
+
+  int size() const;
+  int capacity() const;
+
+  slot* find(const T&, std::size_t);
+  void grow();
+
+  H hash_;
+  C comp_;
+  allocator* alloc_;
+  slot* slots_;
+  int size_;
+  int cap_;
 };
 
 template<typename T, typename H, typename C>
-inline 
+constexpr int canonical_set<T, H, C>::initial_capacity;
+
+/// Allocate slots of size n from a.
+template<typename S>
+inline S*
+allocate_slots(allocator& a, int n)
+{
+  S* p = static_cast<S*>(a.allocate(n * sizeof(S), alignof(S)));
+  for (int i = 0; i < n; ++i)
+    p[i] = S {0, nullptr};
+  return p;
+}
+
+template<typename T, typename H, typename C>
+inline
 canonical_set<T, H, C>::canonical_set(const H& hash, const C& cmp)
-  : set_(new set_type(7, hash, cmp, alloc_type(default_allocator())))
+  : canonical_set(hash, cmp, default_allocator())
 { }
 
 template<typename T, typename H, typename C>
-inline 
-canonical_set<T, H, C>::canonical_set(const H& hash, const C& cmp, allocator& a) 
-  : set_(new set_type(7, hash, cmp, alloc_type(a)))
+inline
+canonical_set<T, H, C>::canonical_set(const H& hash, const C& cmp, allocator& a)
+  : hash_(hash),
+    comp_(cmp),
+    alloc_(&a),
+    slots_(allocate_slots<slot>(a, initial_capacity)),
+    size_(0),
+    cap_(initial_capacity)
 { }
 
 template<typename T, typename H, typename C>
-inline 
-canonical_set<T, H, C>::~canonical_set() 
-{ 
-  delete set_; 
+canonical_set<T, H, C>::~canonical_set()
+{
+  for (int i = 0; i < cap_; ++i) {
+    if (T* t = slots_[i].term) {
+      t->~T();
+      alloc_->deallocate(t, sizeof(T));
+    }
+  }
+  alloc_->deallocate(slots_, cap_ * sizeof(slot));
 }
 
-/// Get the canonical value of T for args.
+/// Returns the number of terms in the set.
+template<typename T, typename H, typename C>
+inline int canonical_set<T, H, C>::size() const { return size_; }
+
+/// Returns the number of slots in the table.
+template<typename T, typename H, typename C>
+inline int canonical_set<T, H, C>::capacity() const { return cap_; }
+
+/// Get the canonical value of T for args. The key is constructed from args
+/// on the stack. If there is no equal term, the key is moved into a new
+/// term.
 template<typename T, typename H, typename C>
-template<typename... Args> 
-inline T& 
+template<typename... Args>
+inline T&
 canonical_set<T, H, C>::get(Args&&... args)
 {
-  auto iter = set_->emplace(std::forward<Args>(args)...).first;
-  return modifiable(*iter);
+  T key(std::forward<Args>(args)...);
+  return intern(key, [&key](allocator& a) -> T* {
+    return new (a.allocate(sizeof(T), alignof(T))) T(std::move(key));
+  });
+}
+
+/// Returns the canonical term equal to key. If there is no such term, this
+/// calls make with the set's allocator to create one. The term returned by
+/// make shall be equal to key; it is usually a copy of key.
+///
+/// This is used when key refers to memory that the canonical term cannot
+/// (e.g., a sequence of operands owned by the caller).
+template<typename T, typename H, typename C>
+template<typename F>
+T&
+canonical_set<T, H, C>::intern(const T& key, F make)
+{
+  std::size_t code = hash_(key);
+  slot* s = find(key, code);
+  if (s->term)
+    return *s->term;
+
+  // Keep the table at most half full.
+  if (2 * (size_ + 1) > cap_) {
+    grow();
+    s = find(key, code);
+  }
+  T* t = make(*alloc_);
+  assert(comp_(*t, key));
+  s->code = code;
+  s->term = t;
+  ++size_;
+  return *t;
+}
+
+/// Returns the slot containing the term equal to key, whose hash code is
+/// code, or the empty slot where it would be inserted.
+template<typename T, typename H, typename C>
+inline auto
+canonical_set<T, H, C>::find(const T& key, std::size_t code) -> slot*
+{
+  std::size_t mask = cap_ - 1;
+  for (std::size_t i = code & mask; ; i = (i + 1) & mask) {
+    slot& s = slots_[i];
+    if (!s.term)
+      return &s;
+    if (s.code == code && comp_(*s.term, key))
+      return &s;
+  }
+}
+
+/// Removes each term `t` for which `pred(t)` is true. Removed terms are 
+/// not destroyed; this is used when they are owned by another allocator.
+/// The remaining terms are reinserted into a new table of the same
+/// capacity.
+template<typename T, typename H, typename C>
+template<typename P>
+void
+canonical_set<T, H, C>::remove_if(P pred)
+{
+  std::size_t mask = cap_ - 1;
+  slot* slots = allocate_slots<slot>(*alloc_, cap_);
+  size_ = 0;
+  for (int i = 0; i < cap_; ++i) {
+    slot& s = slots_[i];
+    if (!s.term || pred(*s.term))
+      continue;
+    std::size_t j = s.code & mask;
+    while (slots[j].term)
+      j = (j + 1) & mask;
+    slots[j] = s;
+    ++size_;
+  }
+  alloc_->deallocate(slots_, cap_ * sizeof(slot));
+  slots_ = slots;
+}
+
+/// Doubles the capacity of the table. Terms are reinserted using their
+/// stored hash codes; they are not compared.
+template<typename T, typename H, typename C>
+void
+canonical_set<T, H, C>::grow()
+{
+  int n = 2 * cap_;
+  std::size_t mask = n - 1;
+  slot* slots = allocate_slots<slot>(*alloc_, n);
+  for (int i = 0; i < cap_; ++i) {
+    slot& s = slots_[i];
+    if (!s.term)
+      continue;
+    std::size_t j = s.code & mask;
+    while (slots[j].term)
+      j = (j + 1) & mask;
+    slots[j] = s;
+  }
+  alloc_->deallocate(slots_, cap_ * sizeof(slot));
+  slots_ = slots;
+  cap_ = n;
 }
 
 } // namespace beaker
@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <type_traits>
 #include <typeinfo>
 
@@ -38,10 +39,99 @@ constexpr std::size_t basis() { return basis_64(); }
 } // namespace fnv1_detail
 
 
-// The fnv1a hash algorithm is the default hasher.
+namespace word_detail {
+
+constexpr std::uint64_t seed() { return 0xa0761d6478bd642full; }
+constexpr std::uint64_t secret_0() { return 0xe7037ed1a0b428dbull; }
+constexpr std::uint64_t secret_1() { return 0x8ebc6af09c88c6e3ull; }
+
+// Returns the high and low halves of the 128-bit product of a and b, 
+// combined with xor.
+inline std::uint64_t
+mix(std::uint64_t a, std::uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+  return static_cast<std::uint64_t>(r >> 64) ^ static_cast<std::uint64_t>(r);
+#else
+  std::uint64_t ha = a >> 32, la = a & 0xffffffffu;
+  std::uint64_t hb = b >> 32, lb = b & 0xffffffffu;
+  std::uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+  std::uint64_t mid = (ll >> 32) + (hl & 0xffffffffu) + (lh & 0xffffffffu);
+  std::uint64_t lo = (mid << 32) | (ll & 0xffffffffu);
+  std::uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+  return hi ^ lo;
+#endif
+}
+
+// The finalizer of MurmurHash3, which spreads every bit of x over all bits
+// of the result.
+inline std::uint64_t
+finish(std::uint64_t x)
+{
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+} // namespace word_detail
+
+
+// The default hasher absorbs its input 8 bytes at a time. Each word is
+// folded into the state with a 64x64 to 128-bit multiplication (as in 
+// wyhash), and the state is finalized when the hash code is requested.
+// The product is zero when a word equals the secret with which it is 
+// combined, so the previous state and the word are also added to the
+// result; no input word can discard the words absorbed before it.
+//
+// Input is not buffered between calls: each call absorbs its own words and
+// a final partial word. The hash code of a sequence of values therefore
+// depends on how those values are divided among calls. That is always the
+// case for values hashed by the same hash() overloads.
 struct hasher
 {
   hasher()
+    : code(word_detail::seed())
+  { }
+
+  void operator()(const void* p, int n) 
+  {
+    const char* first = static_cast<const char*>(p);
+    for ( ; n >= 8; first += 8, n -= 8) {
+      std::uint64_t w;
+      std::memcpy(&w, first, 8);
+      absorb(w);
+    }
+    if (n) {
+      std::uint64_t w = 0;
+      std::memcpy(&w, first, n);
+      absorb(w ^ (std::uint64_t(n) << 59));
+    }
+  }
+
+  void absorb(std::uint64_t w)
+  {
+    code = word_detail::mix(w ^ word_detail::secret_0(), 
+                            code ^ word_detail::secret_1()) ^ (code + w);
+  }
+
+  operator std::size_t() const 
+  {
+    return word_detail::finish(code);
+  }
+
+  std::uint64_t code;
+};
+
+
+// The fnv1a hash algorithm, which absorbs its input one byte at a time.
+// This was the default hasher, and it is retained for comparison.
+struct fnv1a_hasher
+{
+  fnv1a_hasher()
     : code(fnv1_detail::basis())
   { }
 
@@ -62,7 +152,7 @@ struct hasher
 };
 
 
-// A std-compatible hash function using fnv1a and append.
+// A std-compatible hash function using the default hasher and append.
 struct universal_hash
 {
   template<typename T>
@@ -86,7 +176,7 @@ struct universal_eq
 };
 
 
-// A std-compatible hash function using fnv1a and append.
+// A std-compatible hash function using the default hasher and append.
 struct indirect_hash
 {
   template<typename T>
@@ -7,6 +7,7 @@
 #include <array>
 #include <iosfwd>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 
@@ -248,6 +249,84 @@ locatable::set_variable_layout(std::vector<location>&& locs)
   locs_.reset(new vector_layout(std::move(locs)));
 }
 
+
+/// A layout map stores the layouts of terms outside of those terms. This
+/// is used for terms that are shared (e.g., hash-consed expressions): a
+/// shared term can occur at several places in the source code, so it has
+/// a layout for each occurrence, in the order they were added.
+struct layout_map
+{
+  template<typename... Args>
+  void add_fixed_layout(const locatable&, Args... args);
+
+  void add_variable_layout(const locatable&, const std::vector<location>&);
+  void add_variable_layout(const locatable&, std::vector<location>&&);
+
+  int count(const locatable&) const;
+  const layout& get_layout(const locatable&, int) const;
+
+  template<typename P>
+  void remove_if(P);
+
+  void clear();
+
+  std::unordered_map<const locatable*, std::vector<std::unique_ptr<layout>>> map_;
+};
+
+/// Adds a layout of the locations in `args` for an occurrence of `t`.
+template<typename... Args>
+inline void
+layout_map::add_fixed_layout(const locatable& t, Args... args)
+{
+  map_[&t].emplace_back(new array_layout<sizeof...(Args)>({args...}));
+}
+
+/// Adds a layout of a sequence of locations for an occurrence of `t`.
+inline void
+layout_map::add_variable_layout(const locatable& t, const std::vector<location>& locs)
+{
+  map_[&t].emplace_back(new vector_layout(locs));
+}
+
+/// Adds a layout of a sequence of locations for an occurrence of `t`.
+inline void
+layout_map::add_variable_layout(const locatable& t, std::vector<location>&& locs)
+{
+  map_[&t].emplace_back(new vector_layout(std::move(locs)));
+}
+
+/// Returns the number of layouts of `t`.
+inline int
+layout_map::count(const locatable& t) const
+{
+  auto iter = map_.find(&t);
+  return iter != map_.end() ? iter->second.size() : 0;
+}
+
+/// Returns the nth layout of `t`.
+inline const layout&
+layout_map::get_layout(const locatable& t, int n) const
+{
+  return *map_.at(&t)[n];
+}
+
+/// Removes all layouts from the map.
+/// Removes the layouts of each term `t` for which `pred(t)` is true.
+template<typename P>
+void
+layout_map::remove_if(P pred)
+{
+  for (auto iter = map_.begin(); iter != map_.end(); ) {
+    if (pred(*iter->first))
+      iter = map_.erase(iter);
+    else
+      ++iter;
+  }
+}
+
+/// Removes all layouts.
+inline void layout_map::clear() { map_.clear(); }
+
 } // namespace beaker
 
 
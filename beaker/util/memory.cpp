@@ -3,26 +3,83 @@
 
 #include "memory.hpp"
 
+#include <algorithm>
+#include <iostream>
 #include <new>
 
+#if defined(__unix__) || defined(__APPLE__)
+#  include <sys/mman.h>
+#endif
+
 
 namespace beaker
 {
 
+/// Accumulate the statistics of another allocator.
+allocation_stats&
+allocation_stats::operator+=(const allocation_stats& x)
+{
+  allocations += x.allocations;
+  requested += x.requested;
+  alignment += x.alignment;
+  tail += x.tail;
+  blocks += x.blocks;
+  footprint += x.footprint;
+  peak += x.peak;
+  return *this;
+}
+
+void
+write_json(std::ostream& os, const allocation_stats& s)
+{
+  os << "{\"allocations\": " << s.allocations
+     << ", \"requested\": " << s.requested
+     << ", \"alignment\": " << s.alignment
+     << ", \"tail\": " << s.tail
+     << ", \"blocks\": " << s.blocks
+     << ", \"footprint\": " << s.footprint
+     << ", \"peak\": " << s.peak
+     << '}';
+}
+
+
+allocation_stats
+allocator::get_stats() const
+{
+  return {};
+}
+
+void
+allocator::deallocate(void* p, int)
+{
+  deallocate(p);
+}
+
+
 void*
 freestore_allocator::allocate(int n)
 {
+#if BEAKER_ALLOC_STATS
+  ++stats_.allocations;
+  stats_.requested += n;
+#endif
   return ::operator new(n);
 }
 
-// TODO: This can be implemented using the new over-aligned allocation
-// support in C++17. In the meantime, we could just allocate a block
-// of memory large enough to contain n + a and then return the pointer
-// to an address aligned at a.
+// The global operator new returns memory suitably aligned for any
+// fundamental type, so only those alignments are supported.
+//
+// TODO: Over-aligned allocation can be implemented using the new
+// over-aligned allocation support in C++17.
 void*
 freestore_allocator::allocate(int n, int a)
 {
-  assert(false && "not implemented");
+  assert(a <= (int)alignof(std::max_align_t) && "over-aligned allocation");
+#if BEAKER_ALLOC_STATS
+  ++stats_.allocations;
+  stats_.requested += n;
+#endif
+  return ::operator new(n);
 }
 
 void
@@ -31,6 +88,245 @@ freestore_allocator::deallocate(void* p)
   ::operator delete(p);
 }
 
+void
+freestore_allocator::deallocate(void* p, int n)
+{
+  ::operator delete(p, std::size_t(n));
+}
+
+allocation_stats
+freestore_allocator::get_stats() const
+{
+  return stats_;
+}
+
+
+// The size of a huge page. Ranges that use huge pages are aligned to this
+// size so that the system can map them with huge pages.
+constexpr std::size_t huge_page_size = std::size_t(1) << 21;
+
+// The granularity at which released memory is returned to the system.
+constexpr std::size_t page_size = std::size_t(1) << 12;
+
+// Reserve n bytes of virtual memory. If huge is true, the system is advised
+// to back the range with huge pages, if supported.
+//
+// When memory mapping is not supported, the range is allocated from the
+// freestore, and memory is not committed lazily.
+mapped_allocator::mapped_allocator(std::size_t n, bool huge)
+  : map_(), 
+    size_(huge ? n + huge_page_size : n), 
+    base_(), 
+    current_(), 
+    limit_(), 
+    top_(), 
+    huge_(false),
+    free_(),
+    free_bytes_()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#  if defined(MAP_NORESERVE)
+  flags |= MAP_NORESERVE;
+#  endif
+  void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (p == MAP_FAILED)
+    throw std::bad_alloc();
+  map_ = static_cast<char*>(p);
+#else
+  map_ = static_cast<char*>(::operator new(size_));
+#endif
+
+  base_ = map_;
+  if (huge) {
+    std::uintptr_t a = reinterpret_cast<std::uintptr_t>(map_);
+    base_ += (huge_page_size - a % huge_page_size) % huge_page_size;
+#if defined(MADV_HUGEPAGE)
+    huge_ = ::madvise(base_, n, MADV_HUGEPAGE) == 0;
+#endif
+  }
+  current_ = base_;
+  limit_ = base_ + n;
+}
+
+// Return the reserved range to the system.
+mapped_allocator::~mapped_allocator()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  ::munmap(map_, size_);
+#else
+  ::operator delete(map_);
+#endif
+}
+
+// Allocate n bytes with the strictest fundamental alignment.
+void*
+mapped_allocator::allocate(int n)
+{
+  return allocate(n, alignof(std::max_align_t));
+}
+
+// Allocate n bytes aligned to a bytes. The header is stored immediately
+// before the allocated memory. Free memory is reused when possible.
+void*
+mapped_allocator::allocate(int n, int a)
+{
+  assert(n >= 0);
+  assert(a > 0 && (a & (a - 1)) == 0);
+  a = std::max<int>(a, alignof(header));
+  if (void* p = reuse(n, a))
+    return p;
+
+  std::uintptr_t p = reinterpret_cast<std::uintptr_t>(current_);
+  p = (p + sizeof(header) + a - 1) & ~std::uintptr_t(a - 1);
+  std::uintptr_t l = reinterpret_cast<std::uintptr_t>(limit_);
+  if (p > l || l - p < std::uintptr_t(n))
+    throw std::bad_alloc();
+
+  char* addr = reinterpret_cast<char*>(p);
+  new (addr - sizeof(header)) header {current_, top_, n, false};
+#if BEAKER_ALLOC_STATS
+  ++stats_.allocations;
+  stats_.requested += n;
+  stats_.alignment += addr - current_ - sizeof(header);
+#endif
+  current_ = addr + n;
+  top_ = addr;
+  ++stats_.blocks;
+  update_stats();
+  return addr;
+}
+
+// Returns the header of the allocation at p.
+inline auto
+mapped_allocator::get_header(char* p) const -> header*
+{
+  return reinterpret_cast<header*>(p - sizeof(header));
+}
+
+// Returns free memory of at least n bytes aligned to a bytes, or nullptr if
+// there is none. The smallest free allocation that fits is chosen, but not
+// one more than twice the requested size.
+void*
+mapped_allocator::reuse(int n, int a)
+{
+  for (auto iter = free_.lower_bound(n); iter != free_.end(); ++iter) {
+    if (iter->first / 2 > n)
+      break;
+    char* addr = iter->second;
+    if (reinterpret_cast<std::uintptr_t>(addr) % a != 0)
+      continue;
+    header* h = get_header(addr);
+    h->free = false;
+    free_bytes_ -= h->size;
+    free_.erase(iter);
+#if BEAKER_ALLOC_STATS
+    ++stats_.allocations;
+    stats_.requested += n;
+#endif
+    ++stats_.blocks;
+    update_stats();
+    return addr;
+  }
+  return nullptr;
+}
+
+// Rewind the allocator to its state before the most recent allocation.
+inline void
+mapped_allocator::rewind()
+{
+  header* h = get_header(top_);
+  current_ = h->current;
+  top_ = h->top;
+}
+
+// Return the pages entirely within [first, last) to the system. Their 
+// contents are lost, but the range remains reserved.
+void
+mapped_allocator::discard(char* first, char* last)
+{
+#if defined(__unix__) || defined(__APPLE__)
+  std::uintptr_t f = reinterpret_cast<std::uintptr_t>(first);
+  std::uintptr_t l = reinterpret_cast<std::uintptr_t>(last);
+  f = (f + page_size - 1) & ~std::uintptr_t(page_size - 1);
+  l = l & ~std::uintptr_t(page_size - 1);
+  if (f < l)
+    ::madvise(reinterpret_cast<char*>(f), l - f, MADV_DONTNEED);
+#endif
+}
+
+// The footprint is the memory between the start of the range and the most
+// recent allocation, excluding free memory.
+inline void
+mapped_allocator::update_stats()
+{
+  stats_.footprint = (current_ - base_) - free_bytes_;
+  stats_.peak = std::max(stats_.peak, stats_.footprint);
+}
+
+// If p is the most recent allocation, rewind the allocator to its state
+// before p was allocated, and then over any free memory preceding it.
+// Otherwise, add p to the free list.
+void
+mapped_allocator::deallocate(void* p)
+{
+  if (!p)
+    return;
+  char* addr = static_cast<char*>(p);
+  header* h = get_header(addr);
+  assert(!h->free && "memory already deallocated");
+  --stats_.blocks;
+  if (addr != top_) {
+    h->free = true;
+    free_.emplace(h->size, addr);
+    free_bytes_ += h->size;
+    discard(addr, addr + h->size);
+    update_stats();
+    return;
+  }
+
+  char* last = current_;
+  rewind();
+  while (top_ && get_header(top_)->free) {
+    header* t = get_header(top_);
+    auto range = free_.equal_range(t->size);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (iter->second == top_) {
+        free_.erase(iter);
+        break;
+      }
+    }
+    free_bytes_ -= t->size;
+    rewind();
+  }
+  discard(current_, last);
+  update_stats();
+}
+
+allocation_stats
+mapped_allocator::get_stats() const
+{
+  return stats_;
+}
+
+
+// The statistics of the pool are those of the sequential allocator from 
+// which size classes are allocated, except that allocations and bytes 
+// requested are counted for each request.
+allocation_stats
+pool_allocator::get_stats() const
+{
+  allocation_stats s = blocks_.get_stats();
+  s.allocations = stats_.allocations;
+  s.requested = stats_.requested;
+  return s;
+}
+
+constexpr int pool_allocator::granularity;
+constexpr int pool_allocator::num_classes;
+constexpr int pool_allocator::max_size;
+
+
 allocator&
 default_allocator()
 {
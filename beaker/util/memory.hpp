@@ -5,17 +5,55 @@
 #define BEAKER_UTIL_MEMORY_HPP
 
 #include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
 #include <memory>
+#include <new>
 
 
 namespace beaker
 {
 
+// Statistics about the memory allocated by an allocator.
+//
+// The number of allocations and the bytes requested and padded for alignment
+// are counted only when the library is configured with BEAKER_ALLOC_STATS, 
+// because these are counted on every allocation. They are totals over the
+// lifetime of the allocator. The remaining statistics are maintained only
+// when blocks of memory are acquired or released, and always available. 
+// These describe memory currently held by the allocator: the number of 
+// blocks, their total size (the footprint), and the unused memory at the
+// end of blocks that are no longer allocated from. The peak is the largest
+// footprint over the lifetime of the allocator.
+struct allocation_stats
+{
+  allocation_stats& operator+=(const allocation_stats&);
+
+  std::size_t allocations = 0;
+  std::size_t requested = 0;
+  std::size_t alignment = 0;
+  std::size_t tail = 0;
+  std::size_t blocks = 0;
+  std::size_t footprint = 0;
+  std::size_t peak = 0;
+};
+
+/// Write the statistics as a JSON object.
+void write_json(std::ostream&, const allocation_stats&);
+
+
 // The base class of all allocators.
 struct allocator
 {
   virtual ~allocator() = default;
 
+  // Returns statistics about allocated memory. By default, no statistics are
+  // collected.
+  virtual allocation_stats get_stats() const;
+
   // Allocate n bytes of storage.
   virtual void* allocate(int) = 0;
 
@@ -25,6 +63,11 @@ struct allocator
 
   // Deallocate the indicated storage.
   virtual void deallocate(void*) = 0;
+
+  // Deallocate the indicated storage of n bytes. The size shall be that of
+  // the request for which the storage was allocated. Allocators that recycle
+  // memory by size override this. By default, the size is ignored.
+  virtual void deallocate(void*, int);
 };
 
 
@@ -36,13 +79,105 @@ allocator& default_allocator();
 // Freestore allocation
 
 // An allocator that uses new and delete.
+//
+// Each allocation is a block. The size of a block is not known when it is
+// deallocated, so only the number of allocations and bytes requested are
+// counted.
 struct freestore_allocator : allocator
 {
   void* allocate(int) override;
   void* allocate(int, int) override;
   void deallocate(void*) override;
+  void deallocate(void*, int) override;
+
+  allocation_stats get_stats() const override;
+
+  allocation_stats stats_;
+};
+
+
+// -------------------------------------------------------------------------- //
+// Mapped allocation
+
+// An allocator that allocates from a single range of virtual memory, which is
+// reserved when the allocator is created. Memory is committed by the system
+// when it is first touched, so reserving a large range is inexpensive. All 
+// memory is returned to the system, at once, when the allocator is destroyed.
+//
+// The mapped allocator is intended to be the source of blocks for the 
+// sequential allocators of a module (see node_store). A large range of
+// contiguous memory reduces the number of system calls made to acquire 
+// blocks and, when huge pages are requested, the number of TLB misses
+// incurred by traversing terms.
+//
+// Each allocation is preceded by a header that records the state of the
+// allocator before the allocation and the size of the allocation. 
+// Deallocating the most recent allocation rewinds the allocator, so memory
+// released by the sequential allocator (which releases blocks from the 
+// newest) is reused. Other deallocations add the memory to a free list, 
+// from which later requests of a similar size are allocated, and the
+// allocator is rewound over free memory when it becomes the most recent
+// allocation. This lets the blocks of modules and checkpoints released in
+// any order be reused (e.g., in the node region; see default_node_allocator).
+// The pages of released memory are returned to the system.
+//
+// Allocation fails with std::bad_alloc when the reserved range is exhausted.
+struct mapped_allocator : allocator
+{
+  struct header
+  {
+    char* current;
+    char* top;
+    int size;
+    bool free;
+  };
+
+  explicit mapped_allocator(std::size_t, bool = false);
+  ~mapped_allocator();
+
+  mapped_allocator(const mapped_allocator&) = delete;
+  mapped_allocator& operator=(const mapped_allocator&) = delete;
+
+  using allocator::deallocate;
+
+  void* allocate(int) override;
+  void* allocate(int, int) override;
+  void deallocate(void*) override;
+
+  allocation_stats get_stats() const override;
+
+  const char* begin() const;
+  const char* end() const;
+  bool uses_huge_pages() const;
+
+  // Private methods.
+  header* get_header(char*) const;
+  void* reuse(int, int);
+  void rewind();
+  void discard(char*, char*);
+  void update_stats();
+
+  char* map_;
+  std::size_t size_;
+  char* base_;
+  char* current_;
+  char* limit_;
+  char* top_;
+  bool huge_;
+  std::multimap<int, char*> free_;
+  std::size_t free_bytes_;
+  allocation_stats stats_;
 };
 
+// Returns the beginning of the reserved range of memory.
+inline const char* mapped_allocator::begin() const { return base_; }
+
+// Returns the end of the reserved range of memory.
+inline const char* mapped_allocator::end() const { return limit_; }
+
+// Returns true if the system was advised to use huge pages for the range.
+inline bool mapped_allocator::uses_huge_pages() const { return huge_; }
+
 
 // -------------------------------------------------------------------------- //
 // Sequential allocation
@@ -61,49 +196,99 @@ struct freestore_allocator : allocator
 //    | B | P |       Allocatable memory         |
 //    +---+---+----------------------------------+
 //
-// B is the "control block" portion of the memory. It essentially contains a
-// pointer to the next block (or nullptr in the last case). P is the current
-// allocation pointer. When memory is allocated, this is incremented to consume
-// the rest of the allocatable memory.
+// B is the "control block" portion of the memory. It contains a pointer to 
+// the previously allocated block (or nullptr for the first), the size of 
+// the block, and the number of bytes left unused when the allocator moved
+// on to a new block. P is the current allocation pointer. When memory is 
+// allocated, this is incremented to consume the rest of the allocatable 
+// memory.
+//
+// The first block has S bytes, and each new block is twice the size of the
+// previous one, up to max_block_size bytes. Large modules require few blocks
+// and the memory wasted at the end of each block is small relative to its 
+// size.
 //
-// TODO: Support aligned allocation. The allocate() function would take the
-// alignment as a second argument and guarantee that the pointer was a multiple
-// of that value.
+// Allocations that are large relative to the blocks being allocated (more 
+// than a quarter of the next block's size) are "jumbo" allocations. Each is
+// given a block of its own, which is linked into the chain but does not 
+// replace the current block, so allocation continues in the current block
+// afterwards. There is no limit on the size of an allocation.
 //
-// NOTE: This is not compatible with standard allocators because it isn't typed. 
+// A mark records the state of the allocator. Releasing a mark rewinds the 
+// allocator to that state: blocks allocated after the mark are returned to 
+// the underlying allocator, and memory allocated after the mark in the 
+// block that was current is reused. Because the block chain is ordered from
+// the newest block, the blocks allocated after a mark are the prefix of the
+// chain. Marks must be released in the reverse order in which they were
+// taken, and objects allocated after the mark are not destroyed.
+//
+// NOTE: This is not compatible with standard allocators because it isn't 
+// typed.
 template<int S = 8192>
 struct sequential_allocator : allocator
 {
   struct block
   {
     block* next;
+    int size;
   };
 
+  /// A position in the allocator.
+  struct mark
+  {
+    block* head;
+    char* current;
+    char* limit;
+    int size;
+    std::size_t tail;
+  };
+
+  static constexpr int max_block_size = S > (1 << 20) ? S : (1 << 20);
+
   sequential_allocator()
     : sequential_allocator(default_allocator())
   { }
 
   sequential_allocator(allocator& a)
-    : alloc_(&a), current_(0), head_(), tail_()
+    : alloc_(&a), current_(), limit_(), head_(), size_(S)
   { }
 
   ~sequential_allocator();
 
+  allocator& get_block_allocator() const;
+  void set_block_allocator(allocator&);
+
+  using allocator::deallocate;
+
   void* allocate(int) override;
   void* allocate(int, int) override;
   void deallocate(void*) override;
 
+  mark get_mark() const;
+  void release(mark);
+  bool allocated_since(const mark&, const void*) const;
+
+  allocation_stats get_stats() const override;
+
   // Private methods.
   char* limit() const;
   int over(int) const;
+  void* allocate_slow(int, int);
+  void* allocate_jumbo(int, int);
+  void* acquire(int);
   void extend();
 
   allocator* alloc_;
   char* current_;
+  char* limit_;
   block* head_;
-  block* tail_;
+  int size_;
+  allocation_stats stats_;
 };
 
+template<int S>
+constexpr int sequential_allocator<S>::max_block_size;
+
 // Destroy the allocator, releasing all of it's allocated memory.
 template<int S>
 sequential_allocator<S>::~sequential_allocator()
@@ -117,25 +302,39 @@ sequential_allocator<S>::~sequential_allocator()
   }
 }
 
+// Returns the allocator from which blocks are allocated.
+template<int S>
+inline allocator&
+sequential_allocator<S>::get_block_allocator() const
+{
+  return *alloc_;
+}
+
+// Sets the allocator from which blocks are allocated. This is only valid 
+// before any memory has been allocated.
+template<int S>
+inline void
+sequential_allocator<S>::set_block_allocator(allocator& a)
+{
+  assert(!head_ && "allocator in use");
+  alloc_ = &a;
+}
+
 // Allocate n bytes of memory from the current block.
-//
-// TODO: What if n is greater than the size of the block. We could actually
-// allocate a "jumbo block" and link that into the chain.
 template<int S>
-void*
+inline void*
 sequential_allocator<S>::allocate(int n)
 {
-  assert(n < S - (int)sizeof(block));
-  
-  // Guarantee that we have an initial block.
-  if (!head_)
-    extend();
+  assert(n >= 0);
+#if BEAKER_ALLOC_STATS
+  ++stats_.allocations;
+  stats_.requested += n;
+#endif
 
   // If the allocation would exceed the current block, allocate a new
-  // one and update the current pointer.
-  char* limit = reinterpret_cast<char*>(tail_) + S;
-  if (limit - current_ < n)
-    extend();
+  // block (or a jumbo block).
+  if (limit_ - current_ < n)
+    return allocate_slow(n, 1);
 
   // Bump the pointer and return the address where the object will be
   // allocated.
@@ -146,30 +345,27 @@ sequential_allocator<S>::allocate(int n)
 
 // Allocate n bytes of memory from the current block aligned to the number
 // of bytes required by align.
-//
-// TODO: What if n is greater than the size of the block. We could actually
-// allocate a "jumbo block" and link that into the chain.
 template<int S>
-void*
+inline void*
 sequential_allocator<S>::allocate(int n, int a)
 {
-  assert(n < S - (int)sizeof(block));
-  assert(a > 0);
-  
-  // Guarantee that we have a block.
-  if (!head_)
-    extend();
+  assert(n >= 0);
+  assert(a > 0 && (a & (a - 1)) == 0);
+#if BEAKER_ALLOC_STATS
+  ++stats_.allocations;
+  stats_.requested += n;
+#endif
   
-  // Compute the adjustment needed to align the allocation. If that adjustment,
-  // along with the original request exceeds the limit of the current block,
-  // then extend the store and re-compute the adjustment. Then align the
-  // current pointer.
+  // Compute the adjustment needed to align the allocation. If that 
+  // adjustment, along with the original request exceeds the limit of the 
+  // current block, then allocate from a new block.
   int k = over(a) ? a - over(a) : 0;
-  if (limit() - current_ < n + k) {
-    extend();
-    k = over(a) ? a - over(a) : 0;
-  }
+  if (limit_ - current_ < n + k)
+    return allocate_slow(n, a);
   current_ += k;
+#if BEAKER_ALLOC_STATS
+  stats_.alignment += k;
+#endif
 
   // Bump the pointer and return the address where the object will be
   // allocated.
@@ -184,42 +380,266 @@ void
 sequential_allocator<S>::deallocate(void* p)
 { }
 
+// Returns the current position in the allocator.
+template<int S>
+inline typename sequential_allocator<S>::mark
+sequential_allocator<S>::get_mark() const
+{
+  return {head_, current_, limit_, size_, stats_.tail};
+}
+
+// Release all memory allocated after the mark m.
+template<int S>
+void
+sequential_allocator<S>::release(mark m)
+{
+  while (head_ != m.head) {
+    assert(head_ && "invalid mark");
+    block* q = head_->next;
+    --stats_.blocks;
+    stats_.footprint -= head_->size;
+    head_->~block();
+    alloc_->deallocate(head_);
+    head_ = q;
+  }
+  current_ = m.current;
+  limit_ = m.limit;
+  size_ = m.size;
+  stats_.tail = m.tail;
+}
+
+// Returns true if p was allocated after the mark m; that memory is released
+// by releasing m. This is either in a block allocated after the mark, or in
+// the part of the block that was current at the mark that was not yet used.
+template<int S>
+bool
+sequential_allocator<S>::allocated_since(const mark& m, const void* p) const
+{
+  const char* q = static_cast<const char*>(p);
+  for (block* b = head_; b != m.head; b = b->next) {
+    const char* s = reinterpret_cast<const char*>(b);
+    if (s <= q && q < s + b->size)
+      return true;
+  }
+  return m.current <= q && q < m.limit;
+}
+
+// Returns statistics about the allocator.
+template<int S>
+allocation_stats
+sequential_allocator<S>::get_stats() const
+{
+  return stats_;
+}
+
 // Returns a pointer past the end of the current block.
 template<int S>
-char*
+inline char*
 sequential_allocator<S>::limit() const
 {
-  return reinterpret_cast<char*>(tail_) + S;
+  return limit_;
 }
 
-// Returns the current offset modulo an alignment value.
+// Returns the current offset modulo an alignment value. The alignment must
+// be a power of two.
 template<int S>
-int
+inline int
 sequential_allocator<S>::over(int a) const
 {
-  return reinterpret_cast<std::uintptr_t>(current_) % a;
+  return reinterpret_cast<std::uintptr_t>(current_) & (a - 1);
+}
+
+// Allocate n bytes aligned to a bytes when the current block cannot hold
+// the request. Jumbo requests are allocated in their own block. Otherwise,
+// a new current block is allocated.
+template<int S>
+void*
+sequential_allocator<S>::allocate_slow(int n, int a)
+{
+  if (n + a > size_ / 4)
+    return allocate_jumbo(n, a);
+  extend();
+
+  // Blocks are allocated with the strictest fundamental alignment, so
+  // only stricter alignments need adjustment.
+  int k = over(a) ? a - over(a) : 0;
+#if BEAKER_ALLOC_STATS
+  stats_.alignment += k;
+#endif
+  char* addr = current_ + k;
+  current_ = addr + n;
+  return addr;
+}
+
+// Allocate a block that holds exactly n bytes aligned to a bytes. The block
+// is linked into the chain, but the current block is unchanged.
+template<int S>
+void*
+sequential_allocator<S>::allocate_jumbo(int n, int a)
+{
+  int k = sizeof(block) + n + a;
+  assert(k > n && "allocation size overflow");
+  block* b = new (acquire(k)) block { head_, k };
+  head_ = b;
+  std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(b + 1);
+  addr = (addr + a - 1) & ~std::uintptr_t(a - 1);
+#if BEAKER_ALLOC_STATS
+  stats_.alignment += addr - reinterpret_cast<std::uintptr_t>(b + 1);
+#endif
+  return reinterpret_cast<void*>(addr);
+}
+
+// Allocate a block of n bytes from the underlying allocator.
+template<int S>
+void*
+sequential_allocator<S>::acquire(int n)
+{
+  ++stats_.blocks;
+  stats_.footprint += n;
+  if (stats_.footprint > stats_.peak)
+    stats_.peak = stats_.footprint;
+  return alloc_->allocate(n);
 }
 
-// Allocate a new block.
+// Allocate a new current block. The size of the block is the size of the
+// previous block, doubled, to a maximum of max_block_size bytes.
 template<int S>
 void
 sequential_allocator<S>::extend()
 {
+  // The rest of the current block is not used.
+  stats_.tail += limit_ - current_;
+
   // Allocate a new block and embed the block at the front and set the
   // current allocation pointer past that.
-  current_ = (char*)alloc_->allocate(S);
-  block* b = new (current_) block { nullptr };
+  current_ = (char*)acquire(size_);
+  block* b = new (current_) block { head_, size_ };
+  limit_ = current_ + size_;
   current_ += sizeof(block);
 
-  // Update the list of nodes.
-  if (!head_)
-    head_ = b;
-  else
-    tail_->next = b;
-  tail_ = b;
+  // Update the list of blocks.
+  head_ = b;
+  if (size_ <= max_block_size / 2)
+    size_ *= 2;
 }
 
 
+// -------------------------------------------------------------------------- //
+// Pool allocation
+
+// A pool allocator recycles memory by size. Each request is rounded up to a
+// size class, a multiple of the strictest fundamental alignment, and memory
+// deallocated by the pool is kept in a free list for its class. Requests are
+// allocated from the free list for their class when it is not empty, and 
+// otherwise from a sequential allocator. That memory is returned when the
+// pool is destroyed. The pool is suited to short-lived objects that are
+// allocated and deallocated frequently.
+//
+// Requests larger than the largest size class are forwarded to the 
+// underlying allocator. 
+//
+// Storage must be deallocated with its size (see typed_allocator). Unsized
+// deallocation is not supported.
+struct pool_allocator : allocator
+{
+  static constexpr int granularity = alignof(std::max_align_t);
+  static constexpr int num_classes = 16;
+  static constexpr int max_size = granularity * num_classes;
+
+  struct free_block
+  {
+    free_block* next;
+  };
+
+  pool_allocator();
+  explicit pool_allocator(allocator&);
+
+  pool_allocator(const pool_allocator&) = delete;
+  pool_allocator& operator=(const pool_allocator&) = delete;
+
+  void* allocate(int) override;
+  void* allocate(int, int) override;
+  void deallocate(void*) override;
+  void deallocate(void*, int) override;
+
+  allocation_stats get_stats() const override;
+
+  static int get_class(int);
+
+  allocator* alloc_;
+  sequential_allocator<> blocks_;
+  free_block* free_[num_classes];
+  allocation_stats stats_;
+};
+
+inline
+pool_allocator::pool_allocator()
+  : pool_allocator(default_allocator())
+{ }
+
+inline
+pool_allocator::pool_allocator(allocator& a)
+  : alloc_(&a), blocks_(a), free_(), stats_()
+{ }
+
+// Returns the size class of a request of n bytes. Requests of 0 bytes are
+// in the smallest class.
+inline int
+pool_allocator::get_class(int n)
+{
+  return n ? (n - 1) / granularity : 0;
+}
+
+// Allocate n bytes with the strictest fundamental alignment.
+inline void*
+pool_allocator::allocate(int n)
+{
+  assert(n >= 0);
+#if BEAKER_ALLOC_STATS
+  ++stats_.allocations;
+  stats_.requested += n;
+#endif
+  if (n > max_size)
+    return alloc_->allocate(n);
+  int c = get_class(n);
+  if (free_block* b = free_[c]) {
+    free_[c] = b->next;
+    return b;
+  }
+  return blocks_.allocate((c + 1) * granularity, granularity);
+}
+
+// Allocate n bytes aligned to a bytes. Size classes are aligned to the
+// strictest fundamental alignment, so over-aligned requests are not
+// supported.
+inline void*
+pool_allocator::allocate(int n, int a)
+{
+  assert(a <= granularity && "over-aligned allocation");
+  return allocate(n);
+}
+
+// Unsized deallocation is not supported. The pool cannot recover the size
+// class of p, so the program is aborted rather than leaking the storage.
+inline void
+pool_allocator::deallocate(void* p)
+{
+  std::abort();
+}
+
+// Deallocate the storage p of n bytes. Storage in a size class is added to 
+// the free list for its class.
+inline void
+pool_allocator::deallocate(void* p, int n)
+{
+  if (!p)
+    return;
+  if (n > max_size)
+    return alloc_->deallocate(p, n);
+  int c = get_class(n);
+  free_[c] = new (p) free_block {free_[c]};
+}
+
 // -------------------------------------------------------------------------- //
 // Typed allocator
 
@@ -330,7 +750,7 @@ template<typename T>
 inline void
 typed_allocator<T>::deallocate(T* p, std::size_t n)
 {
-  alloc_->deallocate(p);
+  alloc_->deallocate(p, n * sizeof(T));
 }
 
 template<typename T>
@@ -349,6 +769,20 @@ typed_allocator<T>::destroy(T* p)
 }
 
 
+/// Returns true if memory allocated by a can be deallocated by b.
+template<typename T, typename U>
+inline bool
+operator==(const typed_allocator<T>& a, const typed_allocator<U>& b)
+{
+  return a.alloc_ == b.alloc_;
+}
+
+template<typename T, typename U>
+inline bool
+operator!=(const typed_allocator<T>& a, const typed_allocator<U>& b)
+{
+  return a.alloc_ != b.alloc_;
+}
 
 } // namespace beaker
 
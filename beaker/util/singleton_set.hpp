@@ -48,7 +48,7 @@ inline singleton_set<T>::~singleton_set()
   typed_allocator<T> alloc(*alloc_);
   if (obj_) {
     alloc.destroy(obj_);
-    alloc.deallocate(obj_);
+    alloc.deallocate(obj_, 1);
   }
 }
 
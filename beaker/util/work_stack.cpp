@@ -0,0 +1,4 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "work_stack.hpp"
@@ -0,0 +1,84 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BEAKER_UTIL_WORK_STACK_HPP
+#define BEAKER_UTIL_WORK_STACK_HPP
+
+#include <cassert>
+#include <vector>
+
+
+namespace beaker {
+
+/// A work stack holds the pending steps of an algorithm that would otherwise
+/// recurse on the call stack. 
+///
+/// Clearing the stack retains its storage, so an algorithm that reuses its
+/// work stack does not allocate memory once the stack has grown to the depth
+/// of the largest input.
+template<typename T>
+struct work_stack
+{
+  bool is_empty() const;
+  int get_size() const;
+
+  void push(const T&);
+  T pop();
+
+  T& top();
+  const T& top() const;
+
+  void clear();
+
+  std::vector<T> items_;
+};
+
+/// Returns true if there is no pending work.
+template<typename T>
+inline bool work_stack<T>::is_empty() const { return items_.empty(); }
+
+/// Returns the number of items on the stack.
+template<typename T>
+inline int work_stack<T>::get_size() const { return items_.size(); }
+
+/// Push `x` onto the stack.
+template<typename T>
+inline void work_stack<T>::push(const T& x) { items_.push_back(x); }
+
+/// Remove and return the top of the stack.
+template<typename T>
+inline T
+work_stack<T>::pop() 
+{
+  assert(!items_.empty());
+  T x = items_.back();
+  items_.pop_back();
+  return x;
+}
+
+/// Returns the top of the stack.
+template<typename T>
+inline T& 
+work_stack<T>::top() 
+{ 
+  assert(!items_.empty());
+  return items_.back(); 
+}
+
+/// Returns the top of the stack.
+template<typename T>
+inline const T& 
+work_stack<T>::top() const 
+{ 
+  assert(!items_.empty());
+  return items_.back(); 
+}
+
+/// Remove all items from the stack, retaining its storage.
+template<typename T>
+inline void work_stack<T>::clear() { items_.clear(); }
+
+} // namespace beaker
+
+
+#endif
@@ -34,12 +34,18 @@ using module = beaker::module;
 
 
 // A builder for the language.
+//
+// The layouts of the terms of the current line are kept in a layout map,
+// not in the terms. Terms are released after each line, without being 
+// destroyed, so the map is cleared instead.
 struct builder : beaker::sys_bool::builder, beaker::sys_int::builder
 {
   builder(module&);
 
   const language& get_language() const;
   language& get_language(); 
+
+  beaker::layout_map layouts;
 };
 
 inline const language&
@@ -18,7 +18,7 @@
 ///
 /// FIXME: Read from a stream inste
 beaker::expr*
-read(icalc::module& mod, std::istream& is)
+read(icalc::builder& build, std::istream& is)
 {
   // Read the input line.
   std::string line;
@@ -65,7 +65,6 @@ read(icalc::module& mod, std::istream& is)
 
   // Try to parse the tokens stream.
   auto ts = beaker::make_stream(toks);
-  icalc::builder build(mod);
   icalc::parser parse(ts, build);
   beaker::expr* e = &parse.expression();
 
@@ -122,13 +121,22 @@ main()
 {
   icalc::language lang;
   icalc::module mod(lang);
+  icalc::builder build(mod);
+  beaker::sys_bool::builder& bools = build;
+  beaker::sys_int::builder& ints = build;
 
   std::string line;
   while (std::cin) {
+    // The terms of each line, and their layouts, are released after the 
+    // line is evaluated.
+    build.layouts.clear();
+    beaker::checkpoint c1(bools);
+    beaker::checkpoint c2(ints);
+
     // Read
     beaker::expr* e;
     try {
-      e = read(mod, std::cin);
+      e = read(build, std::cin);
       if (!std::cin) break;
       if (!e) continue;
     } 
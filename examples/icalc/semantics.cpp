@@ -51,7 +51,7 @@ void
 semantics::check_bool(expr& e1)
 {
   if (!is_boolean(e1))
-    throw type_error(e1.get_location(), "operand does not have type 'bool'");
+    throw type_error(get_location(e1), "operand does not have type 'bool'");
 }
 
 /// Check that `e1` and `e2` both have type bool.
@@ -67,7 +67,7 @@ void
 semantics::check_int(expr& e1)
 {
   if (!is_integral(e1))
-    throw type_error(e1.get_location(), "operand does not have type 'int'");
+    throw type_error(get_location(e1), "operand does not have type 'int'");
 }
 
 /// Check that `e1` and `e2` both have type int.
@@ -83,24 +83,33 @@ void
 semantics::check_same(expr& e1, expr& e2)
 {
   if (!same_typed(e1, e2))
-    throw type_error(e1.get_location(), "operands have different types");
+    throw type_error(get_location(e1), "operands have different types");
+}
+
+/// Returns the location of `e` in the current line. If `e` occurs more than
+/// once, this is its most recent occurrence.
+location
+semantics::get_location(const expr& e) const
+{
+  int n = build.layouts.count(e);
+  return n ? build.layouts.get_layout(e, n - 1).get_location() : location();
 }
 
 /// A helper function that assigns source locations of unary expressions
 /// to an expression. This constructs the layout [tok, e1].
-static inline expr&
-set_locations(expr& r, token tok, expr& e1)
+expr&
+semantics::set_locations(expr& r, token tok, expr& e1)
 {
-  r.set_fixed_layout(tok.get_location(), e1.get_location());
+  build.layouts.add_fixed_layout(r, tok.get_location(), get_location(e1));
   return r;
 }
 
 /// A helper function that assigns source locations of binary expressions
 /// to an expression. This constructs the layout [e1, tok, e2].
-static inline expr&
-set_locations(expr& r, expr& e1, token tok, expr& e2)
+expr&
+semantics::set_locations(expr& r, expr& e1, token tok, expr& e2)
 {
-  r.set_fixed_layout(e1.get_location(), tok.get_location(), e2.get_location());
+  build.layouts.add_fixed_layout(r, get_location(e1), tok.get_location(), get_location(e2));
   return r;
 }
 
@@ -114,12 +123,12 @@ semantics::on_condition(expr& e1, token q, expr& e2, token c, expr& e3)
   check_bool(e1);
   check_same(e2, e3);
   expr& ret = build.make_if_expr(e1, e2, e3);
-  ret.set_fixed_layout(
-    e1.get_location(), 
+  build.layouts.add_fixed_layout(ret,
+    get_location(e1), 
     q.get_location(), 
-    e2.get_location(), 
+    get_location(e2), 
     c.get_location(), 
-    e3.get_location()
+    get_location(e3)
   );
   return ret;
 }
@@ -154,7 +163,7 @@ make_bool_or(semantics& sema, expr& e1, token tok, expr& e2)
 {
   beaker::sys_bool::builder& bb = sema.build;
   expr& ret = bb.make_or_expr(e1, e2);
-  return set_locations(ret, e1, tok, e2);;
+  return sema.set_locations(ret, e1, tok, e2);
 }
 
 /// A subroutine of on_bitwise_xor.
@@ -163,7 +172,7 @@ make_bool_xor(semantics& sema, expr& e1, token tok, expr& e2)
 {
   beaker::sys_bool::builder& bb = sema.build;
   expr& ret = bb.make_xor_expr(e1, e2);
-  return set_locations(ret, e1, tok, e2);
+  return sema.set_locations(ret, e1, tok, e2);
 }
 
 /// A subroutine of on_bitwise_and.
@@ -172,7 +181,7 @@ make_bool_and(semantics& sema, expr& e1, token tok, expr& e2)
 {
   beaker::sys_bool::builder& bb = sema.build;
   expr& ret = bb.make_and_expr(e1, e2);
-  return set_locations(ret, e1, tok, e2);
+  return sema.set_locations(ret, e1, tok, e2);
 }
 
 /// Process the expression `e1 | e2`.
@@ -183,7 +192,7 @@ semantics::on_bitwise_or(expr& e1, token tok, expr& e2)
     return make_bool_or(*this, e1, tok, e2);
   else if (are_integral(e1, e2))
     throw type_error(location(), "bitwise-or not implemented");
-  throw type_error(e1.get_location(), "operands have different types");
+  throw type_error(get_location(e1), "operands have different types");
 }
 
 /// Process the expression `e1 ^ e2`.
@@ -195,7 +204,7 @@ semantics::on_bitwise_xor(expr& e1, token tok, expr& e2)
   else if (are_integral(e1, e2)) {
     throw type_error(location(), "bitwise-xor not implemented");
   }
-  throw type_error(e1.get_location(), "operands have different types");
+  throw type_error(get_location(e1), "operands have different types");
 }
 
 /// Process the expression `e1 & e2`.
@@ -207,7 +216,7 @@ semantics::on_bitwise_and(expr& e1, token tok, expr& e2)
   else if (are_integral(e1, e2)) {
     throw type_error(location(), "bitwise-and not implemented");
   }
-  throw type_error(e1.get_location(), "operands have different types");
+  throw type_error(get_location(e1), "operands have different types");
 }
 
 
@@ -220,7 +229,7 @@ make_bool_eq(semantics& sema, expr& e1, token tok, expr& e2)
 {
   beaker::sys_bool::builder& bb = sema.build;
   expr& ret = bb.make_eq_expr(e1, e2);
-  return set_locations(ret, e1, tok, e2);
+  return sema.set_locations(ret, e1, tok, e2);
 }
 
 /// A subroutine of on_ne. This returns an xor expression.
@@ -229,7 +238,7 @@ make_bool_ne(semantics& sema, expr& e1, token tok, expr& e2)
 {
   beaker::sys_bool::builder& bb = sema.build;
   expr& ret = bb.make_xor_expr(e1, e2);
-  return set_locations(ret, e1, tok, e2);
+  return sema.set_locations(ret, e1, tok, e2);
 }
 
 /// A subroutine of on_equal.
@@ -238,7 +247,7 @@ make_int_eq(semantics& sema, expr& e1, token tok, expr& e2)
 {
   beaker::sys_int::builder& bb = sema.build;
   expr& ret = bb.make_eq_expr(e1, e2);
-  return set_locations(ret, e1, tok, e2);
+  return sema.set_locations(ret, e1, tok, e2);
 }
 
 /// A subroutine of on_not_equal.
@@ -247,7 +256,7 @@ make_int_ne(semantics& sema, expr& e1, token tok, expr& e2)
 {
   beaker::sys_int::builder& bb = sema.build;
   expr& ret = bb.make_ne_expr(e1, e2);
-  return set_locations(ret, e1, tok, e2);
+  return sema.set_locations(ret, e1, tok, e2);
 }
 
 /// Process the expression `e1 == e2`.
@@ -258,7 +267,7 @@ semantics::on_equal(expr& e1, token tok, expr& e2)
     return make_bool_eq(*this, e1, tok, e2);
   else if (are_integral(e1, e2)) 
     return make_int_eq(*this, e1, tok, e2);
-  throw type_error(e1.get_location(), "operands have different types");
+  throw type_error(get_location(e1), "operands have different types");
 }
 
 /// Process the expression `e1 != e2`.
@@ -269,7 +278,7 @@ semantics::on_not_equal(expr& e1, token tok, expr& e2)
     return make_bool_ne(*this, e1, tok, e2);
   else if (are_integral(e1, e2))
     return make_int_ne(*this, e1, tok, e2);
-  throw type_error(e1.get_location(), "operands have different types");
+  throw type_error(get_location(e1), "operands have different types");
 }
 
 // -------------------------------------------------------------------------- //
@@ -385,7 +394,7 @@ semantics::on_bool(token tok)
     ret = &build.make_true_expr();
   else
     ret = &build.make_false_expr();
-  ret->set_fixed_layout(tok.get_location());
+  build.layouts.add_fixed_layout(*ret, tok.get_location());
   return *ret;
 }
 
@@ -394,7 +403,7 @@ semantics::on_int(token tok)
 {
   const beaker::int_attr& attr = get_int_attribute(tok);
   expr& ret = build.make_int_expr(build.get_int32_type(), attr.get_value());
-  ret.set_fixed_layout(tok.get_location());
+  build.layouts.add_fixed_layout(ret, tok.get_location());
   return ret;
 }
 
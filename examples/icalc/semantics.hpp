@@ -71,6 +71,10 @@ struct semantics
   void check_int(expr&, expr&);
   void check_same(expr&, expr&);
 
+  location get_location(const expr&) const;
+  expr& set_locations(expr&, token, expr&);
+  expr& set_locations(expr&, expr&, token, expr&);
+
   builder& build;
 };
 
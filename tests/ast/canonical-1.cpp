@@ -0,0 +1,136 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+#include <beaker/sys.tuple/ast.hpp>
+
+#include <string>
+#include <vector>
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+    new sys_tuple::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& nb = mod.get_builder<sys_name::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+  auto& tb = mod.get_builder<sys_tuple::feature>();
+
+  // Terms remain canonical as the table grows.
+  std::vector<sys_int::nat_type*> nats;
+  for (int p = 8; p <= 64; p *= 2)
+    nats.push_back(&ib.get_nat_type(p));
+  assert(&ib.get_nat8_type() == nats[0]);
+  assert(&ib.get_nat64_type() == nats[3]);
+  assert(nats[2]->get_precision() == 32);
+  assert(ib.nat_->size() == 4);
+
+  std::vector<name*> names;
+  for (int i = 0; i < 100; ++i)
+    names.push_back(&nb.get_name(("x" + std::to_string(i)).c_str()));
+  for (int i = 0; i < 100; ++i)
+    assert(&nb.get_name(("x" + std::to_string(i)).c_str()) == names[i]);
+  assert(nb.name_->size() == 100);
+  assert(nb.name_->size() * 2 <= nb.name_->capacity());
+
+  // Finding a function or tuple type does not allocate, and new types do 
+  // not refer to the sequence used to find them.
+  type& b = ib.get_int32_type();
+  type& z = ib.get_int64_type();
+  type_seq ts {&b, &z, &b, &z};
+  sys_fn::fn_type& f = fb.get_fn_type(ts, b);
+  sys_tuple::tuple_type& t = tb.get_tuple_type(ts);
+  char* used = lang.get_mark().arenas_[other_family].current;
+  assert(&fb.get_fn_type(ts, b) == &f);
+  assert(&tb.get_tuple_type(ts) == &t);
+  assert(lang.get_mark().arenas_[other_family].current == used);
+  ts.base().back() = &b;
+  assert(&f.get_parameter_types()[3] == &z);
+  assert(&fb.get_fn_type(ts, b) != &f);
+  assert(&fb.get_fn_type(type_seq {&b, &z, &b, &z}, b) == &f);
+  assert(&fb.get_fn_type(type_seq {&b, &z, &b, &z}, z) != &f);
+
+  // Canonical terms are compared and hashed by identity. A copy of a 
+  // canonical term has the same structure, but it is not equal.
+  type_seq ps {&b, &z, &b, &z};
+  sys_fn::fn_type c(type_span::view(ps), b);
+  assert(is_canonical_type(f) && is_canonical_name(*names[0]));
+  assert(!is_canonical_name(nb.get_name()));
+  assert(equal(f, f) && !equal(f, c));
+  assert(equal_structure(f, c));
+  assert(term_hash()(c) == term_hash()(f));
+  hasher h1;
+  hash(h1, f);
+  hasher h2;
+  hash(h2, &f);
+  assert((std::size_t)h1 == (std::size_t)h2);
+
+  // A word equal to the hasher's secret does not discard the words hashed
+  // before it.
+  std::uint64_t words[][2] {
+    {1, word_detail::secret_0()},
+    {2, word_detail::secret_0()},
+    {1, 0},
+  };
+  std::size_t codes[3];
+  for (int i = 0; i < 3; ++i) {
+    hasher h;
+    h(words[i], sizeof(words[i]));
+    codes[i] = h;
+  }
+  assert(codes[0] != codes[1] && codes[0] != codes[2]);
+  hasher hw;
+  hw(words[0], 8);
+  assert((std::size_t)hw != codes[0]);
+
+  // Canonical sets belong to the language, so the modules of a language
+  // share their canonical terms.
+  module other(lang);
+  auto& ib2 = other.get_builder<sys_int::feature>();
+  auto& nb2 = other.get_builder<sys_name::feature>();
+  auto& fb2 = other.get_builder<sys_fn::feature>();
+  type& z2 = ib2.get_int64_type();
+  assert(&z2 == &z);
+  assert(equal(z, z2) && term_hash()(z) == term_hash()(z2));
+  assert(&nb2.get_name("x0") == names[0]);
+  sys_fn::fn_type& f2 = fb2.get_fn_type(type_seq {&b, &z2, &b, &z2}, b);
+  assert(&f2 == &f);
+  assert(equal(f, f2) && term_hash()(f) == term_hash()(f2));
+
+#if BEAKER_HASH_CACHE
+  // Canonical terms store their hash codes, which are appended in place of
+  // their structure. Terms with different codes are not equal.
+  assert(f.hash_ != 0);
+  assert(names[0]->hash_ != 0);
+  hasher h3;
+  hash_structure(h3, f);
+  hasher h4;
+  hash(h4, f.hash_);
+  assert((std::size_t)h3 == (std::size_t)h4);
+  sys_fn::fn_type g(type_span::view(ts), b);
+  assert(g.hash_ == 0);
+  assert(!equal_structure(f, g));
+  assert(g.hash_ == 0);
+  assert(term_hash()(g) != term_hash()(f));
+  assert(g.hash_ != 0 && g.hash_ != f.hash_);
+  assert(!equal_structure(f, g));
+#endif
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+#include <beaker/all/evaluation/evaluate.hpp>
+
+
+/// Check that the evaluation of `e` fails at the expression `f`, and that
+/// raising the failure throws the exception E.
+template<typename E>
+void
+check_failure(evaluator& eval, const language& lang, const expr& e, const expr& f)
+{
+  std::clog << pretty(lang, e) << " ~> failure at " << pretty(lang, f) << '\n';
+  result r = try_evaluate(eval, e);
+  assert(!r);
+  assert(r.get_failure().expr_ == &f);
+  bool thrown = false;
+  try {
+    r.get_failure().raise();
+  } catch (E& err) {
+    assert(err.expr_ == &f);
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+  module mod(lang);
+  auto& vb = mod.get_builder<sys_void::feature>();
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& rb = mod.get_builder<sys_var::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+
+  auto& int8 = ib.get_int8_type();
+  auto& int64 = ib.get_int64_type();
+  auto& one = ib.make_int_expr(int8, 1);
+  auto& max = ib.make_int_expr(int8, int8.max());
+  auto& zero = ib.make_int_expr(int8, 0);
+
+  evaluator eval(lang);
+
+  // Failures refer to the innermost failing expression.
+  auto& ovf = ib.make_add_expr(max, one);
+  auto& div = ib.make_quo_expr(one, zero);
+  auto& trap = vb.make_trap_expr();
+  auto& asrt = bb.make_assert_expr(bb.make_false_expr());
+  check_failure<sys_int::overflow_error>(eval, lang, ovf, ovf);
+  check_failure<sys_int::overflow_error>(eval, lang, ib.make_mul_expr(ib.make_neg_expr(ovf), one), ovf);
+  check_failure<sys_int::division_error>(eval, lang, ib.make_add_expr(one, div), div);
+  check_failure<sys_void::trap_error>(eval, lang, vb.make_void_expr(trap), trap);
+  check_failure<sys_bool::assertion_error>(eval, lang, bb.make_if_expr(asrt, one, zero), asrt);
+
+  // Operands that are not evaluated do not fail.
+  check_value(lang, bb.make_and_then_expr(bb.make_false_expr(), asrt), value(0));
+
+  // The evaluator can be used after a failure.
+  result r = try_evaluate(eval, ib.make_add_expr(one, one));
+  assert(r && r.get_value() == value(2));
+
+  // def f(n : int64) -> int64 { return n * n * n; }
+  auto& n = fb.make_parm_decl("n", int64);
+  auto& ret = fb.make_parm_decl("r", int64);
+  decl_seq parms {&n};
+  auto& vn = rb.make_val_expr(rb.make_ref_expr(n));
+  auto& sq = ib.make_mul_expr(vn, vn);
+  auto& cube = ib.make_mul_expr(sq, vn);
+  auto& body = fb.make_block_stmt({&fb.make_ret_stmt(cube)});
+  auto& f = fb.make_fn_decl(dc(mod), "f", fb.get_fn_type(parms, ret), parms, ret, body);
+
+  // A failed call releases its frames. The square overflows first.
+  r = try_call(eval, f, {value(3)});
+  assert(r && r.get_value() == value(27));
+  r = try_call(eval, f, {value(std::intmax_t(1) << 32)});
+  assert(!r && r.get_failure().expr_ == &sq);
+  assert(!eval.get_frame());
+  assert(eval.stack_.block_ == -1);
+
+  // A failure in a statement is reported as a flow of control.
+  auto& s = fb.make_expr_stmt(fb.make_call_expr(rb.make_ref_expr(f), {&ib.make_int_expr(int64, value(std::intmax_t(1) << 32))}));
+  assert(try_evaluate(eval, s) == fail_control);
+  assert(eval.get_failure().expr_ == &sq);
+  assert(try_evaluate(eval, fb.make_ret_stmt(one)) == fail_control);
+  assert(!eval.get_failure().expr_);
+}
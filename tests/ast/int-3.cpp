@@ -0,0 +1,141 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/all/evaluation/machine.hpp>
+#include <beaker/all/evaluation/closure.hpp>
+
+
+/// Check that `e` has the value v in every evaluator.
+void
+check_int(const language& lang, const expr& e, const value& v)
+{
+  check_value(lang, e, v);
+  evaluator eval(lang);
+  assert(evaluate(eval, make_closure(e)) == v);
+  assert(execute(eval, compile(e)) == v);
+}
+
+/// Check that the evaluation of `e` fails in every evaluator.
+void
+check_int_error(const language& lang, const expr& e)
+{
+  check_error(lang, e);
+  evaluator eval(lang);
+  int n = 0;
+  try {
+    evaluate(eval, make_closure(e));
+  } catch (evaluation_error&) {
+    ++n;
+  }
+  try {
+    execute(eval, compile(e));
+  } catch (evaluation_error&) {
+    ++n;
+  }
+  assert(n == 2);
+}
+
+/// Check the bounds of arithmetic on the integer type t.
+void
+check_int_type(const language& lang, sys_int::builder& ib, sys_int::int_type& t)
+{
+  auto& min = ib.make_int_expr(t, value(t.min()));
+  auto& max = ib.make_int_expr(t, value(t.max()));
+  auto& zero = ib.make_int_expr(t, 0);
+  auto& one = ib.make_int_expr(t, 1);
+  auto& neg = ib.make_int_expr(t, -1);
+  auto& two = ib.make_int_expr(t, 2);
+  auto& half = ib.make_int_expr(t, value(t.min() / 2));
+
+  check_int(lang, ib.make_add_expr(max, neg), value(t.max() - 1));
+  check_int_error(lang, ib.make_add_expr(max, one));
+  check_int_error(lang, ib.make_add_expr(min, neg));
+  check_int(lang, ib.make_sub_expr(min, neg), value(t.min() + 1));
+  check_int_error(lang, ib.make_sub_expr(min, one));
+  check_int_error(lang, ib.make_sub_expr(max, neg));
+  check_int(lang, ib.make_mul_expr(half, two), value(t.min()));
+  check_int_error(lang, ib.make_mul_expr(min, two));
+  check_int_error(lang, ib.make_mul_expr(min, neg));
+  check_int_error(lang, ib.make_mul_expr(max, two));
+  check_int_error(lang, ib.make_quo_expr(min, neg));
+  check_int_error(lang, ib.make_quo_expr(one, zero));
+  check_int(lang, ib.make_rem_expr(min, neg), value(0));
+  check_int_error(lang, ib.make_neg_expr(min));
+  check_int(lang, ib.make_neg_expr(max), value(t.min() + 1));
+  check_int_error(lang, ib.make_rec_expr(zero));
+}
+
+/// Check the bounds of arithmetic on the natural number type t.
+void
+check_nat_type(const language& lang, sys_int::builder& ib, sys_int::nat_type& t)
+{
+  auto& max = ib.make_int_expr(t, value(t.max()));
+  auto& zero = ib.make_int_expr(t, 0);
+  auto& one = ib.make_int_expr(t, 1);
+  auto& two = ib.make_int_expr(t, 2);
+
+  check_int(lang, ib.make_sub_expr(max, one), value(t.max() - 1));
+  check_int_error(lang, ib.make_add_expr(max, one));
+  check_int_error(lang, ib.make_sub_expr(zero, one));
+  check_int_error(lang, ib.make_mul_expr(max, two));
+  check_int(lang, ib.make_quo_expr(max, max), value(1));
+  check_int_error(lang, ib.make_rem_expr(one, zero));
+}
+
+/// Check that arithmetic on the modular type t wraps.
+void
+check_mod_type(const language& lang, sys_int::builder& ib, sys_int::mod_type& t)
+{
+  auto& max = ib.make_int_expr(t, value(t.max()));
+  auto& zero = ib.make_int_expr(t, 0);
+  auto& one = ib.make_int_expr(t, 1);
+
+  check_int(lang, ib.make_add_expr(max, one), value(0));
+  check_int(lang, ib.make_sub_expr(zero, one), value(t.max()));
+  check_int(lang, ib.make_mul_expr(max, max), value(1));
+  check_int(lang, ib.make_neg_expr(one), value(t.max()));
+  check_int_error(lang, ib.make_quo_expr(one, zero));
+}
+
+/// Check that values of the unsigned type t are ordered as unsigned
+/// integers, including values above the maximum of the signed type.
+template<typename T>
+void
+check_unsigned_order(const language& lang, sys_int::builder& ib, T& t)
+{
+  auto& one = ib.make_int_expr(t, 1);
+  auto& high = ib.make_int_expr(t, value(t.max() / 2 + 1));
+  auto& max = ib.make_int_expr(t, value(t.max()));
+
+  check_int(lang, ib.make_lt_expr(one, max), value(1));
+  check_int(lang, ib.make_gt_expr(high, one), value(1));
+  check_int(lang, ib.make_le_expr(high, one), value(0));
+  check_int(lang, ib.make_ge_expr(high, max), value(0));
+  check_int(lang, ib.make_ge_expr(max, high), value(1));
+  check_int(lang, ib.make_ne_expr(max, high), value(1));
+}
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+
+  for (int p : {8, 16, 32, 64}) {
+    check_int_type(lang, ib, ib.get_int_type(p));
+    check_nat_type(lang, ib, ib.get_nat_type(p));
+    check_mod_type(lang, ib, ib.get_mod_type(p));
+    check_unsigned_order(lang, ib, ib.get_nat_type(p));
+    check_unsigned_order(lang, ib, ib.get_mod_type(p));
+  }
+}
@@ -0,0 +1,216 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/all/evaluation/machine.hpp>
+#include <beaker/all/evaluation/closure.hpp>
+#include <beaker/all/evaluation/jit.hpp>
+#include <beaker/util/hash.hpp>
+
+#include <sstream>
+
+
+/// Check that `e` has the value v in every evaluator. Wide expressions are
+/// evaluated by the tree walker.
+void
+check_int(const language& lang, const expr& e, const value& v)
+{
+  check_value(lang, e, v);
+  evaluator eval(lang);
+  assert(evaluate(eval, make_closure(e)) == v);
+  assert(execute(eval, compile(e)) == v);
+}
+
+/// Check that the evaluation of `e` fails in every evaluator.
+void
+check_int_error(const language& lang, const expr& e)
+{
+  check_error(lang, e);
+  evaluator eval(lang);
+  int n = 0;
+  try {
+    evaluate(eval, make_closure(e));
+  } catch (evaluation_error&) {
+    ++n;
+  }
+  try {
+    execute(eval, compile(e));
+  } catch (evaluation_error&) {
+    ++n;
+  }
+  assert(n == 2);
+}
+
+/// Check that the native form of `e` has the value v.
+void
+check_jit(const language& lang, jit& j, const expr& e, const value& v)
+{
+  std::clog << pretty(lang, e) << " ~> " << v << " [jit]\n";
+  assert(j.execute(j.compile(e)) == v);
+}
+
+/// Returns the printed form of `e`.
+std::string
+print_text(const language& lang, const expr& e)
+{
+  std::stringstream ss;
+  ss << pretty(lang, e);
+  return ss.str();
+}
+
+/// Returns the 128-bit integer 2^n.
+wide_natural
+pow2(int n)
+{
+  return wide_natural(1) << n;
+}
+
+
+/// Check the representation of wide integer values.
+void
+check_values()
+{
+  // Values that fit in a signed word are small, and every value has one
+  // representation, whether it is given as a signed or unsigned integer.
+  assert(value(wide_integer(-5)).is_small());
+  assert(value(wide_integer(-5)) == value(-5));
+  assert(value(wide_natural(5)) == value(5));
+  assert(value(wide_natural(~std::uint64_t(0))).is_wide());
+  assert(value(wide_natural(~std::uint64_t(0))) == value(wide_integer(~std::uint64_t(0))));
+  assert(value(wide_natural(pow2(63))) == value(wide_integer(pow2(63))));
+  assert(universal_hash()(value(wide_natural(pow2(63)))) == 
+         universal_hash()(value(wide_integer(pow2(63)))));
+  assert(value(wide_integer(pow2(64))).is_wide());
+  assert(value(wide_integer(pow2(64))).get_wide() == wide_integer(pow2(64)));
+  assert(value(-wide_integer(pow2(64))).get_wide() == -wide_integer(pow2(64)));
+  assert(value(pow2(127)).get_wide_natural() == pow2(127));
+
+  // Small values are sign or zero extended.
+  assert(value(-1).get_wide() == -1);
+  assert(value(-1).get_wide_natural() == ~std::uint64_t(0));
+  assert(universal_hash()(value(pow2(100))) == universal_hash()(value(pow2(100))));
+
+  std::stringstream ss;
+  ss << value(wide_integer(pow2(64)));
+  assert(ss.str() == "<int 18446744073709551616>");
+}
+
+/// Check the bounds of arithmetic on the type int128.
+void
+check_int_type(const language& lang, sys_int::builder& ib, sys_int::int_type& t)
+{
+  auto& min = ib.make_int_expr(t, value(t.wide_min()));
+  auto& max = ib.make_int_expr(t, value(t.wide_max()));
+  auto& zero = ib.make_int_expr(t, 0);
+  auto& one = ib.make_int_expr(t, 1);
+  auto& neg = ib.make_int_expr(t, -1);
+  auto& two = ib.make_int_expr(t, 2);
+  auto& word = ib.make_int_expr(t, value(std::numeric_limits<std::intmax_t>::max()));
+
+  check_int(lang, ib.make_add_expr(one, two), value(3));
+  check_int(lang, ib.make_add_expr(word, one), value(wide_integer(pow2(63))));
+  check_int(lang, ib.make_mul_expr(word, word), value(wide_integer(pow2(63) - 1) * wide_integer(pow2(63) - 1)));
+  check_int(lang, ib.make_add_expr(max, neg), value(t.wide_max() - 1));
+  check_int_error(lang, ib.make_add_expr(max, one));
+  check_int_error(lang, ib.make_sub_expr(min, one));
+  check_int_error(lang, ib.make_mul_expr(max, two));
+  check_int_error(lang, ib.make_quo_expr(min, neg));
+  check_int_error(lang, ib.make_quo_expr(one, zero));
+  check_int(lang, ib.make_rem_expr(min, neg), value(0));
+  check_int_error(lang, ib.make_neg_expr(min));
+  check_int(lang, ib.make_neg_expr(max), value(t.wide_min() + 1));
+
+  check_int(lang, ib.make_lt_expr(min, neg), value(1));
+  check_int(lang, ib.make_gt_expr(word, max), value(0));
+  check_int(lang, ib.make_eq_expr(max, max), value(1));
+
+  assert(print_text(lang, max) == "170141183460469231731687303715884105727");
+  assert(print_text(lang, min) == "-170141183460469231731687303715884105728");
+}
+
+/// Check the bounds of arithmetic on the type nat128.
+void
+check_nat_type(const language& lang, sys_int::builder& ib, sys_int::nat_type& t)
+{
+  auto& max = ib.make_int_expr(t, value(t.wide_max()));
+  auto& zero = ib.make_int_expr(t, 0);
+  auto& one = ib.make_int_expr(t, 1);
+  auto& word = ib.make_int_expr(t, value(~std::uintmax_t(0)));
+
+  check_int(lang, ib.make_add_expr(word, one), value(pow2(64)));
+  check_int(lang, ib.make_sub_expr(max, one), value(t.wide_max() - 1));
+  check_int_error(lang, ib.make_add_expr(max, one));
+  check_int_error(lang, ib.make_sub_expr(zero, one));
+  check_int(lang, ib.make_quo_expr(max, max), value(1));
+  check_int(lang, ib.make_gt_expr(word, one), value(1));
+  check_int(lang, ib.make_lt_expr(word, max), value(1));
+  check_int(lang, ib.make_sub_expr(ib.make_add_expr(word, one), one), value(wide_natural(~std::uintmax_t(0))));
+
+  // Literals are stored in one representation, so equal literals are
+  // shared, whatever the signedness of their values.
+  ib.set_hash_consing(true);
+  auto& w1 = ib.make_int_expr(t, value(wide_natural(~std::uintmax_t(0))));
+  auto& w2 = ib.make_int_expr(t, value(wide_integer(~std::uintmax_t(0))));
+  auto& w3 = ib.make_int_expr(t, value(~std::uintmax_t(0)));
+  assert(&w1 == &w2 && &w1 == &w3);
+  assert(w1.get_value() == value(wide_natural(~std::uintmax_t(0))));
+  ib.set_hash_consing(false);
+
+  assert(print_text(lang, max) == "340282366920938463463374607431768211455");
+}
+
+/// Check that arithmetic on the type mod128 wraps.
+void
+check_mod_type(const language& lang, sys_int::builder& ib, sys_int::mod_type& t)
+{
+  auto& max = ib.make_int_expr(t, value(t.wide_max()));
+  auto& zero = ib.make_int_expr(t, 0);
+  auto& one = ib.make_int_expr(t, 1);
+
+  check_int(lang, ib.make_add_expr(max, one), value(0));
+  check_int(lang, ib.make_sub_expr(zero, one), value(t.wide_max()));
+  check_int(lang, ib.make_mul_expr(max, max), value(1));
+  check_int(lang, ib.make_neg_expr(one), value(t.wide_max()));
+  check_int_error(lang, ib.make_quo_expr(one, zero));
+}
+
+/// Check that wide literals are generated correctly. Wide values cannot be
+/// returned from native code, so they are compared.
+void
+check_native(const language& lang, sys_int::builder& ib)
+{
+  evaluator eval(lang);
+  jit j(eval);
+  sys_int::nat_type& n = ib.get_nat_type(128);
+  sys_int::int_type& z = ib.get_int_type(128);
+  auto& word = ib.make_int_expr(n, value(~std::uintmax_t(0)));
+  auto& big = ib.make_int_expr(n, value(pow2(64)));
+  auto& min = ib.make_int_expr(z, value(z.wide_min()));
+  auto& neg = ib.make_int_expr(z, -1);
+
+  check_jit(lang, j, ib.make_lt_expr(word, big), value(1));
+  check_jit(lang, j, ib.make_eq_expr(ib.make_add_expr(word, ib.make_int_expr(n, 1)), big), value(1));
+  check_jit(lang, j, ib.make_lt_expr(min, neg), value(1));
+}
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+
+  check_values();
+  check_int_type(lang, ib, ib.get_int_type(128));
+  check_nat_type(lang, ib, ib.get_nat_type(128));
+  check_mod_type(lang, ib, ib.get_mod_type(128));
+  check_native(lang, ib);
+}
@@ -0,0 +1,231 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+#include <beaker/all/evaluation/evaluate.hpp>
+
+#include <cstring>
+
+
+/// Check that calling `fn` with args produces the value v, and that the
+/// frame stack has been released.
+void
+check_call(evaluator& eval, const decl& fn, const std::vector<value>& args, const value& v)
+{
+  std::clog << "call ~> " << v << '\n';
+  assert(call(eval, fn, args) == v);
+  assert(!eval.get_frame());
+  assert(eval.stack_.block_ == -1);
+}
+
+/// Check that calling `fn` with args fails, and that the frame stack has been
+/// released.
+void
+check_call_error(evaluator& eval, const decl& fn, const std::vector<value>& args)
+{
+  std::clog << "call ~> error\n";
+  bool f = false;
+  try {
+    call(eval, fn, args);
+  } catch (evaluation_error&) {
+    f = true;
+  }
+  assert(f);
+  assert(!eval.get_frame());
+  assert(eval.stack_.block_ == -1);
+}
+
+/// Check that requests larger than a block are allocated in the frame stack.
+void
+check_frame_stack()
+{
+  frame_stack s;
+  int n = 3 * frame_stack::block_size;
+  frame_stack::mark m = s.get_mark();
+  char* p = static_cast<char*>(s.allocate(16));
+  char* q = static_cast<char*>(s.allocate(n));
+  std::memset(q, 0xff, n);
+  assert(q != p + 16);
+  char* r = static_cast<char*>(s.allocate(16));
+  assert(r < q || q + n <= r);
+
+  // A retained block is replaced when it is too small.
+  s.release(m);
+  s.allocate(frame_stack::block_size);
+  q = static_cast<char*>(s.allocate(2 * n));
+  std::memset(q, 0xff, 2 * n);
+  s.release(m);
+  assert(s.allocate(16) == p);
+}
+
+
+int
+main()
+{
+  check_frame_stack();
+
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+  module mod(lang);
+  auto& vb = mod.get_builder<sys_void::feature>();
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& rb = mod.get_builder<sys_var::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+
+  auto& void_ = vb.get_void_type();
+  auto& int64 = ib.get_int64_type();
+  auto& ref64 = rb.get_ref_type(int64);
+  auto& zero = ib.make_int_expr(int64, 0);
+  auto& one = ib.make_int_expr(int64, 1);
+  auto& two = ib.make_int_expr(int64, 2);
+
+  // def fact(n : int64) -> int64 { return n == 0 ? 1 : n * fact(n - 1); }
+  sys_fn::fn_decl* fact;
+  {
+    auto& n = fb.make_parm_decl("n", int64);
+    auto& r = fb.make_parm_decl("r", int64);
+    decl_seq parms {&n};
+    auto& fn = fb.make_fn_decl(dc(mod), "fact", fb.get_fn_type(parms, r), parms, r);
+    auto& vn = rb.make_val_expr(rb.make_ref_expr(n));
+    auto& rec = fb.make_call_expr(rb.make_ref_expr(fn), {&ib.make_sub_expr(vn, one)});
+    auto& val = bb.make_if_expr(ib.make_eq_expr(vn, zero), one, ib.make_mul_expr(vn, rec));
+    fn.def_ = &fb.make_block_stmt({&fb.make_ret_stmt(val)});
+    fact = &fn;
+  }
+
+  // def sum(n : int64, acc : int64) -> int64 { 
+  //   return n == 0 ? acc : sum(n - 1, acc + n); 
+  // }
+  sys_fn::fn_decl* sum;
+  {
+    auto& n = fb.make_parm_decl("n", int64);
+    auto& acc = fb.make_parm_decl("acc", int64);
+    auto& r = fb.make_parm_decl("r", int64);
+    decl_seq parms {&n, &acc};
+    auto& fn = fb.make_fn_decl(dc(mod), "sum", fb.get_fn_type(parms, r), parms, r);
+    auto& vn = rb.make_val_expr(rb.make_ref_expr(n));
+    auto& va = rb.make_val_expr(rb.make_ref_expr(acc));
+    auto& rec = fb.make_call_expr(rb.make_ref_expr(fn), {
+      &ib.make_sub_expr(vn, one), 
+      &ib.make_add_expr(va, vn)
+    });
+    auto& val = bb.make_if_expr(ib.make_eq_expr(vn, zero), va, rec);
+    fn.def_ = &fb.make_block_stmt({&fb.make_ret_stmt(rb.make_copy_init(val))});
+    sum = &fn;
+  }
+
+  // def inc(p : int64&) -> void { p = p + 1; return; }
+  sys_fn::fn_decl* inc;
+  {
+    auto& p = fb.make_parm_decl("p", ref64);
+    auto& r = fb.make_parm_decl("r", void_);
+    decl_seq parms {&p};
+    auto& vp = rb.make_val_expr(rb.make_ref_expr(p));
+    auto& body = fb.make_block_stmt({
+      &fb.make_expr_stmt(rb.make_assign_expr(rb.make_ref_expr(p), ib.make_add_expr(vp, one))),
+      &fb.make_ret_stmt()
+    });
+    inc = &fb.make_fn_decl(dc(mod), "inc", fb.get_fn_type(parms, r), parms, r, body);
+  }
+
+  // def next(p : int64&) -> int64 { inc(p); return p; }
+  sys_fn::fn_decl* next;
+  {
+    auto& p = fb.make_parm_decl("p", ref64);
+    auto& r = fb.make_parm_decl("r", int64);
+    decl_seq parms {&p};
+    auto& body = fb.make_block_stmt({
+      &fb.make_expr_stmt(fb.make_call_expr(rb.make_ref_expr(*inc), {&rb.make_ref_init(rb.make_ref_expr(p))})),
+      &fb.make_ret_stmt(rb.make_val_expr(rb.make_ref_expr(p)))
+    });
+    next = &fb.make_fn_decl(dc(mod), "next", fb.get_fn_type(parms, r), parms, r, body);
+  }
+
+  // def f(x : int64) -> int64 {
+  //   var a : int64 = x;
+  //   { var b : int64 = a + 1; a = b * 2; }
+  //   inc(a);
+  //   return next(a);
+  // }
+  //
+  // The tail call to next refers to a local variable, so it is made directly.
+  sys_fn::fn_decl* f;
+  {
+    auto& x = fb.make_parm_decl("x", int64);
+    auto& r = fb.make_parm_decl("r", int64);
+    decl_seq parms {&x};
+    auto& fn = fb.make_fn_decl(dc(mod), "f", fb.get_fn_type(parms, r), parms, r);
+    auto& a = fb.make_var_decl(dc(fn), "a", int64, rb.make_copy_init(rb.make_val_expr(rb.make_ref_expr(x))));
+    auto& va = rb.make_val_expr(rb.make_ref_expr(a));
+    auto& b = fb.make_var_decl(dc(fn), "b", int64, rb.make_copy_init(ib.make_add_expr(va, one)));
+    auto& vb = rb.make_val_expr(rb.make_ref_expr(b));
+    auto& inner = fb.make_block_stmt({
+      &fb.make_decl_stmt(b),
+      &fb.make_expr_stmt(rb.make_assign_expr(rb.make_ref_expr(a), ib.make_mul_expr(vb, two)))
+    });
+    auto& ra = rb.make_ref_init(rb.make_ref_expr(a));
+    fn.def_ = &fb.make_block_stmt({
+      &fb.make_decl_stmt(a),
+      &inner,
+      &fb.make_expr_stmt(fb.make_call_expr(rb.make_ref_expr(*inc), {&ra})),
+      &fb.make_ret_stmt(fb.make_call_expr(rb.make_ref_expr(*next), {&ra}))
+    });
+    f = &fn;
+  }
+
+  evaluator eval(lang);
+
+  // Recursion.
+  check_call(eval, *fact, {value(0)}, value(1));
+  check_call(eval, *fact, {value(10)}, value(3628800));
+  check_call(eval, *fact, {value(20)}, value(2432902008176640000));
+  check_call_error(eval, *fact, {value(21)});
+
+  // Tail recursion runs in constant space. Without tail calls, this would
+  // exhaust the native stack.
+  check_call(eval, *sum, {value(100000), value(0)}, value(5000050000));
+  assert(eval.stack_.blocks_.size() == 1);
+
+  // Variables, blocks, and references.
+  check_call(eval, *f, {value(3)}, value(10));
+  check_call(eval, *f, {value(-1)}, value(2));
+
+  // Calls as expressions.
+  auto& c1 = fb.make_call_expr(rb.make_ref_expr(*fact), {&ib.make_int_expr(int64, 5)});
+  check_value(lang, c1, value(120));
+  check_value(lang, ib.make_add_expr(c1, c1), value(240));
+
+  // Function values.
+  auto& rf = rb.make_ref_expr(*fact);
+  assert(evaluate(eval, rf) == value(*fact));
+  check_value(lang, fb.make_eq_expr(rf, rf), value(1));
+  check_value(lang, fb.make_ne_expr(rf, rf), value(0));
+
+  // Variables declared outside of functions are bound globally.
+  {
+    auto& g = fb.make_var_decl(dc(mod), "g", int64, rb.make_copy_init(two));
+    auto& vg = rb.make_val_expr(rb.make_ref_expr(g));
+    assert(evaluate(eval, g) == value(2));
+    assert(evaluate(eval, vg) == value(2));
+    auto& s = fb.make_expr_stmt(rb.make_assign_expr(rb.make_ref_expr(g), ib.make_mul_expr(vg, vg)));
+    assert(evaluate(eval, s) == next_control);
+    assert(evaluate(eval, vg) == value(4));
+    assert(evaluate(eval, fb.make_call_expr(rb.make_ref_expr(*next), {&rb.make_ref_init(rb.make_ref_expr(g))})) == value(5));
+    assert(evaluate(eval, vg) == value(5));
+  }
+}
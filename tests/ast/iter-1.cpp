@@ -0,0 +1,177 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.tuple/ast.hpp>
+#include <beaker/all/evaluation/iterative.hpp>
+#include <beaker/all/comparison/iterative.hpp>
+
+
+/// Check that the iterative evaluation of `e` has the same value as `e`.
+void
+check_iterative(const language& lang, const expr& e, const value& v)
+{
+  std::clog << pretty(lang, e) << " ~> " << v << " [iterative]\n";
+  evaluator eval(lang);
+  assert(evaluate_iterative(eval, e) == v);
+  assert(evaluate_iterative(eval, e) == evaluate(eval, e));
+}
+
+/// Check that the iterative evaluation of `e` fails.
+void
+check_iterative_error(const language& lang, const expr& e)
+{
+  std::clog << pretty(lang, e) << " ~> error [iterative]\n";
+  evaluator eval(lang);
+  bool f = false;
+  try {
+    evaluate_iterative(eval, e);
+  } catch (evaluation_error&) {
+    f = true;
+  }
+  assert(f);
+}
+
+/// Check that iterative comparison and hashing agree with equal() and 
+/// hash() for `a` and `b`.
+void
+check_comparison(const language& lang, const expr& a, const expr& b)
+{
+  std::clog << pretty(lang, a) << " ?= " << pretty(lang, b) << " [iterative]\n";
+  assert(equal_iterative(a, b) == equal(a, b));
+  hasher h1;
+  hash(h1, a);
+  hasher h2;
+  hash_iterative(h2, a);
+  assert((std::size_t)h1 == (std::size_t)h2);
+}
+
+/// Returns a chain of n additions of 1 to `e`, leaning left if `left` is
+/// true, and right otherwise.
+expr&
+make_chain(sys_int::builder& ib, expr& e, int n, bool left)
+{
+  expr* r = &e;
+  for (int i = 0; i < n; ++i) {
+    expr& one = ib.make_int_expr(e.get_type(), 1);
+    r = left ? &ib.make_add_expr(*r, one) : &ib.make_add_expr(one, *r);
+  }
+  return *r;
+}
+
+/// Check evaluation and comparison of chains too deep to recurse over.
+void
+check_deep(const language& lang, sys_int::builder& ib, bool left)
+{
+  const int n = 1000000;
+  auto& mod64 = ib.get_mod_type(64);
+  expr& c1 = make_chain(ib, ib.make_int_expr(mod64, 0), n, left);
+  expr& c2 = make_chain(ib, ib.make_int_expr(mod64, 0), n, left);
+  expr& c3 = make_chain(ib, ib.make_int_expr(mod64, 1), n, left);
+
+  evaluator eval(lang);
+  iterative_evaluator w(eval);
+  assert(w.evaluate(c1) == value(n));
+  assert(w.evaluate(c3) == value(n + 1));
+
+  iterative_comparison c;
+  assert(c.equal(c1, c2));
+  assert(!c.equal(c1, c3));
+  hasher h1;
+  c.hash(h1, c1);
+  hasher h2;
+  c.hash(h2, c2);
+  assert((std::size_t)h1 == (std::size_t)h2);
+}
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_tuple::feature(),
+  });
+  module mod(lang);
+  auto& vb = mod.get_builder<sys_void::feature>();
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& tb = mod.get_builder<sys_tuple::feature>();
+
+  auto& int8 = ib.get_int8_type();
+  auto& nat8 = ib.get_nat8_type();
+  auto& mod8 = ib.get_mod8_type();
+  auto& int128 = ib.get_int_type(128);
+
+  auto& t = bb.make_true_expr();
+  auto& f = bb.make_false_expr();
+  auto& z1 = ib.make_int_expr(int8, 1);
+  auto& z2 = ib.make_int_expr(int8, 2);
+  auto& zmax = ib.make_int_expr(int8, int8.max());
+  auto& n0 = ib.make_int_expr(nat8, 0);
+  auto& n1 = ib.make_int_expr(nat8, 1);
+  auto& mmax = ib.make_int_expr(mod8, mod8.max());
+  auto& w1 = ib.make_int_expr(int128, 1);
+  auto& wmax = ib.make_int_expr(int128, value(int128.wide_max()));
+
+  // Literals and logic.
+  check_iterative(lang, vb.make_nop_expr(), value());
+  check_iterative(lang, vb.make_void_expr(z1), value());
+  check_iterative(lang, bb.make_and_expr(t, f), value(0));
+  check_iterative(lang, bb.make_imp_expr(f, f), value(1));
+  check_iterative(lang, bb.make_not_expr(f), value(1));
+
+  // Short circuiting and conditionals.
+  auto& trap = bb.make_assert_expr(f);
+  check_iterative(lang, bb.make_and_then_expr(f, trap), value(0));
+  check_iterative(lang, bb.make_or_else_expr(t, trap), value(1));
+  check_iterative(lang, bb.make_if_expr(f, z1, z2), value(2));
+  check_iterative(lang, bb.make_if_expr(bb.make_and_then_expr(t, f), z1, z2), value(2));
+
+  // Arithmetic, including wide arithmetic.
+  check_iterative(lang, ib.make_sub_expr(z1, z2), value(-1));
+  check_iterative(lang, ib.make_quo_expr(z2, z1), value(2));
+  check_iterative(lang, ib.make_lt_expr(z1, z2), value(1));
+  check_iterative(lang, ib.make_add_expr(mmax, ib.make_int_expr(mod8, 1)), value(0));
+  check_iterative(lang, ib.make_add_expr(
+    ib.make_mul_expr(z2, ib.make_add_expr(z1, z2)),
+    ib.make_neg_expr(ib.make_sub_expr(z2, z1))
+  ), value(5));
+  check_iterative(lang, ib.make_sub_expr(wmax, w1), value(int128.wide_max() - 1));
+  check_iterative(lang, ib.make_lt_expr(w1, wmax), value(1));
+
+  // Tuples are evaluated by the tree walker.
+  auto& tup = tb.make_tuple_expr({&z1, &ib.make_add_expr(z1, z2)});
+  check_iterative(lang, ib.make_add_expr(tb.make_proj_expr(tup, 1), z1), value(4));
+
+  // Errors.
+  check_iterative_error(lang, vb.make_trap_expr());
+  check_iterative_error(lang, trap);
+  check_iterative_error(lang, ib.make_add_expr(zmax, z1));
+  check_iterative_error(lang, ib.make_sub_expr(n0, n1));
+  check_iterative_error(lang, ib.make_add_expr(wmax, w1));
+  check_iterative_error(lang, bb.make_if_expr(t, vb.make_trap_expr(), vb.make_nop_expr()));
+
+  // Comparison and hashing agree with the recursive algorithms, including
+  // for expressions whose comparison is overridden.
+  auto& e1 = ib.make_add_expr(z1, ib.make_mul_expr(z2, z1));
+  auto& e2 = ib.make_add_expr(z1, ib.make_mul_expr(z2, z1));
+  auto& e3 = ib.make_add_expr(z1, ib.make_mul_expr(z1, z2));
+  check_comparison(lang, e1, e2);
+  check_comparison(lang, e1, e3);
+  check_comparison(lang, bb.make_if_expr(t, e1, e3), bb.make_if_expr(t, e2, e3));
+  check_comparison(lang, tb.make_proj_expr(tup, 0), tb.make_proj_expr(tup, 1));
+  check_comparison(lang, ib.make_neg_expr(tb.make_proj_expr(tup, 1)), 
+                         ib.make_neg_expr(tb.make_proj_expr(tup, 1)));
+  assert(!equal_iterative(tb.make_proj_expr(tup, 0), tb.make_proj_expr(tup, 1)));
+
+  check_deep(lang, ib, true);
+  check_deep(lang, ib, false);
+}
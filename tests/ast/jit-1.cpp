@@ -0,0 +1,197 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+#include <beaker/sys.int/evaluation/evaluate.hpp>
+#include <beaker/all/evaluation/jit.hpp>
+
+
+/// Check that the native form of `e` has the same value as `e`.
+void
+check_jit(const language& lang, jit& j, const expr& e, const value& v)
+{
+  std::clog << pretty(lang, e) << " ~> " << v << " [jit]\n";
+  native_program p = j.compile(e);
+  assert(j.execute(p) == v);
+  assert(j.execute(p) == evaluate(j.get_evaluator(), e));
+}
+
+/// Check that the execution of the native form of `e` fails.
+void
+check_jit_error(const language& lang, jit& j, const expr& e)
+{
+  std::clog << pretty(lang, e) << " ~> error [jit]\n";
+  native_program p = j.compile(e);
+  bool f = false;
+  try {
+    j.execute(p);
+  } catch (evaluation_error&) {
+    f = true;
+  }
+  assert(f);
+}
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+  module mod(lang);
+  auto& vb = mod.get_builder<sys_void::feature>();
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& rb = mod.get_builder<sys_var::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+
+  evaluator eval(lang);
+  jit j(eval);
+
+  auto& int8 = ib.get_int8_type();
+  auto& nat8 = ib.get_nat8_type();
+  auto& mod8 = ib.get_mod8_type();
+  auto& int32 = ib.get_int32_type();
+
+  auto& t = bb.make_true_expr();
+  auto& f = bb.make_false_expr();
+  auto& z1 = ib.make_int_expr(int8, 1);
+  auto& z2 = ib.make_int_expr(int8, 2);
+  auto& zmax = ib.make_int_expr(int8, int8.max());
+  auto& zmin = ib.make_int_expr(int8, int8.min());
+  auto& zneg = ib.make_int_expr(int8, -1);
+  auto& n0 = ib.make_int_expr(nat8, 0);
+  auto& n1 = ib.make_int_expr(nat8, 1);
+  auto& nmax = ib.make_int_expr(nat8, nat8.max());
+  auto& m1 = ib.make_int_expr(mod8, 1);
+  auto& mmax = ib.make_int_expr(mod8, mod8.max());
+
+  // Literals and logic.
+  check_jit(lang, j, vb.make_nop_expr(), value());
+  check_jit(lang, j, vb.make_void_expr(z1), value());
+  check_jit(lang, j, t, value(1));
+  check_jit(lang, j, bb.make_and_expr(t, f), value(0));
+  check_jit(lang, j, bb.make_imp_expr(f, f), value(1));
+  check_jit(lang, j, bb.make_not_expr(f), value(1));
+
+  // Short circuiting and conditionals.
+  auto& trap = bb.make_assert_expr(f);
+  check_jit(lang, j, bb.make_and_then_expr(f, trap), value(0));
+  check_jit(lang, j, bb.make_or_else_expr(t, trap), value(1));
+  check_jit(lang, j, bb.make_if_expr(t, z1, z2), value(1));
+  check_jit(lang, j, bb.make_if_expr(f, z1, z2), value(2));
+  check_jit(lang, j, bb.make_if_expr(bb.make_and_then_expr(t, f), z1, z2), value(2));
+
+  // Arithmetic.
+  check_jit(lang, j, ib.make_add_expr(z1, z2), value(3));
+  check_jit(lang, j, ib.make_sub_expr(z1, z2), value(-1));
+  check_jit(lang, j, ib.make_mul_expr(z2, z2), value(4));
+  check_jit(lang, j, ib.make_quo_expr(z2, z1), value(2));
+  check_jit(lang, j, ib.make_rem_expr(z1, z2), value(1));
+  check_jit(lang, j, ib.make_rem_expr(zmin, zneg), value(0));
+  check_jit(lang, j, ib.make_neg_expr(z2), value(-2));
+  check_jit(lang, j, ib.make_lt_expr(zneg, z2), value(1));
+  check_jit(lang, j, ib.make_lt_expr(n1, nmax), value(1));
+  check_jit(lang, j, ib.make_add_expr(mmax, m1), value(0));
+  check_jit(lang, j, ib.make_sub_expr(nmax, n1), value(254));
+  check_jit(lang, j, ib.make_add_expr(
+    ib.make_mul_expr(z2, ib.make_add_expr(z1, z2)),
+    ib.make_neg_expr(ib.make_sub_expr(z2, z1))
+  ), value(5));
+
+  // Errors.
+  check_jit_error(lang, j, vb.make_trap_expr());
+  check_jit_error(lang, j, trap);
+  check_jit_error(lang, j, ib.make_add_expr(zmax, z1));
+  check_jit_error(lang, j, ib.make_add_expr(nmax, n1));
+  check_jit_error(lang, j, ib.make_sub_expr(n0, n1));
+  check_jit_error(lang, j, ib.make_quo_expr(z1, ib.make_sub_expr(z1, z1)));
+  check_jit_error(lang, j, ib.make_quo_expr(zmin, zneg));
+  check_jit_error(lang, j, ib.make_neg_expr(zmin));
+  check_jit_error(lang, j, bb.make_if_expr(t, vb.make_trap_expr(), vb.make_nop_expr()));
+
+  // Unsupported expressions are evaluated by the tree walker.
+  bool f1 = false;
+  try {
+    j.compile(ib.make_neg_expr(n1));
+  } catch (generation_error&) {
+    f1 = true;
+  }
+  assert(f1);
+
+  // Functions. Define:
+  //
+  //    def add(a : int32, b : int32) -> int32 { return a + b; }
+  //    def fact(n : int32) -> int32 { return n == 0 ? 1 : n * fact(n - 1); }
+  auto& zero = ib.make_int_expr(int32, 0);
+  auto& one = ib.make_int_expr(int32, 1);
+  {
+    auto& a = fb.make_parm_decl("a", int32);
+    auto& b = fb.make_parm_decl("b", int32);
+    auto& r = fb.make_parm_decl("r", int32);
+    decl_seq parms {&a, &b};
+    auto& type = fb.get_fn_type(parms, r);
+    auto& va = rb.make_val_expr(rb.make_ref_expr(a));
+    auto& vb = rb.make_val_expr(rb.make_ref_expr(b));
+    auto& body = fb.make_block_stmt({
+      &fb.make_ret_stmt(rb.make_copy_init(ib.make_add_expr(va, vb)))
+    });
+    mod.add_declaration(fb.make_fn_decl(dc(mod), "add", type, parms, r, body));
+  }
+  {
+    auto& n = fb.make_parm_decl("n", int32);
+    auto& r = fb.make_parm_decl("r", int32);
+    decl_seq parms {&n};
+    auto& type = fb.get_fn_type(parms, r);
+    auto& fn = fb.make_fn_decl(dc(mod), "fact", type, parms, r);
+    auto& vn = rb.make_val_expr(rb.make_ref_expr(n));
+    auto& rec = fb.make_call_expr(rb.make_ref_expr(fn), {&ib.make_sub_expr(vn, one)});
+    auto& val = bb.make_if_expr(ib.make_eq_expr(vn, zero), one, ib.make_mul_expr(vn, rec));
+    fn.def_ = &fb.make_block_stmt({&fb.make_ret_stmt(val)});
+    mod.add_declaration(fn);
+  }
+  const decl& add = mod.get_declarations()[0];
+  const decl& fact = mod.get_declarations()[1];
+  j.load(mod);
+  assert(j.call(add, {value(3), value(4)}) == value(7));
+  assert(j.call(fact, {value(5)}) == value(120));
+
+  // Errors propagate through calls.
+  bool f2 = false;
+  try {
+    j.call(add, {value(int32.max()), value(1)});
+  } catch (sys_int::overflow_error&) {
+    f2 = true;
+  }
+  assert(f2);
+  bool f3 = false;
+  try {
+    j.call(fact, {value(13)});
+  } catch (sys_int::overflow_error&) {
+    f3 = true;
+  }
+  assert(f3);
+
+  // Compiled expressions can call loaded functions.
+  auto& call = fb.make_call_expr(rb.make_ref_expr(const_cast<decl&>(fact)), {&ib.make_int_expr(int32, 6)});
+  assert(evaluate(j, call) == value(720));
+  assert(evaluate(j, call) == value(720));
+
+  // Values that are not representable natively are evaluated by the tree
+  // walker.
+  auto& big = ib.make_int_expr(ib.get_int_type(128), 5);
+  assert(evaluate(j, big) == value(5));
+}
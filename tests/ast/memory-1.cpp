@@ -0,0 +1,535 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include <beaker/util/memory.hpp>
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+#include <beaker/sys.tuple/ast.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+
+using namespace beaker;
+
+/// An allocator that records the size of each allocation.
+struct counting_allocator : freestore_allocator
+{
+  void* allocate(int n) override
+  {
+    sizes_.push_back(n);
+    ++live_;
+    return freestore_allocator::allocate(n);
+  }
+
+  void deallocate(void* p) override
+  {
+    --live_;
+    freestore_allocator::deallocate(p);
+  }
+
+  void deallocate(void* p, int n) override
+  {
+    --live_;
+    freestore_allocator::deallocate(p, n);
+  }
+
+  std::vector<int> sizes_;
+  int live_ = 0;
+};
+
+/// Returns true if p is aligned to a bytes.
+bool
+is_aligned(void* p, int a)
+{
+  return reinterpret_cast<std::uintptr_t>(p) % a == 0;
+}
+
+
+/// Check that blocks grow geometrically up to the maximum block size.
+void
+check_growth()
+{
+  using alloc_type = sequential_allocator<1024>;
+  counting_allocator base;
+  {
+    alloc_type alloc(base);
+    for (int i = 0; i < 100000; ++i)
+      assert(is_aligned(alloc.allocate(24, 8), 8));
+    assert(base.sizes_.size() > 1);
+    assert(base.sizes_[0] == 1024);
+    for (std::size_t i = 1; i < base.sizes_.size(); ++i) {
+      int n = base.sizes_[i - 1];
+      int m = base.sizes_[i];
+      assert(m == (n < alloc_type::max_block_size ? 2 * n : n));
+    }
+  }
+  assert(base.live_ == 0);
+}
+
+/// Check that jumbo allocations are not limited by the block size and do 
+/// not interrupt allocation in the current block.
+void
+check_jumbo()
+{
+  counting_allocator base;
+  {
+    sequential_allocator<1024> alloc(base);
+    char* p1 = (char*)alloc.allocate(8);
+    
+    // Larger than a block.
+    char* big = (char*)alloc.allocate(100000, 64);
+    assert(is_aligned(big, 64));
+    std::memset(big, 0xff, 100000);
+    
+    // Allocation continues in the first block.
+    char* p2 = (char*)alloc.allocate(8);
+    assert(p2 == p1 + 8);
+    assert(base.sizes_.size() == 2);
+
+    // Many large allocations.
+    for (int i = 0; i < 100; ++i) {
+      char* p = (char*)alloc.allocate(5000 + i, 16);
+      assert(is_aligned(p, 16));
+      std::memset(p, i, 5000 + i);
+    }
+    assert(base.live_ == 102);
+  }
+  assert(base.live_ == 0);
+}
+
+/// Check that a jumbo allocation can be the first allocation.
+void
+check_first_jumbo()
+{
+  counting_allocator base;
+  {
+    sequential_allocator<> alloc(base);
+    std::memset(alloc.allocate(1 << 16), 0, 1 << 16);
+    assert(base.live_ == 1);
+    std::memset(alloc.allocate(16, 16), 0, 16);
+    assert(base.live_ == 2);
+  }
+  assert(base.live_ == 0);
+}
+
+/// Check that releasing a mark frees the blocks allocated after it, and 
+/// that allocation resumes from the mark.
+void
+check_release()
+{
+  counting_allocator base;
+  {
+    sequential_allocator<1024> alloc(base);
+    alloc.allocate(16);
+    auto m1 = alloc.get_mark();
+    char* p1 = (char*)alloc.allocate(16);
+    alloc.release(m1);
+    assert(alloc.allocate(16) == p1);
+    assert(base.live_ == 1);
+
+    // Release new blocks and jumbo blocks.
+    auto m2 = alloc.get_mark();
+    for (int i = 0; i < 10000; ++i)
+      alloc.allocate(32, 8);
+    alloc.allocate(1 << 20);
+    assert(base.live_ > 2);
+    alloc.release(m2);
+    assert(base.live_ == 1);
+    std::size_t n = base.sizes_.size();
+    
+    // The same blocks are allocated again.
+    for (int i = 0; i < 10000; ++i)
+      alloc.allocate(32, 8);
+    for (std::size_t i = n; i < base.sizes_.size(); ++i)
+      assert(base.sizes_[i] == base.sizes_[i - n + 1]);
+
+    // Release everything.
+    alloc.release({});
+    assert(base.live_ == 0);
+    alloc.allocate(8);
+    assert(base.live_ == 1);
+  }
+  assert(base.live_ == 0);
+}
+
+/// Check that checkpoints release the terms allocated by a factory unless 
+/// they are committed.
+void
+check_checkpoint()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t = ib.get_int64_type();
+  
+  auto m = ib.get_mark();
+  {
+    checkpoint c(ib);
+    for (int i = 0; i < 100000; ++i)
+      ib.make_int_expr(t, i);
+  }
+  assert(ib.get_mark().arenas_[other_family].current == m.arenas_[other_family].current);
+
+  {
+    checkpoint c(ib);
+    ib.make_int_expr(t, 42);
+    c.commit();
+  }
+  assert(ib.get_mark().arenas_[other_family].current != m.arenas_[other_family].current);
+}
+
+/// Check the statistics of a sequential allocator.
+void
+check_stats()
+{
+  counting_allocator base;
+  sequential_allocator<1024> alloc(base);
+  alloc.allocate(3);
+  alloc.allocate(8, 8);
+  alloc.allocate(400);
+  alloc.allocate(400);
+  alloc.allocate(400);
+  allocation_stats s1 = alloc.get_stats();
+  assert(s1.blocks == 2);
+  assert(s1.footprint == 1024 + 2048);
+  assert(s1.peak == s1.footprint);
+  assert(s1.tail == 1024 - 16 - 8 - 8 - 800);
+#if BEAKER_ALLOC_STATS
+  assert(s1.allocations == 5);
+  assert(s1.requested == 1211);
+  assert(s1.alignment == 5);
+#endif
+
+  // Releasing memory reduces the footprint, but not the peak.
+  auto m = alloc.get_mark();
+  alloc.allocate(100000);
+  allocation_stats s2 = alloc.get_stats();
+  assert(s2.blocks == 3);
+  alloc.release(m);
+  allocation_stats s3 = alloc.get_stats();
+  assert(s3.blocks == 2);
+  assert(s3.footprint == s1.footprint);
+  assert(s3.peak == s2.footprint);
+  assert(s3.tail == s1.tail);
+}
+
+/// Check that the statistics of a module can be written as JSON.
+void
+check_stats_json()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t = ib.get_int64_type();
+  for (int i = 0; i < 1000; ++i)
+    ib.make_int_expr(t, i);
+  assert(ib.get_stats().footprint > 1000 * sizeof(expr));
+
+  std::stringstream ss;
+  write_allocation_stats(ss, mod);
+  std::string str = ss.str();
+  assert(str.find("\"language\": {") != str.npos);
+  assert(str.find("\"module\": {") != str.npos);
+  assert(str.find("\"factories\": {\"sys_bool\": {") != str.npos);
+  assert(str.find("\"sys_int\": {") != str.npos);
+  assert(str.find("\"total\": {") != str.npos);
+}
+
+/// Check that short term sequences are stored inline, and that longer ones
+/// are stored immediately after the node.
+void
+check_spans()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_tuple::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& tb = mod.get_builder<sys_tuple::feature>();
+  auto& t = ib.get_int64_type();
+
+  expr_seq es;
+  for (int i = 0; i < 1000; ++i)
+    es.push_back(ib.make_int_expr(t, i));
+
+  // Two elements are stored in the node.
+  auto& e1 = tb.make_tuple_expr({&es[0], &es[1]});
+  const char* p = reinterpret_cast<const char*>(&e1);
+  const char* q = reinterpret_cast<const char*>(e1.get_elements().data());
+  assert(p < q && q < p + sizeof(e1));
+  assert(&e1.get_element(1) == &es[1]);
+
+  // More elements follow the node.
+  auto& e2 = tb.make_tuple_expr(es);
+  p = reinterpret_cast<const char*>(&e2);
+  q = reinterpret_cast<const char*>(e2.get_elements().data());
+  assert(q == p + sizeof(e2));
+  assert(e2.get_elements().size() == 1000);
+  for (int i = 0; i < 1000; ++i)
+    assert(&e2.get_element(i) == &es[i]);
+
+  // Copies share elements.
+  expr_span s = e2.get_elements();
+  assert(s.data() == e2.get_elements().data());
+}
+
+
+/// Check that a factory with the family policy allocates the terms of each
+/// family in a separate arena.
+void
+check_families()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+  assert(fb.get_arena_policy() == shared_arena_policy);
+  fb.set_arena_policy(family_arena_policy);
+
+  // Interleaved declarations and statements.
+  auto& t = ib.get_int64_type();
+  auto& z = ib.make_int_expr(t, 0);
+  auto& d1 = fb.make_parm_decl("a", t);
+  auto& s1 = fb.make_expr_stmt(z);
+  auto& d2 = fb.make_parm_decl("b", t);
+  auto& s2 = fb.make_expr_stmt(z);
+
+  // Terms of the same family are adjacent.
+  assert((char*)&d2 == (char*)&d1 + sizeof(d1));
+  assert((char*)&s2 == (char*)&s1 + sizeof(s1));
+  assert(fb.get_stats(decl_family).footprint > 0);
+  assert(fb.get_stats(stmt_family).footprint > 0);
+  assert(fb.get_stats(expr_family).footprint == 0);
+
+  // Checkpoints release terms in every arena.
+  {
+    checkpoint c(fb);
+    fb.make_parm_decl("c", t);
+    fb.make_expr_stmt(z);
+  }
+  assert((char*)&fb.make_parm_decl("d", t) == (char*)&d2 + sizeof(d2));
+  assert((char*)&fb.make_expr_stmt(z) == (char*)&s2 + sizeof(s2));
+}
+
+
+/// Check that a mapped allocator provides the blocks of a module.
+void
+check_mapped()
+{
+  // Allocations are aligned, and the most recent allocation is rewound when
+  // it is deallocated, along with free memory preceding it.
+  {
+    mapped_allocator m(1 << 20);
+    char* p1 = (char*)m.allocate(10);
+    char* p2 = (char*)m.allocate(100, 64);
+    assert((std::uintptr_t)p1 % alignof(std::max_align_t) == 0);
+    assert((std::uintptr_t)p2 % 64 == 0);
+    assert(m.begin() <= p1 && p2 + 100 <= m.end());
+    std::size_t n = m.get_stats().footprint;
+    m.deallocate(p1);
+    assert(m.get_stats().blocks == 1);
+    assert(m.get_stats().footprint == n - 10);
+    m.deallocate(p2);
+    assert(m.get_stats().blocks == 0);
+    assert(m.get_stats().footprint == 0);
+    assert(m.allocate(10) == p1);
+  }
+
+  // Memory that is not the most recent allocation is reused by requests of
+  // a similar size.
+  {
+    mapped_allocator m(1 << 20);
+    char* p1 = (char*)m.allocate(8192);
+    char* p2 = (char*)m.allocate(16);
+    m.deallocate(p1);
+    assert(m.allocate(16384) != p1);
+    assert(m.allocate(8000) == p1);
+    assert(m.get_stats().blocks == 3);
+    m.deallocate(p2);
+    assert(m.allocate(16) == p2);
+  }
+
+  // Allocation fails when the range is exhausted.
+  {
+    mapped_allocator m(1 << 16);
+    bool thrown = false;
+    try {
+      m.allocate(1 << 17);
+    } catch (std::bad_alloc&) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+
+  // The terms of a module are allocated in the mapped range. With compact
+  // references, terms are always allocated in the node region.
+#if !BEAKER_COMPACT_REFS
+  mapped_allocator blocks(std::size_t(1) << 32, true);
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang, blocks);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t = ib.get_int64_type();
+  auto& e = ib.make_int_expr(t, 0);
+  assert(blocks.begin() <= (char*)&e && (char*)&e < blocks.end());
+
+  // Blocks released by a checkpoint are reused.
+  std::size_t n = blocks.get_stats().footprint;
+  {
+    checkpoint c(ib);
+    for (int i = 0; i < 100000; ++i)
+      ib.make_int_expr(t, i);
+    assert(blocks.get_stats().footprint > n);
+  }
+  assert(blocks.get_stats().footprint == n);
+#endif
+
+  // Blocks of destroyed modules are reused even when they are not the most
+  // recent allocations, so the footprint of repeated module lifetimes is 
+  // steady. With compact references, every module allocates blocks from
+  // the node region.
+  {
+#if BEAKER_COMPACT_REFS
+    allocator& region = default_node_allocator();
+#else
+    mapped_allocator region(std::size_t(1) << 32);
+#endif
+    symbol_table syms;
+    language lang(syms, {
+      new sys_bool::feature(),
+      new sys_int::feature(),
+    });
+    module keep(lang, region);
+    auto& kb = keep.get_builder<sys_int::feature>();
+    auto& t = kb.get_int64_type();
+    allocation_stats steady;
+    for (int i = 0; i < 20; ++i) {
+      {
+        module mod(lang, region);
+        auto& ib = mod.get_builder<sys_int::feature>();
+        for (int j = 0; j < 20000; ++j)
+          ib.make_int_expr(t, j);
+        if (i == 0)
+          kb.make_int_expr(t, 0);
+      }
+      allocation_stats s = region.get_stats();
+      if (i == 1)
+        steady = s;
+      if (i > 1)
+        assert(s.peak == steady.peak && s.footprint == steady.footprint);
+    }
+  }
+}
+
+
+/// Check that a pool recycles memory by size class.
+void
+check_pool()
+{
+  counting_allocator a;
+  pool_allocator pool(a);
+
+  // Memory is reused by requests in the same size class.
+  void* p1 = pool.allocate(24);
+  void* p2 = pool.allocate(8);
+  assert(is_aligned(p1, alignof(std::max_align_t)));
+  pool.deallocate(p1, 24);
+  assert(pool.allocate(20) == p1);
+  pool.deallocate(p2, 8);
+  assert(pool.allocate(1) == p2);
+
+  // Large requests are forwarded to the underlying allocator.
+  int live = a.live_;
+  void* p3 = pool.allocate(pool_allocator::max_size + 1);
+  assert(a.live_ == live + 1);
+  pool.deallocate(p3, pool_allocator::max_size + 1);
+  assert(a.live_ == live);
+
+  // Containers deallocate with the size of their storage, so storage is 
+  // recycled as they grow.
+  std::vector<int, typed_allocator<int>> v {typed_allocator<int>(pool)};
+  v.push_back(0);
+  int* first = v.data();
+  v.push_back(1);
+  assert(v.data() != first);
+  assert(pool.allocate(sizeof(int)) == first);
+}
+
+
+/// Check that operands are stored as node references.
+void
+check_refs()
+{
+  node_ref<expr> null;
+  assert(!null);
+#if BEAKER_COMPACT_REFS
+  assert(sizeof(node_ref<expr>) == 4);
+#else
+  assert(sizeof(node_ref<expr>) == sizeof(expr*));
+#endif
+
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t = ib.get_int64_type();
+  auto& a = ib.make_int_expr(t, 1);
+  auto& b = ib.make_int_expr(t, 2);
+  auto& e = ib.make_add_expr(a, ib.make_neg_expr(b));
+  assert(&e.get_type() == &t);
+  assert(&e.get_lhs() == &a);
+  assert(&cast<sys_int::neg_expr>(e.get_rhs()).get_operand() == &b);
+}
+
+
+int
+main()
+{
+  check_growth();
+  check_jumbo();
+  check_first_jumbo();
+  check_release();
+  check_checkpoint();
+  check_stats();
+  check_stats_json();
+  check_spans();
+  check_families();
+  check_mapped();
+  check_pool();
+  check_refs();
+}
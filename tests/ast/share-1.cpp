@@ -0,0 +1,99 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+#include <beaker/all/evaluation/evaluate.hpp>
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+  module mod(lang);
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t32 = ib.get_int32_type();
+  auto& t64 = ib.get_int64_type();
+
+  // Expressions are not shared by default.
+  assert(!ib.is_hash_consing());
+  assert(&ib.make_int_expr(t64, 1) != &ib.make_int_expr(t64, 1));
+
+  ib.set_hash_consing(true);
+  bb.set_hash_consing(true);
+
+  // Equal literals and operators are the same expression.
+  auto& one = ib.make_int_expr(t64, 1);
+  assert(&ib.make_int_expr(t64, 1) == &one);
+  assert(&ib.make_int_expr(t64, 2) != &one);
+  assert(&ib.make_int_expr(t32, 1) != &one);
+  auto& e1 = ib.make_add_expr(one, ib.make_neg_expr(ib.make_int_expr(t64, 2)));
+  char* used = ib.get_mark().arenas_[expr_family].current;
+  auto& e2 = ib.make_add_expr(ib.make_int_expr(t64, 1), ib.make_neg_expr(ib.make_int_expr(t64, 2)));
+  assert(&e1 == &e2);
+  assert(ib.get_mark().arenas_[expr_family].current == used);
+  assert(&ib.make_add_expr(one, e1) != &ib.make_add_expr(e1, one));
+
+  // Repeated subexpressions form a DAG, which evaluates as the tree would.
+  expr* e = &one;
+  for (int i = 0; i < 10; ++i)
+    e = &ib.make_add_expr(*e, *e);
+  assert(ib.get_shared_set<sys_int::add_expr>().size() == 13);
+  evaluator eval(lang);
+  assert(evaluate(eval, *e) == value(1024));
+
+  auto& c = bb.make_if_expr(bb.make_true_expr(), e1, one);
+  assert(&bb.make_if_expr(bb.make_true_expr(), e2, one) == &c);
+  assert(evaluate(eval, c) == value(-1));
+
+  // Assertions are not pure, so they are not shared.
+  auto& t = bb.make_true_expr();
+  assert(&bb.make_assert_expr(t) != &bb.make_assert_expr(t));
+
+  // Layouts of shared expressions are kept in the layout map.
+  layout_map& locs = ib.get_layout_map();
+  locs.add_fixed_layout(one, location(1, 1, 2));
+  locs.add_fixed_layout(one, location(3, 5, 6));
+  locs.add_variable_layout(e1, {location(4, 1, 2), location(4, 3, 4)});
+  assert(!one.has_layout());
+  assert(locs.count(one) == 2);
+  assert(locs.get_layout(one, 1).get_location().get_line() == 3);
+  assert(locs.get_layout(e1, 0).size() == 2);
+  assert(locs.count(*e) == 0);
+
+  // Shared expressions allocated after a mark are released with it, along
+  // with their layouts. Expressions made before the mark are still shared.
+  int shared = ib.get_shared_set<sys_int::int_expr>().size();
+  auto m = ib.get_mark();
+  for (int i = 0; i < 1000; ++i)
+    locs.add_fixed_layout(ib.make_int_expr(t64, 100 + i), location(5, 1, 2));
+  assert(ib.get_shared_set<sys_int::int_expr>().size() == shared + 1000);
+  ib.release(m);
+  assert(ib.get_shared_set<sys_int::int_expr>().size() == shared);
+  assert(locs.count(one) == 2);
+  assert(&ib.make_int_expr(t64, 1) == &one);
+  auto& big = ib.make_int_expr(t64, 50000);
+  assert(evaluate(eval, big) == value(50000));
+  assert(&ib.make_int_expr(t64, 50000) == &big);
+  assert(evaluate(eval, ib.make_int_expr(t64, 100)) == value(100));
+  assert(locs.count(ib.make_int_expr(t64, 100)) == 0);
+
+  // Expressions are not shared after the mode is turned off.
+  ib.set_hash_consing(false);
+  assert(&ib.make_int_expr(t64, 1) != &one);
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+#include <beaker/base/expr_table.hpp>
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+  module mod(lang);
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& rb = mod.get_builder<sys_var::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+
+  expr_table tab;
+  bb.set_expr_table(&tab);
+  ib.set_expr_table(&tab);
+  assert(ib.get_expr_table() == &tab);
+
+  // Expressions are recorded as they are made, after their operands.
+  auto& t = ib.get_int64_type();
+  auto& one = ib.make_int_expr(t, 1);
+  auto& two = ib.make_int_expr(t, 2);
+  auto& add = ib.make_add_expr(one, ib.make_neg_expr(two));
+  assert(tab.size() == 4);
+  flat_expr e = tab.get(tab.find(add));
+  assert(e.get_kind() == add.get_kind());
+  assert(e.get_form() == binary_form);
+  assert(&e.get_type() == &t);
+  assert(e.get_arity() == 2);
+  assert(e.get_operand(0).get_index() == tab.find(one));
+  assert(e.get_operand(0).get_value() == value(1));
+  assert(e.get_operand(1).get_form() == unary_form);
+  assert(e.get_operand(1).get_operand(0).get_value() == value(2));
+  for (int i = 0; i < tab.size(); ++i)
+    for (int j = 0; j < tab.get(i).get_arity(); ++j)
+      assert(tab.get(i).get_operand(j).get_index() < i);
+
+  // Expressions made by other factories are added with their users.
+  auto& x = fb.make_parm_decl("x", t);
+  auto& val = rb.make_val_expr(rb.make_ref_expr(x));
+  auto& sum = ib.make_add_expr(val, one);
+  flat_expr s = tab.get(tab.find(sum));
+  assert(s.get_operand(0).get_form() == unary_form);
+  flat_expr r = s.get_operand(0).get_operand(0);
+  assert(r.is_opaque());
+  assert(r.get_expr().get_kind() == sys_var::ref_expr::node_kind);
+  assert(s.get_operand(1).get_index() == tab.find(one));
+
+  // Equal trees have equal hash codes, and operands are constant when
+  // they do not refer to objects.
+  auto& same = ib.make_add_expr(ib.make_int_expr(t, 1), ib.make_neg_expr(ib.make_int_expr(t, 2)));
+  auto& cond = bb.make_if_expr(bb.make_true_expr(), same, sum);
+  std::vector<std::size_t> codes = tab.hash_all();
+  std::vector<std::uint8_t> consts = tab.constant_all();
+  assert(codes[tab.find(same)] == codes[tab.find(add)]);
+  assert(codes[tab.find(sum)] != codes[tab.find(add)]);
+  assert(consts[tab.find(add)]);
+  assert(!consts[tab.find(sum)]);
+  assert(!consts[tab.find(cond)]);
+  assert(tab.get(tab.find(cond)).get_form() == ternary_form);
+
+  // Expressions are not recorded after the table is removed.
+  int n = tab.size();
+  ib.set_expr_table(nullptr);
+  ib.make_int_expr(t, 3);
+  assert(tab.size() == n);
+
+  // Expressions released by a checkpoint are removed from the table, so
+  // a new expression at a reused address gets a new row.
+  ib.set_expr_table(&tab);
+  n = tab.size();
+  expr* p;
+  {
+    checkpoint c(ib);
+    p = &ib.make_int_expr(t, 7);
+    ib.make_neg_expr(*p);
+    assert(tab.size() == n + 2);
+  }
+  assert(tab.size() == n);
+  auto& k = ib.make_int_expr(t, 8);
+  assert(&k == p);
+  assert(tab.size() == n + 1);
+  assert(tab.get(tab.find(k)).get_value() == value(8));
+}
@@ -0,0 +1,206 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+#include <beaker/all/evaluation/tiered.hpp>
+
+
+/// Evaluate `e` n times, checking its value each time. Returns the tier
+/// in which the last evaluation was performed.
+tier
+check_tiered(const language& lang, tiered_evaluator& eval, const expr& e, const value& v, int n)
+{
+  std::clog << pretty(lang, e) << " ~> " << v << " [tiered x" << n << "]\n";
+  const profile* p = eval.get_profile(e);
+  int c = p ? p->get_count() : 0;
+  for (int i = 0; i < n; ++i)
+    assert(eval.evaluate(e) == v);
+  p = eval.get_profile(e);
+  assert(p && p->get_count() == c + n);
+  return p->get_tier();
+}
+
+/// Check that evaluating `e` fails.
+void
+check_tiered_error(tiered_evaluator& eval, const expr& e)
+{
+  bool f = false;
+  try {
+    eval.evaluate(e);
+  } catch (evaluation_error&) {
+    f = true;
+  }
+  assert(f);
+}
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& rb = mod.get_builder<sys_var::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+
+  auto& int8 = ib.get_int8_type();
+  auto& int32 = ib.get_int32_type();
+  auto& z1 = ib.make_int_expr(int8, 1);
+  auto& z2 = ib.make_int_expr(int8, 2);
+  auto& zmax = ib.make_int_expr(int8, int8.max());
+
+  evaluator eval(lang);
+  jit j(eval);
+
+  // Without a native tier, expressions are promoted only to the machine.
+  {
+    tiered_evaluator te(eval);
+    auto& e = ib.make_add_expr(z1, z2);
+    assert(check_tiered(lang, te, e, value(3), 1) == walk_tier);
+    assert(check_tiered(lang, te, e, value(3), 1) == machine_tier);
+    assert(te.get_transitions().size() == 1);
+  }
+
+  // Expressions are promoted through each tier as they become hot.
+  {
+    tiered_evaluator te(eval, j);
+    te.set_thresholds(3, 10);
+    auto& e = ib.make_mul_expr(z2, ib.make_add_expr(z1, z2));
+    assert(check_tiered(lang, te, e, value(6), 2) == walk_tier);
+    assert(check_tiered(lang, te, e, value(6), 1) == machine_tier);
+    assert(check_tiered(lang, te, e, value(6), 6) == machine_tier);
+    assert(check_tiered(lang, te, e, value(6), 1) == native_tier);
+    auto& ts = te.get_transitions();
+    assert(ts.size() == 2);
+    assert(ts[0].expr_ == &e && ts[0].from_ == walk_tier && ts[0].to_ == machine_tier);
+    assert(ts[0].count_ == 3);
+    assert(ts[1].from_ == machine_tier && ts[1].to_ == native_tier);
+    assert(ts[1].count_ == 10);
+    for (const transition& t : ts)
+      std::clog << "  " << get_tier_name(t.from_) << " -> "
+                << get_tier_name(t.to_) << " @ " << t.count_ << '\n';
+
+    // Cold expressions are never compiled.
+    auto& c = ib.make_sub_expr(z2, z1);
+    assert(check_tiered(lang, te, c, value(1), 1) == walk_tier);
+    assert(te.get_transitions().size() == 2);
+
+    // Errors are reported in every tier.
+    auto& o = ib.make_add_expr(zmax, z1);
+    for (int i = 0; i < 12; ++i)
+      check_tiered_error(te, o);
+    assert(te.get_profile(o)->get_tier() == native_tier);
+
+    te.reset();
+    assert(!te.get_profile(e));
+    assert(te.get_transitions().empty());
+  }
+
+  // Unsigned values above the maximum signed value are ordered the same in
+  // every tier.
+  {
+    tiered_evaluator te(eval, j);
+    te.set_thresholds(3, 10);
+    auto& n1 = ib.make_int_expr(ib.get_nat64_type(), 1);
+    auto& nmax = ib.make_int_expr(ib.get_nat64_type(), value(~std::uintmax_t(0)));
+    assert(check_tiered(lang, te, ib.make_lt_expr(n1, nmax), value(1), 12) == native_tier);
+    assert(check_tiered(lang, te, ib.make_ge_expr(n1, nmax), value(0), 12) == native_tier);
+    auto& m1 = ib.make_int_expr(ib.get_mod_type(64), 1);
+    auto& mhigh = ib.make_int_expr(ib.get_mod_type(64), value(std::uintmax_t(1) << 63));
+    assert(check_tiered(lang, te, ib.make_gt_expr(mhigh, m1), value(1), 12) == native_tier);
+    assert(check_tiered(lang, te, ib.make_le_expr(mhigh, m1), value(0), 12) == native_tier);
+  }
+
+  // Programs and profiles are discarded when their expressions are 
+  // released, so a new expression at the same address is not evaluated
+  // as the old one.
+  {
+    tiered_evaluator te(eval, j);
+    te.set_thresholds(1, 2);
+    auto& z40 = ib.make_int_expr(int8, 40);
+    const void* addr;
+    {
+      checkpoint c(ib);
+      auto& e = ib.make_add_expr(z1, z2);
+      addr = &e;
+      assert(evaluate(j, e) == value(3));
+      assert(check_tiered(lang, te, e, value(3), 3) == native_tier);
+      assert(te.get_transitions().size() == 2);
+    }
+    assert(te.get_transitions().empty());
+    checkpoint c(ib);
+    auto& e = ib.make_add_expr(z40, z2);
+    assert(&e == addr);
+    assert(!te.get_profile(e));
+    assert(evaluate(j, e) == value(42));
+    assert(check_tiered(lang, te, e, value(42), 3) == native_tier);
+  }
+
+  // Expressions with no native representation are pinned.
+  {
+    tiered_evaluator te(eval, j);
+    te.set_thresholds(1, 2);
+    auto& big = ib.make_int_expr(ib.get_int_type(128), 5);
+    assert(check_tiered(lang, te, big, value(5), 3) == machine_tier);
+    assert(te.get_profile(big)->is_pinned());
+  }
+
+  // Pinned expressions still reach the machine when its threshold is above
+  // the native threshold.
+  {
+    tiered_evaluator te(eval, j);
+    te.set_thresholds(3, 1);
+    auto& big = ib.make_int_expr(ib.get_int_type(128), 7);
+    assert(check_tiered(lang, te, big, value(7), 2) == walk_tier);
+    assert(te.get_profile(big)->is_pinned());
+    assert(check_tiered(lang, te, big, value(7), 1) == machine_tier);
+    assert(te.get_transitions().size() == 1);
+  }
+
+  // Functions are interpreted until they become hot, and then loaded.
+  //
+  //    def sq(n : int32) -> int32 { return n * n; }
+  {
+    auto& n = fb.make_parm_decl("n", int32);
+    auto& r = fb.make_parm_decl("r", int32);
+    decl_seq parms {&n};
+    auto& vn = rb.make_val_expr(rb.make_ref_expr(n));
+    auto& body = fb.make_block_stmt({&fb.make_ret_stmt(ib.make_mul_expr(vn, vn))});
+    mod.add_declaration(fb.make_fn_decl(dc(mod), "sq", fb.get_fn_type(parms, r), parms, r, body));
+  }
+  const decl& sq = mod.get_declarations()[0];
+  {
+    tiered_evaluator te(eval);
+    assert(te.call(sq, {value(3)}) == value(9));
+    assert(te.get_profile(sq)->get_tier() == walk_tier);
+  }
+  {
+    tiered_evaluator te(eval, j);
+    te.set_thresholds(2, 2);
+    te.load(mod);
+    assert(!te.get_profile(sq));
+    assert(te.call(sq, {value(7)}) == value(49));
+    assert(te.get_profile(sq)->get_tier() == walk_tier);
+    assert(te.get_transitions().empty());
+    assert(te.call(sq, {value(8)}) == value(64));
+    assert(te.get_profile(sq)->get_count() == 2);
+    assert(te.get_profile(sq)->get_tier() == native_tier);
+    assert(te.get_transitions().size() == 1);
+    assert(te.get_transitions()[0].decl_ == &sq);
+  }
+}
@@ -1,77 +1,163 @@
 // Copyright (c) 2015-2017 Andrew Sutton
 // All rights reserved
 
-#include "test.hpp"
+#include "util.hpp"
 
-#include <beaker/base/printing/print.hpp>
-#include <beaker/base/generation/generation.hpp>
-#include <beaker/base/serialization/writer.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.tuple/ast.hpp>
+#include <beaker/all/evaluation/machine.hpp>
+#include <beaker/all/evaluation/closure.hpp>
+#include <beaker/all/evaluation/jit.hpp>
+#include <beaker/util/hash.hpp>
 
+#include <sstream>
 
-using namespace beaker;
 
-static void
-check_canonical_types()
+/// Check that `e` has the value v in every evaluator.
+void
+check_tuple(const language& lang, const expr& e, const value& v)
 {
-  // Check canonical types.
-  builder& build = global_builder::get();
-  type& b = build.get_bool_type();
-  type& z = build.get_int32_type();
-  type& t1 = build.get_tuple_type({&b, &z});
-  type& t2 = build.get_tuple_type({&b, &z});
-  type& t3 = build.get_tuple_type({&z, &b});
-  assert(&t1 == &t2);
-  assert(&t1 != &t3);
+  check_value(lang, e, v);
+  evaluator eval(lang);
+  assert(evaluate(eval, make_closure(e)) == v);
+  assert(execute(eval, compile(e)) == v);
 }
 
-int 
+/// Check that the native form of `e` has the value v. Tuples are generated
+/// as struct values, but only their integer elements can be returned.
+void
+check_jit(const language& lang, const expr& e, const value& v)
+{
+  std::clog << pretty(lang, e) << " ~> " << v << " [jit]\n";
+  evaluator eval(lang);
+  jit j(eval);
+  assert(j.execute(j.compile(e)) == v);
+}
+
+/// Returns the printed form of `e`.
+std::string
+print_text(const language& lang, const expr& e)
+{
+  std::stringstream ss;
+  ss << pretty(lang, e);
+  return ss.str();
+}
+
+
+/// Check the representation of aggregate values.
+void
+check_values()
+{
+  sequential_allocator<> alloc;
+  aggregate& a1 = make_aggregate(alloc, 2);
+  a1.get_element(0) = value(1);
+  a1.get_element(1) = value(2);
+  aggregate& a2 = make_aggregate(alloc, 2);
+  a2.get_element(0) = value(1);
+  a2.get_element(1) = value(2);
+  aggregate& a3 = make_aggregate(alloc, 2);
+  a3.get_element(0) = value(2);
+  a3.get_element(1) = value(1);
+  aggregate& a4 = make_aggregate(alloc, 0);
+
+  assert(value(a1).is_aggregate());
+  assert(value(a1) == value(a2));
+  assert(value(a1) != value(a3));
+  assert(value(a1) != value(a4));
+  assert(value(a4) == value(a4));
+  assert(value(a1) != value(1));
+  assert(universal_hash()(value(a1)) == universal_hash()(value(a2)));
+
+  // Elements are initially void.
+  aggregate& a5 = make_aggregate(alloc, 3);
+  assert(a5.get_element(2).is_void());
+
+  std::stringstream ss;
+  ss << value(a1);
+  assert(ss.str() == "{<int 1>, <int 2>}");
+}
+
+/// Check that tuple types are canonical.
+void
+check_types(const language& lang, sys_tuple::builder& tb, 
+            sys_bool::builder& bb, sys_int::builder& ib)
+{
+  type& b = bb.get_bool_type();
+  type& z = ib.get_int32_type();
+  type& t1 = tb.get_tuple_type({&b, &z});
+  type& t2 = tb.get_tuple_type({&b, &z});
+  type& t3 = tb.get_tuple_type({&z, &b});
+  check_identical_terms(lang, t1, t2);
+  check_different_terms(lang, t1, t3);
+}
+
+
+int
 main()
 {
   symbol_table syms;
-  system_lang lang(syms);
-  module mod(lang);
-  
-  // Create and establish a global builder context.
-  builder build(mod);
-  global_builder global(build);
-
-  check_canonical_types();
-
-  type& i32 = build.get_int32_type();
-  expr& e1 = build.make_true_expr();
-  expr& e2 = build.make_int_expr(i32, 5);
-  expr& e3 = build.make_false_expr();
-
-  expr& t1 = build.make_tuple_expr({ // {true, 5, false}
-    &build.make_copy_init(e1), 
-    &build.make_copy_init(e2),
-    &build.make_copy_init(e3)
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_tuple::feature(),
   });
-  expr& p1 = build.make_proj_expr(t1, 1); // t1.1 ~> 5
+  module mod(lang);
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& tb = mod.get_builder<sys_tuple::feature>();
 
-  expr& t2 = build.make_tuple_expr({ // {5, true}
-    &build.make_copy_init(e2), 
-    &build.make_copy_init(e1)
-  });
-  expr& p2 = build.make_proj_expr(t2, 1); // t2.1 ~> 5
+  check_values();
+  check_types(lang, tb, bb, ib);
 
-  expr& t3 = build.make_tuple_expr({ // {false, 5}
-    &build.make_copy_init(e3),
-    &build.make_copy_init(e2) 
-  });
+  auto& i32 = ib.get_int32_type();
+  auto& e1 = bb.make_true_expr();
+  auto& e2 = ib.make_int_expr(i32, 5);
+  auto& e3 = bb.make_false_expr();
+
+  auto& t1 = tb.make_tuple_expr({&e1, &e2, &e3}); // {true, 5, false}
+  auto& t2 = tb.make_tuple_expr({&e1, &e2, &e3});
+  auto& t3 = tb.make_tuple_expr({&e2, &e1});
+  auto& t4 = tb.make_tuple_expr({&t3, &e3}); // {{5, true}, false}
+  check_equal_terms(lang, t1, t2);
+  check_different_terms(lang, t1, t3);
+  assert(print_text(lang, t4) == "{{5, true}, false}");
+
+  // Projections
+  auto& p1 = tb.make_proj_expr(t1, 1);
+  auto& p2 = tb.make_proj_expr(tb.make_proj_expr(t4, 0), 1);
+  assert(&p1.get_type() == &i32);
+  check_tuple(lang, p1, value(5));
+  check_tuple(lang, p2, value(1));
+  check_tuple(lang, ib.make_add_expr(p1, p1), value(10));
+  check_jit(lang, p1, value(5));
+  check_jit(lang, p2, value(1));
 
-  decl& main_ = build.make_main();
-  add_stmts(main_)
-    .run(p2)
-    .run(t3)
-    .ret(p1)
-  ;
+  // Tuple values are aggregates.
+  sequential_allocator<> alloc;
+  aggregate& a = make_aggregate(alloc, 3);
+  a.get_element(0) = value(1);
+  a.get_element(1) = value(5);
+  a.get_element(2) = value(0);
+  check_tuple(lang, t1, value(a));
 
-  archive_writer ar;
-  write_module(ar, mod);
-  ar.save("out.bkm");
+  aggregate& a1 = make_aggregate(alloc, 2);
+  a1.get_element(0) = value(5);
+  a1.get_element(1) = value(1);
+  aggregate& a2 = make_aggregate(alloc, 2);
+  a2.get_element(0) = value(a1);
+  a2.get_element(1) = value(0);
+  check_tuple(lang, t4, value(a2));
 
-  generator gen("a.ll");
-  generate(gen, mod);
-  gen.print();
+  // Aggregates are released after a top-level evaluation, unless they are
+  // part of its result.
+  {
+    evaluator eval(lang);
+    value v = evaluate(eval, t4);
+    char* p = eval.alloc_.get_mark().current;
+    for (int i = 0; i < 100; ++i)
+      assert(evaluate(eval, p2) == value(1));
+    assert(eval.alloc_.get_mark().current == p);
+    assert(v == value(a2));
+  }
 }
@@ -72,6 +72,8 @@ check_value(const language& lang, const expr& e, const value& v)
   std::clog << pretty(lang, e) << " ~> " << v << '\n';
   evaluator eval(lang);
   assert(evaluate(eval, e) == v);
+  result r = try_evaluate(eval, e);
+  assert(r && r.get_value() == v);
 }
 
 /// Check that the evaluation of `e` fails.
@@ -90,6 +92,7 @@ check_error(const language& lang, const expr& e)
     f = true;
   }
   assert(f);
+  assert(!try_evaluate(eval, e));
 }
 
 
@@ -0,0 +1,108 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#include "util.hpp"
+
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/all/evaluation/machine.hpp>
+
+
+/// Check that the compiled form of `e` has the same value as `e`.
+void
+check_machine(const language& lang, const expr& e, const value& v)
+{
+  std::clog << pretty(lang, e) << " ~> " << v << " [vm]\n";
+  evaluator eval(lang);
+  program p = compile(e);
+  machine m(eval);
+  assert(m.execute(p) == v);
+  assert(m.execute(p) == evaluate(eval, e));
+}
+
+/// Check that the execution of the compiled form of `e` fails.
+void
+check_machine_error(const language& lang, const expr& e)
+{
+  std::clog << pretty(lang, e) << " ~> error [vm]\n";
+  evaluator eval(lang);
+  program p = compile(e);
+  bool f = false;
+  try {
+    execute(eval, p);
+  } catch (evaluation_error&) {
+    f = true;
+  }
+  assert(f);
+}
+
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& vb = mod.get_builder<sys_void::feature>();
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+
+  auto& int8 = ib.get_int8_type();
+  auto& nat8 = ib.get_nat8_type();
+  auto& mod8 = ib.get_mod8_type();
+
+  auto& t = bb.make_true_expr();
+  auto& f = bb.make_false_expr();
+  auto& z1 = ib.make_int_expr(int8, 1);
+  auto& z2 = ib.make_int_expr(int8, 2);
+  auto& zmax = ib.make_int_expr(int8, int8.max());
+  auto& zmin = ib.make_int_expr(int8, int8.min());
+  auto& n0 = ib.make_int_expr(nat8, 0);
+  auto& n1 = ib.make_int_expr(nat8, 1);
+  auto& m1 = ib.make_int_expr(mod8, 1);
+  auto& mmax = ib.make_int_expr(mod8, mod8.max());
+
+  // Literals and logic.
+  check_machine(lang, vb.make_nop_expr(), value());
+  check_machine(lang, vb.make_void_expr(z1), value());
+  check_machine(lang, t, value(1));
+  check_machine(lang, bb.make_and_expr(t, f), value(0));
+  check_machine(lang, bb.make_imp_expr(f, f), value(1));
+  check_machine(lang, bb.make_not_expr(f), value(1));
+
+  // Short circuiting and conditionals.
+  auto& trap = bb.make_assert_expr(f);
+  check_machine(lang, bb.make_and_then_expr(f, trap), value(0));
+  check_machine(lang, bb.make_or_else_expr(t, trap), value(1));
+  check_machine(lang, bb.make_if_expr(t, z1, z2), value(1));
+  check_machine(lang, bb.make_if_expr(f, z1, z2), value(2));
+  check_machine(lang, bb.make_if_expr(bb.make_and_then_expr(t, f), z1, z2), value(2));
+
+  // Arithmetic.
+  check_machine(lang, ib.make_add_expr(z1, z2), value(3));
+  check_machine(lang, ib.make_sub_expr(z1, z2), value(-1));
+  check_machine(lang, ib.make_mul_expr(z2, z2), value(4));
+  check_machine(lang, ib.make_quo_expr(z2, z1), value(2));
+  check_machine(lang, ib.make_rem_expr(z1, z2), value(1));
+  check_machine(lang, ib.make_neg_expr(z2), value(-2));
+  check_machine(lang, ib.make_lt_expr(z1, z2), value(1));
+  check_machine(lang, ib.make_add_expr(mmax, m1), value(0));
+  check_machine(lang, ib.make_add_expr(
+    ib.make_mul_expr(z2, ib.make_add_expr(z1, z2)),
+    ib.make_neg_expr(ib.make_sub_expr(z2, z1))
+  ), value(5));
+
+  // Errors.
+  check_machine_error(lang, vb.make_trap_expr());
+  check_machine_error(lang, trap);
+  check_machine_error(lang, ib.make_add_expr(zmax, z1));
+  check_machine_error(lang, ib.make_sub_expr(n0, n1));
+  check_machine_error(lang, ib.make_quo_expr(z1, ib.make_sub_expr(z1, z1)));
+  check_machine_error(lang, ib.make_neg_expr(zmin));
+  check_machine_error(lang, bb.make_if_expr(t, vb.make_trap_expr(), vb.make_nop_expr()));
+}
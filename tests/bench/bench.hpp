@@ -0,0 +1,47 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+#ifndef BENCH_BENCH_HPP
+#define BENCH_BENCH_HPP
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+
+/// Returns the average number of nanoseconds taken by each of `n` calls
+/// to `f`.
+template<typename F>
+inline double
+measure(int n, F f)
+{
+  using clock = std::chrono::steady_clock;
+  auto start = clock::now();
+  for (int i = 0; i < n; ++i)
+    f();
+  auto stop = clock::now();
+  std::chrono::duration<double, std::nano> d = stop - start;
+  return d.count() / n;
+}
+
+/// Print a labeled measurement.
+inline void
+report(const char* label, double ns)
+{
+  std::cout << std::left << std::setw(32) << label 
+            << std::right << std::setw(12) << std::fixed << std::setprecision(1) 
+            << ns << " ns\n";
+}
+
+/// Print a labeled measurement along with its speedup relative to a
+/// baseline measurement.
+inline void
+report(const char* label, double ns, double base)
+{
+  std::cout << std::left << std::setw(32) << label 
+            << std::right << std::setw(12) << std::fixed << std::setprecision(1) 
+            << ns << " ns" 
+            << std::setw(10) << std::setprecision(2) << base / ns << "x\n";
+}
+
+#endif
@@ -0,0 +1,101 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Compares the recursive tree walker, equal(), and hash() with their 
+// iterative counterparts on deep chains of additions that lean left or
+// right. Chains are limited to a depth that the recursive algorithms can
+// handle; only the iterative algorithms handle deeper chains.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/base/comparison/equal.hpp>
+#include <beaker/base/comparison/hash.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/all/evaluation/iterative.hpp>
+#include <beaker/all/comparison/iterative.hpp>
+
+#include <cassert>
+#include <string>
+
+
+using namespace beaker;
+
+/// Returns a chain of n additions of 1 to 0, leaning left if `left` is 
+/// true, and right otherwise.
+expr&
+make_chain(sys_int::builder& ib, type& t, int n, bool left)
+{
+  expr* r = &ib.make_int_expr(t, 0);
+  for (int i = 0; i < n; ++i) {
+    expr& one = ib.make_int_expr(t, 1);
+    r = left ? &ib.make_add_expr(*r, one) : &ib.make_add_expr(one, *r);
+  }
+  return *r;
+}
+
+void
+run(const char* shape, const language& lang, const expr& e1, const expr& e2, int depth, int n)
+{
+  evaluator eval(lang);
+  iterative_evaluator w(eval);
+  iterative_comparison c;
+  assert(evaluate(eval, e1) == w.evaluate(e1));
+  assert(equal(e1, e2) && c.equal(e1, e2));
+
+  std::cout << shape << " (depth " << depth << ")\n";
+  double walk = measure(n, [&]() { evaluate(eval, e1); });
+  double iter = measure(n, [&]() { w.evaluate(e1); });
+  report("  evaluate walk", walk);
+  report("  evaluate iterative", iter, walk);
+
+  double req = measure(n, [&]() { equal(e1, e2); });
+  double ieq = measure(n, [&]() { c.equal(e1, e2); });
+  report("  equal recursive", req);
+  report("  equal iterative", ieq, req);
+
+  std::size_t x = 0;
+  double rh = measure(n, [&]() { hasher h; hash(h, e1); x += h; });
+  double ih = measure(n, [&]() { hasher h; c.hash(h, e1); x += h; });
+  report("  hash recursive", rh);
+  report("  hash iterative", ih, rh);
+  if (x == 1)
+    std::cout << '\n';
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t = ib.get_mod_type(64);
+
+  for (int depth : {1000, 10000, 50000}) {
+    int n = 10000000 / depth;
+    expr& l1 = make_chain(ib, t, depth, true);
+    expr& l2 = make_chain(ib, t, depth, true);
+    run("left", lang, l1, l2, depth, n);
+    expr& r1 = make_chain(ib, t, depth, false);
+    expr& r2 = make_chain(ib, t, depth, false);
+    run("right", lang, r1, r2, depth, n);
+  }
+
+  // Only the iterative algorithms handle chains this deep.
+  int depth = 1000000;
+  expr& e1 = make_chain(ib, t, depth, true);
+  expr& e2 = make_chain(ib, t, depth, true);
+  evaluator eval(lang);
+  iterative_evaluator w(eval);
+  iterative_comparison c;
+  std::cout << "left (depth " << depth << ")\n";
+  report("  evaluate iterative", measure(10, [&]() { w.evaluate(e1); }));
+  report("  equal iterative", measure(10, [&]() { c.equal(e1, e2); }));
+  report("  hash iterative", measure(10, [&]() { hasher h; c.hash(h, e1); }));
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Compares speculative constant folding with the throwing evaluator, which
+// reports failures by exception, and with try_evaluate(), which returns a
+// failure record. Expressions that fold and expressions that overflow at
+// various depths are measured.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/all/evaluation/evaluate.hpp>
+
+#include <cassert>
+#include <string>
+
+
+using namespace beaker;
+
+/// Returns a chain of n additions of 1 to the literal v.
+expr&
+make_chain(sys_int::builder& ib, type& t, int v, int n)
+{
+  expr* r = &ib.make_int_expr(t, v);
+  for (int i = 0; i < n; ++i)
+    r = &ib.make_add_expr(*r, ib.make_int_expr(t, 1));
+  return *r;
+}
+
+/// Folds `e` by catching exceptions. Returns true if `e` has a value.
+bool
+fold_catch(evaluator& eval, const expr& e)
+{
+  try {
+    evaluate(eval, e);
+    return true;
+  } catch (evaluation_error&) {
+    return false;
+  }
+}
+
+/// Folds `e` by status. Returns true if `e` has a value.
+bool
+fold_status(evaluator& eval, const expr& e)
+{
+  return bool(try_evaluate(eval, e));
+}
+
+void
+run(const char* label, const language& lang, const expr& e, int n)
+{
+  evaluator eval(lang);
+  int x = 0;
+  double base = measure(n, [&]() { x += fold_catch(eval, e); });
+  double stat = measure(n, [&]() { x += fold_status(eval, e); });
+  std::string s = std::string("  ") + label + " catch";
+  report(s.c_str(), base);
+  s = std::string("  ") + label + " status";
+  report(s.c_str(), stat, base);
+  if (x == -1)
+    std::cout << '\n';
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t = ib.get_int8_type();
+
+  for (int d : {1, 10, 100}) {
+    std::cout << "depth " << d << '\n';
+    run("folds", lang, make_chain(ib, t, 0, d), 1000000 / d);
+    run("fails", lang, make_chain(ib, t, 127, d), 1000000 / d);
+  }
+}
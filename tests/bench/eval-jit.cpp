@@ -0,0 +1,131 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Compares the tree walking evaluator and the evaluation machine with
+// native code compiled by the JIT, on expressions and functions that are
+// evaluated repeatedly.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+#include <beaker/all/evaluation/machine.hpp>
+#include <beaker/all/evaluation/jit.hpp>
+
+#include <cassert>
+
+
+using namespace beaker;
+
+/// Builds a balanced expression tree of the given depth whose value never
+/// overflows a 32-bit integer.
+expr&
+make_arith(sys_int::builder& ib, type& t, int depth, int n = 1)
+{
+  if (depth == 0)
+    return ib.make_int_expr(t, n % 7);
+  expr& e1 = make_arith(ib, t, depth - 1, 2 * n);
+  expr& e2 = make_arith(ib, t, depth - 1, 2 * n + 1);
+  switch (depth % 3) {
+    case 0: return ib.make_add_expr(e1, e2);
+    case 1: return ib.make_sub_expr(e1, e2);
+    default: return ib.make_mul_expr(ib.make_rem_expr(e1, ib.make_int_expr(t, 5)), e2);
+  }
+}
+
+/// Builds a chain of conditionals comparing arithmetic subexpressions.
+expr&
+make_logic(sys_bool::builder& bb, sys_int::builder& ib, type& t, int depth)
+{
+  expr& a = make_arith(ib, t, 3, depth);
+  expr& b = make_arith(ib, t, 3, depth + 1);
+  if (depth == 0)
+    return ib.make_lt_expr(a, b);
+  expr& c = make_logic(bb, ib, t, depth - 1);
+  return bb.make_if_expr(bb.make_and_then_expr(c, ib.make_le_expr(a, b)),
+                         ib.make_ne_expr(a, b),
+                         bb.make_not_expr(ib.make_eq_expr(a, b)));
+}
+
+void
+run(const char* name, jit& j, const expr& e, int n)
+{
+  evaluator& eval = j.get_evaluator();
+  program p = compile(e);
+  machine m(eval);
+  native_program np = j.compile(e);
+  assert(evaluate(eval, e) == j.execute(np));
+
+  std::cout << name << '\n';
+  double walk = measure(n, [&]() { evaluate(eval, e); });
+  double vm = measure(n, [&]() { m.execute(p); });
+  double native = measure(n, [&]() { j.execute(np); });
+  double cjit = measure(10, [&]() { j.compile(e); });
+  report("  tree walker", walk);
+  report("  machine", vm, walk);
+  report("  jit", native, walk);
+  report("  jit compile", cjit);
+}
+
+/// Defines the function:
+///
+///   def fib(n : int32) -> int32 { return n < 2 ? n : fib(n - 1) + fib(n - 2); }
+decl&
+make_fib(module& mod)
+{
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& rb = mod.get_builder<sys_var::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+  auto& int32 = ib.get_int32_type();
+  auto& n = fb.make_parm_decl("n", int32);
+  auto& r = fb.make_parm_decl("r", int32);
+  decl_seq parms {&n};
+  auto& fn = fb.make_fn_decl(dc(mod), "fib", fb.get_fn_type(parms, r), parms, r);
+  auto& vn = rb.make_val_expr(rb.make_ref_expr(n));
+  auto& f1 = fb.make_call_expr(rb.make_ref_expr(fn),
+                               {&ib.make_sub_expr(vn, ib.make_int_expr(int32, 1))});
+  auto& f2 = fb.make_call_expr(rb.make_ref_expr(fn),
+                               {&ib.make_sub_expr(vn, ib.make_int_expr(int32, 2))});
+  auto& val = bb.make_if_expr(ib.make_lt_expr(vn, ib.make_int_expr(int32, 2)),
+                              vn, ib.make_add_expr(f1, f2));
+  fn.def_ = &fb.make_block_stmt({&fb.make_ret_stmt(val)});
+  mod.add_declaration(fn);
+  return fn;
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+  module mod(lang);
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& int32 = ib.get_int32_type();
+
+  evaluator eval(lang);
+  jit j(eval);
+  run("small arithmetic", j, make_arith(ib, int32, 3), 1000000);
+  run("large arithmetic", j, make_arith(ib, int32, 12), 1000);
+  run("conditional logic", j, make_logic(bb, ib, int32, 16), 10000);
+
+  decl& fib = make_fib(mod);
+  j.load(mod);
+  assert(j.call(fib, {value(20)}) == value(6765));
+  std::cout << "fib(20)\n";
+  report("  jit", measure(100, [&]() { j.call(fib, {value(20)}); }));
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Compares the tree walking evaluator with closures and the evaluation
+// machine on arithmetic and logical expressions that are evaluated
+// repeatedly.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/all/evaluation/machine.hpp>
+#include <beaker/all/evaluation/closure.hpp>
+
+#include <cassert>
+
+
+using namespace beaker;
+
+/// Builds a balanced expression tree of the given depth whose value never
+/// overflows a 32-bit integer.
+expr&
+make_arith(sys_int::builder& ib, type& t, int depth, int n = 1)
+{
+  if (depth == 0)
+    return ib.make_int_expr(t, n % 7);
+  expr& e1 = make_arith(ib, t, depth - 1, 2 * n);
+  expr& e2 = make_arith(ib, t, depth - 1, 2 * n + 1);
+  switch (depth % 3) {
+    case 0: return ib.make_add_expr(e1, e2);
+    case 1: return ib.make_sub_expr(e1, e2);
+    default: return ib.make_mul_expr(ib.make_rem_expr(e1, ib.make_int_expr(t, 5)), e2);
+  }
+}
+
+/// Builds a chain of conditionals comparing arithmetic subexpressions.
+expr&
+make_logic(sys_bool::builder& bb, sys_int::builder& ib, type& t, int depth)
+{
+  expr& a = make_arith(ib, t, 3, depth);
+  expr& b = make_arith(ib, t, 3, depth + 1);
+  if (depth == 0)
+    return ib.make_lt_expr(a, b);
+  expr& c = make_logic(bb, ib, t, depth - 1);
+  return bb.make_if_expr(bb.make_and_then_expr(c, ib.make_le_expr(a, b)),
+                         ib.make_ne_expr(a, b),
+                         bb.make_not_expr(ib.make_eq_expr(a, b)));
+}
+
+void
+run(const char* name, const language& lang, const expr& e, int n)
+{
+  evaluator eval(lang);
+  program p = compile(e);
+  machine m(eval);
+  closure_program cp = make_closure(e);
+  assert(evaluate(eval, e) == m.execute(p));
+  assert(evaluate(eval, e) == evaluate(eval, cp));
+
+  std::cout << name << " (" << p.get_code().size() << " instructions)\n";
+  double walk = measure(n, [&]() { evaluate(eval, e); });
+  double cl = measure(n, [&]() { evaluate(eval, cp); });
+  double vm = measure(n, [&]() { m.execute(p); });
+  double cvm = measure(n, [&]() { execute(eval, compile(e)); });
+  report("  tree walker", walk);
+  report("  closure", cl, walk);
+  report("  machine", vm, walk);
+  report("  compile + machine", cvm, walk);
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& bb = mod.get_builder<sys_bool::feature>();
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& int32 = ib.get_int32_type();
+
+  run("small arithmetic", lang, make_arith(ib, int32, 3), 1000000);
+  run("large arithmetic", lang, make_arith(ib, int32, 12), 1000);
+  run("conditional logic", lang, make_logic(bb, ib, int32, 16), 10000);
+}
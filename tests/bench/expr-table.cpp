@@ -0,0 +1,84 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Compares hashing every subexpression of a large expression by walking its
+// tree with hashing the same expressions in a linear scan of an expression
+// table.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/base/expr_table.hpp>
+#include <beaker/base/comparison/hash.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+
+#include <vector>
+
+
+using namespace beaker;
+
+/// Returns a balanced tree of additions and negations of the given depth
+/// whose leaves are distinct literals. Operators alternate between levels.
+expr&
+make_tree(sys_int::builder& ib, type& t, int depth, int& n)
+{
+  if (depth == 0)
+    return ib.make_int_expr(t, n++);
+  if (depth % 2)
+    return ib.make_neg_expr(make_tree(ib, t, depth - 1, n));
+  expr& e1 = make_tree(ib, t, depth - 1, n);
+  expr& e2 = make_tree(ib, t, depth - 1, n);
+  return ib.make_add_expr(e1, e2);
+}
+
+/// Hashes each subexpression of e into codes, in post order.
+std::size_t
+hash_tree(const expr& e, std::vector<std::size_t>& codes)
+{
+  hasher h;
+  hash(h, e);
+  if (const unary_expr* u = dynamic_cast<const unary_expr*>(&e))
+    hash_tree(u->get_first(), codes);
+  else if (const binary_expr* b = dynamic_cast<const binary_expr*>(&e)) {
+    hash_tree(b->get_first(), codes);
+    hash_tree(b->get_second(), codes);
+  }
+  codes.push_back(h);
+  return h;
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t = ib.get_int64_type();
+
+  // A tree with about 100 thousand nodes.
+  expr_table tab;
+  ib.set_expr_table(&tab);
+  int n = 0;
+  expr& e = make_tree(ib, t, 31, n);
+  ib.set_expr_table(nullptr);
+
+  std::size_t x = 0;
+  std::cout << "hash all subexpressions\n";
+  double base = measure(10, [&]() {
+    std::vector<std::size_t> codes;
+    codes.reserve(tab.size());
+    x += hash_tree(e, codes);
+  });
+  report("  tree", base);
+  report("  table", measure(10, [&]() {
+    x += tab.hash_all().back();
+  }), base);
+  if (x == 1)
+    std::cout << '\n';
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Compares building redundant expressions with and without hash-consing.
+// The expression is an unrolled sum of products of small literals, as
+// generated code might contain, so most of its subexpressions repeat.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+
+#include <string>
+
+
+using namespace beaker;
+
+/// The number of terms in the sum.
+constexpr int size = 1 << 18;
+
+/// Returns the sum of (i % 8) * ((i % 4) + 1) for each i less than n.
+expr&
+make_sum(sys_int::builder& ib, type& t, int n)
+{
+  expr* e = &ib.make_int_expr(t, 0);
+  for (int i = 0; i < n; ++i) {
+    expr& a = ib.make_int_expr(t, i % 8);
+    expr& b = ib.make_add_expr(ib.make_int_expr(t, i % 4), ib.make_int_expr(t, 1));
+    e = &ib.make_add_expr(*e, ib.make_mul_expr(a, b));
+  }
+  return *e;
+}
+
+/// Build the sum in a new module, with hash-consing if b is true. Reports
+/// the time to build the sum and the memory used by its expressions.
+double
+run(const char* label, language& lang, bool b, double base)
+{
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t = ib.get_int64_type();
+  ib.set_hash_consing(b);
+
+  std::size_t before = ib.get_stats().footprint;
+  double ns = measure(1, [&]() { make_sum(ib, t, size); });
+  std::size_t after = ib.get_stats().footprint;
+
+  std::string s = std::string("  ") + label;
+  if (base)
+    report(s.c_str(), ns, base);
+  else
+    report(s.c_str(), ns);
+  std::cout << "    footprint " << (after - before) / 1024 << " KB\n";
+  return ns;
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+
+  std::cout << "build sum\n";
+  double base = run("unique", lang, false, 0);
+  run("hash-consed", lang, true, base);
+}
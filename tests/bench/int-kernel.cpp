@@ -0,0 +1,160 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Compares the arithmetic kernels of integer types with checked arithmetic
+// computed in the value representation, for each operator and width. Also
+// measures the evaluation of each operator by the tree walker, including
+// 128-bit arithmetic.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.int/evaluation/evaluate.hpp>
+
+#include <string>
+#include <vector>
+
+
+using namespace beaker;
+using namespace beaker::sys_int;
+
+// Operands are read through these so that operations are not folded.
+std::vector<std::intmax_t> lhs;
+std::vector<std::intmax_t> rhs;
+
+/// Checked arithmetic in the value representation, bounded by the limits of
+/// the type t. This is how integer arithmetic was computed before kernels.
+struct generic
+{
+  static arith_status
+  add(const int_type& t, std::intmax_t a, std::intmax_t b, std::intmax_t& r)
+  {
+    if ((b > 0 && a > t.max() - b) || (b < 0 && a < t.min() - b))
+      return arith_overflow;
+    r = a + b;
+    return arith_ok;
+  }
+
+  static arith_status
+  sub(const int_type& t, std::intmax_t a, std::intmax_t b, std::intmax_t& r)
+  {
+    if ((b < 0 && a > t.max() + b) || (b > 0 && a < t.min() + b))
+      return arith_overflow;
+    r = a - b;
+    return arith_ok;
+  }
+
+  static arith_status
+  mul(const int_type& t, std::intmax_t a, std::intmax_t b, std::intmax_t& r)
+  {
+    if (b > 0 && (a > t.max() / b || a < t.min() / b))
+      return arith_overflow;
+    if (b < 0 && (a < t.max() / b || (b != -1 && a > t.min() / b) || (b == -1 && a == t.min())))
+      return arith_overflow;
+    r = a * b;
+    return arith_ok;
+  }
+
+  static arith_status
+  quo(const int_type& t, std::intmax_t a, std::intmax_t b, std::intmax_t& r)
+  {
+    if (b == 0)
+      return arith_division;
+    if (a == t.min() && b == -1)
+      return arith_overflow;
+    r = a / b;
+    return arith_ok;
+  }
+};
+
+using generic_fn = arith_status (*)(const int_type&, std::intmax_t, std::intmax_t, std::intmax_t&);
+
+/// Run an operation over all operands. Returns the number of successful
+/// operations so that the result is used.
+template<typename F>
+int
+sweep(F f)
+{
+  int n = 0;
+  std::intmax_t r;
+  for (std::size_t i = 0; i < lhs.size(); ++i)
+    n += f(lhs[i], rhs[i], r) == arith_ok;
+  return n;
+}
+
+void
+run(const char* op, const int_type& t, generic_fn g, kernel::binary_fn k, int n)
+{
+  int x = 0;
+  double base = measure(n, [&]() {
+    x += sweep([&](std::intmax_t a, std::intmax_t b, std::intmax_t& r) { return g(t, a, b, r); });
+  });
+  double kern = measure(n, [&]() {
+    x += sweep([&](std::intmax_t a, std::intmax_t b, std::intmax_t& r) { return k(a, b, r); });
+  });
+  std::string label = std::string("  ") + op + " generic";
+  report(label.c_str(), base / lhs.size());
+  label = std::string("  ") + op + " kernel";
+  report(label.c_str(), kern / lhs.size(), base / lhs.size());
+  if (x == -1)
+    std::cout << '\n';
+}
+
+/// Measures the tree walker evaluating `e`.
+void
+run_walk(const char* op, const language& lang, const expr& e, int n)
+{
+  evaluator eval(lang);
+  std::string label = std::string("  ") + op + " walk";
+  report(label.c_str(), measure(n, [&]() { evaluate(eval, e); }));
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+
+  for (int p : {8, 16, 32, 64}) {
+    int_type& t = ib.get_int_type(p);
+    lhs.clear();
+    rhs.clear();
+    for (int i = 0; i < 4096; ++i) {
+      lhs.push_back((i * 7919) % (t.max() < 1000 ? t.max() : 1000) - 3);
+      rhs.push_back((i * 104729) % 13 - 6);
+    }
+
+    std::cout << "int" << p << '\n';
+    const kernel& k = t.get_kernel();
+    run("add", t, generic::add, k.add_, 1000);
+    run("sub", t, generic::sub, k.sub_, 1000);
+    run("mul", t, generic::mul, k.mul_, 1000);
+    run("quo", t, generic::quo, k.quo_, 1000);
+
+    auto& a = ib.make_int_expr(t, 5);
+    auto& b = ib.make_int_expr(t, 3);
+    run_walk("add", lang, ib.make_add_expr(a, b), 1000000);
+    run_walk("sub", lang, ib.make_sub_expr(a, b), 1000000);
+    run_walk("mul", lang, ib.make_mul_expr(a, b), 1000000);
+    run_walk("quo", lang, ib.make_quo_expr(a, b), 1000000);
+  }
+
+  // Types wider than a machine word have no word-sized kernel. Their
+  // arithmetic is computed by the wide kernel, which the walker selects.
+  int_type& w = ib.get_int_type(128);
+  std::cout << "int128\n";
+  auto& a = ib.make_int_expr(w, value(w.wide_max() / 3));
+  auto& b = ib.make_int_expr(w, 3);
+  run_walk("add", lang, ib.make_add_expr(a, b), 1000000);
+  run_walk("sub", lang, ib.make_sub_expr(a, b), 1000000);
+  run_walk("mul", lang, ib.make_mul_expr(a, b), 1000000);
+  run_walk("quo", lang, ib.make_quo_expr(a, b), 1000000);
+}
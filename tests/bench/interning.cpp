@@ -0,0 +1,123 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Measures the hashing of canonical terms. The first part compares the
+// default hasher with the fnv1a hasher on the kinds and addresses that make
+// up the hash code of a canonical type. The second part measures lookups of
+// canonical types and names, which are dominated by hashing. Compare the
+// second part with a build that uses fnv1a to see the effect on interning,
+// or with BEAKER_HASH_CACHE to see the effect of memoized hash codes.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+
+#include <string>
+#include <vector>
+
+
+using namespace beaker;
+
+/// The number of lookups in each measurement.
+constexpr int size = 1 << 16;
+
+/// Hashes the kind and parameter and return types of a function type with
+/// n parameters, as hash_type would, using a hasher of type H.
+template<typename H>
+std::size_t
+hash_fn(int kind, const std::vector<const type*>& ts, int n)
+{
+  H h;
+  h(&kind, sizeof(kind));
+  for (int i = 0; i < n; ++i)
+    h(&ts[i], sizeof(ts[i]));
+  h(&ts[n], sizeof(ts[n]));
+  return h;
+}
+
+template<typename H>
+double
+hash_words(const std::vector<const type*>& ts)
+{
+  std::size_t x = 0;
+  double ns = measure(10, [&]() {
+    for (int i = 0; i < size; ++i)
+      x += hash_fn<H>(i & 0xff, ts, i % 8);
+  }) / size;
+  if (x == 1)
+    std::cout << '\n';
+  return ns;
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& nb = mod.get_builder<sys_name::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+
+  std::vector<const type*> ts {
+    &ib.get_int8_type(), &ib.get_int16_type(), &ib.get_int32_type(), 
+    &ib.get_int64_type(), &ib.get_nat8_type(), &ib.get_nat16_type(), 
+    &ib.get_nat32_type(), &ib.get_nat64_type(), &ib.get_mod32_type(),
+  };
+
+  std::cout << "hash canonical types\n";
+  double base = hash_words<fnv1a_hasher>(ts);
+  report("  fnv1a", base);
+  report("  word", hash_words<hasher>(ts), base);
+
+  // Names for distinct symbols.
+  std::vector<const symbol*> ss;
+  for (int i = 0; i < 4096; ++i)
+    ss.push_back(&syms.get("x" + std::to_string(i)));
+
+  // Function types with up to 7 parameters.
+  std::vector<type_seq> ps(8);
+  for (int i = 0; i < 8; ++i)
+    for (int j = 0; j < i; ++j)
+      ps[i].push_back(const_cast<type*>(ts[j]));
+
+  std::size_t x = 0;
+  std::cout << "intern terms\n";
+  report("  int types", measure(10, [&]() {
+    for (int i = 0; i < size; ++i)
+      x += reinterpret_cast<std::uintptr_t>(&ib.get_int_type(8 << (i % 4)));
+  }) / size);
+  report("  names", measure(10, [&]() {
+    for (int i = 0; i < size; ++i)
+      x += reinterpret_cast<std::uintptr_t>(&nb.get_name(*ss[i % ss.size()]));
+  }) / size);
+  report("  fn types", measure(10, [&]() {
+    for (int i = 0; i < size; ++i)
+      x += reinterpret_cast<std::uintptr_t>(&fb.get_fn_type(ps[i % 8], ib.get_int64_type()));
+  }) / size);
+
+  // Rehash a function type whose parameters are function types, nested 8
+  // deep. The nested types are canonical, so they are hashed by identity.
+  type* n = &ib.get_int64_type();
+  for (int i = 0; i < 8; ++i)
+    n = &fb.get_fn_type(type_seq {n, n, n}, *n);
+  report("  rehash nested fn type", measure(1000, [&]() {
+    x += term_hash()(*n);
+  }));
+  if (x == 1)
+    std::cout << '\n';
+}
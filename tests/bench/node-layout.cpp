@@ -0,0 +1,101 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Compares the layout of terms when a factory allocates all terms in a
+// shared arena with the layout when each family of terms has its own arena.
+// The builder for functions creates calls, parameters, and statements in
+// the same factory; they are created in an interleaved order, and only the
+// calls are traversed.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/base/comparison/hash.hpp>
+#include <beaker/sys.void/ast.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/sys.name/ast.hpp>
+#include <beaker/sys.var/ast.hpp>
+#include <beaker/sys.fn/ast.hpp>
+
+#include <string>
+#include <vector>
+
+
+using namespace beaker;
+
+/// The number of calls in each module.
+constexpr int size = 1 << 19;
+
+/// Returns a hash of the call expressions in v, visiting their functions
+/// and arguments.
+std::size_t
+traverse(const std::vector<sys_fn::call_expr*>& v)
+{
+  hasher h;
+  for (const sys_fn::call_expr* c : v) {
+    hash(h, c->get_function());
+    hash(h, c->get_arguments());
+  }
+  return h;
+}
+
+/// Build calls in a module whose function factory uses the policy p and
+/// measure their traversal. Returns the traversal time per call.
+double
+run(const char* label, language& lang, arena_policy p, double base)
+{
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& rb = mod.get_builder<sys_var::feature>();
+  auto& fb = mod.get_builder<sys_fn::feature>();
+  fb.set_arena_policy(p);
+
+  auto& t = ib.get_int64_type();
+  auto& r = fb.make_parm_decl("r", t);
+  decl_seq parms {&fb.make_parm_decl("n", t)};
+  auto& fn = fb.make_fn_decl(dc(mod), "f", fb.get_fn_type(parms, r), parms, r);
+  auto& ref = rb.make_ref_expr(fn);
+
+  // Each call is surrounded by the declarations and statements that would
+  // be created while parsing it.
+  std::vector<sys_fn::call_expr*> calls;
+  calls.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    fb.make_parm_decl("x", t);
+    auto& c = fb.make_call_expr(ref, {&ib.make_int_expr(t, i)});
+    fb.make_expr_stmt(c);
+    fb.make_ret_stmt();
+    calls.push_back(&c);
+  }
+
+  std::size_t x = 0;
+  double ns = measure(20, [&]() { x += traverse(calls); }) / size;
+  std::string s = std::string("  ") + label;
+  if (base)
+    report(s.c_str(), ns, base);
+  else
+    report(s.c_str(), ns);
+  if (x == 1)
+    std::cout << '\n';
+  return ns;
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_void::feature(),
+    new sys_bool::feature(),
+    new sys_int::feature(),
+    new sys_name::feature(),
+    new sys_var::feature(),
+    new sys_fn::feature(),
+  });
+
+  std::cout << "traverse calls\n";
+  double base = run("shared arena", lang, shared_arena_policy, 0);
+  run("family arenas", lang, family_arena_policy, base);
+}
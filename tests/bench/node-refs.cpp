@@ -0,0 +1,72 @@
+// Copyright (c) 2015-2017 Andrew Sutton
+// All rights reserved
+
+// Measures the size of expression nodes, the memory needed to store a large
+// expression, and the time needed to traverse it. Run this with and without
+// BEAKER_COMPACT_REFS to compare pointers with 32-bit node references.
+
+#include "bench.hpp"
+
+#include <beaker/base/module.hpp>
+#include <beaker/base/symbol_table.hpp>
+#include <beaker/base/comparison/hash.hpp>
+#include <beaker/sys.bool/ast.hpp>
+#include <beaker/sys.int/ast.hpp>
+#include <beaker/all/evaluation/evaluate.hpp>
+
+
+using namespace beaker;
+
+/// Returns a balanced tree of additions and negations of the given depth
+/// whose leaves are the literal 1. Operators alternate between levels.
+expr&
+make_tree(sys_int::builder& ib, type& t, int depth)
+{
+  if (depth == 0)
+    return ib.make_int_expr(t, 1);
+  if (depth % 2)
+    return ib.make_neg_expr(make_tree(ib, t, depth - 1));
+  return ib.make_add_expr(make_tree(ib, t, depth - 1), make_tree(ib, t, depth - 1));
+}
+
+int
+main()
+{
+  symbol_table syms;
+  language lang(syms, {
+    new sys_bool::feature(),
+    new sys_int::feature(),
+  });
+  module mod(lang);
+  auto& ib = mod.get_builder<sys_int::feature>();
+  auto& t = ib.get_int64_type();
+
+#if BEAKER_COMPACT_REFS
+  std::cout << "compact references\n";
+#else
+  std::cout << "pointer references\n";
+#endif
+  std::cout << "  sizeof(literal_expr)        " << sizeof(literal_expr) << '\n';
+  std::cout << "  sizeof(unary_expr)          " << sizeof(unary_expr) << '\n';
+  std::cout << "  sizeof(binary_expr)         " << sizeof(binary_expr) << '\n';
+  std::cout << "  sizeof(ternary_expr)        " << sizeof(ternary_expr) << '\n';
+
+  // A tree with about 3 million nodes.
+  std::size_t before = ib.get_stats().footprint;
+  expr& e = make_tree(ib, t, 41);
+  std::size_t after = ib.get_stats().footprint;
+  std::cout << "  footprint                   " << (after - before) / 1024 << " KB\n";
+
+  std::size_t x = 0;
+  report("  hash", measure(10, [&]() {
+    hasher h;
+    hash(h, e);
+    x += h;
+  }));
+  evaluator eval(lang);
+  report("  evaluate", measure(10, [&]() {
+    x += evaluate(eval, e).get_int();
+  }));
+  if (x == 1)
+    std::cout << '\n';
+}